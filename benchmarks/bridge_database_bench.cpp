@@ -0,0 +1,300 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <random>
+
+#include "dependency/bridge_bot/database_manager.hpp"
+
+namespace {
+
+using obcx::storage::DatabaseManager;
+using obcx::storage::DatabaseOptions;
+using obcx::storage::MessageMapping;
+
+constexpr int kMappings = 100'000;
+
+constexpr const char *kInsertSql = R"(
+        INSERT OR REPLACE INTO message_mappings
+        (source_platform, source_message_id, target_platform, target_message_id)
+        VALUES (?, ?, ?, ?);
+    )";
+
+constexpr const char *kSelectSql = R"(
+        SELECT target_message_id FROM message_mappings
+        WHERE source_platform = ? AND source_message_id = ?
+          AND target_platform = ?;
+    )";
+
+// 参照组：改动前的做法，回滚日志 + synchronous=FULL，每次调用重新 prepare
+class LegacyMappings {
+public:
+  explicit LegacyMappings(const std::string &path) {
+    sqlite3_open(path.c_str(), &db_);
+    sqlite3_exec(db_,
+                 "PRAGMA journal_mode = DELETE; PRAGMA synchronous = FULL;",
+                 nullptr, nullptr, nullptr);
+  }
+  ~LegacyMappings() { sqlite3_close(db_); }
+
+  LegacyMappings(const LegacyMappings &) = delete;
+  auto operator=(const LegacyMappings &) -> LegacyMappings & = delete;
+
+  auto add(const MessageMapping &mapping) -> bool {
+    sqlite3_stmt *stmt = nullptr;
+    sqlite3_prepare_v2(db_, kInsertSql, -1, &stmt, nullptr);
+    sqlite3_bind_text(stmt, 1, mapping.source_platform.c_str(), -1,
+                      SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, mapping.source_message_id.c_str(), -1,
+                      SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, mapping.target_platform.c_str(), -1,
+                      SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, mapping.target_message_id.c_str(), -1,
+                      SQLITE_STATIC);
+    const int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE;
+  }
+
+  auto find(const std::string &source_message_id)
+      -> std::optional<std::string> {
+    sqlite3_stmt *stmt = nullptr;
+    sqlite3_prepare_v2(db_, kSelectSql, -1, &stmt, nullptr);
+    sqlite3_bind_text(stmt, 1, "qq", -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, source_message_id.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, "telegram", -1, SQLITE_STATIC);
+    std::optional<std::string> result;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+      result = reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    return result;
+  }
+
+private:
+  sqlite3 *db_ = nullptr;
+};
+
+auto database_path(const std::string &name) -> std::string {
+  const auto path =
+      std::filesystem::temp_directory_path() / ("obcx-bench-" + name + ".db");
+  for (const auto *suffix : {"", "-wal", "-shm", "-journal"}) {
+    std::filesystem::remove(path.string() + suffix);
+  }
+  return path.string();
+}
+
+auto mapping(int i) -> MessageMapping {
+  return MessageMapping{.source_platform = "qq",
+                        .source_message_id = std::to_string(i),
+                        .target_platform = "telegram",
+                        .target_message_id = std::to_string(i + 1'000'000)};
+}
+
+// 建表并写入 kMappings 条映射，供查询基准共用
+auto populated_database() -> const std::string & {
+  static const std::string path = [] {
+    auto path = database_path("lookup");
+    DatabaseManager db(path);
+    db.initialize();
+    for (int i = 0; i < kMappings; ++i) {
+      db.add_message_mapping(mapping(i));
+    }
+    return path;
+  }();
+  return path;
+}
+
+void BM_InsertMappingsLegacy(benchmark::State &state) {
+  for (auto _ : state) {
+    const auto path = database_path("insert-legacy");
+    {
+      DatabaseManager schema(path, {.read_connections = 0, .wal = false});
+      schema.initialize();
+    }
+    LegacyMappings db(path);
+    for (int i = 0; i < kMappings; ++i) {
+      benchmark::DoNotOptimize(db.add(mapping(i)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kMappings);
+}
+BENCHMARK(BM_InsertMappingsLegacy)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(1);
+
+void BM_InsertMappings(benchmark::State &state) {
+  for (auto _ : state) {
+    const auto path = database_path("insert");
+    DatabaseManager db(path);
+    db.initialize();
+    for (int i = 0; i < kMappings; ++i) {
+      benchmark::DoNotOptimize(db.add_message_mapping(mapping(i)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kMappings);
+}
+BENCHMARK(BM_InsertMappings)->Unit(benchmark::kMillisecond)->Iterations(1);
+
+// 关闭写入批次，每行一个事务
+void BM_InsertMappingsUnbatched(benchmark::State &state) {
+  for (auto _ : state) {
+    const auto path = database_path("insert-unbatched");
+    DatabaseManager db(path, {.batch_interval = std::chrono::milliseconds(0)});
+    db.initialize();
+    for (int i = 0; i < kMappings; ++i) {
+      benchmark::DoNotOptimize(db.add_message_mapping(mapping(i)));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kMappings);
+}
+BENCHMARK(BM_InsertMappingsUnbatched)
+    ->Unit(benchmark::kMillisecond)
+    ->Iterations(1);
+
+void BM_LookupMappingsLegacy(benchmark::State &state) {
+  LegacyMappings db(populated_database());
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> key(0, kMappings - 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(db.find(std::to_string(key(rng))));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LookupMappingsLegacy);
+
+void BM_LookupMappings(benchmark::State &state) {
+  DatabaseManager db(populated_database());
+  db.initialize();
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> key(0, kMappings - 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        db.get_target_message_id("qq", std::to_string(key(rng)), "telegram"));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LookupMappings);
+
+// 解析对最近转发消息的回复。参数为映射缓存大小，0 表示每次都查询 SQLite
+void BM_ResolveRecentReply(benchmark::State &state) {
+  constexpr int kRecent = 1000;
+  DatabaseManager db(populated_database(),
+                     {.mapping_cache_size =
+                          static_cast<std::size_t>(state.range(0))});
+  db.initialize();
+  for (int i = kMappings; i < kMappings + kRecent; ++i) {
+    db.add_message_mapping(mapping(i));
+  }
+  db.flush();
+
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> key(kMappings, kMappings + kRecent - 1);
+  for (auto _ : state) {
+    // 回复的是对端转发过来的消息，只有反向映射
+    const auto reply_to = std::to_string(key(rng) + 1'000'000);
+    benchmark::DoNotOptimize(
+        db.find_linked_message_id("telegram", reply_to, "qq"));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResolveRecentReply)->Arg(0)->Arg(8192);
+
+// 保留策略基准：kLargeTable 条映射的 created_at 均匀分布在过去 kSpanDays
+// 天内，清理后只保留最近 kRetentionDays 天
+constexpr int64_t kLargeTable = 10'000'000;
+constexpr int64_t kSpanDays = 400;
+constexpr int64_t kRetentionDays = 30;
+// 保留期内的第一条映射，清理前后都只查询保留期内的映射
+constexpr int64_t kRetainedFrom =
+    kLargeTable - kLargeTable * kRetentionDays / kSpanDays;
+
+auto archive_dir() -> std::filesystem::path {
+  return std::filesystem::temp_directory_path() / "obcx-bench-archive";
+}
+
+auto retention_options() -> DatabaseOptions {
+  return {.mapping_cache_size = 0,
+          .retention_age = std::chrono::hours(24 * kRetentionDays),
+          .archive_dir = archive_dir().string()};
+}
+
+// 建表后用一条 INSERT ... SELECT 批量生成映射，比逐行写入快两个数量级
+auto large_database() -> const std::string & {
+  static const std::string path = [] {
+    auto path = database_path("large");
+    std::filesystem::remove_all(archive_dir());
+    {
+      DatabaseManager schema(path);
+      schema.initialize();
+    }
+    sqlite3 *db = nullptr;
+    sqlite3_open(path.c_str(), &db);
+    sqlite3_exec(db, "PRAGMA cache_size = -1048576;", nullptr, nullptr,
+                 nullptr);
+    sqlite3_stmt *stmt = nullptr;
+    sqlite3_prepare_v2(db, R"(
+        WITH RECURSIVE seq(i) AS (
+            SELECT 0 UNION ALL SELECT i + 1 FROM seq WHERE i < ?1 - 1)
+        INSERT INTO message_mappings
+        (source_platform, source_message_id, target_platform,
+         target_message_id, created_at)
+        SELECT 'qq', i, 'telegram', i + 1000000,
+               datetime(strftime('%s', 'now') - (?1 - i) * ?2 / ?1,
+                        'unixepoch')
+        FROM seq;
+    )",
+                       -1, &stmt, nullptr);
+    sqlite3_bind_int64(stmt, 1, kLargeTable);
+    sqlite3_bind_int64(stmt, 2, kSpanDays * 24 * 3600);
+    sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr);
+    sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+    return path;
+  }();
+  return path;
+}
+
+void lookup_retained_mappings(benchmark::State &state, DatabaseManager &db) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int64_t> key(kRetainedFrom, kLargeTable - 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        db.get_target_message_id("qq", std::to_string(key(rng)), "telegram"));
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["db_mib"] = static_cast<double>(std::filesystem::file_size(
+                                 large_database())) /
+                             (1 << 20);
+}
+
+void BM_LookupLargeTable(benchmark::State &state) {
+  DatabaseManager db(large_database(), {.mapping_cache_size = 0});
+  db.initialize();
+  lookup_retained_mappings(state, db);
+}
+BENCHMARK(BM_LookupLargeTable);
+
+// 把保留期外的映射按月移入归档库，每批 retention_batch_rows 行
+void BM_ApplyRetention(benchmark::State &state) {
+  std::size_t rows = 0;
+  for (auto _ : state) {
+    DatabaseManager db(large_database(), retention_options());
+    db.initialize();
+    rows = db.apply_retention();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(rows));
+}
+BENCHMARK(BM_ApplyRetention)->Unit(benchmark::kMillisecond)->Iterations(1);
+
+void BM_LookupAfterRetention(benchmark::State &state) {
+  DatabaseManager db(large_database(), retention_options());
+  db.initialize();
+  // 单独运行时先完成清理；已经清理过时不做任何事
+  db.apply_retention();
+  lookup_retained_mappings(state, db);
+}
+BENCHMARK(BM_LookupAfterRetention);
+
+} // namespace
@@ -0,0 +1,138 @@
+#include <benchmark/benchmark.h>
+
+#include <any>
+#include <map>
+#include <typeindex>
+
+#include "core/event_dispatcher.hpp"
+#include "core/qq_bot.hpp"
+
+namespace {
+
+using obcx::common::Event;
+using obcx::common::MessageEvent;
+using obcx::core::IBot;
+namespace asio = boost::asio;
+
+// 参照组：std::map<type_index> 查找 + std::any 类型擦除 + 每个处理器拷贝事件
+class AnyDispatcher {
+public:
+  explicit AnyDispatcher(asio::io_context &io_context)
+      : io_context_(io_context) {}
+
+  template <typename EventType>
+  void on(std::function<asio::awaitable<void>(IBot &, EventType)> handler) {
+    handlers_[std::type_index(typeid(EventType))].push_back(
+        [handler](IBot *bot, std::any event_any) -> asio::awaitable<void> {
+          if (auto *event = std::any_cast<EventType>(&event_any)) {
+            co_await handler(*bot, *event);
+          }
+        });
+  }
+
+  void dispatch(IBot *bot, const Event &event) {
+    std::visit(
+        [this, bot](const auto &concrete_event) {
+          using ConcreteEventType = std::decay_t<decltype(concrete_event)>;
+          const auto type_idx = std::type_index(typeid(ConcreteEventType));
+          if (handlers_.contains(type_idx)) {
+            for (const auto &handler : handlers_.at(type_idx)) {
+              asio::co_spawn(
+                  io_context_,
+                  [handler, bot, concrete_event]() -> asio::awaitable<void> {
+                    co_await handler(bot, concrete_event);
+                  },
+                  asio::detached);
+            }
+          }
+        },
+        event);
+  }
+
+private:
+  asio::io_context &io_context_;
+  std::map<std::type_index,
+           std::vector<std::function<asio::awaitable<void>(IBot *, std::any)>>>
+      handlers_;
+};
+
+auto sample_event() -> Event {
+  MessageEvent event;
+  event.post_type = "message";
+  event.message_type = "group";
+  event.user_id = obcx::common::UserId(int64_t{2458061234});
+  event.group_id = obcx::common::ChatId(int64_t{987654321});
+  event.message_id = obcx::common::MessageId(int64_t{-2093847561});
+  event.raw_message = "今天的会议改到下午三点，大家记得带上周报 "
+                      "[CQ:image,file=report.png]";
+  for (int i = 0; i < 4; ++i) {
+    obcx::common::MessageSegment segment;
+    segment.type = "text";
+    segment.data["text"] = "今天的会议改到下午三点，大家记得带上周报";
+    event.message.push_back(std::move(segment));
+  }
+  return event;
+}
+
+template <typename Dispatcher, typename Handler>
+void run_dispatch(benchmark::State &state, Handler handler) {
+  asio::io_context io_context;
+  obcx::core::QQBot bot{obcx::adapter::onebot11::ProtocolAdapter{}};
+  Dispatcher dispatcher(io_context);
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    dispatcher.template on<MessageEvent>(handler);
+  }
+
+  const auto event = sample_event();
+  for (auto _ : state) {
+    dispatcher.dispatch(&bot, event);
+    io_context.run();
+    io_context.restart();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DispatchAnyReference(benchmark::State &state) {
+  run_dispatch<AnyDispatcher>(
+      state, [](IBot &, MessageEvent event) -> asio::awaitable<void> {
+        benchmark::DoNotOptimize(event.raw_message.data());
+        co_return;
+      });
+}
+BENCHMARK(BM_DispatchAnyReference)->Arg(1)->Arg(10)->Arg(50);
+
+void BM_DispatchVariantIndex(benchmark::State &state) {
+  run_dispatch<obcx::core::EventDispatcher>(
+      state, [](IBot &, const MessageEvent &event) -> asio::awaitable<void> {
+        benchmark::DoNotOptimize(event.raw_message.data());
+        co_return;
+      });
+}
+BENCHMARK(BM_DispatchVariantIndex)->Arg(1)->Arg(10)->Arg(50);
+
+// 每个处理器只关心一个群，事件只命中其中一个
+void BM_DispatchFilteredByGroup(benchmark::State &state) {
+  asio::io_context io_context;
+  obcx::core::QQBot bot{obcx::adapter::onebot11::ProtocolAdapter{}};
+  obcx::core::EventDispatcher dispatcher(io_context);
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    dispatcher.on(
+        obcx::core::MessageFilter{
+            .group_ids = {std::to_string(987654321 - i)}},
+        [](IBot &, const MessageEvent &event) -> asio::awaitable<void> {
+          benchmark::DoNotOptimize(event.raw_message.data());
+          co_return;
+        });
+  }
+
+  const auto event = sample_event();
+  for (auto _ : state) {
+    dispatcher.dispatch(&bot, event);
+    io_context.run();
+    io_context.restart();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DispatchFilteredByGroup)->Arg(1)->Arg(10)->Arg(50);
+
+} // namespace
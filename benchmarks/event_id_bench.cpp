@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <unordered_map>
+
+#include "common/json_utils.hpp"
+
+namespace {
+
+using obcx::common::ChatId;
+using obcx::common::json;
+using obcx::common::Platform;
+
+const json &sample_group_message() {
+  static const json j = json::parse(R"({
+    "time": 1718000000,
+    "self_id": 3889001234,
+    "post_type": "message",
+    "message_type": "group",
+    "sub_type": "normal",
+    "message_id": 1948372615,
+    "user_id": 2458061234,
+    "group_id": 987654321,
+    "message": [{"type": "text", "data": {"text": "hello bridge"}}],
+    "raw_message": "hello bridge",
+    "font": 0,
+    "sender": {"user_id": 2458061234, "nickname": "tester", "card": ""}
+  })");
+  return j;
+}
+
+// 旧路径：数字ID经 std::to_string 转为字符串
+void BM_IdAsString(benchmark::State &state) {
+  const auto &j = sample_group_message();
+  for (auto _ : state) {
+    auto user_id = obcx::common::JsonUtils::get_id_as_string(j, "user_id");
+    auto group_id =
+        obcx::common::JsonUtils::get_optional_id_as_string(j, "group_id");
+    benchmark::DoNotOptimize(user_id);
+    benchmark::DoNotOptimize(group_id);
+  }
+}
+BENCHMARK(BM_IdAsString);
+
+void BM_IdCompact(benchmark::State &state) {
+  const auto &j = sample_group_message();
+  for (auto _ : state) {
+    auto user_id = obcx::common::JsonUtils::get_id(j, "user_id", Platform::qq);
+    auto group_id =
+        obcx::common::JsonUtils::get_optional_id(j, "group_id", Platform::qq);
+    benchmark::DoNotOptimize(user_id);
+    benchmark::DoNotOptimize(group_id);
+  }
+}
+BENCHMARK(BM_IdCompact);
+
+// 桥接查表：按群ID查找映射配置
+template <typename Key> auto make_group_table(std::size_t size) {
+  std::unordered_map<Key, int> table;
+  for (std::size_t i = 0; i < size; ++i) {
+    auto id = static_cast<int64_t>(100000000 + i * 7919);
+    if constexpr (std::is_same_v<Key, std::string>) {
+      table.emplace(std::to_string(id), static_cast<int>(i));
+    } else {
+      table.emplace(ChatId(id, Platform::qq), static_cast<int>(i));
+    }
+  }
+  return table;
+}
+
+void BM_GroupLookupString(benchmark::State &state) {
+  auto table = make_group_table<std::string>(state.range(0));
+  const auto &j = sample_group_message();
+  for (auto _ : state) {
+    auto group_id =
+        obcx::common::JsonUtils::get_optional_id_as_string(j, "group_id");
+    benchmark::DoNotOptimize(table.find(*group_id));
+  }
+}
+BENCHMARK(BM_GroupLookupString)->Arg(16)->Arg(256);
+
+void BM_GroupLookupChatId(benchmark::State &state) {
+  auto table = make_group_table<ChatId>(state.range(0));
+  const auto &j = sample_group_message();
+  for (auto _ : state) {
+    auto group_id =
+        obcx::common::JsonUtils::get_optional_id(j, "group_id", Platform::qq);
+    benchmark::DoNotOptimize(table.find(*group_id));
+  }
+}
+BENCHMARK(BM_GroupLookupChatId)->Arg(16)->Arg(256);
+
+} // namespace
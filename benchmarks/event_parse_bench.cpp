@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/json_backend.hpp"
+#include "common/message_type.hpp"
+#include "onebot11/adapter/event_converter.hpp"
+#include "telegram/adapter/protocol_adapter.hpp"
+
+namespace {
+
+// 录制的流量样本，每行一个事件（JSON Lines）
+auto load_corpus(const std::string &name) -> const std::vector<std::string> & {
+  static std::unordered_map<std::string, std::vector<std::string>> cache;
+  auto &lines = cache[name];
+  if (lines.empty()) {
+    std::ifstream in(std::string(OBCX_BENCH_DATA_DIR) + "/" + name);
+    for (std::string line; std::getline(in, line);) {
+      if (!line.empty()) {
+        lines.push_back(std::move(line));
+      }
+    }
+  }
+  return lines;
+}
+
+void set_counters(benchmark::State &state,
+                  const std::vector<std::string> &corpus) {
+  std::size_t bytes = 0;
+  for (const auto &line : corpus) {
+    bytes += line.size();
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(corpus.size()));
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes));
+  state.SetLabel(std::string(obcx::common::JsonBackend::name()));
+}
+
+// 参照组：直接用 nlohmann 解析并构造事件，不受构建选项影响
+void BM_OneBotNlohmannReference(benchmark::State &state) {
+  const auto &corpus = load_corpus("onebot_events.jsonl");
+  for (auto _ : state) {
+    for (const auto &line : corpus) {
+      auto j = nlohmann::json::parse(line);
+      auto post_type = j.value("post_type", std::string());
+      if (post_type == "message") {
+        obcx::common::MessageEvent event;
+        event.from_json(j);
+        benchmark::DoNotOptimize(event);
+      } else if (post_type == "notice") {
+        obcx::common::NoticeEvent event;
+        event.from_json(j);
+        benchmark::DoNotOptimize(event);
+      } else if (post_type == "request") {
+        obcx::common::RequestEvent event;
+        event.from_json(j);
+        benchmark::DoNotOptimize(event);
+      } else {
+        obcx::common::HeartbeatEvent event;
+        event.from_json(j);
+        benchmark::DoNotOptimize(event);
+      }
+    }
+  }
+  set_counters(state, corpus);
+  state.SetLabel("nlohmann");
+}
+BENCHMARK(BM_OneBotNlohmannReference);
+
+void BM_OneBotFromV11Json(benchmark::State &state) {
+  const auto &corpus = load_corpus("onebot_events.jsonl");
+  for (auto _ : state) {
+    for (const auto &line : corpus) {
+      auto event =
+          obcx::adapter::onebot11::EventConverter::from_v11_json(line);
+      benchmark::DoNotOptimize(event);
+    }
+  }
+  set_counters(state, corpus);
+}
+BENCHMARK(BM_OneBotFromV11Json);
+
+void BM_TelegramParseEvent(benchmark::State &state) {
+  const auto &corpus = load_corpus("telegram_updates.jsonl");
+  obcx::adapter::telegram::ProtocolAdapter adapter;
+  for (auto _ : state) {
+    for (const auto &line : corpus) {
+      auto event = adapter.parse_event(line);
+      benchmark::DoNotOptimize(event);
+    }
+  }
+  set_counters(state, corpus);
+}
+BENCHMARK(BM_TelegramParseEvent);
+
+} // namespace
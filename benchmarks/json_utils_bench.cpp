@@ -0,0 +1,127 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "common/json_utils.hpp"
+#include "common/message_type.hpp"
+
+namespace {
+
+using obcx::common::json;
+namespace JsonUtils = obcx::common::JsonUtils;
+
+const json &sample_group_message() {
+  static const json j = json::parse(R"({
+    "time": 1718000000,
+    "self_id": 3889001234,
+    "post_type": "message",
+    "message_type": "group",
+    "sub_type": "normal",
+    "message_id": 1948372615,
+    "user_id": 2458061234,
+    "group_id": 987654321,
+    "message": [
+      {"type": "reply", "data": {"id": "1948372600"}},
+      {"type": "text", "data": {"text": "hello bridge"}}
+    ],
+    "raw_message": "[CQ:reply,id=1948372600]hello bridge",
+    "font": 14,
+    "sender": {"user_id": 2458061234, "nickname": "tester", "card": ""}
+  })");
+  return j;
+}
+
+// 旧实现：const std::string& 键，contains + operator[] 两次查找
+template <typename T>
+auto legacy_get_value(const json &j, const std::string &key,
+                      const T &default_value = T{}) -> T {
+  if (j.contains(key) && !j[key].is_null()) {
+    try {
+      return j[key].get<T>();
+    } catch (const json::exception &) {
+      return default_value;
+    }
+  }
+  return default_value;
+}
+
+auto legacy_has_path(const json &j, const std::string &path) -> bool {
+  try {
+    auto ptr = json::json_pointer(path);
+    return j.contains(ptr);
+  } catch (const json::exception &) {
+    return false;
+  }
+}
+
+void BM_MessageEventFromJson(benchmark::State &state) {
+  const auto &j = sample_group_message();
+  for (auto _ : state) {
+    obcx::common::MessageEvent event;
+    event.from_json(j);
+    benchmark::DoNotOptimize(event);
+  }
+}
+BENCHMARK(BM_MessageEventFromJson);
+
+void BM_GetValueLegacy(benchmark::State &state) {
+  const auto &j = sample_group_message();
+  for (auto _ : state) {
+    auto post_type = legacy_get_value<std::string>(j, "post_type");
+    auto font = legacy_get_value<int32_t>(j, "font");
+    auto missing = legacy_get_value<std::string>(j, "anonymous_flag_field");
+    benchmark::DoNotOptimize(post_type);
+    benchmark::DoNotOptimize(font);
+    benchmark::DoNotOptimize(missing);
+  }
+}
+BENCHMARK(BM_GetValueLegacy);
+
+void BM_GetValue(benchmark::State &state) {
+  const auto &j = sample_group_message();
+  for (auto _ : state) {
+    auto post_type = JsonUtils::get_value<std::string>(j, "post_type");
+    auto font = JsonUtils::get_value<int32_t>(j, "font");
+    auto missing = JsonUtils::get_value<std::string>(j, "anonymous_flag_field");
+    benchmark::DoNotOptimize(post_type);
+    benchmark::DoNotOptimize(font);
+    benchmark::DoNotOptimize(missing);
+  }
+}
+BENCHMARK(BM_GetValue);
+
+// 路径查找：存在、缺失、格式非法三种情况各一次
+void BM_HasPathLegacy(benchmark::State &state) {
+  const auto &j = sample_group_message();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(legacy_has_path(j, "/message/1/data/text"));
+    benchmark::DoNotOptimize(legacy_has_path(j, "/sender/title"));
+    benchmark::DoNotOptimize(legacy_has_path(j, "sender/card"));
+  }
+}
+BENCHMARK(BM_HasPathLegacy);
+
+void BM_HasPath(benchmark::State &state) {
+  const auto &j = sample_group_message();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(JsonUtils::has_path(j, "/message/1/data/text"));
+    benchmark::DoNotOptimize(JsonUtils::has_path(j, "/sender/title"));
+    benchmark::DoNotOptimize(JsonUtils::has_path(j, "sender/card"));
+  }
+}
+BENCHMARK(BM_HasPath);
+
+void BM_HasPathPrecomputed(benchmark::State &state) {
+  static const JsonUtils::JsonPath kText("/message/1/data/text");
+  static const JsonUtils::JsonPath kTitle("/sender/title");
+  static const JsonUtils::JsonPath kMalformed("sender/card");
+  const auto &j = sample_group_message();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(JsonUtils::has_path(j, kText));
+    benchmark::DoNotOptimize(JsonUtils::has_path(j, kTitle));
+    benchmark::DoNotOptimize(JsonUtils::has_path(j, kMalformed));
+  }
+}
+BENCHMARK(BM_HasPathPrecomputed);
+
+} // namespace
@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "common/logger.hpp"
+#include "common/message_type.hpp"
+#include "onebot11/adapter/event_converter.hpp"
+
+namespace {
+
+using obcx::common::Logger;
+
+auto load_messages() -> const std::vector<std::string> & {
+  static const auto lines = [] {
+    std::vector<std::string> result;
+    std::ifstream in(std::string(OBCX_BENCH_DATA_DIR) + "/onebot_events.jsonl");
+    for (std::string line; std::getline(in, line);) {
+      if (line.find("\"post_type\":\"message\"") != std::string::npos) {
+        result.push_back(std::move(line));
+      }
+    }
+    return result;
+  }();
+  return lines;
+}
+
+enum class Mode : int64_t { sync, async_block, async_overrun };
+
+void setup_logger(Mode mode) {
+  static const bool initialized = [] {
+    Logger::initialize(spdlog::level::info,
+                       (std::filesystem::temp_directory_path() /
+                        "obcx_logging_bench.log")
+                           .string());
+    // 只测文件输出，控制台输出会与基准结果混在一起
+    Logger::get()->sinks().front()->set_level(spdlog::level::off);
+    return true;
+  }();
+  (void)initialized;
+
+  Logger::disable_async();
+  if (mode != Mode::sync) {
+    Logger::enable_async(
+        {.queue_size = 8192,
+         .threads = 1,
+         .overflow = mode == Mode::async_block
+                         ? spdlog::async_overflow_policy::block
+                         : spdlog::async_overflow_policy::overrun_oldest});
+  }
+}
+
+// 模拟 QQ->Telegram 转发路径：解析事件，并输出转发处理器中的日志，
+// 其中 DEBUG 日志在 INFO 级别下被过滤
+void BM_ForwardWithInfoLogging(benchmark::State &state) {
+  const auto mode = static_cast<Mode>(state.range(0));
+  if (state.thread_index() == 0) {
+    setup_logger(mode);
+  }
+  const auto &corpus = load_messages();
+
+  for (auto _ : state) {
+    for (const auto &line : corpus) {
+      auto event =
+          obcx::adapter::onebot11::EventConverter::from_v11_json(line);
+      const auto *message =
+          event ? std::get_if<obcx::common::MessageEvent>(&*event) : nullptr;
+      if (message == nullptr || !message->group_id) {
+        continue;
+      }
+      OBCX_DEBUG("QQ群 {} 查找结果: TG群={}, topic_id={}", *message->group_id,
+                 "-1001234567890", -1);
+      OBCX_INFO("准备从QQ群 {} 转发消息到Telegram群 {}", *message->group_id,
+                "-1001234567890");
+      OBCX_DEBUG("QQ到Telegram转发显示发送者：{}", message->user_id);
+      OBCX_INFO("成功转发QQ消息 {} 到Telegram", message->message_id);
+      benchmark::DoNotOptimize(message);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(corpus.size()));
+  if (state.thread_index() == 0) {
+    state.counters["dropped"] = static_cast<double>(Logger::dropped());
+    Logger::disable_async();
+  }
+}
+BENCHMARK(BM_ForwardWithInfoLogging)
+    ->ArgName("mode")
+    ->Arg(static_cast<int64_t>(Mode::sync))
+    ->Arg(static_cast<int64_t>(Mode::async_block))
+    ->Arg(static_cast<int64_t>(Mode::async_overrun))
+    ->Threads(1)
+    ->Threads(4)
+    ->UseRealTime();
+
+} // namespace
@@ -96,7 +96,7 @@ auto handle_message_with_heavy_tasks(core::Bot &bot,
       OBCX_INFO("用户请求图像处理，调度到线程池...");
 
       auto result = co_await bot.run_heavy_task([&]() {
-        return simulate_image_processing("user_image_" + event.user_id);
+        return simulate_image_processing("user_image_" + event.user_id.str());
       });
 
       OBCX_INFO("图像处理任务完成，返回事件循环 (线程ID: {})", get_thread_id());
@@ -1,19 +1,54 @@
 #include "config.hpp"
 
+#include <atomic>
+#include <mutex>
+
 namespace bridge {
 
-// 全局群组映射配置
-std::unordered_map<std::string, GroupBridgeConfig> GROUP_MAP;
+namespace {
+// 当前的群组映射，整体替换
+std::atomic<std::shared_ptr<const GroupMappings>> current_mappings{
+    std::make_shared<const GroupMappings>()};
+// 串行化 load_group_mappings
+std::mutex load_mutex;
+
+void build_qq_routes(GroupMappings &mappings) {
+  for (const auto &[tg_id, config] : mappings.groups) {
+    if (config.mode == BridgeMode::GROUP_TO_GROUP) {
+      mappings.qq_routes.try_emplace(qq_chat_key(config.qq_group_id),
+                                     QQGroupRoute{tg_id.str(), -1});
+    } else {
+      for (const auto &topic_config : config.topics) {
+        mappings.qq_routes.try_emplace(
+            qq_chat_key(topic_config.qq_group_id),
+            QQGroupRoute{tg_id.str(), topic_config.telegram_topic_id});
+      }
+    }
+  }
+}
+} // namespace
+
+auto group_mappings() -> std::shared_ptr<const GroupMappings> {
+  return current_mappings.load(std::memory_order_acquire);
+}
 
 void load_group_mappings() {
+  std::lock_guard lock(load_mutex);
   try {
-    GROUP_MAP.clear();
-
     // 获取配置
     auto config_section =
         obcx::common::ConfigLoader::instance().get_section("group_mappings");
     if (!config_section.has_value()) {
       OBCX_WARN("No group_mappings section found in config");
+    }
+    if (config_section == group_mappings()->source) {
+      OBCX_DEBUG("Group mappings unchanged, keeping current mappings");
+      return;
+    }
+    auto mappings = std::make_shared<GroupMappings>();
+    mappings->source = config_section;
+    if (!config_section.has_value()) {
+      current_mappings.store(std::move(mappings), std::memory_order_release);
       return;
     }
     const auto &config = config_section.value();
@@ -43,7 +78,7 @@ void load_group_mappings() {
             GroupBridgeConfig config(telegram_group_id, qq_group_id,
                                      show_qq_to_tg_sender, show_tg_to_qq_sender,
                                      enable_qq_to_tg, enable_tg_to_qq);
-            GROUP_MAP[telegram_group_id] = config;
+            mappings->groups[telegram_chat_key(telegram_group_id)] = config;
             OBCX_INFO("Loaded group mapping: {} -> {}", telegram_group_id,
                       qq_group_id);
           }
@@ -123,7 +158,7 @@ void load_group_mappings() {
               GroupBridgeConfig config(
                   telegram_group_id, topics, show_qq_to_tg_sender,
                   show_tg_to_qq_sender, enable_qq_to_tg, enable_tg_to_qq);
-              GROUP_MAP[telegram_group_id] = config;
+              mappings->groups[telegram_chat_key(telegram_group_id)] = config;
               OBCX_INFO("Loaded topic group mapping for TG {} with {} topics",
                         telegram_group_id, topics.size());
             }
@@ -132,7 +167,10 @@ void load_group_mappings() {
       }
     }
 
-    OBCX_INFO("Group mappings loaded: {} total mappings", GROUP_MAP.size());
+    build_qq_routes(*mappings);
+    OBCX_INFO("Group mappings loaded: {} total mappings",
+              mappings->groups.size());
+    current_mappings.store(std::move(mappings), std::memory_order_release);
   } catch (const std::exception &e) {
     OBCX_ERROR("Failed to load group mappings: {}", e.what());
   }
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "common/config_loader.hpp"
+#include "common/id.hpp"
 #include "common/logger.hpp"
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -77,11 +81,39 @@ struct GroupBridgeConfig {
         enable_tg_to_qq{enable_tg_qq} {}
 };
 
-// 动态加载的群组桥接映射配置
-extern std::unordered_map<std::string, GroupBridgeConfig> GROUP_MAP;
+/**
+ * @brief QQ群到Telegram群/Topic的反向索引项
+ */
+struct QQGroupRoute {
+  std::string telegram_group_id;
+  int64_t topic_id; // -1表示不是topic模式
+};
+
+/**
+ * @brief 一次加载得到的全部群组映射，发布后不再修改
+ */
+struct GroupMappings {
+  // 群组桥接映射配置，键为带 telegram 平台标记的群ID
+  std::unordered_map<obcx::common::ChatId, GroupBridgeConfig> groups;
+  // 根据 groups 生成的反向索引，键为带 qq 平台标记的群ID
+  std::unordered_map<obcx::common::ChatId, QQGroupRoute> qq_routes;
+  // 生成本映射的 group_mappings 配置段，为空表示配置中没有该段
+  std::optional<toml::table> source;
+};
+
+/**
+ * @brief 当前的群组映射
+ *
+ * 无锁读取，从不返回空指针。重新加载时整体替换，已取得的快照在持有期间
+ * 保持有效。
+ */
+auto group_mappings() -> std::shared_ptr<const GroupMappings>;
 
 /**
  * @brief 从配置文件加载群组映射
+ *
+ * group_mappings 配置段与当前映射的来源相同时什么也不做；否则在新对象上
+ * 构建后原子地替换当前映射，加载失败时保留当前映射。
  */
 void load_group_mappings();
 
@@ -92,86 +124,124 @@ void initialize_config();
 
 // 辅助函数
 namespace {
-/**
- * @brief 根据Telegram群ID和Topic ID查找对应的QQ群ID
- */
-inline std::string get_qq_group_id_for_topic(const std::string &tg_group_id,
-                                             int64_t topic_id) {
-  auto it = GROUP_MAP.find(tg_group_id);
-  if (it == GROUP_MAP.end())
-    return "";
+inline auto telegram_chat_key(std::string_view tg_group_id)
+    -> obcx::common::ChatId {
+  return obcx::common::ChatId(tg_group_id, obcx::common::Platform::telegram);
+}
 
-  const auto &config = it->second;
-  if (config.mode == BridgeMode::GROUP_TO_GROUP) {
-    return config.qq_group_id;
-  } else {
-    // Topic模式：查找对应的topic配置
-    for (const auto &topic_config : config.topics) {
-      if (topic_config.telegram_topic_id == topic_id) {
-        return topic_config.qq_group_id;
-      }
-    }
-  }
-  return "";
+inline auto qq_chat_key(std::string_view qq_group_id) -> obcx::common::ChatId {
+  return obcx::common::ChatId(qq_group_id, obcx::common::Platform::qq);
 }
 
 /**
- * @brief 根据QQ群ID查找对应的Telegram群ID和Topic ID
+ * @brief 获取群组桥接配置
+ *
+ * 返回的指针共同持有所在的映射快照，跨越 co_await 使用时不受重新加载影响。
  */
-inline std::pair<std::string, int64_t> get_tg_group_and_topic_id(
-    const std::string &qq_group_id) {
-  for (const auto &[tg_id, config] : GROUP_MAP) {
-    if (config.mode == BridgeMode::GROUP_TO_GROUP) {
-      if (config.qq_group_id == qq_group_id) {
-        return {tg_id, -1}; // -1表示不是topic模式
-      }
-    } else {
-      // Topic模式：查找对应的topic配置
-      for (const auto &topic_config : config.topics) {
-        if (topic_config.qq_group_id == qq_group_id) {
-          return {tg_id, topic_config.telegram_topic_id};
-        }
-      }
-    }
+inline std::shared_ptr<const GroupBridgeConfig> get_bridge_config(
+    const obcx::common::ChatId &tg_group_id) {
+  auto mappings = group_mappings();
+  auto it = mappings->groups.find(tg_group_id);
+  if (it == mappings->groups.end()) {
+    return nullptr;
   }
-  return {"", -1};
+  return {std::move(mappings), &it->second};
 }
 
-/**
- * @brief 获取群组桥接配置
- */
-inline const GroupBridgeConfig *get_bridge_config(
-    const std::string &tg_group_id) {
-  auto it = GROUP_MAP.find(tg_group_id);
-  return (it != GROUP_MAP.end()) ? &it->second : nullptr;
+inline std::shared_ptr<const GroupBridgeConfig> get_bridge_config(
+    std::string_view tg_group_id) {
+  return get_bridge_config(telegram_chat_key(tg_group_id));
 }
 
 /**
  * @brief 根据Telegram群ID和Topic ID获取Topic配置
  */
-const TopicBridgeConfig *get_topic_config(const std::string &tg_group_id,
-                                          int64_t topic_id) {
-  auto it = GROUP_MAP.find(tg_group_id);
-  if (it == GROUP_MAP.end() || it->second.mode != BridgeMode::TOPIC_TO_GROUP) {
+inline std::shared_ptr<const TopicBridgeConfig> get_topic_config(
+    const obcx::common::ChatId &tg_group_id, int64_t topic_id) {
+  auto config = get_bridge_config(tg_group_id);
+  if (!config || config->mode != BridgeMode::TOPIC_TO_GROUP) {
     return nullptr;
   }
 
-  for (const auto &topic_config : it->second.topics) {
+  for (const auto &topic_config : config->topics) {
     if (topic_config.telegram_topic_id == topic_id) {
-      return &topic_config;
+      return {std::move(config), &topic_config};
     }
   }
   return nullptr;
 }
 
+inline std::shared_ptr<const TopicBridgeConfig> get_topic_config(
+    std::string_view tg_group_id, int64_t topic_id) {
+  return get_topic_config(telegram_chat_key(tg_group_id), topic_id);
+}
+
+/**
+ * @brief 根据Telegram群ID和Topic ID查找对应的QQ群ID
+ */
+inline std::string get_qq_group_id_for_topic(std::string_view tg_group_id,
+                                             int64_t topic_id) {
+  const auto config = get_bridge_config(tg_group_id);
+  if (!config)
+    return "";
+
+  if (config->mode == BridgeMode::GROUP_TO_GROUP) {
+    return config->qq_group_id;
+  }
+  // Topic模式：查找对应的topic配置
+  if (const auto topic_config = get_topic_config(tg_group_id, topic_id)) {
+    return topic_config->qq_group_id;
+  }
+  return "";
+}
+
+/**
+ * @brief 根据QQ群ID查找对应的Telegram群ID和Topic ID
+ */
+inline std::pair<std::string, int64_t> get_tg_group_and_topic_id(
+    const obcx::common::ChatId &qq_group_id) {
+  const auto mappings = group_mappings();
+  auto it = mappings->qq_routes.find(qq_group_id);
+  if (it == mappings->qq_routes.end()) {
+    return {"", -1};
+  }
+  return {it->second.telegram_group_id, it->second.topic_id};
+}
+
+inline std::pair<std::string, int64_t> get_tg_group_and_topic_id(
+    std::string_view qq_group_id) {
+  return get_tg_group_and_topic_id(qq_chat_key(qq_group_id));
+}
+
 // 向后兼容的简单函数
-inline std::string get_qq_group_id(const std::string &tg_group_id) {
+inline std::string get_qq_group_id(std::string_view tg_group_id) {
   return get_qq_group_id_for_topic(tg_group_id, -1);
 }
 
-inline std::string get_tg_group_id(const std::string &qq_group_id) {
+inline std::string get_tg_group_id(std::string_view qq_group_id) {
   return get_tg_group_and_topic_id(qq_group_id).first;
 }
+
+// 已配置桥接的群ID列表，用于注册消息处理器时的群号过滤
+inline std::vector<std::string> bridged_telegram_group_ids(
+    const GroupMappings &mappings) {
+  std::vector<std::string> ids;
+  ids.reserve(mappings.groups.size());
+  for (const auto &[tg_id, config] : mappings.groups) {
+    ids.push_back(tg_id.str());
+  }
+  return ids;
+}
+
+inline std::vector<std::string> bridged_qq_group_ids(
+    const GroupMappings &mappings) {
+  std::vector<std::string> ids;
+  ids.reserve(mappings.qq_routes.size());
+  for (const auto &[qq_id, route] : mappings.qq_routes) {
+    ids.push_back(qq_id.str());
+  }
+  return ids;
+}
 } // namespace
 
 // 兼容性别名：保持原有的简单映射接口（仅适用于群组模式）
@@ -179,9 +249,9 @@ inline const std::unordered_map<std::string, std::string>
 get_legacy_group_map() {
   static std::unordered_map<std::string, std::string> legacy_map;
   if (legacy_map.empty()) {
-    for (const auto &[tg_id, config] : GROUP_MAP) {
+    for (const auto &[tg_id, config] : group_mappings()->groups) {
       if (config.mode == BridgeMode::GROUP_TO_GROUP) {
-        legacy_map[tg_id] = config.qq_group_id;
+        legacy_map[tg_id.str()] = config.qq_group_id;
       }
     }
   }
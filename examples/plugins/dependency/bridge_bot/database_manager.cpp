@@ -1,43 +1,443 @@
 #include "database_manager.hpp"
 #include "common/logger.hpp"
+#include "common/metrics.hpp"
+#include <algorithm>
+#include <filesystem>
 #include <fmt/format.h>
 #include <iomanip>
 #include <nlohmann/json.hpp>
 #include <openssl/evp.h>
 #include <openssl/sha.h>
 #include <sstream>
+#include <utility>
 
 namespace obcx::storage {
 
-DatabaseManager::DatabaseManager(const std::string &db_path)
-    : db_path_(db_path), db_(nullptr) {
+namespace {
+
+// 桥接转发路径上常用查询的耗时（含等待数据库锁）
+auto query_latency(std::string_view query) -> common::Histogram & {
+  return common::MetricsRegistry::instance().histogram(
+      "obcx_bridge_db_query_duration_seconds",
+      "Bridge database calls, including time spent waiting for the lock",
+      {{"query", std::string(query)}});
+}
+
+auto &batch_commits() {
+  static auto &counter = common::MetricsRegistry::instance().counter(
+      "obcx_bridge_db_batch_commits_total",
+      "Write batches committed by the bridge database");
+  return counter;
+}
+
+auto &batched_rows() {
+  static auto &counter = common::MetricsRegistry::instance().counter(
+      "obcx_bridge_db_batched_rows_total",
+      "Rows written by bridge database write batches");
+  return counter;
+}
+
+auto user_cache_lookups(std::string_view result) -> common::Counter & {
+  return common::MetricsRegistry::instance().counter(
+      "obcx_bridge_user_cache_lookups_total",
+      "Bridge user lookups served by the user cache or the database",
+      {{"result", std::string(result)}});
+}
+
+auto retired_rows(std::string_view table) -> common::Counter & {
+  return common::MetricsRegistry::instance().counter(
+      "obcx_bridge_db_retired_rows_total",
+      "Rows moved out of the bridge database by the retention policy",
+      {{"table", std::string(table)}});
+}
+
+// 受保留策略管理的表，均以自增 id 为主键并带 created_at
+constexpr std::string_view kRetainedTables[] = {"messages",
+                                                "message_mappings"};
+
+// 还有积压时两批之间的停顿，让实时写入优先使用写线程
+constexpr auto kRetentionPause = std::chrono::milliseconds(20);
+
+// 不比较 last_updated，其余字段相同时视为同一份用户信息
+auto same_profile(const UserInfo &lhs, const UserInfo &rhs) -> bool {
+  return lhs.username == rhs.username && lhs.nickname == rhs.nickname &&
+         lhs.title == rhs.title && lhs.first_name == rhs.first_name &&
+         lhs.last_name == rhs.last_name;
+}
+
+} // namespace
+
+DatabaseManager::DatabaseManager(const std::string &db_path,
+                                 const DatabaseOptions &options)
+    : db_path_(db_path), options_(options),
+      read_pool_(std::max<std::size_t>(options.read_connections, 1)),
+      user_cache_(options.user_cache_size, options.user_cache_ttl),
+      mapping_cache_(options.mapping_cache_size, options.mapping_cache_ttl) {
   OBCX_DEBUG("DatabaseManager constructed with path: {}", db_path_);
 }
 
 DatabaseManager::~DatabaseManager() {
-  if (db_) {
-    sqlite3_close(db_);
-    OBCX_DEBUG("Database closed");
-  }
+  // 取消等待中的定时器并提交剩余写入。没有先 stop()，join 会等待已提交的
+  // 读写全部执行完；连接随成员析构关闭。已经排队的定时器回调仍会执行，
+  // stopping_ 阻止它们重新设置定时器，否则 join 要再等一个周期
+  boost::asio::post(write_pool_, [this] {
+    stopping_ = true;
+    flush_timer_.cancel();
+    retention_timer_.cancel();
+    flush();
+  });
+  write_pool_.join();
+  read_pool_.join();
 }
 
 bool DatabaseManager::initialize() {
-  std::lock_guard lock(db_mutex_);
+  {
+    std::lock_guard lock(writer_.mutex());
+    if (!writer_.open(db_path_, options_)) {
+      return false;
+    }
 
-  int rc = sqlite3_open(db_path_.c_str(), &db_);
-  if (rc != SQLITE_OK) {
-    OBCX_ERROR("Cannot open database: {}", sqlite3_errmsg(db_));
-    return false;
+    OBCX_INFO("Database opened successfully: {}", db_path_);
+
+    if (!create_tables()) {
+      return false;
+    }
+
+    if (retention_enabled()) {
+      CachedStatement stmt;
+      if (writer_.prepare("PRAGMA auto_vacuum;", stmt) == SQLITE_OK &&
+          sqlite3_step(stmt) == SQLITE_ROW &&
+          sqlite3_column_int(stmt, 0) != 2) {
+        // 旧数据库切换 auto_vacuum 需要一次完整的 VACUUM，这里不自动执行：
+        // 清理释放的页仍会被新写入复用，只是文件不会缩小
+        OBCX_INFO("Database {} was created without incremental auto_vacuum, "
+                  "run VACUUM once to let retention shrink the file",
+                  db_path_);
+      }
+      boost::asio::post(write_pool_, [this] {
+        schedule_retention(options_.retention_interval);
+      });
+    }
+  }
+
+  // 回滚日志模式下读连接会与写连接互相阻塞，内存数据库无法共享连接，
+  // 这两种情况下读操作都走写连接
+  if (!options_.wal || db_path_ == ":memory:") {
+    return true;
+  }
+  for (std::size_t i = 0; i < options_.read_connections; ++i) {
+    auto connection = std::make_unique<SqliteConnection>();
+    if (!connection->open(db_path_, options_, true)) {
+      return false;
+    }
+    read_connections_.push_back(std::move(connection));
+  }
+  OBCX_DEBUG("Opened {} read connections", read_connections_.size());
+  return true;
+}
+
+auto DatabaseManager::acquire_reader() -> ConnectionLease {
+  if (read_connections_.empty()) {
+    return {writer_, std::unique_lock(writer_.mutex())};
+  }
+  // 轮询起点，优先取空闲连接，全部忙时在起点连接上排队
+  const auto count = read_connections_.size();
+  const auto start = next_reader_.fetch_add(1, std::memory_order_relaxed);
+  for (std::size_t i = 0; i < count; ++i) {
+    auto &connection = *read_connections_[(start + i) % count];
+    std::unique_lock lock(connection.mutex(), std::try_to_lock);
+    if (lock.owns_lock()) {
+      return {connection, std::move(lock)};
+    }
   }
+  auto &connection = *read_connections_[start % count];
+  return {connection, std::unique_lock(connection.mutex())};
+}
 
-  OBCX_INFO("Database opened successfully: {}", db_path_);
+template <typename Mutate> void DatabaseManager::enqueue(Mutate mutate) {
+  std::lock_guard lock(pending_mutex_);
+  mutate(pending_);
 
-  // 启用外键约束
-  if (!execute_sql("PRAGMA foreign_keys = ON;")) {
-    return false;
+  // 写线程只有一个，定时器与提交都在写线程上执行，不需要额外同步
+  if (pending_.size() >= options_.batch_max_rows) {
+    if (!flush_posted_) {
+      flush_posted_ = true;
+      boost::asio::post(write_pool_, [this] { flush(); });
+    }
+  } else if (!timer_armed_) {
+    timer_armed_ = true;
+    boost::asio::post(write_pool_, [this] {
+      if (stopping_) {
+        flush();
+        return;
+      }
+      // 重新设置到期时间会取消上一次等待，被取消的等待不提交
+      flush_timer_.expires_after(options_.batch_interval);
+      flush_timer_.async_wait([this](const boost::system::error_code &ec) {
+        if (!ec) {
+          flush();
+        }
+      });
+    });
   }
+}
+
+template <typename Find>
+auto DatabaseManager::find_pending(Find find)
+    -> std::invoke_result_t<Find &, const PendingWrites &> {
+  std::lock_guard lock(pending_mutex_);
+  if (auto found = find(std::as_const(pending_))) {
+    return found;
+  }
+  return find(std::as_const(committing_));
+}
 
-  return create_tables();
+bool DatabaseManager::flush() {
+  std::lock_guard lock(writer_.mutex());
+  return commit_pending();
+}
+
+bool DatabaseManager::commit_pending() {
+  {
+    std::lock_guard lock(pending_mutex_);
+    committing_ = std::exchange(pending_, {});
+    timer_armed_ = false;
+    flush_posted_ = false;
+  }
+  if (committing_.size() == 0) {
+    return true;
+  }
+
+  const auto write_rows = [this] {
+    bool ok = true;
+    for (const auto &[key, message] : committing_.messages) {
+      ok = write_message(message) && ok;
+    }
+    for (const auto &[key, user] : committing_.users) {
+      if (!write_user(user)) {
+        // 入队时已写入缓存，未落盘时移除，否则相同资料的下次保存会被跳过
+        user_cache_.erase(
+            user_cache_key(user.platform, user.user_id, user.group_id));
+        ok = false;
+      }
+    }
+    for (const auto &[key, mapping] : committing_.mappings) {
+      if (!write_mapping(mapping)) {
+        // 入队时已写入缓存，未落盘时移除，否则回复会解析到不存在的映射
+        mapping_cache_.erase(mapping.source_platform, mapping.source_message_id,
+                             mapping.target_platform);
+        ok = false;
+      }
+    }
+    for (const auto &[platform, heartbeat] : committing_.heartbeats) {
+      ok = write_heartbeat(heartbeat) && ok;
+    }
+    return ok;
+  };
+
+  // 单行失败只回滚该语句，不影响事务中的其他行；BEGIN 失败时逐行自动提交
+  const bool in_transaction = writer_.execute("BEGIN IMMEDIATE;");
+  bool ok = write_rows();
+  if (in_transaction && !writer_.execute("COMMIT;")) {
+    writer_.execute("ROLLBACK;");
+    OBCX_WARN("Write batch commit failed, retrying {} rows one by one",
+              committing_.size());
+    ok = write_rows();
+  }
+
+  batch_commits().inc();
+  batched_rows().inc(committing_.size());
+  OBCX_DEBUG("Committed write batch of {} rows", committing_.size());
+
+  std::lock_guard lock(pending_mutex_);
+  committing_ = {};
+  return ok;
+}
+
+std::size_t DatabaseManager::apply_retention() {
+  if (!retention_enabled()) {
+    return 0;
+  }
+  std::size_t total = 0;
+  for (const auto table : kRetainedTables) {
+    while (const auto rows = retire_batch(table)) {
+      total += rows;
+    }
+  }
+  return total;
+}
+
+void DatabaseManager::schedule_retention(
+    std::chrono::steady_clock::duration delay) {
+  if (stopping_) {
+    return;
+  }
+  retention_timer_.expires_after(delay);
+  retention_timer_.async_wait([this](const boost::system::error_code &ec) {
+    if (ec) {
+      return;
+    }
+    // 每个表每轮只移出一批，其余批次留到下一轮，期间排队的写入先执行
+    std::size_t rows = 0;
+    for (const auto table : kRetainedTables) {
+      rows += retire_batch(table);
+    }
+    schedule_retention(rows > 0 ? kRetentionPause
+                                : options_.retention_interval);
+  });
+}
+
+std::size_t DatabaseManager::retire_batch(std::string_view table) {
+  std::lock_guard lock(writer_.mutex());
+
+  // id 自增且只从最旧的一端删除，MAX(id) 减去上限就是需要移出的 id 上界；
+  // 中间被单独删除过的行会让保留的行数略少于上限
+  int64_t over_limit_id = 0;
+  if (options_.retention_max_rows > 0) {
+    CachedStatement stmt;
+    if (writer_.prepare(fmt::format("SELECT MAX(id) FROM {};", table),
+                        stmt) != SQLITE_OK) {
+      OBCX_ERROR("Failed to prepare retention statement: {}",
+                 sqlite3_errmsg(writer_.handle()));
+      return 0;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+      over_limit_id = sqlite3_column_int64(stmt, 0) -
+                      static_cast<int64_t>(options_.retention_max_rows);
+    }
+  }
+
+  // 按 id 顺序取最旧的一批，只读这一批行，表再大也不会全表扫描。
+  // created_at 随 id 递增，遇到第一条未过期的记录就停止
+  int64_t first_id = 0;
+  int64_t last_id = 0;
+  std::string month;
+  std::size_t rows = 0;
+  {
+    CachedStatement stmt;
+    const auto sql = fmt::format(R"(
+        SELECT id, substr(created_at, 1, 7),
+               created_at < datetime('now', ?1)
+        FROM {} ORDER BY id LIMIT ?2;
+    )",
+                                 table);
+    if (writer_.prepare(sql, stmt) != SQLITE_OK) {
+      OBCX_ERROR("Failed to prepare retention statement: {}",
+                 sqlite3_errmsg(writer_.handle()));
+      return 0;
+    }
+    // 未设置保留时长时绑定 NULL，比较结果为 NULL，只按行数上限清理
+    const auto age = fmt::format("-{} hours", options_.retention_age.count());
+    if (options_.retention_age.count() > 0) {
+      sqlite3_bind_text(stmt, 1, age.c_str(), -1, SQLITE_STATIC);
+    }
+    sqlite3_bind_int64(stmt, 2,
+                       static_cast<int64_t>(options_.retention_batch_rows));
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      const auto id = sqlite3_column_int64(stmt, 0);
+      const auto *text =
+          reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+      const std::string_view row_month = text != nullptr ? text : "undated";
+      const bool expired =
+          sqlite3_column_int(stmt, 2) != 0 || id <= over_limit_id;
+      // 一批只写一个归档库
+      if (!expired || (rows > 0 && row_month != month)) {
+        break;
+      }
+      if (rows == 0) {
+        first_id = id;
+        month = row_month;
+      }
+      last_id = id;
+      ++rows;
+    }
+  }
+
+  if (rows == 0 || !retire_rows(table, month, first_id, last_id)) {
+    return 0;
+  }
+  // 删除留下的空闲页归还给文件系统；数据库不是增量模式时什么也不做
+  writer_.execute("PRAGMA incremental_vacuum;");
+
+  retired_rows(table).inc(rows);
+  OBCX_DEBUG("Retired {} rows from {} ({})", rows, table, month);
+  return rows;
+}
+
+bool DatabaseManager::retire_rows(std::string_view table,
+                                  std::string_view month, int64_t first_id,
+                                  int64_t last_id) {
+  const bool archive = !options_.archive_dir.empty();
+  if (archive) {
+    // 每月一个归档库：<archive_dir>/<数据库文件名>-YYYY-MM.db
+    const std::filesystem::path dir(options_.archive_dir);
+    const auto path =
+        dir / fmt::format("{}-{}.db",
+                          std::filesystem::path(db_path_).stem().string(),
+                          month);
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+
+    CachedStatement attach;
+    if (writer_.prepare("ATTACH DATABASE ? AS archive;", attach) !=
+        SQLITE_OK) {
+      OBCX_ERROR("Failed to prepare attach statement: {}",
+                 sqlite3_errmsg(writer_.handle()));
+      return false;
+    }
+    const auto path_text = path.string();
+    sqlite3_bind_text(attach, 1, path_text.c_str(), -1, SQLITE_STATIC);
+    if (sqlite3_step(attach) != SQLITE_DONE) {
+      OBCX_ERROR("Failed to attach archive {}: {}", path_text,
+                 sqlite3_errmsg(writer_.handle()));
+      return false;
+    }
+  }
+
+  const auto execute_range = [&](const std::string &sql) {
+    CachedStatement stmt;
+    if (writer_.prepare(sql, stmt) != SQLITE_OK) {
+      OBCX_ERROR("Failed to prepare retention statement: {}",
+                 sqlite3_errmsg(writer_.handle()));
+      return false;
+    }
+    sqlite3_bind_int64(stmt, 1, first_id);
+    sqlite3_bind_int64(stmt, 2, last_id);
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+      OBCX_ERROR("Retention of {} failed: {}", table,
+                 sqlite3_errmsg(writer_.handle()));
+      return false;
+    }
+    return true;
+  };
+
+  // 归档表不带约束和索引，只用于追加与离线查询
+  bool ok = !archive ||
+            writer_.execute(fmt::format("CREATE TABLE IF NOT EXISTS "
+                                        "archive.{0} AS SELECT * FROM "
+                                        "main.{0} WHERE 0;",
+                                        table));
+  // 主库与归档库在 WAL 下各自原子提交：崩溃时最多在归档中留下重复行，
+  // 不会丢失记录
+  ok = ok && writer_.execute("BEGIN IMMEDIATE;");
+  if (ok) {
+    ok = (!archive ||
+          execute_range(fmt::format("INSERT INTO archive.{0} SELECT * FROM "
+                                    "main.{0} WHERE id BETWEEN ?1 AND ?2;",
+                                    table))) &&
+         execute_range(fmt::format(
+             "DELETE FROM main.{} WHERE id BETWEEN ?1 AND ?2;", table)) &&
+         writer_.execute("COMMIT;");
+    if (!ok) {
+      writer_.execute("ROLLBACK;");
+    }
+  }
+
+  if (archive) {
+    writer_.execute("DETACH DATABASE archive;");
+  }
+  return ok;
 }
 
 bool DatabaseManager::create_tables() {
@@ -61,7 +461,7 @@ bool DatabaseManager::create_tables() {
         );
     )";
 
-  if (!execute_sql(create_messages_table)) {
+  if (!writer_.execute(create_messages_table)) {
     return false;
   }
 
@@ -82,7 +482,7 @@ bool DatabaseManager::create_tables() {
         );
     )";
 
-  if (!execute_sql(create_users_table)) {
+  if (!writer_.execute(create_users_table)) {
     return false;
   }
 
@@ -99,7 +499,17 @@ bool DatabaseManager::create_tables() {
         );
     )";
 
-  if (!execute_sql(create_mappings_table)) {
+  if (!writer_.execute(create_mappings_table)) {
+    return false;
+  }
+
+  // 反向查找（目标消息 -> 源消息）使用的索引
+  const std::string create_mappings_target_index = R"(
+        CREATE INDEX IF NOT EXISTS idx_message_mappings_target
+        ON message_mappings(target_platform, target_message_id, source_platform);
+    )";
+
+  if (!writer_.execute(create_mappings_target_index)) {
     return false;
   }
 
@@ -124,7 +534,7 @@ bool DatabaseManager::create_tables() {
         );
     )";
 
-  if (!execute_sql(create_sticker_cache_table)) {
+  if (!writer_.execute(create_sticker_cache_table)) {
     return false;
   }
 
@@ -144,7 +554,7 @@ bool DatabaseManager::create_tables() {
     CREATE INDEX IF NOT EXISTS idx_qq_sticker_hash ON qq_sticker_mapping(qq_sticker_hash);
   )";
 
-  if (!execute_sql(create_qq_sticker_mapping_table)) {
+  if (!writer_.execute(create_qq_sticker_mapping_table)) {
     return false;
   }
 
@@ -170,7 +580,7 @@ bool DatabaseManager::create_tables() {
         );
     )";
 
-  if (!execute_sql(create_message_retry_table)) {
+  if (!writer_.execute(create_message_retry_table)) {
     return false;
   }
 
@@ -194,7 +604,7 @@ bool DatabaseManager::create_tables() {
         );
     )";
 
-  if (!execute_sql(create_media_retry_table)) {
+  if (!writer_.execute(create_media_retry_table)) {
     return false;
   }
 
@@ -204,7 +614,7 @@ bool DatabaseManager::create_tables() {
         CREATE INDEX IF NOT EXISTS idx_media_retry_next_retry ON media_download_retry_queue(next_retry_at);
     )";
 
-  if (!execute_sql(create_retry_indexes)) {
+  if (!writer_.execute(create_retry_indexes)) {
     return false;
   }
 
@@ -217,7 +627,7 @@ bool DatabaseManager::create_tables() {
             updated_at INTEGER NOT NULL DEFAULT (strftime('%s','now'))
         );
     )";
-  if (!execute_sql(create_heartbeat_table)) {
+  if (!writer_.execute(create_heartbeat_table)) {
     return false;
   }
 
@@ -225,22 +635,25 @@ bool DatabaseManager::create_tables() {
   return true;
 }
 
-bool DatabaseManager::execute_sql(const std::string &sql) {
-  char *error_msg = nullptr;
-  int rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &error_msg);
-
-  if (rc != SQLITE_OK) {
-    OBCX_ERROR("SQL error: {}", error_msg);
-    sqlite3_free(error_msg);
-    return false;
+bool DatabaseManager::save_message(const MessageInfo &message_info) {
+  static auto &latency = query_latency("save_message");
+  const common::ScopedTimer timer(latency);
+
+  if (batching()) {
+    enqueue([&](PendingWrites &pending) {
+      pending.messages.insert_or_assign(
+          Key{message_info.platform, message_info.message_id,
+              message_info.group_id},
+          message_info);
+    });
+    return true;
   }
 
-  return true;
+  std::lock_guard lock(writer_.mutex());
+  return write_message(message_info);
 }
 
-bool DatabaseManager::save_message(const MessageInfo &message_info) {
-  std::lock_guard lock(db_mutex_);
-
+bool DatabaseManager::write_message(const MessageInfo &message_info) {
   const std::string sql = R"(
         INSERT OR REPLACE INTO messages
         (platform, message_id, group_id, user_id, content, raw_message, message_type,
@@ -248,10 +661,11 @@ bool DatabaseManager::save_message(const MessageInfo &message_info) {
         VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
-    OBCX_ERROR("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to prepare statement: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -290,10 +704,10 @@ bool DatabaseManager::save_message(const MessageInfo &message_info) {
   }
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to insert message: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to insert message: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -303,8 +717,26 @@ bool DatabaseManager::save_message(const MessageInfo &message_info) {
 }
 
 std::optional<MessageInfo> DatabaseManager::get_message(
-    const std::string &platform, const std::string &message_id) {
-  std::lock_guard lock(db_mutex_);
+    const std::string &platform, std::string_view message_id) {
+  static auto &latency = query_latency("get_message");
+  const common::ScopedTimer timer(latency);
+
+  // 与下面的查询一样不区分群组，返回该消息ID的任意一条记录
+  if (auto pending = find_pending(
+          [&](const PendingWrites &writes) -> std::optional<MessageInfo> {
+            const auto it =
+                writes.messages.lower_bound(KeyView{platform, message_id, {}});
+            if (it != writes.messages.end() &&
+                std::get<0>(it->first) == platform &&
+                std::get<1>(it->first) == message_id) {
+              return it->second;
+            }
+            return std::nullopt;
+          })) {
+    return pending;
+  }
+
+  auto reader = acquire_reader();
 
   const std::string sql = R"(
         SELECT platform, message_id, group_id, user_id, content, raw_message, message_type,
@@ -312,15 +744,17 @@ std::optional<MessageInfo> DatabaseManager::get_message(
         FROM messages WHERE platform = ? AND message_id = ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = reader->prepare(sql, stmt);
   if (rc != SQLITE_OK) {
-    OBCX_ERROR("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to prepare statement: {}",
+               sqlite3_errmsg(reader->handle()));
     return std::nullopt;
   }
 
   sqlite3_bind_text(stmt, 1, platform.c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_text(stmt, 2, message_id.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_text(stmt, 2, message_id.data(),
+                    static_cast<int>(message_id.size()), SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
   if (rc == SQLITE_ROW) {
@@ -361,11 +795,9 @@ std::optional<MessageInfo> DatabaseManager::get_message(
 
     // created_at处理（如果需要的话）
 
-    sqlite3_finalize(stmt);
     return msg_info;
   }
 
-  sqlite3_finalize(stmt);
   return std::nullopt;
 }
 
@@ -373,7 +805,9 @@ bool DatabaseManager::update_message_forwarding(
     const std::string &platform, const std::string &message_id,
     const std::string &forwarded_to_platform,
     const std::string &forwarded_message_id) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
+  // 要更新的消息可能还在写队列中
+  commit_pending();
 
   const std::string sql = R"(
         UPDATE messages
@@ -381,10 +815,11 @@ bool DatabaseManager::update_message_forwarding(
         WHERE platform = ? AND message_id = ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
-    OBCX_ERROR("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to prepare statement: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -394,10 +829,10 @@ bool DatabaseManager::update_message_forwarding(
   sqlite3_bind_text(stmt, 4, message_id.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to update message forwarding: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to update message forwarding: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -406,19 +841,60 @@ bool DatabaseManager::update_message_forwarding(
   return true;
 }
 
+auto DatabaseManager::user_cache_key(std::string_view platform,
+                                     std::string_view user_id,
+                                     std::string_view group_id)
+    -> std::string {
+  std::string key;
+  key.reserve(platform.size() + user_id.size() + group_id.size() + 2);
+  key.append(platform).append(1, '\0').append(user_id).append(1, '\0');
+  key.append(group_id);
+  return key;
+}
+
 bool DatabaseManager::save_or_update_user(const UserInfo &user_info) {
-  std::lock_guard lock(db_mutex_);
+  static auto &latency = query_latency("save_or_update_user");
+  const common::ScopedTimer timer(latency);
+
+  // 每条消息都会保存一次发送者，资料没有变化时跳过写入
+  const auto key = user_cache_key(user_info.platform, user_info.user_id,
+                                  user_info.group_id);
+  if (const auto cached = user_cache_.get(key);
+      cached && *cached && same_profile(**cached, user_info)) {
+    return true;
+  }
+
+  if (batching()) {
+    enqueue([&](PendingWrites &pending) {
+      pending.users.insert_or_assign(
+          Key{user_info.platform, user_info.user_id, user_info.group_id},
+          user_info);
+    });
+    user_cache_.put(key, user_info);
+    return true;
+  }
+
+  std::lock_guard lock(writer_.mutex());
+  if (!write_user(user_info)) {
+    user_cache_.erase(key);
+    return false;
+  }
+  user_cache_.put(key, user_info);
+  return true;
+}
 
+bool DatabaseManager::write_user(const UserInfo &user_info) {
   const std::string sql = R"(
         INSERT OR REPLACE INTO users
         (platform, user_id, group_id, username, nickname, title, first_name, last_name, last_updated)
         VALUES (?, ?, ?, ?, ?, ?, ?, ?, CURRENT_TIMESTAMP);
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
-    OBCX_ERROR("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to prepare statement: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -432,10 +908,9 @@ bool DatabaseManager::save_or_update_user(const UserInfo &user_info) {
   sqlite3_bind_text(stmt, 8, user_info.last_name.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to save user: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to save user: {}", sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -445,25 +920,68 @@ bool DatabaseManager::save_or_update_user(const UserInfo &user_info) {
 }
 
 std::optional<UserInfo> DatabaseManager::get_user(const std::string &platform,
-                                                  const std::string &user_id,
-                                                  const std::string &group_id) {
-  std::lock_guard lock(db_mutex_);
+                                                  std::string_view user_id,
+                                                  std::string_view group_id) {
+  static auto &latency = query_latency("get_user");
+  static auto &cache_hits = user_cache_lookups("hit");
+  static auto &cache_misses = user_cache_lookups("miss");
+  const common::ScopedTimer timer(latency);
+
+  // 在查看写队列之前取版本号：之后的任何写入都会让下面的回填失效
+  const auto cache_version = user_cache_.version();
+
+  if (auto pending = find_pending(
+          [&](const PendingWrites &writes) -> std::optional<UserInfo> {
+            const auto it =
+                writes.users.find(KeyView{platform, user_id, group_id});
+            if (it != writes.users.end()) {
+              return it->second;
+            }
+            return std::nullopt;
+          })) {
+    return pending;
+  }
+
+  const auto key = user_cache_key(platform, user_id, group_id);
+  if (auto cached = user_cache_.get(key)) {
+    cache_hits.inc();
+    return *std::move(cached);
+  }
+  cache_misses.inc();
+
+  auto user_info = query_user(platform, user_id, group_id);
+  if (user_info) {
+    user_cache_.put_if_unchanged(cache_version, key, user_info);
+  } else {
+    user_cache_.put_if_unchanged(cache_version, key, std::nullopt,
+                                 options_.user_negative_ttl);
+  }
+  return user_info;
+}
+
+std::optional<UserInfo> DatabaseManager::query_user(
+    const std::string &platform, std::string_view user_id,
+    std::string_view group_id) {
+  auto reader = acquire_reader();
 
   const std::string sql = R"(
         SELECT platform, user_id, group_id, username, nickname, title, first_name, last_name, last_updated
         FROM users WHERE platform = ? AND user_id = ? AND group_id = ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = reader->prepare(sql, stmt);
   if (rc != SQLITE_OK) {
-    OBCX_ERROR("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to prepare statement: {}",
+               sqlite3_errmsg(reader->handle()));
     return std::nullopt;
   }
 
   sqlite3_bind_text(stmt, 1, platform.c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_text(stmt, 2, user_id.c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_text(stmt, 3, group_id.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_text(stmt, 2, user_id.data(), static_cast<int>(user_id.size()),
+                    SQLITE_STATIC);
+  sqlite3_bind_text(stmt, 3, group_id.data(),
+                    static_cast<int>(group_id.size()), SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
   if (rc == SQLITE_ROW) {
@@ -500,20 +1018,18 @@ std::optional<UserInfo> DatabaseManager::get_user(const std::string &platform,
     if (last_name)
       user_info.last_name = last_name;
 
-    sqlite3_finalize(stmt);
     return user_info;
   }
 
-  sqlite3_finalize(stmt);
   return std::nullopt;
 }
 
 std::string DatabaseManager::get_user_display_name(
-    const std::string &platform, const std::string &user_id,
-    const std::string &group_id) {
+    const std::string &platform, std::string_view user_id,
+    std::string_view group_id) {
   auto user_info = get_user(platform, user_id, group_id);
   if (!user_info.has_value()) {
-    return user_id; // 如果没找到用户信息，返回用户ID
+    return std::string(user_id); // 如果没找到用户信息，返回用户ID
   }
 
   const auto &user = user_info.value();
@@ -573,12 +1089,12 @@ std::string DatabaseManager::get_user_display_name(
     }
   }
 
-  return user_id;
+  return std::string(user_id);
 }
 
 bool DatabaseManager::should_fetch_user_info(const std::string &platform,
-                                             const std::string &user_id,
-                                             const std::string &group_id) {
+                                             std::string_view user_id,
+                                             std::string_view group_id) {
   auto user_info = get_user(platform, user_id, group_id);
 
   // 如果用户不存在，需要获取
@@ -602,7 +1118,8 @@ bool DatabaseManager::should_fetch_user_info(const std::string &platform,
 }
 
 bool DatabaseManager::add_message_mapping(const MessageMapping &mapping) {
-  std::lock_guard lock(db_mutex_);
+  static auto &latency = query_latency("add_message_mapping");
+  const common::ScopedTimer timer(latency);
 
   // 验证消息ID不为空
   if (mapping.source_message_id.empty() || mapping.target_message_id.empty()) {
@@ -612,6 +1129,29 @@ bool DatabaseManager::add_message_mapping(const MessageMapping &mapping) {
     return false;
   }
 
+  if (batching()) {
+    // 先写缓存再入队，写线程提交失败时的移除才不会被这里的写入覆盖
+    mapping_cache_.put(mapping.source_platform, mapping.source_message_id,
+                       mapping.target_platform, mapping.target_message_id);
+    enqueue([&](PendingWrites &pending) {
+      pending.mappings.insert_or_assign(Key{mapping.source_platform,
+                                            mapping.source_message_id,
+                                            mapping.target_platform},
+                                        mapping);
+    });
+    return true;
+  }
+
+  std::lock_guard lock(writer_.mutex());
+  if (!write_mapping(mapping)) {
+    return false;
+  }
+  mapping_cache_.put(mapping.source_platform, mapping.source_message_id,
+                     mapping.target_platform, mapping.target_message_id);
+  return true;
+}
+
+bool DatabaseManager::write_mapping(const MessageMapping &mapping) {
   OBCX_DEBUG("Adding message mapping: {}:{} -> {}:{}", mapping.source_platform,
              mapping.source_message_id, mapping.target_platform,
              mapping.target_message_id);
@@ -622,10 +1162,11 @@ bool DatabaseManager::add_message_mapping(const MessageMapping &mapping) {
         VALUES (?, ?, ?, ?);
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
-    OBCX_ERROR("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to prepare statement: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -639,10 +1180,10 @@ bool DatabaseManager::add_message_mapping(const MessageMapping &mapping) {
                     SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to add message mapping: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to add message mapping: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -653,9 +1194,23 @@ bool DatabaseManager::add_message_mapping(const MessageMapping &mapping) {
 }
 
 std::optional<std::string> DatabaseManager::get_target_message_id(
-    const std::string &source_platform, const std::string &source_message_id,
+    const std::string &source_platform, std::string_view source_message_id,
     const std::string &target_platform) {
-  std::lock_guard lock(db_mutex_);
+  // 在查看缓存与写队列之前取版本号：之后的任何写入都会让回填失效
+  const auto cache_version = mapping_cache_.version();
+  if (auto cached = mapping_cache_.find_target(
+          source_platform, source_message_id, target_platform)) {
+    return cached;
+  }
+  return load_target_message_id(cache_version, source_platform,
+                                source_message_id, target_platform);
+}
+
+std::optional<std::string> DatabaseManager::load_target_message_id(
+    uint64_t cache_version, const std::string &source_platform,
+    std::string_view source_message_id, const std::string &target_platform) {
+  static auto &latency = query_latency("get_target_message_id");
+  const common::ScopedTimer timer(latency);
 
   // 验证参数不为空
   if (source_message_id.empty()) {
@@ -664,6 +1219,20 @@ std::optional<std::string> DatabaseManager::get_target_message_id(
     return std::nullopt;
   }
 
+  if (auto pending = find_pending(
+          [&](const PendingWrites &writes) -> std::optional<std::string> {
+            const auto it = writes.mappings.find(
+                KeyView{source_platform, source_message_id, target_platform});
+            if (it != writes.mappings.end()) {
+              return it->second.target_message_id;
+            }
+            return std::nullopt;
+          })) {
+    return pending;
+  }
+
+  auto reader = acquire_reader();
+
   OBCX_DEBUG("Querying target message ID: {}:{} -> {}", source_platform,
              source_message_id, target_platform);
 
@@ -672,35 +1241,51 @@ std::optional<std::string> DatabaseManager::get_target_message_id(
         WHERE source_platform = ? AND source_message_id = ? AND target_platform = ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = reader->prepare(sql, stmt);
   if (rc != SQLITE_OK) {
-    OBCX_ERROR("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to prepare statement: {}",
+               sqlite3_errmsg(reader->handle()));
     return std::nullopt;
   }
 
   sqlite3_bind_text(stmt, 1, source_platform.c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_text(stmt, 2, source_message_id.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_text(stmt, 2, source_message_id.data(),
+                    static_cast<int>(source_message_id.size()), SQLITE_STATIC);
   sqlite3_bind_text(stmt, 3, target_platform.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
   if (rc == SQLITE_ROW) {
     std::string result =
         reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
-    sqlite3_finalize(stmt);
     OBCX_DEBUG("Found target message ID: {}", result);
+    mapping_cache_.put_if_unchanged(cache_version, source_platform,
+                                    source_message_id, target_platform,
+                                    result);
     return result;
   }
 
-  sqlite3_finalize(stmt);
   OBCX_DEBUG("No target message ID found");
   return std::nullopt;
 }
 
 std::optional<std::string> DatabaseManager::get_source_message_id(
-    const std::string &target_platform, const std::string &target_message_id,
+    const std::string &target_platform, std::string_view target_message_id,
     const std::string &source_platform) {
-  std::lock_guard lock(db_mutex_);
+  const auto cache_version = mapping_cache_.version();
+  if (auto cached = mapping_cache_.find_source(
+          target_platform, target_message_id, source_platform)) {
+    return cached;
+  }
+  return load_source_message_id(cache_version, target_platform,
+                                target_message_id, source_platform);
+}
+
+std::optional<std::string> DatabaseManager::load_source_message_id(
+    uint64_t cache_version, const std::string &target_platform,
+    std::string_view target_message_id, const std::string &source_platform) {
+  static auto &latency = query_latency("get_source_message_id");
+  const common::ScopedTimer timer(latency);
 
   // 验证参数不为空
   if (target_message_id.empty()) {
@@ -709,6 +1294,16 @@ std::optional<std::string> DatabaseManager::get_source_message_id(
     return std::nullopt;
   }
 
+  if (auto pending = find_pending(
+          [&](const PendingWrites &writes) {
+            return find_pending_source(writes, target_platform,
+                                       target_message_id, source_platform);
+          })) {
+    return pending;
+  }
+
+  auto reader = acquire_reader();
+
   OBCX_DEBUG("Querying source message ID: {}:{} <- {}", target_platform,
              target_message_id, source_platform);
 
@@ -717,70 +1312,186 @@ std::optional<std::string> DatabaseManager::get_source_message_id(
         WHERE target_platform = ? AND target_message_id = ? AND source_platform = ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = reader->prepare(sql, stmt);
   if (rc != SQLITE_OK) {
-    OBCX_ERROR("Failed to prepare statement: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to prepare statement: {}",
+               sqlite3_errmsg(reader->handle()));
     return std::nullopt;
   }
 
   sqlite3_bind_text(stmt, 1, target_platform.c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_text(stmt, 2, target_message_id.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_text(stmt, 2, target_message_id.data(),
+                    static_cast<int>(target_message_id.size()), SQLITE_STATIC);
   sqlite3_bind_text(stmt, 3, source_platform.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
   if (rc == SQLITE_ROW) {
     std::string result =
         reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
-    sqlite3_finalize(stmt);
     OBCX_DEBUG("Found source message ID: {}", result);
+    mapping_cache_.put_if_unchanged(cache_version, source_platform, result,
+                                    target_platform, target_message_id);
     return result;
   }
 
-  sqlite3_finalize(stmt);
   OBCX_DEBUG("No source message ID found");
   return std::nullopt;
 }
 
+auto DatabaseManager::find_pending_source(const PendingWrites &writes,
+                                          std::string_view target_platform,
+                                          std::string_view target_message_id,
+                                          std::string_view source_platform)
+    -> std::optional<std::string> {
+  // 反向查找没有索引，写队列最多 batch_max_rows 行，直接遍历
+  for (const auto &[key, mapping] : writes.mappings) {
+    if (mapping.target_platform == target_platform &&
+        mapping.target_message_id == target_message_id &&
+        mapping.source_platform == source_platform) {
+      return mapping.source_message_id;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string> DatabaseManager::find_linked_message_id(
+    const std::string &platform, std::string_view message_id,
+    const std::string &peer_platform) {
+  const auto cache_version = mapping_cache_.version();
+  if (auto cached = find_cached_link(platform, message_id, peer_platform)) {
+    return cached;
+  }
+  return load_linked_message_id(cache_version, platform, message_id,
+                                peer_platform);
+}
+
+auto DatabaseManager::find_cached_link(std::string_view platform,
+                                       std::string_view message_id,
+                                       std::string_view peer_platform)
+    -> std::optional<std::string> {
+  if (auto target =
+          mapping_cache_.find_target(platform, message_id, peer_platform)) {
+    return target;
+  }
+  return mapping_cache_.find_source(platform, message_id, peer_platform);
+}
+
+std::optional<std::string> DatabaseManager::load_linked_message_id(
+    uint64_t cache_version, const std::string &platform,
+    std::string_view message_id, const std::string &peer_platform) {
+  static auto &latency = query_latency("find_linked_message_id");
+  const common::ScopedTimer timer(latency);
+
+  if (message_id.empty()) {
+    return std::nullopt;
+  }
+
+  if (auto pending = find_pending(
+          [&](const PendingWrites &writes) -> std::optional<std::string> {
+            const auto it = writes.mappings.find(
+                KeyView{platform, message_id, peer_platform});
+            if (it != writes.mappings.end()) {
+              return it->second.target_message_id;
+            }
+            return find_pending_source(writes, platform, message_id,
+                                       peer_platform);
+          })) {
+    return pending;
+  }
+
+  auto reader = acquire_reader();
+
+  // 两个方向合并为一次查询，正向映射优先
+  const std::string sql = R"(
+        SELECT 0, target_message_id FROM message_mappings
+        WHERE source_platform = ?1 AND source_message_id = ?2
+          AND target_platform = ?3
+        UNION ALL
+        SELECT 1, source_message_id FROM message_mappings
+        WHERE target_platform = ?1 AND target_message_id = ?2
+          AND source_platform = ?3
+        ORDER BY 1 LIMIT 1;
+    )";
+
+  CachedStatement stmt;
+  int rc = reader->prepare(sql, stmt);
+  if (rc != SQLITE_OK) {
+    OBCX_ERROR("Failed to prepare statement: {}",
+               sqlite3_errmsg(reader->handle()));
+    return std::nullopt;
+  }
+
+  sqlite3_bind_text(stmt, 1, platform.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_text(stmt, 2, message_id.data(),
+                    static_cast<int>(message_id.size()), SQLITE_STATIC);
+  sqlite3_bind_text(stmt, 3, peer_platform.c_str(), -1, SQLITE_STATIC);
+
+  if (sqlite3_step(stmt) != SQLITE_ROW) {
+    OBCX_DEBUG("No linked message ID found: {}:{} <-> {}", platform,
+               message_id, peer_platform);
+    return std::nullopt;
+  }
+
+  std::string result =
+      reinterpret_cast<const char *>(sqlite3_column_text(stmt, 1));
+  if (sqlite3_column_int(stmt, 0) == 0) {
+    mapping_cache_.put_if_unchanged(cache_version, platform, message_id,
+                                    peer_platform, result);
+  } else {
+    mapping_cache_.put_if_unchanged(cache_version, peer_platform, result,
+                                    platform, message_id);
+  }
+  return result;
+}
+
 bool DatabaseManager::delete_message_mapping(
-    const std::string &source_platform, const std::string &source_message_id,
+    const std::string &source_platform, std::string_view source_message_id,
     const std::string &target_platform) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
+  // 先提交写队列，否则队列中的映射会在删除之后重新写入
+  commit_pending();
 
   const std::string sql = R"(
         DELETE FROM message_mappings
         WHERE source_platform = ? AND source_message_id = ? AND target_platform = ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
-    OBCX_ERROR("Failed to prepare delete statement: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to prepare delete statement: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
   sqlite3_bind_text(stmt, 1, source_platform.c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_text(stmt, 2, source_message_id.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_text(stmt, 2, source_message_id.data(),
+                    static_cast<int>(source_message_id.size()), SQLITE_STATIC);
   sqlite3_bind_text(stmt, 3, target_platform.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  // 删除之后再清除缓存，删除前开始的查询回填会因版本变化被丢弃
+  mapping_cache_.erase(source_platform, source_message_id, target_platform);
 
   if (rc == SQLITE_DONE) {
     OBCX_DEBUG("消息映射删除成功: {}:{} -> {}", source_platform,
                source_message_id, target_platform);
     return true;
   } else {
-    OBCX_ERROR("Failed to delete message mapping: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to delete message mapping: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 }
 
 bool DatabaseManager::update_message_mapping(
-    const std::string &source_platform, const std::string &source_message_id,
+    const std::string &source_platform, std::string_view source_message_id,
     const std::string &target_platform,
     const std::string &new_target_message_id) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
+  // 要更新的映射可能还在写队列中
+  commit_pending();
 
   const std::string sql = R"(
         UPDATE message_mappings
@@ -788,27 +1499,35 @@ bool DatabaseManager::update_message_mapping(
         WHERE source_platform = ? AND source_message_id = ? AND target_platform = ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
-    OBCX_ERROR("Failed to prepare update statement: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to prepare update statement: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
   sqlite3_bind_text(stmt, 1, new_target_message_id.c_str(), -1, SQLITE_STATIC);
   sqlite3_bind_text(stmt, 2, source_platform.c_str(), -1, SQLITE_STATIC);
-  sqlite3_bind_text(stmt, 3, source_message_id.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_text(stmt, 3, source_message_id.data(),
+                    static_cast<int>(source_message_id.size()), SQLITE_STATIC);
   sqlite3_bind_text(stmt, 4, target_platform.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
+  if (rc == SQLITE_DONE && sqlite3_changes(writer_.handle()) > 0) {
+    mapping_cache_.put(source_platform, source_message_id, target_platform,
+                       new_target_message_id);
+  } else {
+    mapping_cache_.erase(source_platform, source_message_id, target_platform);
+  }
 
   if (rc == SQLITE_DONE) {
     OBCX_DEBUG("消息映射更新成功: {}:{} -> {}:{}", source_platform,
                source_message_id, target_platform, new_target_message_id);
     return true;
   } else {
-    OBCX_ERROR("Failed to update message mapping: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to update message mapping: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 }
@@ -818,7 +1537,7 @@ bool DatabaseManager::save_message_from_event(const common::MessageEvent &event,
   MessageInfo msg_info;
   msg_info.platform = platform;
   msg_info.message_id = event.message_id;
-  msg_info.group_id = event.group_id.value_or("");
+  msg_info.group_id = event.group_id.value_or(common::ChatId{});
   msg_info.user_id = event.user_id;
   msg_info.content = event.raw_message;
   msg_info.timestamp = event.time;
@@ -862,7 +1581,9 @@ bool DatabaseManager::save_user_from_event(const common::MessageEvent &event,
   user_info.platform = platform;
   user_info.user_id = event.user_id;
   // 只有QQ用户使用群组特定的昵称，Telegram用户始终使用空的group_id
-  user_info.group_id = (platform == "qq") ? event.group_id.value_or("") : "";
+  user_info.group_id = (platform == "qq")
+                           ? event.group_id.value_or(common::ChatId{}).str()
+                           : "";
   user_info.last_updated = std::chrono::system_clock::now();
 
   // 尝试从event.data中提取更多用户信息
@@ -901,6 +1622,157 @@ bool DatabaseManager::save_user_from_event(const common::MessageEvent &event,
   return save_or_update_user(user_info);
 }
 
+// === 异步接口 ===
+
+auto DatabaseManager::save_message_from_event_async(
+    const common::MessageEvent &event, const std::string &platform)
+    -> boost::asio::awaitable<bool> {
+  co_return co_await run_write(
+      [&] { return save_message_from_event(event, platform); });
+}
+
+auto DatabaseManager::save_user_from_event_async(
+    const common::MessageEvent &event, const std::string &platform)
+    -> boost::asio::awaitable<bool> {
+  co_return co_await run_write(
+      [&] { return save_user_from_event(event, platform); });
+}
+
+auto DatabaseManager::save_or_update_user_async(const UserInfo &user_info)
+    -> boost::asio::awaitable<bool> {
+  co_return co_await run_write([&] { return save_or_update_user(user_info); });
+}
+
+auto DatabaseManager::get_user_display_name_async(const std::string &platform,
+                                                  std::string_view user_id,
+                                                  std::string_view group_id)
+    -> boost::asio::awaitable<std::string> {
+  co_return co_await run_read(
+      [&] { return get_user_display_name(platform, user_id, group_id); });
+}
+
+auto DatabaseManager::should_fetch_user_info_async(const std::string &platform,
+                                                   std::string_view user_id,
+                                                   std::string_view group_id)
+    -> boost::asio::awaitable<bool> {
+  co_return co_await run_read(
+      [&] { return should_fetch_user_info(platform, user_id, group_id); });
+}
+
+auto DatabaseManager::add_message_mapping_async(const MessageMapping &mapping)
+    -> boost::asio::awaitable<bool> {
+  co_return co_await run_write([&] { return add_message_mapping(mapping); });
+}
+
+auto DatabaseManager::get_target_message_id_async(
+    const std::string &source_platform, std::string_view source_message_id,
+    const std::string &target_platform)
+    -> boost::asio::awaitable<std::optional<std::string>> {
+  // 缓存命中时直接返回，不切换到读线程
+  const auto cache_version = mapping_cache_.version();
+  if (auto cached = mapping_cache_.find_target(
+          source_platform, source_message_id, target_platform)) {
+    co_return cached;
+  }
+  co_return co_await run_read([&] {
+    return load_target_message_id(cache_version, source_platform,
+                                  source_message_id, target_platform);
+  });
+}
+
+auto DatabaseManager::get_source_message_id_async(
+    const std::string &target_platform, std::string_view target_message_id,
+    const std::string &source_platform)
+    -> boost::asio::awaitable<std::optional<std::string>> {
+  const auto cache_version = mapping_cache_.version();
+  if (auto cached = mapping_cache_.find_source(
+          target_platform, target_message_id, source_platform)) {
+    co_return cached;
+  }
+  co_return co_await run_read([&] {
+    return load_source_message_id(cache_version, target_platform,
+                                  target_message_id, source_platform);
+  });
+}
+
+auto DatabaseManager::find_linked_message_id_async(
+    const std::string &platform, std::string_view message_id,
+    const std::string &peer_platform)
+    -> boost::asio::awaitable<std::optional<std::string>> {
+  // 缓存命中时直接返回，不切换到读线程
+  const auto cache_version = mapping_cache_.version();
+  if (auto cached = find_cached_link(platform, message_id, peer_platform)) {
+    co_return cached;
+  }
+  co_return co_await run_read([&] {
+    return load_linked_message_id(cache_version, platform, message_id,
+                                  peer_platform);
+  });
+}
+
+auto DatabaseManager::delete_message_mapping_async(
+    const std::string &source_platform, std::string_view source_message_id,
+    const std::string &target_platform) -> boost::asio::awaitable<bool> {
+  co_return co_await run_write([&] {
+    return delete_message_mapping(source_platform, source_message_id,
+                                  target_platform);
+  });
+}
+
+auto DatabaseManager::update_message_mapping_async(
+    const std::string &source_platform, std::string_view source_message_id,
+    const std::string &target_platform,
+    const std::string &new_target_message_id) -> boost::asio::awaitable<bool> {
+  co_return co_await run_write([&] {
+    return update_message_mapping(source_platform, source_message_id,
+                                  target_platform, new_target_message_id);
+  });
+}
+
+auto DatabaseManager::save_sticker_cache_async(
+    const StickerCacheInfo &cache_info) -> boost::asio::awaitable<bool> {
+  co_return co_await run_write([&] { return save_sticker_cache(cache_info); });
+}
+
+auto DatabaseManager::get_sticker_cache_async(const std::string &platform,
+                                              const std::string &sticker_hash)
+    -> boost::asio::awaitable<std::optional<StickerCacheInfo>> {
+  co_return co_await run_read(
+      [&] { return get_sticker_cache(platform, sticker_hash); });
+}
+
+auto DatabaseManager::save_qq_sticker_mapping_async(
+    const QQStickerMapping &mapping) -> boost::asio::awaitable<bool> {
+  co_return co_await run_write(
+      [&] { return save_qq_sticker_mapping(mapping); });
+}
+
+auto DatabaseManager::get_qq_sticker_mapping_async(
+    const std::string &qq_sticker_hash)
+    -> boost::asio::awaitable<std::optional<QQStickerMapping>> {
+  co_return co_await run_read(
+      [&] { return get_qq_sticker_mapping(qq_sticker_hash); });
+}
+
+auto DatabaseManager::update_qq_sticker_last_used_async(
+    const std::string &qq_sticker_hash) -> boost::asio::awaitable<bool> {
+  co_return co_await run_write(
+      [&] { return update_qq_sticker_last_used(qq_sticker_hash); });
+}
+
+auto DatabaseManager::update_platform_heartbeat_async(
+    const std::string &platform,
+    const std::chrono::system_clock::time_point &heartbeat_time)
+    -> boost::asio::awaitable<bool> {
+  co_return co_await run_write(
+      [&] { return update_platform_heartbeat(platform, heartbeat_time); });
+}
+
+auto DatabaseManager::get_platform_heartbeat_async(const std::string &platform)
+    -> boost::asio::awaitable<std::optional<PlatformHeartbeatInfo>> {
+  co_return co_await run_read([&] { return get_platform_heartbeat(platform); });
+}
+
 // 时间戳转换辅助函数
 int64_t DatabaseManager::time_point_to_timestamp(
     const std::chrono::system_clock::time_point &tp) {
@@ -916,7 +1788,7 @@ std::chrono::system_clock::time_point DatabaseManager::timestamp_to_time_point(
 // === 表情包缓存相关操作实现 ===
 
 bool DatabaseManager::save_sticker_cache(const StickerCacheInfo &cache_info) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
 
   const std::string sql = R"(
         INSERT OR REPLACE INTO sticker_cache (
@@ -926,12 +1798,12 @@ bool DatabaseManager::save_sticker_cache(const StickerCacheInfo &cache_info) {
         ) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
     )";
 
-  sqlite3_stmt *stmt = nullptr;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
 
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare save sticker cache statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -987,10 +1859,10 @@ bool DatabaseManager::save_sticker_cache(const StickerCacheInfo &cache_info) {
                      time_point_to_timestamp(cache_info.last_used_at));
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to save sticker cache: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to save sticker cache: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1001,7 +1873,7 @@ bool DatabaseManager::save_sticker_cache(const StickerCacheInfo &cache_info) {
 
 std::optional<StickerCacheInfo> DatabaseManager::get_sticker_cache(
     const std::string &platform, const std::string &sticker_hash) {
-  std::lock_guard lock(db_mutex_);
+  auto reader = acquire_reader();
 
   const std::string sql = R"(
         SELECT platform, sticker_id, sticker_hash, original_name, file_type, mime_type,
@@ -1011,12 +1883,12 @@ std::optional<StickerCacheInfo> DatabaseManager::get_sticker_cache(
         WHERE platform = ? AND sticker_hash = ?
     )";
 
-  sqlite3_stmt *stmt = nullptr;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = reader->prepare(sql, stmt);
 
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare get sticker cache statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(reader->handle()));
     return std::nullopt;
   }
 
@@ -1025,7 +1897,6 @@ std::optional<StickerCacheInfo> DatabaseManager::get_sticker_cache(
 
   rc = sqlite3_step(stmt);
   if (rc != SQLITE_ROW) {
-    sqlite3_finalize(stmt);
     return std::nullopt;
   }
 
@@ -1078,7 +1949,6 @@ std::optional<StickerCacheInfo> DatabaseManager::get_sticker_cache(
   cache_info.last_used_at =
       timestamp_to_time_point(sqlite3_column_int64(stmt, idx++));
 
-  sqlite3_finalize(stmt);
 
   OBCX_DEBUG("Sticker cache found: {} - {}", platform, sticker_hash);
   return cache_info;
@@ -1086,7 +1956,7 @@ std::optional<StickerCacheInfo> DatabaseManager::get_sticker_cache(
 
 bool DatabaseManager::update_sticker_last_used(
     const std::string &platform, const std::string &sticker_hash) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
 
   const std::string sql = R"(
         UPDATE sticker_cache
@@ -1094,12 +1964,12 @@ bool DatabaseManager::update_sticker_last_used(
         WHERE platform = ? AND sticker_hash = ?
     )";
 
-  sqlite3_stmt *stmt = nullptr;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
 
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare update sticker last used statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1109,10 +1979,10 @@ bool DatabaseManager::update_sticker_last_used(
   sqlite3_bind_text(stmt, 3, sticker_hash.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to update sticker last used: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to update sticker last used: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1123,7 +1993,7 @@ auto DatabaseManager::update_sticker_conversion(
     const std::string &platform, const std::string &sticker_hash,
     const std::string &conversion_status,
     const std::optional<std::string> &converted_file_path) -> bool {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
 
   const std::string sql = R"(
         UPDATE sticker_cache
@@ -1131,12 +2001,12 @@ auto DatabaseManager::update_sticker_conversion(
         WHERE platform = ? AND sticker_hash = ?
     )";
 
-  sqlite3_stmt *stmt = nullptr;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
 
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare update sticker conversion statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1152,10 +2022,10 @@ auto DatabaseManager::update_sticker_conversion(
   sqlite3_bind_text(stmt, 4, sticker_hash.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to update sticker conversion: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to update sticker conversion: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1165,7 +2035,7 @@ auto DatabaseManager::update_sticker_conversion(
 // === QQ表情包映射相关操作 ===
 
 bool DatabaseManager::save_qq_sticker_mapping(const QQStickerMapping &mapping) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
 
   const std::string sql = R"(
     INSERT OR REPLACE INTO qq_sticker_mapping 
@@ -1173,12 +2043,12 @@ bool DatabaseManager::save_qq_sticker_mapping(const QQStickerMapping &mapping) {
     VALUES (?, ?, ?, ?, ?, ?, ?, ?)
   )";
 
-  sqlite3_stmt *stmt = nullptr;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
 
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare save qq sticker mapping statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1212,10 +2082,10 @@ bool DatabaseManager::save_qq_sticker_mapping(const QQStickerMapping &mapping) {
   }
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to save qq sticker mapping: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to save qq sticker mapping: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1224,7 +2094,7 @@ bool DatabaseManager::save_qq_sticker_mapping(const QQStickerMapping &mapping) {
 
 auto DatabaseManager::get_qq_sticker_mapping(const std::string &qq_sticker_hash)
     -> std::optional<QQStickerMapping> {
-  std::lock_guard lock(db_mutex_);
+  auto reader = acquire_reader();
 
   const std::string sql = R"(
     SELECT qq_sticker_hash, telegram_file_id, file_type, created_at, last_used_at, is_gif, content_type, last_checked_at 
@@ -1232,12 +2102,12 @@ auto DatabaseManager::get_qq_sticker_mapping(const std::string &qq_sticker_hash)
     WHERE qq_sticker_hash = ?
   )";
 
-  sqlite3_stmt *stmt = nullptr;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = reader->prepare(sql, stmt);
 
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare get qq sticker mapping statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(reader->handle()));
     return std::nullopt;
   }
 
@@ -1271,19 +2141,18 @@ auto DatabaseManager::get_qq_sticker_mapping(const std::string &qq_sticker_hash)
           timestamp_to_time_point(sqlite3_column_int64(stmt, 7));
     }
 
-    sqlite3_finalize(stmt);
     return mapping;
   } else if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to get qq sticker mapping: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to get qq sticker mapping: {}",
+               sqlite3_errmsg(reader->handle()));
   }
 
-  sqlite3_finalize(stmt);
   return std::nullopt;
 }
 
 bool DatabaseManager::update_qq_sticker_last_used(
     const std::string &qq_sticker_hash) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
 
   const std::string sql = R"(
     UPDATE qq_sticker_mapping 
@@ -1291,12 +2160,12 @@ bool DatabaseManager::update_qq_sticker_last_used(
     WHERE qq_sticker_hash = ?
   )";
 
-  sqlite3_stmt *stmt = nullptr;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
 
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare update qq sticker last used statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1305,11 +2174,10 @@ bool DatabaseManager::update_qq_sticker_last_used(
   sqlite3_bind_text(stmt, 2, qq_sticker_hash.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
     OBCX_ERROR("Failed to update qq sticker last used: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1354,9 +2222,9 @@ std::string DatabaseManager::calculate_hash(const std::string &input) {
 }
 
 int DatabaseManager::cleanup_old_image_type_cache(int max_age_days) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
 
-  if (!db_) {
+  if (!writer_.handle()) {
     OBCX_ERROR("数据库连接未初始化");
     return -1;
   }
@@ -1374,9 +2242,10 @@ int DatabaseManager::cleanup_old_image_type_cache(int max_age_days) {
       AND last_used_at < ?
     )";
 
-    sqlite3_stmt *stmt;
-    if (sqlite3_prepare_v2(db_, sql, -1, &stmt, nullptr) != SQLITE_OK) {
-      OBCX_ERROR("清理缓存SQL准备失败: {}", sqlite3_errmsg(db_));
+    CachedStatement stmt;
+    if (writer_.prepare(sql, stmt) != SQLITE_OK) {
+      OBCX_ERROR("清理缓存SQL准备失败: {}",
+                 sqlite3_errmsg(writer_.handle()));
       return -1;
     }
 
@@ -1386,14 +2255,14 @@ int DatabaseManager::cleanup_old_image_type_cache(int max_age_days) {
     int deleted_count = -1;
 
     if (result == SQLITE_DONE) {
-      deleted_count = sqlite3_changes(db_);
+      deleted_count = sqlite3_changes(writer_.handle());
       OBCX_INFO("清理了{}条超过{}天未使用的图片类型缓存记录", deleted_count,
                 max_age_days);
     } else {
-      OBCX_ERROR("清理缓存执行失败: {}", sqlite3_errmsg(db_));
+      OBCX_ERROR("清理缓存执行失败: {}",
+                 sqlite3_errmsg(writer_.handle()));
     }
 
-    sqlite3_finalize(stmt);
     return deleted_count;
 
   } catch (const std::exception &e) {
@@ -1403,9 +2272,9 @@ int DatabaseManager::cleanup_old_image_type_cache(int max_age_days) {
 }
 
 std::string DatabaseManager::get_cache_statistics() {
-  std::lock_guard lock(db_mutex_);
+  auto reader = acquire_reader();
 
-  if (!db_) {
+  if (!reader->handle()) {
     return "数据库连接未初始化";
   }
 
@@ -1414,14 +2283,13 @@ std::string DatabaseManager::get_cache_statistics() {
   try {
     // 统计总记录数
     const char *count_sql = "SELECT COUNT(*) FROM qq_sticker_mapping";
-    sqlite3_stmt *stmt;
+    CachedStatement stmt;
 
-    if (sqlite3_prepare_v2(db_, count_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (reader->prepare(count_sql, stmt) == SQLITE_OK) {
       if (sqlite3_step(stmt) == SQLITE_ROW) {
         int total_count = sqlite3_column_int(stmt, 0);
         stats << "总缓存记录数: " << total_count << "\n";
       }
-      sqlite3_finalize(stmt);
     }
 
     // 统计有图片类型信息的记录数
@@ -1430,12 +2298,11 @@ std::string DatabaseManager::get_cache_statistics() {
       WHERE is_gif IS NOT NULL
     )";
 
-    if (sqlite3_prepare_v2(db_, typed_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (reader->prepare(typed_sql, stmt) == SQLITE_OK) {
       if (sqlite3_step(stmt) == SQLITE_ROW) {
         int typed_count = sqlite3_column_int(stmt, 0);
         stats << "已检测类型的记录数: " << typed_count << "\n";
       }
-      sqlite3_finalize(stmt);
     }
 
     // 统计GIF和非GIF的分布
@@ -1447,14 +2314,13 @@ std::string DatabaseManager::get_cache_statistics() {
       WHERE is_gif IS NOT NULL
     )";
 
-    if (sqlite3_prepare_v2(db_, gif_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (reader->prepare(gif_sql, stmt) == SQLITE_OK) {
       if (sqlite3_step(stmt) == SQLITE_ROW) {
         int gif_count = sqlite3_column_int(stmt, 0);
         int static_count = sqlite3_column_int(stmt, 1);
         stats << "GIF图片数: " << gif_count << "\n";
         stats << "静态图片数: " << static_count << "\n";
       }
-      sqlite3_finalize(stmt);
     }
 
     // 统计最近检测时间
@@ -1468,13 +2334,12 @@ std::string DatabaseManager::get_cache_statistics() {
         std::chrono::system_clock::now() - std::chrono::hours(24);
     int64_t recent_timestamp = time_point_to_timestamp(recent_time);
 
-    if (sqlite3_prepare_v2(db_, recent_sql, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (reader->prepare(recent_sql, stmt) == SQLITE_OK) {
       sqlite3_bind_int64(stmt, 1, recent_timestamp);
       if (sqlite3_step(stmt) == SQLITE_ROW) {
         int recent_count = sqlite3_column_int(stmt, 0);
         stats << "24小时内检测的记录数: " << recent_count << "\n";
       }
-      sqlite3_finalize(stmt);
     }
 
   } catch (const std::exception &e) {
@@ -1487,7 +2352,7 @@ std::string DatabaseManager::get_cache_statistics() {
 // === 消息重试队列相关操作 ===
 
 bool DatabaseManager::add_message_retry(const MessageRetryInfo &retry_info) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
 
   const std::string sql = R"(
         INSERT OR REPLACE INTO message_retry_queue
@@ -1497,11 +2362,11 @@ bool DatabaseManager::add_message_retry(const MessageRetryInfo &retry_info) {
         VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare message retry statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1529,10 +2394,10 @@ bool DatabaseManager::add_message_retry(const MessageRetryInfo &retry_info) {
                      time_point_to_timestamp(retry_info.last_attempt_at));
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to insert message retry: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to insert message retry: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1540,8 +2405,8 @@ bool DatabaseManager::add_message_retry(const MessageRetryInfo &retry_info) {
 }
 
 std::vector<MessageRetryInfo> DatabaseManager::get_pending_message_retries(
-    int limit) {
-  std::lock_guard lock(db_mutex_);
+    int limit, std::chrono::system_clock::time_point due_before) {
+  auto reader = acquire_reader();
   std::vector<MessageRetryInfo> retries;
 
   const std::string sql = R"(
@@ -1554,17 +2419,15 @@ std::vector<MessageRetryInfo> DatabaseManager::get_pending_message_retries(
         LIMIT ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = reader->prepare(sql, stmt);
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare get pending message retries statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(reader->handle()));
     return retries;
   }
 
-  int64_t current_time =
-      time_point_to_timestamp(std::chrono::system_clock::now());
-  sqlite3_bind_int64(stmt, 1, current_time);
+  sqlite3_bind_int64(stmt, 1, time_point_to_timestamp(due_before));
   sqlite3_bind_int(stmt, 2, limit);
 
   while (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -1603,7 +2466,6 @@ std::vector<MessageRetryInfo> DatabaseManager::get_pending_message_retries(
     retries.push_back(info);
   }
 
-  sqlite3_finalize(stmt);
   return retries;
 }
 
@@ -1612,7 +2474,7 @@ bool DatabaseManager::update_message_retry(
     const std::string &target_platform, int retry_count,
     const std::chrono::system_clock::time_point &next_retry_at,
     const std::string &failure_reason) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
 
   const std::string sql = R"(
         UPDATE message_retry_queue
@@ -1620,11 +2482,11 @@ bool DatabaseManager::update_message_retry(
         WHERE source_platform = ? AND source_message_id = ? AND target_platform = ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare update message retry statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1638,10 +2500,10 @@ bool DatabaseManager::update_message_retry(
   sqlite3_bind_text(stmt, 7, target_platform.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to update message retry: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to update message retry: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1651,18 +2513,18 @@ bool DatabaseManager::update_message_retry(
 bool DatabaseManager::remove_message_retry(const std::string &source_platform,
                                            const std::string &source_message_id,
                                            const std::string &target_platform) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
 
   const std::string sql = R"(
         DELETE FROM message_retry_queue
         WHERE source_platform = ? AND source_message_id = ? AND target_platform = ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare remove message retry statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1671,10 +2533,10 @@ bool DatabaseManager::remove_message_retry(const std::string &source_platform,
   sqlite3_bind_text(stmt, 3, target_platform.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to remove message retry: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to remove message retry: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1685,7 +2547,7 @@ bool DatabaseManager::remove_message_retry(const std::string &source_platform,
 
 bool DatabaseManager::add_media_download_retry(
     const MediaDownloadRetryInfo &retry_info) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
 
   const std::string sql = R"(
         INSERT OR REPLACE INTO media_download_retry_queue
@@ -1695,11 +2557,11 @@ bool DatabaseManager::add_media_download_retry(
         VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare media download retry statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1721,11 +2583,10 @@ bool DatabaseManager::add_media_download_retry(
                      time_point_to_timestamp(retry_info.last_attempt_at));
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
     OBCX_ERROR("Failed to insert media download retry: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1733,8 +2594,9 @@ bool DatabaseManager::add_media_download_retry(
 }
 
 std::vector<MediaDownloadRetryInfo>
-DatabaseManager::get_pending_media_download_retries(int limit) {
-  std::lock_guard lock(db_mutex_);
+DatabaseManager::get_pending_media_download_retries(
+    int limit, std::chrono::system_clock::time_point due_before) {
+  std::lock_guard lock(writer_.mutex());
   std::vector<MediaDownloadRetryInfo> retries;
 
   const std::string sql = R"(
@@ -1747,18 +2609,16 @@ DatabaseManager::get_pending_media_download_retries(int limit) {
         LIMIT ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
     OBCX_ERROR(
         "Failed to prepare get pending media download retries statement: {}",
-        sqlite3_errmsg(db_));
+        sqlite3_errmsg(writer_.handle()));
     return retries;
   }
 
-  int64_t current_time =
-      time_point_to_timestamp(std::chrono::system_clock::now());
-  sqlite3_bind_int64(stmt, 1, current_time);
+  sqlite3_bind_int64(stmt, 1, time_point_to_timestamp(due_before));
   sqlite3_bind_int(stmt, 2, limit);
 
   while (sqlite3_step(stmt) == SQLITE_ROW) {
@@ -1788,7 +2648,6 @@ DatabaseManager::get_pending_media_download_retries(int limit) {
     retries.push_back(info);
   }
 
-  sqlite3_finalize(stmt);
   return retries;
 }
 
@@ -1796,7 +2655,7 @@ bool DatabaseManager::update_media_download_retry(
     const std::string &platform, const std::string &file_id, int retry_count,
     const std::chrono::system_clock::time_point &next_retry_at,
     const std::string &failure_reason, bool use_proxy) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
 
   const std::string sql = R"(
         UPDATE media_download_retry_queue
@@ -1804,11 +2663,11 @@ bool DatabaseManager::update_media_download_retry(
         WHERE platform = ? AND file_id = ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare update media download retry statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1822,11 +2681,10 @@ bool DatabaseManager::update_media_download_retry(
   sqlite3_bind_text(stmt, 7, file_id.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
     OBCX_ERROR("Failed to update media download retry: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1835,18 +2693,18 @@ bool DatabaseManager::update_media_download_retry(
 
 bool DatabaseManager::remove_media_download_retry(const std::string &platform,
                                                   const std::string &file_id) {
-  std::lock_guard lock(db_mutex_);
+  std::lock_guard lock(writer_.mutex());
 
   const std::string sql = R"(
         DELETE FROM media_download_retry_queue
         WHERE platform = ? AND file_id = ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare remove media download retry statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1854,11 +2712,10 @@ bool DatabaseManager::remove_media_download_retry(const std::string &platform,
   sqlite3_bind_text(stmt, 2, file_id.c_str(), -1, SQLITE_STATIC);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
     OBCX_ERROR("Failed to remove media download retry: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
@@ -1869,44 +2726,74 @@ bool DatabaseManager::remove_media_download_retry(const std::string &platform,
 bool DatabaseManager::update_platform_heartbeat(
     const std::string &platform,
     const std::chrono::system_clock::time_point &heartbeat_time) {
-  std::lock_guard lock(db_mutex_);
+  // 数据库按秒存储，队列中的值同样截断到秒
+  PlatformHeartbeatInfo heartbeat{
+      .platform = platform,
+      .last_heartbeat_at =
+          std::chrono::floor<std::chrono::seconds>(heartbeat_time),
+      .updated_at = std::chrono::floor<std::chrono::seconds>(
+          std::chrono::system_clock::now())};
+
+  if (batching()) {
+    enqueue([&](PendingWrites &pending) {
+      pending.heartbeats.insert_or_assign(platform, std::move(heartbeat));
+    });
+    return true;
+  }
+
+  std::lock_guard lock(writer_.mutex());
+  return write_heartbeat(heartbeat);
+}
 
+bool DatabaseManager::write_heartbeat(const PlatformHeartbeatInfo &heartbeat) {
   const std::string sql = R"(
         INSERT OR REPLACE INTO platform_heartbeats 
         (platform, last_heartbeat_at, updated_at)
         VALUES (?, ?, strftime('%s','now'));
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = writer_.prepare(sql, stmt);
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare update platform heartbeat statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
   auto heartbeat_timestamp = std::chrono::duration_cast<std::chrono::seconds>(
-                                 heartbeat_time.time_since_epoch())
+                                 heartbeat.last_heartbeat_at.time_since_epoch())
                                  .count();
 
-  sqlite3_bind_text(stmt, 1, platform.c_str(), -1, SQLITE_STATIC);
+  sqlite3_bind_text(stmt, 1, heartbeat.platform.c_str(), -1, SQLITE_STATIC);
   sqlite3_bind_int64(stmt, 2, heartbeat_timestamp);
 
   rc = sqlite3_step(stmt);
-  sqlite3_finalize(stmt);
 
   if (rc != SQLITE_DONE) {
-    OBCX_ERROR("Failed to update platform heartbeat: {}", sqlite3_errmsg(db_));
+    OBCX_ERROR("Failed to update platform heartbeat: {}",
+               sqlite3_errmsg(writer_.handle()));
     return false;
   }
 
-  OBCX_DEBUG("Platform heartbeat updated: {}", platform);
+  OBCX_DEBUG("Platform heartbeat updated: {}", heartbeat.platform);
   return true;
 }
 
 std::optional<PlatformHeartbeatInfo> DatabaseManager::get_platform_heartbeat(
     const std::string &platform) {
-  std::lock_guard lock(db_mutex_);
+  if (auto pending = find_pending(
+          [&](const PendingWrites &writes)
+              -> std::optional<PlatformHeartbeatInfo> {
+            const auto it = writes.heartbeats.find(platform);
+            if (it != writes.heartbeats.end()) {
+              return it->second;
+            }
+            return std::nullopt;
+          })) {
+    return pending;
+  }
+
+  auto reader = acquire_reader();
 
   const std::string sql = R"(
         SELECT platform, last_heartbeat_at, updated_at 
@@ -1914,11 +2801,11 @@ std::optional<PlatformHeartbeatInfo> DatabaseManager::get_platform_heartbeat(
         WHERE platform = ?;
     )";
 
-  sqlite3_stmt *stmt;
-  int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr);
+  CachedStatement stmt;
+  int rc = reader->prepare(sql, stmt);
   if (rc != SQLITE_OK) {
     OBCX_ERROR("Failed to prepare get platform heartbeat statement: {}",
-               sqlite3_errmsg(db_));
+               sqlite3_errmsg(reader->handle()));
     return std::nullopt;
   }
 
@@ -1937,11 +2824,9 @@ std::optional<PlatformHeartbeatInfo> DatabaseManager::get_platform_heartbeat(
     int64_t updated_timestamp = sqlite3_column_int64(stmt, 2);
     info.updated_at = std::chrono::system_clock::from_time_t(updated_timestamp);
 
-    sqlite3_finalize(stmt);
     return info;
   }
 
-  sqlite3_finalize(stmt);
   return std::nullopt;
 }
 
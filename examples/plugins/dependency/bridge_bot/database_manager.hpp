@@ -1,12 +1,25 @@
 #pragma once
 
 #include "common/message_type.hpp"
+#include "lru_cache.hpp"
+#include "mapping_cache.hpp"
+#include "sqlite_connection.hpp"
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
-#include <sqlite3.h>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 namespace obcx::storage {
@@ -141,18 +154,45 @@ struct PlatformHeartbeatInfo {
 /**
  * @brief 数据库管理器类
  *
- * 提供消息持久化、用户信息管理、消息ID映射等功能
+ * 提供消息持久化、用户信息管理、消息ID映射等功能。
+ *
+ * 同步方法会阻塞调用线程直到 SQLite 完成；事件协程应使用 *_async 版本，
+ * 它们把同一调用交给数据库线程执行：写操作在唯一的写线程上按提交顺序
+ * 串行执行，读操作由读线程池执行。调用方协程挂起期间不占用 io_context
+ * 线程，完成后在调用方的执行器上恢复。
+ *
+ * 每个连接缓存自己的预编译语句。WAL 模式下读操作使用独立的只读连接，
+ * 与写连接并行执行。
+ *
+ * 消息、用户、消息ID映射与平台心跳的写入默认先进入内存中的写队列，同一
+ * 主键只保留最后一次写入，由写线程每隔 batch_interval 或积攒
+ * batch_max_rows 行后在一个事务中提交。队列中的数据对读操作立即可见；
+ * 修改同一张表的其他写操作会先提交队列，析构时提交剩余写入。
+ *
+ * get_user 的结果（包括用户不存在）按 (platform, user_id, group_id) 缓存
+ * 在 LRU 中，save_or_update_user 写入时同步更新缓存；与缓存中内容相同的
+ * 用户信息不再重复写入。
+ *
+ * 最近的消息ID映射在 add_message_mapping 时放入双向缓存，回复与撤回时
+ * 两个方向的查找都先查缓存，SQLite 只作为后备存储。
+ *
+ * 配置了保留策略时，写线程每隔 retention_interval 从消息表与映射表最旧的
+ * 一端移出过期记录：每批一个短事务，批次之间让出写线程给实时写入。移出
+ * 的记录按创建月份追加到归档库（ATTACH 后写入再 DETACH），随后用增量
+ * VACUUM 回收空闲页。归档库是普通 SQLite 文件，在线查询不读取归档。
  */
 class DatabaseManager {
 public:
   /**
    * @brief 构造函数
    * @param db_path 数据库文件路径
+   * @param options 日志模式、读连接数与缓存等连接参数
    */
-  explicit DatabaseManager(const std::string &db_path);
+  explicit DatabaseManager(const std::string &db_path,
+                           const DatabaseOptions &options = {});
 
   /**
-   * @brief 析构函数
+   * @brief 析构函数，等待已提交的异步操作完成后关闭数据库
    */
   ~DatabaseManager();
 
@@ -161,11 +201,26 @@ public:
   DatabaseManager &operator=(const DatabaseManager &) = delete;
 
   /**
-   * @brief 初始化数据库（创建表结构）
+   * @brief 初始化数据库（打开连接、创建表结构）
    * @return 成功返回true，失败返回false
    */
   bool initialize();
 
+  /**
+   * @brief 立即在一个事务中提交写队列中积攒的写入
+   * @return 全部写入成功返回true，任一行失败返回false
+   */
+  bool flush();
+
+  /**
+   * @brief 按保留策略移出消息表与映射表中的旧记录，直到没有可移出的记录
+   *
+   * 后台任务会定期执行同样的清理；这里同步执行全部批次，供维护与测试
+   * 使用。未配置保留策略时什么也不做。
+   * @return 移出的行数
+   */
+  std::size_t apply_retention();
+
   // === 消息相关操作 ===
 
   /**
@@ -182,7 +237,7 @@ public:
    * @return 消息信息，如果未找到返回nullopt
    */
   std::optional<MessageInfo> get_message(const std::string &platform,
-                                         const std::string &message_id);
+                                         std::string_view message_id);
 
   /**
    * @brief 更新消息的转发信息
@@ -214,8 +269,8 @@ public:
    * @return 用户信息，如果未找到返回nullopt
    */
   std::optional<UserInfo> get_user(const std::string &platform,
-                                   const std::string &user_id,
-                                   const std::string &group_id = "");
+                                   std::string_view user_id,
+                                   std::string_view group_id = {});
 
   /**
    * @brief 获取用户的显示名称（优先显示昵称，其次用户名，最后用户ID）
@@ -225,8 +280,8 @@ public:
    * @return 用户显示名称
    */
   std::string get_user_display_name(const std::string &platform,
-                                    const std::string &user_id,
-                                    const std::string &group_id = "");
+                                    std::string_view user_id,
+                                    std::string_view group_id = {});
 
   /**
    * @brief 检查用户是否需要更新信息（用于主动获取QQ用户信息）
@@ -236,8 +291,8 @@ public:
    * @return 如果用户不存在或信息不完整返回true
    */
   bool should_fetch_user_info(const std::string &platform,
-                              const std::string &user_id,
-                              const std::string &group_id = "");
+                              std::string_view user_id,
+                              std::string_view group_id = {});
 
   // === 消息ID映射相关操作 ===
 
@@ -256,7 +311,7 @@ public:
    * @return 目标消息ID，如果未找到返回nullopt
    */
   std::optional<std::string> get_target_message_id(
-      const std::string &source_platform, const std::string &source_message_id,
+      const std::string &source_platform, std::string_view source_message_id,
       const std::string &target_platform);
 
   /**
@@ -267,9 +322,23 @@ public:
    * @return 源消息ID，如果未找到返回nullopt
    */
   std::optional<std::string> get_source_message_id(
-      const std::string &target_platform, const std::string &target_message_id,
+      const std::string &target_platform, std::string_view target_message_id,
       const std::string &source_platform);
 
+  /**
+   * @brief 查找与消息关联的对端消息ID，两个方向都查
+   *
+   * 先按源消息查找转发后的消息，找不到再按目标消息查找原始消息，用于
+   * 解析回复与撤回。两个方向合并为一次查询，缓存命中时不访问 SQLite。
+   * @param platform 消息所在平台
+   * @param message_id 消息ID
+   * @param peer_platform 对端平台
+   * @return 对端消息ID，如果未找到返回nullopt
+   */
+  std::optional<std::string> find_linked_message_id(
+      const std::string &platform, std::string_view message_id,
+      const std::string &peer_platform);
+
   /**
    * @brief 删除消息映射
    * @param source_platform 源平台
@@ -278,7 +347,7 @@ public:
    * @return 成功返回true，失败返回false
    */
   bool delete_message_mapping(const std::string &source_platform,
-                              const std::string &source_message_id,
+                              std::string_view source_message_id,
                               const std::string &target_platform);
 
   /**
@@ -290,7 +359,7 @@ public:
    * @return 成功返回true，失败返回false
    */
   bool update_message_mapping(const std::string &source_platform,
-                              const std::string &source_message_id,
+                              std::string_view source_message_id,
                               const std::string &target_platform,
                               const std::string &new_target_message_id);
 
@@ -385,6 +454,20 @@ public:
    */
   static std::string calculate_hash(const std::string &input);
 
+  /**
+   * @brief 获取用户信息缓存的命中统计
+   */
+  [[nodiscard]] CacheStats user_cache_stats() const {
+    return user_cache_.stats();
+  }
+
+  /**
+   * @brief 获取消息ID映射缓存的命中统计
+   */
+  [[nodiscard]] CacheStats mapping_cache_stats() const {
+    return mapping_cache_.stats();
+  }
+
   /**
    * @brief 清理过期的图片类型缓存记录
    * @param max_age_days 最大保留天数，超过此天数的记录将被删除
@@ -410,9 +493,12 @@ public:
   /**
    * @brief 获取需要重试的消息列表
    * @param limit 返回记录的最大数量
-   * @return 需要重试的消息列表
+   * @param due_before 只返回下次重试时间不晚于该时间的记录
+   * @return 需要重试的消息列表，按下次重试时间升序
    */
-  std::vector<MessageRetryInfo> get_pending_message_retries(int limit = 100);
+  std::vector<MessageRetryInfo> get_pending_message_retries(
+      int limit = 100, std::chrono::system_clock::time_point due_before =
+                           std::chrono::system_clock::now());
 
   /**
    * @brief 更新消息重试信息
@@ -453,10 +539,12 @@ public:
   /**
    * @brief 获取需要重试的媒体下载列表
    * @param limit 返回记录的最大数量
-   * @return 需要重试的媒体下载列表
+   * @param due_before 只返回下次重试时间不晚于该时间的记录
+   * @return 需要重试的媒体下载列表，按下次重试时间升序
    */
   std::vector<MediaDownloadRetryInfo> get_pending_media_download_retries(
-      int limit = 50);
+      int limit = 50, std::chrono::system_clock::time_point due_before =
+                          std::chrono::system_clock::now());
 
   /**
    * @brief 更新媒体下载重试信息
@@ -501,23 +589,277 @@ public:
   std::optional<PlatformHeartbeatInfo> get_platform_heartbeat(
       const std::string &platform);
 
+  // === 异步接口 ===
+
+  /**
+   * @brief 在读线程池上执行只读操作
+   *
+   * 调用方协程挂起直到 func 返回，因此 func 可以按引用捕获调用方的局部
+   * 变量。func 抛出的异常在 co_await 处重新抛出。
+   */
+  template <typename Func>
+  auto run_read(Func func)
+      -> boost::asio::awaitable<std::invoke_result_t<Func &>> {
+    co_return co_await run_on(read_pool_, std::move(func));
+  }
+
+  /**
+   * @brief 在写线程上执行写操作，多个写操作按提交顺序串行执行
+   */
+  template <typename Func>
+  auto run_write(Func func)
+      -> boost::asio::awaitable<std::invoke_result_t<Func &>> {
+    co_return co_await run_on(write_pool_, std::move(func));
+  }
+
+  auto save_message_from_event_async(const common::MessageEvent &event,
+                                     const std::string &platform)
+      -> boost::asio::awaitable<bool>;
+
+  auto save_user_from_event_async(const common::MessageEvent &event,
+                                  const std::string &platform)
+      -> boost::asio::awaitable<bool>;
+
+  auto save_or_update_user_async(const UserInfo &user_info)
+      -> boost::asio::awaitable<bool>;
+
+  auto get_user_display_name_async(const std::string &platform,
+                                   std::string_view user_id,
+                                   std::string_view group_id = {})
+      -> boost::asio::awaitable<std::string>;
+
+  auto should_fetch_user_info_async(const std::string &platform,
+                                    std::string_view user_id,
+                                    std::string_view group_id = {})
+      -> boost::asio::awaitable<bool>;
+
+  auto add_message_mapping_async(const MessageMapping &mapping)
+      -> boost::asio::awaitable<bool>;
+
+  auto get_target_message_id_async(const std::string &source_platform,
+                                   std::string_view source_message_id,
+                                   const std::string &target_platform)
+      -> boost::asio::awaitable<std::optional<std::string>>;
+
+  auto get_source_message_id_async(const std::string &target_platform,
+                                   std::string_view target_message_id,
+                                   const std::string &source_platform)
+      -> boost::asio::awaitable<std::optional<std::string>>;
+
+  auto find_linked_message_id_async(const std::string &platform,
+                                    std::string_view message_id,
+                                    const std::string &peer_platform)
+      -> boost::asio::awaitable<std::optional<std::string>>;
+
+  auto delete_message_mapping_async(const std::string &source_platform,
+                                    std::string_view source_message_id,
+                                    const std::string &target_platform)
+      -> boost::asio::awaitable<bool>;
+
+  auto update_message_mapping_async(const std::string &source_platform,
+                                    std::string_view source_message_id,
+                                    const std::string &target_platform,
+                                    const std::string &new_target_message_id)
+      -> boost::asio::awaitable<bool>;
+
+  auto save_sticker_cache_async(const StickerCacheInfo &cache_info)
+      -> boost::asio::awaitable<bool>;
+
+  auto get_sticker_cache_async(const std::string &platform,
+                               const std::string &sticker_hash)
+      -> boost::asio::awaitable<std::optional<StickerCacheInfo>>;
+
+  auto save_qq_sticker_mapping_async(const QQStickerMapping &mapping)
+      -> boost::asio::awaitable<bool>;
+
+  auto get_qq_sticker_mapping_async(const std::string &qq_sticker_hash)
+      -> boost::asio::awaitable<std::optional<QQStickerMapping>>;
+
+  auto update_qq_sticker_last_used_async(const std::string &qq_sticker_hash)
+      -> boost::asio::awaitable<bool>;
+
+  auto update_platform_heartbeat_async(
+      const std::string &platform,
+      const std::chrono::system_clock::time_point &heartbeat_time)
+      -> boost::asio::awaitable<bool>;
+
+  auto get_platform_heartbeat_async(const std::string &platform)
+      -> boost::asio::awaitable<std::optional<PlatformHeartbeatInfo>>;
+
 private:
+  using Key = std::tuple<std::string, std::string, std::string>;
+  using KeyView = std::tuple<std::string_view, std::string_view,
+                             std::string_view>;
+
+  /**
+   * @brief 尚未落盘的写入，同一主键只保留最后一次
+   */
+  struct PendingWrites {
+    // (platform, message_id, group_id)
+    std::map<Key, MessageInfo, std::less<>> messages;
+    // (platform, user_id, group_id)
+    std::map<Key, UserInfo, std::less<>> users;
+    // (source_platform, source_message_id, target_platform)
+    std::map<Key, MessageMapping, std::less<>> mappings;
+    std::map<std::string, PlatformHeartbeatInfo, std::less<>> heartbeats;
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+      return messages.size() + users.size() + mappings.size() +
+             heartbeats.size();
+    }
+  };
+
+  /**
+   * @brief 借出的连接，持有该连接的互斥锁直到析构
+   */
+  class ConnectionLease {
+  public:
+    ConnectionLease(SqliteConnection &connection,
+                    std::unique_lock<std::mutex> lock) noexcept
+        : connection_(&connection), lock_(std::move(lock)) {}
+
+    auto operator->() const noexcept -> SqliteConnection * {
+      return connection_;
+    }
+
+  private:
+    SqliteConnection *connection_;
+    std::unique_lock<std::mutex> lock_;
+  };
+
   std::string db_path_;
-  sqlite3 *db_;
-  std::mutex db_mutex_;
+  DatabaseOptions options_;
+  SqliteConnection writer_;
+  // 只读连接，initialize() 之后不再增减
+  std::vector<std::unique_ptr<SqliteConnection>> read_connections_;
+  std::atomic<std::size_t> next_reader_{0};
+
+  // 写线程只有一个，保证写操作按提交顺序落盘
+  boost::asio::thread_pool write_pool_{1};
+  boost::asio::thread_pool read_pool_;
+
+  std::mutex pending_mutex_;
+  PendingWrites pending_;
+  // 正在提交的批次，事务完成前读操作仍从这里取数据
+  PendingWrites committing_;
+  bool timer_armed_ = false;
+  bool flush_posted_ = false;
+  // 只在写线程上访问
+  boost::asio::steady_timer flush_timer_{write_pool_};
+  boost::asio::steady_timer retention_timer_{write_pool_};
+  // 析构开始后置位，定时器回调不再重新设置定时器
+  bool stopping_ = false;
+
+  // 值为 nullopt 表示数据库中没有该用户
+  LruCache<std::string, std::optional<UserInfo>> user_cache_;
+  MessageMappingCache mapping_cache_;
 
   /**
-   * @brief 创建数据库表
-   * @return 成功返回true，失败返回false
+   * @brief 借出一个读连接；没有读连接时借出写连接
    */
-  bool create_tables();
+  auto acquire_reader() -> ConnectionLease;
+
+  [[nodiscard]] auto batching() const noexcept -> bool {
+    return options_.batch_interval.count() > 0;
+  }
+
+  /**
+   * @brief 在写队列锁内修改 pending_，并按行数或时间安排提交
+   */
+  template <typename Mutate> void enqueue(Mutate mutate);
+
+  /**
+   * @brief 依次在 pending_ 与 committing_ 中查找，find 返回 std::optional
+   */
+  template <typename Find>
+  auto find_pending(Find find)
+      -> std::invoke_result_t<Find &, const PendingWrites &>;
 
   /**
-   * @brief 执行SQL语句
-   * @param sql SQL语句
+   * @brief 提交写队列，调用方须持有写连接的锁
+   */
+  bool commit_pending();
+
+  [[nodiscard]] auto retention_enabled() const noexcept -> bool {
+    return options_.retention_age.count() > 0 ||
+           options_.retention_max_rows > 0;
+  }
+
+  /**
+   * @brief 在写线程上安排下一轮保留清理，只能在写线程上调用
+   */
+  void schedule_retention(std::chrono::steady_clock::duration delay);
+
+  /**
+   * @brief 从 table 最旧的一端移出一批过期记录，一批只含同一个月的记录
+   * @return 移出的行数，没有可移出的记录或失败时返回 0
+   */
+  std::size_t retire_batch(std::string_view table);
+
+  /**
+   * @brief 把 id 在 [first_id, last_id] 的记录写入 month 的归档库（未配置
+   * 归档目录时跳过）并从主库删除，调用方须持有写连接的锁
+   */
+  bool retire_rows(std::string_view table, std::string_view month,
+                   int64_t first_id, int64_t last_id);
+
+  static auto user_cache_key(std::string_view platform,
+                             std::string_view user_id,
+                             std::string_view group_id) -> std::string;
+
+  // 映射查找的缓存未命中路径：依次查写队列与数据库，并在 cache_version
+  // 之后没有写入时回填缓存
+  std::optional<std::string> load_target_message_id(
+      uint64_t cache_version, const std::string &source_platform,
+      std::string_view source_message_id, const std::string &target_platform);
+  std::optional<std::string> load_source_message_id(
+      uint64_t cache_version, const std::string &target_platform,
+      std::string_view target_message_id, const std::string &source_platform);
+  std::optional<std::string> load_linked_message_id(
+      uint64_t cache_version, const std::string &platform,
+      std::string_view message_id, const std::string &peer_platform);
+
+  auto find_cached_link(std::string_view platform, std::string_view message_id,
+                        std::string_view peer_platform)
+      -> std::optional<std::string>;
+
+  static auto find_pending_source(const PendingWrites &writes,
+                                  std::string_view target_platform,
+                                  std::string_view target_message_id,
+                                  std::string_view source_platform)
+      -> std::optional<std::string>;
+
+  /**
+   * @brief 不经过缓存直接查询用户表
+   */
+  std::optional<UserInfo> query_user(const std::string &platform,
+                                     std::string_view user_id,
+                                     std::string_view group_id);
+
+  // 单行写入，调用方须持有写连接的锁
+  bool write_message(const MessageInfo &message_info);
+  bool write_user(const UserInfo &user_info);
+  bool write_mapping(const MessageMapping &mapping);
+  bool write_heartbeat(const PlatformHeartbeatInfo &heartbeat);
+
+  template <typename Func>
+  static auto run_on(boost::asio::thread_pool &pool, Func func)
+      -> boost::asio::awaitable<std::invoke_result_t<Func &>> {
+    using Result = std::invoke_result_t<Func &>;
+    // co_spawn 的完成处理器绑定在调用方的执行器上，结果在那里恢复
+    co_return co_await boost::asio::co_spawn(
+        pool,
+        [func = std::move(func)]() mutable -> boost::asio::awaitable<Result> {
+          co_return func();
+        },
+        boost::asio::use_awaitable);
+  }
+
+  /**
+   * @brief 创建数据库表
    * @return 成功返回true，失败返回false
    */
-  bool execute_sql(const std::string &sql);
+  bool create_tables();
 
   /**
    * @brief 时间戳转换辅助函数
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace obcx::storage {
+
+/**
+ * @brief 缓存命中统计
+ */
+struct CacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  std::size_t size = 0;
+
+  [[nodiscard]] auto hit_rate() const noexcept -> double {
+    const auto lookups = hits + misses;
+    return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+  }
+};
+
+/**
+ * @brief 带过期时间的线程安全 LRU 缓存
+ *
+ * 超过容量时淘汰最久未访问的条目，过期条目在下次访问时删除。每次修改
+ * 都会递增版本号：读者在查询数据库前取 version()，回填时把它传给
+ * put_if_unchanged()，期间有写入就放弃回填，避免把旧值写回缓存。
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @param capacity 最大条目数，0 表示禁用缓存
+   * @param ttl 条目的默认存活时间
+   */
+  LruCache(std::size_t capacity, Clock::duration ttl)
+      : capacity_(capacity), ttl_(ttl) {}
+
+  LruCache(const LruCache &) = delete;
+  auto operator=(const LruCache &) -> LruCache & = delete;
+
+  /**
+   * @brief 查找并把条目移到最近使用的位置
+   * @return 未命中或已过期时返回nullopt
+   */
+  auto get(const Key &key) -> std::optional<Value> {
+    std::lock_guard lock(mutex_);
+    const auto it = index_.find(key);
+    if (it == index_.end()) {
+      ++stats_.misses;
+      return std::nullopt;
+    }
+    if (it->second->expires_at <= Clock::now()) {
+      entries_.erase(it->second);
+      index_.erase(it);
+      ++stats_.misses;
+      return std::nullopt;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    ++stats_.hits;
+    return it->second->value;
+  }
+
+  /**
+   * @brief 插入或替换条目
+   * @param ttl 本条目的存活时间，默认使用构造时的 ttl
+   */
+  void put(const Key &key, Value value,
+           std::optional<Clock::duration> ttl = std::nullopt) {
+    std::lock_guard lock(mutex_);
+    ++version_;
+    insert(key, std::move(value), ttl.value_or(ttl_));
+  }
+
+  /**
+   * @brief 仅当 version 之后没有修改时插入，用于查询数据库后回填
+   * @return 是否插入
+   */
+  auto put_if_unchanged(uint64_t version, const Key &key, Value value,
+                        std::optional<Clock::duration> ttl = std::nullopt)
+      -> bool {
+    std::lock_guard lock(mutex_);
+    if (version != version_) {
+      return false;
+    }
+    insert(key, std::move(value), ttl.value_or(ttl_));
+    return true;
+  }
+
+  void erase(const Key &key) {
+    std::lock_guard lock(mutex_);
+    ++version_;
+    if (const auto it = index_.find(key); it != index_.end()) {
+      entries_.erase(it->second);
+      index_.erase(it);
+    }
+  }
+
+  void clear() {
+    std::lock_guard lock(mutex_);
+    ++version_;
+    entries_.clear();
+    index_.clear();
+  }
+
+  /// 当前版本号，任何修改都会使其递增
+  [[nodiscard]] auto version() const -> uint64_t {
+    std::lock_guard lock(mutex_);
+    return version_;
+  }
+
+  [[nodiscard]] auto stats() const -> CacheStats {
+    std::lock_guard lock(mutex_);
+    auto stats = stats_;
+    stats.size = entries_.size();
+    return stats;
+  }
+
+private:
+  struct Entry {
+    Key key;
+    Value value;
+    Clock::time_point expires_at;
+  };
+
+  // 调用方须持有 mutex_
+  void insert(const Key &key, Value value, Clock::duration ttl) {
+    if (capacity_ == 0) {
+      return;
+    }
+    const auto expires_at = Clock::now() + ttl;
+    if (const auto it = index_.find(key); it != index_.end()) {
+      it->second->value = std::move(value);
+      it->second->expires_at = expires_at;
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return;
+    }
+    if (entries_.size() >= capacity_) {
+      index_.erase(entries_.back().key);
+      entries_.pop_back();
+      ++stats_.evictions;
+    }
+    entries_.push_front(Entry{key, std::move(value), expires_at});
+    index_.emplace(key, entries_.begin());
+  }
+
+  const std::size_t capacity_;
+  const Clock::duration ttl_;
+
+  mutable std::mutex mutex_;
+  // 头部为最近使用的条目
+  std::list<Entry> entries_;
+  std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index_;
+  uint64_t version_ = 0;
+  CacheStats stats_;
+};
+
+} // namespace obcx::storage
@@ -0,0 +1,154 @@
+#include "mapping_cache.hpp"
+
+namespace obcx::storage {
+
+MessageMappingCache::MessageMappingCache(std::size_t capacity,
+                                         Clock::duration ttl)
+    : capacity_(capacity), ttl_(ttl) {}
+
+auto MessageMappingCache::make_key(std::string_view platform,
+                                   std::string_view message_id,
+                                   std::string_view other_platform)
+    -> std::string {
+  std::string key;
+  key.reserve(platform.size() + message_id.size() + other_platform.size() +
+              2);
+  key.append(platform).append(1, '\0').append(message_id).append(1, '\0');
+  key.append(other_platform);
+  return key;
+}
+
+auto MessageMappingCache::find_target(std::string_view source_platform,
+                                      std::string_view source_message_id,
+                                      std::string_view target_platform)
+    -> std::optional<std::string> {
+  const auto key =
+      make_key(source_platform, source_message_id, target_platform);
+  std::lock_guard lock(mutex_);
+  const auto it = lookup(by_source_, key);
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  return it->target_message_id;
+}
+
+auto MessageMappingCache::find_source(std::string_view target_platform,
+                                      std::string_view target_message_id,
+                                      std::string_view source_platform)
+    -> std::optional<std::string> {
+  const auto key =
+      make_key(target_platform, target_message_id, source_platform);
+  std::lock_guard lock(mutex_);
+  const auto it = lookup(by_target_, key);
+  if (it == entries_.end()) {
+    return std::nullopt;
+  }
+  return it->source_message_id;
+}
+
+void MessageMappingCache::put(std::string_view source_platform,
+                              std::string_view source_message_id,
+                              std::string_view target_platform,
+                              std::string_view target_message_id) {
+  std::lock_guard lock(mutex_);
+  ++version_;
+  insert(source_platform, source_message_id, target_platform,
+         target_message_id);
+}
+
+auto MessageMappingCache::put_if_unchanged(uint64_t version,
+                                           std::string_view source_platform,
+                                           std::string_view source_message_id,
+                                           std::string_view target_platform,
+                                           std::string_view target_message_id)
+    -> bool {
+  std::lock_guard lock(mutex_);
+  if (version != version_) {
+    return false;
+  }
+  insert(source_platform, source_message_id, target_platform,
+         target_message_id);
+  return true;
+}
+
+void MessageMappingCache::erase(std::string_view source_platform,
+                                std::string_view source_message_id,
+                                std::string_view target_platform) {
+  const auto key =
+      make_key(source_platform, source_message_id, target_platform);
+  std::lock_guard lock(mutex_);
+  ++version_;
+  if (const auto it = by_source_.find(key); it != by_source_.end()) {
+    remove(it->second);
+  }
+}
+
+auto MessageMappingCache::version() const -> uint64_t {
+  std::lock_guard lock(mutex_);
+  return version_;
+}
+
+auto MessageMappingCache::stats() const -> CacheStats {
+  std::lock_guard lock(mutex_);
+  auto stats = stats_;
+  stats.size = entries_.size();
+  return stats;
+}
+
+auto MessageMappingCache::lookup(Index &index, const std::string &key)
+    -> Iterator {
+  const auto it = index.find(key);
+  if (it == index.end()) {
+    ++stats_.misses;
+    return entries_.end();
+  }
+  const auto entry = it->second;
+  if (entry->expires_at <= Clock::now()) {
+    remove(entry);
+    ++stats_.misses;
+    return entries_.end();
+  }
+  entries_.splice(entries_.begin(), entries_, entry);
+  ++stats_.hits;
+  return entry;
+}
+
+void MessageMappingCache::insert(std::string_view source_platform,
+                                 std::string_view source_message_id,
+                                 std::string_view target_platform,
+                                 std::string_view target_message_id) {
+  if (capacity_ == 0) {
+    return;
+  }
+  auto source_key =
+      make_key(source_platform, source_message_id, target_platform);
+  if (const auto it = by_source_.find(source_key); it != by_source_.end()) {
+    remove(it->second);
+  }
+  auto target_key =
+      make_key(target_platform, target_message_id, source_platform);
+  // 目标消息被另一条源消息占用时同样替换，保证两个索引一一对应
+  if (const auto it = by_target_.find(target_key); it != by_target_.end()) {
+    remove(it->second);
+  }
+  if (entries_.size() >= capacity_) {
+    remove(std::prev(entries_.end()));
+    ++stats_.evictions;
+  }
+
+  entries_.push_front(Entry{.source_key = std::move(source_key),
+                            .target_key = std::move(target_key),
+                            .source_message_id = std::string(source_message_id),
+                            .target_message_id = std::string(target_message_id),
+                            .expires_at = Clock::now() + ttl_});
+  by_source_.emplace(entries_.front().source_key, entries_.begin());
+  by_target_.emplace(entries_.front().target_key, entries_.begin());
+}
+
+void MessageMappingCache::remove(Iterator it) {
+  by_source_.erase(it->source_key);
+  by_target_.erase(it->target_key);
+  entries_.erase(it);
+}
+
+} // namespace obcx::storage
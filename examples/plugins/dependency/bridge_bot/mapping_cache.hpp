@@ -0,0 +1,119 @@
+#pragma once
+
+#include "lru_cache.hpp"
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace obcx::storage {
+
+/**
+ * @brief 最近消息ID映射的双向缓存
+ *
+ * 每条映射只存一份，同时按源消息与目标消息建立索引，两个方向共用一个
+ * LRU 顺序和容量上限。同一源消息写入新映射时旧映射连同其反向索引一起
+ * 删除，反向查找不会返回已被替换的目标消息。
+ *
+ * 只缓存确实存在的映射：两个桥接插件各自持有 DatabaseManager，一方写入
+ * 的映射另一方无法感知，缓存"不存在"会让对方长期查不到。
+ */
+class MessageMappingCache {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @param capacity 最大映射数，0 表示禁用缓存
+   * @param ttl 映射的存活时间
+   */
+  MessageMappingCache(std::size_t capacity, Clock::duration ttl);
+
+  MessageMappingCache(const MessageMappingCache &) = delete;
+  auto operator=(const MessageMappingCache &)
+      -> MessageMappingCache & = delete;
+
+  /**
+   * @brief 根据源消息查找目标消息ID
+   */
+  auto find_target(std::string_view source_platform,
+                   std::string_view source_message_id,
+                   std::string_view target_platform)
+      -> std::optional<std::string>;
+
+  /**
+   * @brief 根据目标消息查找源消息ID
+   */
+  auto find_source(std::string_view target_platform,
+                   std::string_view target_message_id,
+                   std::string_view source_platform)
+      -> std::optional<std::string>;
+
+  /**
+   * @brief 插入映射，替换同一源消息的旧映射
+   */
+  void put(std::string_view source_platform, std::string_view source_message_id,
+           std::string_view target_platform,
+           std::string_view target_message_id);
+
+  /**
+   * @brief 仅当 version 之后没有修改时插入，用于查询数据库后回填
+   * @return 是否插入
+   */
+  auto put_if_unchanged(uint64_t version, std::string_view source_platform,
+                        std::string_view source_message_id,
+                        std::string_view target_platform,
+                        std::string_view target_message_id) -> bool;
+
+  /**
+   * @brief 删除源消息对应的映射及其反向索引
+   */
+  void erase(std::string_view source_platform,
+             std::string_view source_message_id,
+             std::string_view target_platform);
+
+  /// 当前版本号，任何修改都会使其递增
+  [[nodiscard]] auto version() const -> uint64_t;
+
+  [[nodiscard]] auto stats() const -> CacheStats;
+
+private:
+  struct Entry {
+    std::string source_key;
+    std::string target_key;
+    std::string source_message_id;
+    std::string target_message_id;
+    Clock::time_point expires_at;
+  };
+  using Iterator = std::list<Entry>::iterator;
+  using Index = std::unordered_map<std::string, Iterator>;
+
+  static auto make_key(std::string_view platform, std::string_view message_id,
+                       std::string_view other_platform) -> std::string;
+
+  // 以下函数调用方须持有 mutex_
+  auto lookup(Index &index, const std::string &key) -> Iterator;
+  void insert(std::string_view source_platform,
+              std::string_view source_message_id,
+              std::string_view target_platform,
+              std::string_view target_message_id);
+  void remove(Iterator it);
+
+  const std::size_t capacity_;
+  const Clock::duration ttl_;
+
+  mutable std::mutex mutex_;
+  // 头部为最近使用的映射
+  std::list<Entry> entries_;
+  // (source_platform, source_message_id, target_platform) -> 映射
+  Index by_source_;
+  // (target_platform, target_message_id, source_platform) -> 映射
+  Index by_target_;
+  uint64_t version_ = 0;
+  CacheStats stats_;
+};
+
+} // namespace obcx::storage
@@ -215,9 +215,9 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
     co_return;
   }
 
-  const std::string qq_group_id = event.group_id.value();
+  const obcx::common::ChatId &qq_group_id = *event.group_id;
   std::string telegram_group_id;
-  const GroupBridgeConfig *bridge_config = nullptr;
+  std::shared_ptr<const GroupBridgeConfig> bridge_config;
 
   // 查找对应的Telegram群ID、topic ID和桥接配置
   auto [tg_id, topic_id] = get_tg_group_and_topic_id(qq_group_id);
@@ -246,8 +246,7 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
     }
   } else if (bridge_config->mode == BridgeMode::TOPIC_TO_GROUP) {
     // Topic模式：需要检查具体的topic配置
-    const TopicBridgeConfig *topic_config =
-        get_topic_config(telegram_group_id, topic_id);
+    const auto topic_config = get_topic_config(telegram_group_id, topic_id);
     if (!topic_config || !topic_config->enable_qq_to_tg) {
       OBCX_DEBUG("QQ群 {} 到Telegram topic {} 的转发已禁用，跳过", qq_group_id,
                  topic_id);
@@ -270,7 +269,8 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
   }
 
   // 检查消息是否已转发（避免重复）
-  if (db_manager_->get_target_message_id("qq", event.message_id, "telegram")
+  if ((co_await db_manager_->get_target_message_id_async(
+           "qq", event.message_id, "telegram"))
           .has_value()) {
     OBCX_DEBUG("QQ消息 {} 已转发到Telegram，跳过重复处理", event.message_id);
     co_return;
@@ -281,18 +281,21 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
 
   try {
     // 保存/更新用户信息
-    db_manager_->save_user_from_event(event, "qq");
+    co_await db_manager_->save_user_from_event_async(event, "qq");
     // 保存消息信息
-    db_manager_->save_message_from_event(event, "qq");
+    co_await db_manager_->save_message_from_event_async(event, "qq");
 
     // 获取用户显示名称（使用群组特定的昵称）
-    std::string sender_display_name = db_manager_->get_user_display_name(
-        "qq", event.user_id, event.group_id.value_or(""));
+    std::string sender_display_name =
+        co_await db_manager_->get_user_display_name_async(
+            "qq", event.user_id,
+            event.group_id.value_or(obcx::common::ChatId{}));
 
     // 如果仍然是用户ID（说明没有昵称信息），尝试同步获取一次
     if (sender_display_name == event.user_id &&
-        db_manager_->should_fetch_user_info("qq", event.user_id,
-                                            event.group_id.value_or(""))) {
+        co_await db_manager_->should_fetch_user_info_async(
+            "qq", event.user_id,
+            event.group_id.value_or(obcx::common::ChatId{}))) {
       try {
         // 同步获取群成员信息（仅第一次）
         std::string response = co_await qq_bot.get_group_member_info(
@@ -310,8 +313,8 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
           obcx::storage::UserInfo user_info;
           user_info.platform = "qq";
           user_info.user_id = event.user_id;
-          user_info.group_id =
-              event.group_id.value_or(""); // 群组特定的用户信息
+          // 群组特定的用户信息
+          user_info.group_id = event.group_id.value_or(obcx::common::ChatId{});
           user_info.last_updated = std::chrono::system_clock::now();
 
           std::string general_nickname, card, title;
@@ -350,9 +353,11 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
           }
 
           // 保存用户信息并更新显示名称
-          if (db_manager_->save_or_update_user(user_info)) {
-            sender_display_name = db_manager_->get_user_display_name(
-                "qq", event.user_id, event.group_id.value_or(""));
+          if (co_await db_manager_->save_or_update_user_async(user_info)) {
+            sender_display_name =
+                co_await db_manager_->get_user_display_name_async(
+                    "qq", event.user_id,
+                    event.group_id.value_or(obcx::common::ChatId{}));
             OBCX_DEBUG("同步获取QQ用户信息成功：{} -> {}", event.user_id,
                        sender_display_name);
           }
@@ -371,8 +376,7 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
       show_sender = bridge_config->show_qq_to_tg_sender;
     } else {
       // Topic模式：获取对应topic的配置
-      const TopicBridgeConfig *topic_config =
-          get_topic_config(telegram_group_id, topic_id);
+      const auto topic_config = get_topic_config(telegram_group_id, topic_id);
       show_sender = topic_config ? topic_config->show_qq_to_tg_sender : false;
     }
 
@@ -402,17 +406,11 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
 
     // 如果有引用消息，尝试查找对应平台的消息ID
     if (reply_message_id.has_value()) {
-      std::optional<std::string> target_telegram_message_id;
-
       // 情况1: 如果被回复的QQ消息曾经转发到Telegram过，找到TG的消息ID
-      target_telegram_message_id = db_manager_->get_target_message_id(
-          "qq", reply_message_id.value(), "telegram");
-
       // 情况2: 如果被回复的QQ消息来源于Telegram，找到TG的原始消息ID
-      if (!target_telegram_message_id.has_value()) {
-        target_telegram_message_id = db_manager_->get_source_message_id(
-            "qq", reply_message_id.value(), "telegram");
-      }
+      const auto target_telegram_message_id =
+          co_await db_manager_->find_linked_message_id_async(
+              "qq", reply_message_id.value(), "telegram");
 
       // 如果最终仍未找到映射，清空reply_message_id以避免创建无效的reply段
       if (!target_telegram_message_id.has_value()) {
@@ -468,7 +466,8 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
             std::string qq_sticker_hash =
                 obcx::storage::DatabaseManager::calculate_hash(url);
             auto cached_mapping =
-                db_manager_->get_qq_sticker_mapping(qq_sticker_hash);
+                co_await db_manager_->get_qq_sticker_mapping_async(
+                    qq_sticker_hash);
 
             if (cached_mapping && cached_mapping->is_gif.has_value()) {
               // 使用缓存的结果
@@ -568,7 +567,8 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
                     new_mapping.last_used_at = std::chrono::system_clock::now();
                     new_mapping.last_checked_at =
                         std::chrono::system_clock::now();
-                    db_manager_->save_qq_sticker_mapping(new_mapping);
+                    co_await db_manager_->save_qq_sticker_mapping_async(
+                        new_mapping);
                     OBCX_DEBUG("[图片类型检测] 缓存记录已保存");
                   } else {
                     is_gif = true;
@@ -628,16 +628,18 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
 
             // 查询缓存
             auto cached_mapping =
-                db_manager_->get_qq_sticker_mapping(qq_sticker_hash);
+                co_await db_manager_->get_qq_sticker_mapping_async(
+                    qq_sticker_hash);
             if (cached_mapping.has_value()) {
-              db_manager_->update_qq_sticker_last_used(qq_sticker_hash);
+              co_await db_manager_->update_qq_sticker_last_used_async(
+                  qq_sticker_hash);
 
               // 根据模式获取显示发送者配置
               bool show_sender_for_sticker = false;
               if (bridge_config->mode == BridgeMode::GROUP_TO_GROUP) {
                 show_sender_for_sticker = bridge_config->show_qq_to_tg_sender;
               } else {
-                const TopicBridgeConfig *topic_config =
+                const auto topic_config =
                     get_topic_config(telegram_group_id, topic_id);
                 show_sender_for_sticker =
                     topic_config ? topic_config->show_qq_to_tg_sender : false;
@@ -749,13 +751,13 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
             auto *qq_bot_ptr = static_cast<obcx::core::QQBot *>(&qq_bot);
             if (event.group_id.has_value()) {
               // 群聊文件
-              std::string group_id = event.group_id.value();
+              const auto &group_id = *event.group_id;
               response =
                   co_await qq_bot_ptr->get_group_file_url(group_id, file_id);
               OBCX_DEBUG("get_group_file_url API响应: {}", response);
             } else {
               // 私聊文件
-              std::string user_id = event.user_id;
+              const auto &user_id = event.user_id;
               response =
                   co_await qq_bot_ptr->get_private_file_url(user_id, file_id);
               OBCX_DEBUG("get_private_file_url API响应: {}", response);
@@ -805,8 +807,10 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
         converted_segment.data.clear();
 
         // 从数据库查询用户的显示名称（使用群组特定的昵称）
-        std::string at_display_name = db_manager_->get_user_display_name(
-            "qq", qq_user_id, event.group_id.value_or(""));
+        std::string at_display_name =
+            co_await db_manager_->get_user_display_name_async(
+                "qq", qq_user_id,
+                event.group_id.value_or(obcx::common::ChatId{}));
 
         // 如果查询到的显示名称不是用户ID本身，说明有昵称信息
         if (at_display_name != qq_user_id) {
@@ -814,8 +818,9 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
           OBCX_DEBUG("转换QQ@消息: {} -> @{}", qq_user_id, at_display_name);
         } else {
           // 没有昵称信息，回退到原来的格式但尝试获取一次
-          if (db_manager_->should_fetch_user_info(
-                  "qq", qq_user_id, event.group_id.value_or(""))) {
+          if (co_await db_manager_->should_fetch_user_info_async(
+                  "qq", qq_user_id,
+                  event.group_id.value_or(obcx::common::ChatId{}))) {
             try {
               // 尝试获取群成员信息
               std::string response = co_await qq_bot.get_group_member_info(
@@ -833,8 +838,9 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
                 obcx::storage::UserInfo user_info;
                 user_info.platform = "qq";
                 user_info.user_id = qq_user_id;
+                // 群组特定的用户信息
                 user_info.group_id =
-                    event.group_id.value_or(""); // 群组特定的用户信息
+                    event.group_id.value_or(obcx::common::ChatId{});
                 user_info.last_updated = std::chrono::system_clock::now();
 
                 std::string general_nickname, card, title;
@@ -873,9 +879,12 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
                 }
 
                 // 保存用户信息并更新显示名称
-                if (db_manager_->save_or_update_user(user_info)) {
-                  at_display_name = db_manager_->get_user_display_name(
-                      "qq", qq_user_id, event.group_id.value_or(""));
+                if (co_await db_manager_->save_or_update_user_async(
+                        user_info)) {
+                  at_display_name =
+                      co_await db_manager_->get_user_display_name_async(
+                          "qq", qq_user_id,
+                          event.group_id.value_or(obcx::common::ChatId{}));
                   converted_segment.data["text"] =
                       fmt::format("@{} ", at_display_name);
                   OBCX_DEBUG("实时获取QQ@用户信息成功：{} -> @{}", qq_user_id,
@@ -1078,6 +1087,9 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
       co_await handle_qq_media(image_segments[0]);
     }
 
+    // 合并转发的内容按批量消息排队，不挡住其他会话的普通消息
+    bool bulk_forward = false;
+
     // 处理其他类型的消息段
     for (const auto &segment : other_segments) {
       // 跳过reply段，因为我们已经处理过了
@@ -1087,6 +1099,7 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
 
       // 特殊处理合并转发消息
       if (segment.type == "forward") {
+        bulk_forward = true;
         try {
           // 获取转发消息ID
           std::string forward_id = segment.data.value("id", "");
@@ -1195,6 +1208,7 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
 
       // 处理单个node消息段（自定义转发节点）
       if (segment.type == "node") {
+        bulk_forward = true;
         try {
           // node段包含用户ID、昵称和内容
           std::string node_user_id = segment.data.value("user_id", "");
@@ -1265,18 +1279,21 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
     std::string failure_reason;
 
     try {
+      auto &tg_bot = static_cast<obcx::core::TGBot &>(telegram_bot);
+      const auto priority = bulk_forward
+                                ? obcx::core::SendPriority::bulk
+                                : obcx::core::SendPriority::interactive;
       std::string response;
       if (topic_id == -1) {
         // 群组模式：发送到群组
-        response = co_await telegram_bot.send_group_message(telegram_group_id,
-                                                            message_to_send);
+        response = co_await tg_bot.send_group_message(
+            telegram_group_id, message_to_send, priority);
         OBCX_DEBUG("群组模式：QQ群 {} 转发到Telegram群 {}", qq_group_id,
                    telegram_group_id);
       } else {
         // Topic模式：发送到特定topic
-        auto &tg_bot = static_cast<obcx::core::TGBot &>(telegram_bot);
         response = co_await tg_bot.send_topic_message(
-            telegram_group_id, topic_id, message_to_send);
+            telegram_group_id, topic_id, message_to_send, priority);
         OBCX_DEBUG("Topic模式：QQ群 {} 转发到Telegram群 {} 的topic {}",
                    qq_group_id, telegram_group_id, topic_id);
       }
@@ -1298,7 +1315,7 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
           mapping.target_platform = "telegram";
           mapping.target_message_id = telegram_message_id.value();
           mapping.created_at = std::chrono::system_clock::now();
-          db_manager_->add_message_mapping(mapping);
+          co_await db_manager_->add_message_mapping_async(mapping);
 
           OBCX_INFO("QQ消息 {} 成功转发到Telegram，Telegram消息ID: {}",
                     event.message_id, telegram_message_id.value());
@@ -1321,8 +1338,8 @@ auto QQHandler::forward_to_telegram(obcx::core::IBot &telegram_bot,
       OBCX_INFO("消息发送失败，添加到重试队列: {} -> {}", event.message_id,
                 telegram_group_id);
       retry_manager_->add_message_retry(
-          "qq", "telegram", event.message_id, message_to_send,
-          telegram_group_id, qq_group_id, topic_id,
+          "qq", "telegram", event.message_id.str(), message_to_send,
+          telegram_group_id, qq_group_id.str(), topic_id,
           config::MESSAGE_RETRY_MAX_ATTEMPTS, failure_reason);
     } else if (!telegram_message_id.has_value()) {
       // 如果没有启用重试或没有重试管理器，记录错误
@@ -1354,7 +1371,7 @@ auto QQHandler::handle_recall_event(obcx::core::IBot &telegram_bot,
       co_return;
     }
 
-    const std::string qq_group_id = notice_event.group_id.value();
+    const std::string qq_group_id = notice_event.group_id->str();
 
     // 从事件数据中获取被撤回的消息ID
     std::string recalled_message_id;
@@ -1379,7 +1396,7 @@ auto QQHandler::handle_recall_event(obcx::core::IBot &telegram_bot,
               recalled_message_id);
 
     // 查找对应的Telegram消息ID
-    auto target_message_id = db_manager_->get_target_message_id(
+    auto target_message_id = co_await db_manager_->get_target_message_id_async(
         "qq", recalled_message_id, "telegram");
 
     if (!target_message_id.has_value()) {
@@ -1407,7 +1424,7 @@ auto QQHandler::handle_recall_event(obcx::core::IBot &telegram_bot,
     }
 
     // 无论Telegram撤回是否成功，都删除数据库中的消息映射
-    bool deleted = db_manager_->delete_message_mapping(
+    bool deleted = co_await db_manager_->delete_message_mapping_async(
         "qq", recalled_message_id, "telegram");
     if (deleted) {
       OBCX_DEBUG("已删除消息映射: qq:{} -> telegram:{}", recalled_message_id,
@@ -1431,12 +1448,14 @@ auto QQHandler::handle_checkalive_command(obcx::core::IBot &telegram_bot,
     -> boost::asio::awaitable<void> {
 
   try {
-    const std::string qq_group_id = event.group_id.value();
+    const std::string qq_group_id = event.group_id->str();
 
     // 获取QQ平台的心跳信息
-    auto qq_heartbeat = db_manager_->get_platform_heartbeat("qq");
+    auto qq_heartbeat =
+        co_await db_manager_->get_platform_heartbeat_async("qq");
     // 获取Telegram平台的心跳信息
-    auto telegram_heartbeat = db_manager_->get_platform_heartbeat("telegram");
+    auto telegram_heartbeat =
+        co_await db_manager_->get_platform_heartbeat_async("telegram");
 
     std::string response_text;
 
@@ -1499,7 +1518,7 @@ auto QQHandler::handle_checkalive_command(obcx::core::IBot &telegram_bot,
     // 添加回复segment
     obcx::common::MessageSegment reply_segment;
     reply_segment.type = "reply";
-    reply_segment.data["id"] = event.message_id;
+    reply_segment.data["id"] = event.message_id.str();
     reply_message.push_back(reply_segment);
 
     obcx::common::MessageSegment text_segment;
@@ -1,17 +1,57 @@
 #include "retry_queue_manager.hpp"
 
-#include <cmath>
+#include <algorithm>
 #include <fmt/format.h>
+#include <limits>
 #include <nlohmann/json.hpp>
+#include <random>
 
 namespace bridge {
 
+namespace {
+
+// stop() 检查 Bot 上的发送是否结束的间隔：io_context 停止时没有通知
+constexpr auto kSendPollInterval = std::chrono::milliseconds(50);
+
+// Bot 线程与重试线程共享的发送结果，不含 I/O 对象，由哪一方最后释放都可以
+struct SendState {
+  std::mutex mutex;
+  bool done = false;
+  std::string response;
+  std::exception_ptr error;
+  // 等待方仍在时，完成方才通过它向等待方投递唤醒；等待方离开时清空，
+  // 之后完成方不再访问重试线程的 io_context
+  std::optional<boost::asio::strand<boost::asio::io_context::executor_type>>
+      waiter;
+  // 只在 strand_ 上访问
+  boost::asio::steady_timer *timer = nullptr;
+  boost::asio::io_context *bot_context = nullptr;
+};
+
+// 工厂作为协程参数保存在协程帧中，其捕获的参数与发送同生命周期
+boost::asio::awaitable<std::string>
+run_owned_send(std::function<boost::asio::awaitable<std::string>()> make_send) {
+  co_return co_await make_send();
+}
+
+} // namespace
+
+struct RetryQueueManager::SendRegistry {
+  std::mutex mutex;
+  std::condition_variable finished;
+  // start() 之前与 stop() 之后不再启动发送
+  bool closed = true;
+  std::unordered_set<std::shared_ptr<SendState>> sends;
+};
+
 RetryQueueManager::RetryQueueManager(
     std::shared_ptr<obcx::storage::DatabaseManager> db_manager,
-    boost::asio::io_context &io_context)
+    boost::asio::io_context &io_context, RetryLimits limits)
     : db_manager_(db_manager), io_context_(io_context),
-      retry_timer_(std::make_unique<boost::asio::steady_timer>(io_context)),
-      running_(false) {
+      strand_(boost::asio::make_strand(io_context)),
+      retry_timer_(std::make_unique<boost::asio::system_timer>(strand_)),
+      running_(false), limits_(limits),
+      sends_(std::make_shared<SendRegistry>()) {
   OBCX_INFO("RetryQueueManager initialized");
 }
 
@@ -25,9 +65,13 @@ void RetryQueueManager::start() {
 
   running_ = true;
   OBCX_INFO("Starting RetryQueueManager");
+  {
+    std::lock_guard lock(sends_->mutex);
+    sends_->closed = false;
+  }
 
   // 启动重试队列处理
-  boost::asio::co_spawn(io_context_, process_retry_queues(),
+  boost::asio::co_spawn(strand_, process_retry_queues(),
                         boost::asio::detached);
 }
 
@@ -39,11 +83,106 @@ void RetryQueueManager::stop() {
   OBCX_INFO("Stopping RetryQueueManager");
   running_ = false;
 
-  if (retry_timer_) {
+  // 定时器只在 strand_ 上访问，在回调里调用时立即取消
+  boost::asio::dispatch(strand_, [this] {
     retry_timer_->cancel();
+    for (auto *timer : send_waits_) {
+      timer->cancel();
+    }
+  });
+
+  // 发送协程与完成处理器属于插件代码，返回前必须结束；已停止的 io_context
+  // 不会再运行其中的发送，它们随 Bot 一起销毁，不用等
+  std::unique_lock lock(sends_->mutex);
+  sends_->closed = true;
+  const auto settled = [this] {
+    return std::ranges::all_of(sends_->sends, [](const auto &send) {
+      return send->bot_context->stopped();
+    });
+  };
+  const auto deadline = std::chrono::steady_clock::now() + limits_.stop_timeout;
+  while (!settled() && std::chrono::steady_clock::now() < deadline) {
+    sends_->finished.wait_for(lock, kSendPollInterval);
+  }
+  if (!settled()) {
+    OBCX_WARN("{} retry sends still running on bot threads after {}ms",
+              sends_->sends.size(), limits_.stop_timeout.count());
   }
 }
 
+boost::asio::awaitable<std::string> RetryQueueManager::run_send(
+    boost::asio::io_context &bot_context,
+    std::function<boost::asio::awaitable<std::string>()> make_send) {
+  auto state = std::make_shared<SendState>();
+  state->waiter.emplace(strand_);
+  state->bot_context = &bot_context;
+  boost::asio::steady_timer timer(strand_,
+                                  boost::asio::steady_timer::time_point::max());
+
+  // 已停止的 io_context 不会再运行发送，不启动，等待 stop() 打断
+  bool spawn = false;
+  {
+    std::lock_guard lock(sends_->mutex);
+    if (!sends_->closed && !bot_context.stopped()) {
+      sends_->sends.insert(state);
+      spawn = true;
+    }
+  }
+
+  // 完成处理器只持有共享状态而不持有本协程，等待被打断后发送照常结束，
+  // stop() 通过 sends_ 等待它
+  if (spawn) {
+    boost::asio::co_spawn(
+        bot_context, run_owned_send(std::move(make_send)),
+        [state, sends = sends_](std::exception_ptr error,
+                                std::string response) {
+          {
+            std::lock_guard lock(state->mutex);
+            state->done = true;
+            state->error = std::move(error);
+            state->response = std::move(response);
+            // 持锁投递：等待方清空 waiter 之前重试线程的 io_context 一定还在
+            if (state->waiter) {
+              boost::asio::post(*state->waiter, [state] {
+                if (state->timer != nullptr) {
+                  state->timer->cancel();
+                }
+              });
+            }
+          }
+          std::lock_guard lock(sends->mutex);
+          sends->sends.erase(state);
+          sends->finished.notify_all();
+        });
+  }
+
+  state->timer = &timer;
+  send_waits_.insert(&timer);
+  while (running_) {
+    {
+      std::lock_guard lock(state->mutex);
+      if (state->done) {
+        break;
+      }
+    }
+    boost::system::error_code ec;
+    co_await timer.async_wait(
+        boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+  }
+  send_waits_.erase(&timer);
+  state->timer = nullptr;
+
+  std::unique_lock lock(state->mutex);
+  state->waiter.reset();
+  if (!state->done) {
+    throw boost::system::system_error(boost::asio::error::operation_aborted);
+  }
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+  co_return std::move(state->response);
+}
+
 void RetryQueueManager::add_message_retry(
     const std::string &source_platform, const std::string &target_platform,
     const std::string &source_message_id, const obcx::common::Message &message,
@@ -67,13 +206,20 @@ void RetryQueueManager::add_message_retry(
   retry_info.next_retry_at =
       calculate_next_retry_time(0, DEFAULT_MESSAGE_RETRY_INTERVAL_SECONDS);
 
-  if (db_manager_->add_message_retry(retry_info)) {
-    OBCX_INFO("Added message retry: {} -> {} (msg_id: {})", source_platform,
-              target_platform, source_message_id);
-  } else {
-    OBCX_ERROR("Failed to add message retry: {} -> {} (msg_id: {})",
-               source_platform, target_platform, source_message_id);
-  }
+  // 调用方多在 Bot 的 io 线程上，写库交给重试线程，不阻塞事件处理
+  boost::asio::post(strand_, [this, retry_info = std::move(retry_info)] {
+    if (db_manager_->add_message_retry(retry_info)) {
+      OBCX_INFO("Added message retry: {} -> {} (msg_id: {})",
+                retry_info.source_platform, retry_info.target_platform,
+                retry_info.source_message_id);
+    } else {
+      OBCX_ERROR("Failed to add message retry: {} -> {} (msg_id: {})",
+                 retry_info.source_platform, retry_info.target_platform,
+                 retry_info.source_message_id);
+    }
+    // 持久化失败时仍在本次运行中重试，只是重启后不会恢复
+    schedule_retry(retry_info);
+  });
 }
 
 void RetryQueueManager::add_media_download_retry(
@@ -96,13 +242,16 @@ void RetryQueueManager::add_media_download_retry(
   retry_info.next_retry_at =
       calculate_next_retry_time(0, DEFAULT_MEDIA_RETRY_INTERVAL_SECONDS);
 
-  if (db_manager_->add_media_download_retry(retry_info)) {
-    OBCX_INFO("Added media download retry: {} (file_id: {}, use_proxy: {})",
-              platform, file_id, use_proxy);
-  } else {
-    OBCX_ERROR("Failed to add media download retry: {} (file_id: {})", platform,
-               file_id);
-  }
+  boost::asio::post(strand_, [this, retry_info = std::move(retry_info)] {
+    if (db_manager_->add_media_download_retry(retry_info)) {
+      OBCX_INFO("Added media download retry: {} (file_id: {}, use_proxy: {})",
+                retry_info.platform, retry_info.file_id, retry_info.use_proxy);
+    } else {
+      OBCX_ERROR("Failed to add media download retry: {} (file_id: {})",
+                 retry_info.platform, retry_info.file_id);
+    }
+    schedule_retry(retry_info);
+  });
 }
 
 void RetryQueueManager::register_message_send_callback(
@@ -119,222 +268,407 @@ void RetryQueueManager::register_media_download_callback(
 }
 
 boost::asio::awaitable<void> RetryQueueManager::process_retry_queues() {
-  while (running_) {
-    try {
-      // 处理消息发送重试
-      co_await process_message_retries();
-
-      // 处理媒体下载重试
-      co_await process_media_download_retries();
-
-      // 等待下一次检查
-      retry_timer_->expires_after(
-          std::chrono::seconds(RETRY_QUEUE_CHECK_INTERVAL_SECONDS));
-      co_await retry_timer_->async_wait(boost::asio::use_awaitable);
+  load_pending_retries();
 
-    } catch (const boost::system::system_error &e) {
-      if (e.code() == boost::asio::error::operation_aborted) {
-        OBCX_INFO("Retry queue processing cancelled");
-        break;
-      }
-      OBCX_ERROR("Error in retry queue processing: {}", e.what());
-    } catch (const std::exception &e) {
-      OBCX_ERROR("Exception in retry queue processing: {}", e.what());
+  const auto max_concurrent = limits_.max_concurrent == 0
+                                  ? std::numeric_limits<std::size_t>::max()
+                                  : limits_.max_concurrent;
+  while (running_) {
+    // 并发已满时等到有重试结束，否则等到最早的重试到期；加入更早到期的
+    // 重试也会取消等待，重新计算
+    const bool saturated = in_flight_ >= max_concurrent;
+    retry_timer_->expires_at(saturated
+                                 ? std::chrono::system_clock::time_point::max()
+                                 : next_retry_time());
+    boost::system::error_code ec;
+    co_await retry_timer_->async_wait(
+        boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+    if (ec == boost::asio::error::operation_aborted ||
+        in_flight_ >= max_concurrent) {
+      continue;
     }
 
-    // 短暂等待后继续
-    if (running_) {
-      try {
-        retry_timer_->expires_after(std::chrono::seconds(5));
-        co_await retry_timer_->async_wait(boost::asio::use_awaitable);
-      } catch (const boost::system::system_error &) {
-        // Timer was cancelled, exit gracefully
+    for (auto &retry : take_due_retries(max_concurrent - in_flight_)) {
+      if (!running_) {
         break;
       }
+      ++in_flight_;
+      boost::asio::co_spawn(strand_, run_retry(std::move(retry)),
+                            boost::asio::detached);
     }
   }
 
   OBCX_INFO("Retry queue processing stopped");
 }
 
-boost::asio::awaitable<void> RetryQueueManager::process_message_retries() {
-  auto pending_retries = db_manager_->get_pending_message_retries(50);
-
-  if (pending_retries.empty()) {
-    co_return;
+boost::asio::awaitable<void> RetryQueueManager::run_retry(DueRetry retry) {
+  if (const auto *message =
+          std::get_if<obcx::storage::MessageRetryInfo>(&retry)) {
+    co_await process_message_retry(*message);
+  } else {
+    co_await process_media_download_retry(
+        std::get<obcx::storage::MediaDownloadRetryInfo>(retry));
   }
 
-  OBCX_DEBUG("Processing {} message retries", pending_retries.size());
+  // 空出名额，唤醒处理协程启动下一个已到期的重试
+  --in_flight_;
+  retry_timer_->cancel();
+}
 
-  for (const auto &retry_info : pending_retries) {
-    try {
-      // 查找对应的回调函数
-      auto callback_it =
-          message_send_callbacks_.find(retry_info.target_platform);
-      if (callback_it == message_send_callbacks_.end()) {
-        OBCX_WARN("No callback registered for target platform: {}",
-                  retry_info.target_platform);
-        continue;
-      }
+boost::asio::awaitable<void> RetryQueueManager::process_message_retry(
+    const obcx::storage::MessageRetryInfo &retry_info) {
+  const auto key = message_key(retry_info);
+  try {
+    // 查找对应的回调函数
+    auto callback_it = message_send_callbacks_.find(retry_info.target_platform);
+    if (callback_it == message_send_callbacks_.end()) {
+      // 两个桥接插件共用重试表，另一方向的记录由对应插件处理
+      OBCX_DEBUG("No callback registered for target platform: {}",
+                 retry_info.target_platform);
+      finish_retry(RetryKind::message_send, key, retry_info.next_retry_at);
+      co_return;
+    }
 
-      // 反序列化消息内容
-      auto message_opt = deserialize_message(retry_info.message_content);
-      if (!message_opt.has_value()) {
-        OBCX_ERROR("Failed to deserialize message for retry: {} -> {}",
-                   retry_info.source_platform, retry_info.target_platform);
-        // 删除无效的重试记录
-        db_manager_->remove_message_retry(retry_info.source_platform,
-                                          retry_info.source_message_id,
-                                          retry_info.target_platform);
-        continue;
-      }
+    // 反序列化消息内容
+    auto message_opt = deserialize_message(retry_info.message_content);
+    if (!message_opt.has_value()) {
+      OBCX_ERROR("Failed to deserialize message for retry: {} -> {}",
+                 retry_info.source_platform, retry_info.target_platform);
+      // 删除无效的重试记录
+      db_manager_->remove_message_retry(retry_info.source_platform,
+                                        retry_info.source_message_id,
+                                        retry_info.target_platform);
+      finish_retry(RetryKind::message_send, key, retry_info.next_retry_at);
+      co_return;
+    }
 
-      // 尝试发送消息
-      OBCX_INFO("Retrying message send: {} -> {} (attempt {})",
+    // 尝试发送消息
+    OBCX_INFO("Retrying message send: {} -> {} (attempt {})",
+              retry_info.source_platform, retry_info.target_platform,
+              retry_info.retry_count + 1);
+
+    auto result = co_await callback_it->second(retry_info, message_opt.value());
+
+    if (!running_ && !result.message_id.has_value()) {
+      // 停止时被打断的重发不计入重试次数，记录留在数据库中，下次启动再发
+      OBCX_INFO("Message retry interrupted by shutdown: {} -> {}",
+                retry_info.source_platform, retry_info.target_platform);
+      co_return;
+    }
+
+    if (result.retry_after.has_value()) {
+      // 被目标平台限流不算失败：到时间后再发，重试次数不变
+      auto next = retry_info;
+      next.next_retry_at =
+          std::chrono::system_clock::now() + *result.retry_after;
+      next.failure_reason = "Rate limited";
+      next.last_attempt_at = std::chrono::system_clock::now();
+      db_manager_->update_message_retry(
+          next.source_platform, next.source_message_id, next.target_platform,
+          next.retry_count, next.next_retry_at, next.failure_reason);
+      schedule_retry(next);
+
+      OBCX_INFO("Message retry rate limited for {}s: {} -> {}",
+                result.retry_after->count(), retry_info.source_platform,
+                retry_info.target_platform);
+      co_return;
+    }
+
+    if (result.message_id.has_value()) {
+      // 发送成功，记录消息映射并删除重试记录
+      obcx::storage::MessageMapping mapping;
+      mapping.source_platform = retry_info.source_platform;
+      mapping.source_message_id = retry_info.source_message_id;
+      mapping.target_platform = retry_info.target_platform;
+      mapping.target_message_id = *result.message_id;
+      mapping.created_at = std::chrono::system_clock::now();
+
+      db_manager_->add_message_mapping(mapping);
+      db_manager_->remove_message_retry(retry_info.source_platform,
+                                        retry_info.source_message_id,
+                                        retry_info.target_platform);
+      finish_retry(RetryKind::message_send, key, retry_info.next_retry_at);
+
+      OBCX_INFO("Message retry successful: {} -> {} (msg_id: {})",
                 retry_info.source_platform, retry_info.target_platform,
-                retry_info.retry_count + 1);
-
-      auto result =
-          co_await callback_it->second(retry_info, message_opt.value());
-
-      if (result.has_value()) {
-        // 发送成功，记录消息映射并删除重试记录
-        obcx::storage::MessageMapping mapping;
-        mapping.source_platform = retry_info.source_platform;
-        mapping.source_message_id = retry_info.source_message_id;
-        mapping.target_platform = retry_info.target_platform;
-        mapping.target_message_id = result.value();
-        mapping.created_at = std::chrono::system_clock::now();
-
-        db_manager_->add_message_mapping(mapping);
-        db_manager_->remove_message_retry(retry_info.source_platform,
-                                          retry_info.source_message_id,
-                                          retry_info.target_platform);
-
-        OBCX_INFO("Message retry successful: {} -> {} (msg_id: {})",
-                  retry_info.source_platform, retry_info.target_platform,
-                  result.value());
+                *result.message_id);
+      co_return;
+    }
+
+    // 发送失败，更新重试信息
+    int new_retry_count = retry_info.retry_count + 1;
+
+    if (new_retry_count >= retry_info.max_retry_count) {
+      // 达到最大重试次数，删除记录
+      db_manager_->remove_message_retry(retry_info.source_platform,
+                                        retry_info.source_message_id,
+                                        retry_info.target_platform);
+      finish_retry(RetryKind::message_send, key, retry_info.next_retry_at);
+      OBCX_WARN("Message retry failed after {} attempts: {} -> {}",
+                retry_info.max_retry_count, retry_info.source_platform,
+                retry_info.target_platform);
+    } else {
+      // 更新重试信息
+      auto next = retry_info;
+      next.retry_count = new_retry_count;
+      next.next_retry_at = calculate_next_retry_time(
+          new_retry_count, DEFAULT_MESSAGE_RETRY_INTERVAL_SECONDS);
+      next.failure_reason = "Send failed";
+      next.last_attempt_at = std::chrono::system_clock::now();
+      db_manager_->update_message_retry(
+          next.source_platform, next.source_message_id, next.target_platform,
+          next.retry_count, next.next_retry_at, next.failure_reason);
+      schedule_retry(next);
+
+      OBCX_DEBUG("Updated message retry count to {}, next retry at: {}",
+                 new_retry_count,
+                 std::chrono::system_clock::to_time_t(next.next_retry_at));
+    }
+
+  } catch (const std::exception &e) {
+    OBCX_ERROR("Error processing message retry: {}", e.what());
+    // 不计入重试次数，按当前退避间隔再试
+    auto next = retry_info;
+    next.next_retry_at = calculate_next_retry_time(
+        retry_info.retry_count, DEFAULT_MESSAGE_RETRY_INTERVAL_SECONDS);
+    schedule_retry(next);
+  }
+}
+
+boost::asio::awaitable<void> RetryQueueManager::process_media_download_retry(
+    const obcx::storage::MediaDownloadRetryInfo &retry_info) {
+  const auto key = media_key(retry_info);
+  try {
+    // 查找对应的回调函数
+    auto callback_it = media_download_callbacks_.find(retry_info.platform);
+    if (callback_it == media_download_callbacks_.end()) {
+      OBCX_DEBUG("No callback registered for platform: {}",
+                 retry_info.platform);
+      finish_retry(RetryKind::media_download, key, retry_info.next_retry_at);
+      co_return;
+    }
+
+    // 尝试下载媒体文件
+    OBCX_INFO("Retrying media download: {} (attempt {}, use_proxy: {})",
+              retry_info.file_id, retry_info.retry_count + 1,
+              retry_info.use_proxy);
+
+    auto result = co_await callback_it->second(
+        retry_info.download_url, retry_info.local_path, retry_info.use_proxy);
+
+    if (result.has_value()) {
+      // 下载成功，删除重试记录
+      db_manager_->remove_media_download_retry(retry_info.platform,
+                                               retry_info.file_id);
+      finish_retry(RetryKind::media_download, key, retry_info.next_retry_at);
+      OBCX_INFO("Media download retry successful: {} -> {}",
+                retry_info.file_id, result.value());
+      co_return;
+    }
+
+    // 下载失败，更新重试信息
+    int new_retry_count = retry_info.retry_count + 1;
+    auto next = retry_info;
+    next.retry_count = new_retry_count;
+    next.next_retry_at = calculate_next_retry_time(
+        new_retry_count, DEFAULT_MEDIA_RETRY_INTERVAL_SECONDS);
+    next.last_attempt_at = std::chrono::system_clock::now();
+
+    if (new_retry_count >= retry_info.max_retry_count) {
+      // 达到最大重试次数
+      // 如果之前使用代理失败，尝试直连一次
+      if (retry_info.use_proxy &&
+          new_retry_count == retry_info.max_retry_count) {
+        OBCX_INFO("Proxy download failed, trying direct connection: {}",
+                  retry_info.file_id);
+        next.failure_reason = "Trying direct connection";
+        next.use_proxy = false; // 不使用代理
+        db_manager_->update_media_download_retry(
+            next.platform, next.file_id, next.retry_count, next.next_retry_at,
+            next.failure_reason, next.use_proxy);
+        schedule_retry(next);
       } else {
-        // 发送失败，更新重试信息
-        int new_retry_count = retry_info.retry_count + 1;
-
-        if (new_retry_count >= retry_info.max_retry_count) {
-          // 达到最大重试次数，删除记录
-          db_manager_->remove_message_retry(retry_info.source_platform,
-                                            retry_info.source_message_id,
-                                            retry_info.target_platform);
-          OBCX_WARN("Message retry failed after {} attempts: {} -> {}",
-                    retry_info.max_retry_count, retry_info.source_platform,
-                    retry_info.target_platform);
-        } else {
-          // 更新重试信息
-          auto next_retry_time = calculate_next_retry_time(
-              new_retry_count, DEFAULT_MESSAGE_RETRY_INTERVAL_SECONDS);
-          db_manager_->update_message_retry(
-              retry_info.source_platform, retry_info.source_message_id,
-              retry_info.target_platform, new_retry_count, next_retry_time,
-              "Send failed");
-
-          OBCX_DEBUG("Updated message retry count to {}, next retry at: {}",
-                     new_retry_count,
-                     std::chrono::system_clock::to_time_t(next_retry_time));
-        }
+        // 彻底失败，删除记录
+        db_manager_->remove_media_download_retry(retry_info.platform,
+                                                 retry_info.file_id);
+        finish_retry(RetryKind::media_download, key, retry_info.next_retry_at);
+        OBCX_WARN("Media download retry failed after {} attempts: {}",
+                  retry_info.max_retry_count, retry_info.file_id);
       }
-
-    } catch (const std::exception &e) {
-      OBCX_ERROR("Error processing message retry: {}", e.what());
+    } else {
+      // 更新重试信息
+      next.failure_reason = "Download failed";
+      db_manager_->update_media_download_retry(
+          next.platform, next.file_id, next.retry_count, next.next_retry_at,
+          next.failure_reason, next.use_proxy);
+      schedule_retry(next);
+
+      OBCX_DEBUG("Updated media download retry count to {}, next retry at: {}",
+                 new_retry_count,
+                 std::chrono::system_clock::to_time_t(next.next_retry_at));
     }
+
+  } catch (const std::exception &e) {
+    OBCX_ERROR("Error processing media download retry: {}", e.what());
+    auto next = retry_info;
+    next.next_retry_at = calculate_next_retry_time(
+        retry_info.retry_count, DEFAULT_MEDIA_RETRY_INTERVAL_SECONDS);
+    schedule_retry(next);
   }
 }
 
-boost::asio::awaitable<void>
-RetryQueueManager::process_media_download_retries() {
-  auto pending_retries = db_manager_->get_pending_media_download_retries(30);
+void RetryQueueManager::load_pending_retries() {
+  constexpr auto all = std::numeric_limits<int>::max();
+  constexpr auto any_time = std::chrono::system_clock::time_point::max();
+
+  const auto message_retries =
+      db_manager_->get_pending_message_retries(all, any_time);
+  const auto media_retries =
+      db_manager_->get_pending_media_download_retries(all, any_time);
+  // start() 之前加入的记录已在内存中，数据库里的时间只精确到秒，不覆盖
+  for (const auto &retry_info : message_retries) {
+    if (!is_scheduled(RetryKind::message_send, message_key(retry_info))) {
+      schedule_retry(retry_info);
+    }
+  }
+  for (const auto &retry_info : media_retries) {
+    if (!is_scheduled(RetryKind::media_download, media_key(retry_info))) {
+      schedule_retry(retry_info);
+    }
+  }
+
+  OBCX_INFO("Loaded {} message retries and {} media download retries",
+            message_retries.size(), media_retries.size());
+}
 
-  if (pending_retries.empty()) {
-    co_return;
+void RetryQueueManager::schedule_retry(
+    const obcx::storage::MessageRetryInfo &retry_info) {
+  auto key = message_key(retry_info);
+  {
+    std::lock_guard lock(schedule_mutex_);
+    message_retries_.insert_or_assign(key, retry_info);
+    schedule_.push({retry_info.next_retry_at, RetryKind::message_send,
+                    std::move(key)});
   }
+  wake_up(retry_info.next_retry_at);
+}
 
-  OBCX_DEBUG("Processing {} media download retries", pending_retries.size());
+void RetryQueueManager::schedule_retry(
+    const obcx::storage::MediaDownloadRetryInfo &retry_info) {
+  auto key = media_key(retry_info);
+  {
+    std::lock_guard lock(schedule_mutex_);
+    media_retries_.insert_or_assign(key, retry_info);
+    schedule_.push({retry_info.next_retry_at, RetryKind::media_download,
+                    std::move(key)});
+  }
+  wake_up(retry_info.next_retry_at);
+}
 
-  for (const auto &retry_info : pending_retries) {
-    try {
-      // 查找对应的回调函数
-      auto callback_it = media_download_callbacks_.find(retry_info.platform);
-      if (callback_it == media_download_callbacks_.end()) {
-        OBCX_WARN("No callback registered for platform: {}",
-                  retry_info.platform);
-        continue;
-      }
+void RetryQueueManager::wake_up(std::chrono::system_clock::time_point due) {
+  // 定时器只在 strand_ 上访问；处理协程正忙时取消不起作用，它处理完会
+  // 重新计算最早的到期时间
+  boost::asio::post(strand_, [this, due] {
+    if (due < retry_timer_->expiry()) {
+      retry_timer_->cancel();
+    }
+  });
+}
 
-      // 尝试下载媒体文件
-      OBCX_INFO("Retrying media download: {} (attempt {}, use_proxy: {})",
-                retry_info.file_id, retry_info.retry_count + 1,
-                retry_info.use_proxy);
+bool RetryQueueManager::is_scheduled(RetryKind kind,
+                                     const RetryKey &key) const {
+  std::lock_guard lock(schedule_mutex_);
+  return kind == RetryKind::message_send ? message_retries_.contains(key)
+                                         : media_retries_.contains(key);
+}
 
-      auto result = co_await callback_it->second(
-          retry_info.download_url, retry_info.local_path, retry_info.use_proxy);
+void RetryQueueManager::finish_retry(
+    RetryKind kind, const RetryKey &key,
+    std::chrono::system_clock::time_point due) {
+  std::lock_guard lock(schedule_mutex_);
+  const auto erase = [&](auto &retries) {
+    if (const auto it = retries.find(key);
+        it != retries.end() && it->second.next_retry_at == due) {
+      retries.erase(it);
+    }
+  };
+  if (kind == RetryKind::message_send) {
+    erase(message_retries_);
+  } else {
+    erase(media_retries_);
+  }
+}
 
-      if (result.has_value()) {
-        // 下载成功，删除重试记录
-        db_manager_->remove_media_download_retry(retry_info.platform,
-                                                 retry_info.file_id);
-        OBCX_INFO("Media download retry successful: {} -> {}",
-                  retry_info.file_id, result.value());
+auto RetryQueueManager::take_due_retries(std::size_t limit)
+    -> std::vector<DueRetry> {
+  const auto now = std::chrono::system_clock::now();
+  std::vector<DueRetry> due;
+  std::lock_guard lock(schedule_mutex_);
+  while (due.size() < limit && !schedule_.empty() &&
+         schedule_.top().due <= now) {
+    const auto &entry = schedule_.top();
+    if (is_current(entry)) {
+      if (entry.kind == RetryKind::message_send) {
+        due.emplace_back(message_retries_.at(entry.key));
       } else {
-        // 下载失败，更新重试信息
-        int new_retry_count = retry_info.retry_count + 1;
-
-        if (new_retry_count >= retry_info.max_retry_count) {
-          // 达到最大重试次数
-          // 如果之前使用代理失败，尝试直连一次
-          if (retry_info.use_proxy &&
-              new_retry_count == retry_info.max_retry_count) {
-            OBCX_INFO("Proxy download failed, trying direct connection: {}",
-                      retry_info.file_id);
-            auto next_retry_time = calculate_next_retry_time(
-                new_retry_count, DEFAULT_MEDIA_RETRY_INTERVAL_SECONDS);
-            db_manager_->update_media_download_retry(
-                retry_info.platform, retry_info.file_id, new_retry_count,
-                next_retry_time, "Trying direct connection",
-                false); // 不使用代理
-          } else {
-            // 彻底失败，删除记录
-            db_manager_->remove_media_download_retry(retry_info.platform,
-                                                     retry_info.file_id);
-            OBCX_WARN("Media download retry failed after {} attempts: {}",
-                      retry_info.max_retry_count, retry_info.file_id);
-          }
-        } else {
-          // 更新重试信息
-          auto next_retry_time = calculate_next_retry_time(
-              new_retry_count, DEFAULT_MEDIA_RETRY_INTERVAL_SECONDS);
-          db_manager_->update_media_download_retry(
-              retry_info.platform, retry_info.file_id, new_retry_count,
-              next_retry_time, "Download failed", retry_info.use_proxy);
-
-          OBCX_DEBUG(
-              "Updated media download retry count to {}, next retry at: {}",
-              new_retry_count,
-              std::chrono::system_clock::to_time_t(next_retry_time));
-        }
+        due.emplace_back(media_retries_.at(entry.key));
       }
-
-    } catch (const std::exception &e) {
-      OBCX_ERROR("Error processing media download retry: {}", e.what());
     }
+    schedule_.pop();
   }
+  return due;
+}
+
+auto RetryQueueManager::next_retry_time()
+    -> std::chrono::system_clock::time_point {
+  std::lock_guard lock(schedule_mutex_);
+  drop_stale_entries();
+  return schedule_.empty() ? std::chrono::system_clock::time_point::max()
+                           : schedule_.top().due;
+}
+
+bool RetryQueueManager::is_current(const ScheduledRetry &entry) const {
+  const auto matches = [&](const auto &retries) {
+    const auto it = retries.find(entry.key);
+    return it != retries.end() && it->second.next_retry_at == entry.due;
+  };
+  return entry.kind == RetryKind::message_send ? matches(message_retries_)
+                                               : matches(media_retries_);
+}
+
+void RetryQueueManager::drop_stale_entries() {
+  while (!schedule_.empty() && !is_current(schedule_.top())) {
+    schedule_.pop();
+  }
+}
+
+auto RetryQueueManager::message_key(
+    const obcx::storage::MessageRetryInfo &retry_info) -> RetryKey {
+  return {retry_info.source_platform, retry_info.source_message_id,
+          retry_info.target_platform};
+}
+
+auto RetryQueueManager::media_key(
+    const obcx::storage::MediaDownloadRetryInfo &retry_info) -> RetryKey {
+  return {retry_info.platform, retry_info.file_id, {}};
 }
 
 std::chrono::system_clock::time_point
 RetryQueueManager::calculate_next_retry_time(int retry_count,
                                              int base_interval_seconds) const {
   // 指数退避：2^retry_count * base_interval，但有最大限制
-  int delay_seconds =
-      static_cast<int>(std::pow(2, retry_count)) * base_interval_seconds;
-  delay_seconds = std::min(delay_seconds, MAX_RETRY_INTERVAL_SECONDS);
-
-  return std::chrono::system_clock::now() + std::chrono::seconds(delay_seconds);
+  const auto exponent = std::clamp(retry_count, 0, 16);
+  const std::chrono::milliseconds delay =
+      std::chrono::seconds(std::min<int64_t>(
+          int64_t{base_interval_seconds} << exponent,
+          MAX_RETRY_INTERVAL_SECONDS));
+
+  // 在 [delay/2, delay] 内随机取值，同时失败的一批重试不会在同一时刻一起
+  // 重发
+  thread_local std::mt19937_64 rng{std::random_device{}()};
+  std::uniform_int_distribution<int64_t> jitter(0, delay.count() / 2);
+  return std::chrono::system_clock::now() + delay / 2 +
+         std::chrono::milliseconds(jitter(rng));
 }
 
 std::string RetryQueueManager::serialize_message(
@@ -379,45 +713,118 @@ std::optional<obcx::common::Message> RetryQueueManager::deserialize_message(
   }
 }
 
-std::string RetryQueueManager::get_retry_statistics() const {
-  // 获取重试队列统计信息
-  std::ostringstream stats;
-
+auto RetryQueueManager::retry_after_from_response(std::string_view response)
+    -> std::optional<std::chrono::seconds> {
   try {
-    auto message_retries = db_manager_->get_pending_message_retries(1000);
-    auto media_retries = db_manager_->get_pending_media_download_retries(1000);
+    const auto json = nlohmann::json::parse(response);
+    if (json.value("ok", true)) {
+      return std::nullopt;
+    }
+    // {"ok":false,"error_code":429,"parameters":{"retry_after":N}}
+    const auto parameters = json.find("parameters");
+    if (parameters == json.end() || !parameters->is_object()) {
+      return std::nullopt;
+    }
+    const auto retry_after = parameters->find("retry_after");
+    if (retry_after == parameters->end() ||
+        !retry_after->is_number_integer()) {
+      return std::nullopt;
+    }
+    return std::chrono::seconds(retry_after->get<int64_t>());
+  } catch (const nlohmann::json::exception &) {
+    return std::nullopt;
+  }
+}
 
-    stats << "=== 重试队列统计 ===\n";
-    stats << "待重试消息数: " << message_retries.size() << "\n";
-    stats << "待重试媒体下载数: " << media_retries.size() << "\n";
+auto RetryQueueManager::send_result_from_response(std::string_view response)
+    -> SendResult {
+  SendResult result{.retry_after = retry_after_from_response(response)};
+  try {
+    // Telegram: {"ok":true,"result":{"message_id":N}}
+    // OneBot 11: {"status":"ok","data":{"message_id":N}}
+    const auto json = nlohmann::json::parse(response);
+    for (const auto *field : {"result", "data"}) {
+      const auto body = json.find(field);
+      if (body == json.end() || !body->is_object()) {
+        continue;
+      }
+      const auto message_id = body->find("message_id");
+      if (message_id != body->end() && message_id->is_number_integer()) {
+        result.message_id = std::to_string(message_id->get<int64_t>());
+        break;
+      }
+    }
+  } catch (const nlohmann::json::exception &) {
+    // 响应不是 JSON 时按发送失败处理
+  }
+  return result;
+}
 
-    // 按重试次数统计
-    std::unordered_map<int, int> message_retry_counts;
-    std::unordered_map<int, int> media_retry_counts;
+std::string RetryQueueManager::get_retry_statistics() const {
+  // 获取重试队列统计信息
+  std::ostringstream stats;
 
-    for (const auto &retry : message_retries) {
+  // 按重试次数统计
+  std::map<int, int> message_retry_counts;
+  std::map<int, int> media_retry_counts;
+  std::size_t message_retries = 0;
+  std::size_t media_retries = 0;
+  {
+    std::lock_guard lock(schedule_mutex_);
+    message_retries = message_retries_.size();
+    media_retries = media_retries_.size();
+    for (const auto &[key, retry] : message_retries_) {
       message_retry_counts[retry.retry_count]++;
     }
-
-    for (const auto &retry : media_retries) {
+    for (const auto &[key, retry] : media_retries_) {
       media_retry_counts[retry.retry_count]++;
     }
+  }
 
-    stats << "\n消息重试次数分布:\n";
-    for (const auto &[count, num] : message_retry_counts) {
-      stats << "  " << count << "次: " << num << "个\n";
-    }
+  stats << "=== 重试队列统计 ===\n";
+  stats << "待重试消息数: " << message_retries << "\n";
+  stats << "待重试媒体下载数: " << media_retries << "\n";
 
-    stats << "\n媒体下载重试次数分布:\n";
-    for (const auto &[count, num] : media_retry_counts) {
-      stats << "  " << count << "次: " << num << "个\n";
-    }
+  stats << "\n消息重试次数分布:\n";
+  for (const auto &[count, num] : message_retry_counts) {
+    stats << "  " << count << "次: " << num << "个\n";
+  }
 
-  } catch (const std::exception &e) {
-    stats << "获取统计信息失败: " << e.what() << "\n";
+  stats << "\n媒体下载重试次数分布:\n";
+  for (const auto &[count, num] : media_retry_counts) {
+    stats << "  " << count << "次: " << num << "个\n";
   }
 
   return stats.str();
 }
 
-} // namespace bridge
\ No newline at end of file
+RetryWorker::RetryWorker(
+    std::shared_ptr<obcx::storage::DatabaseManager> db_manager,
+    RetryLimits limits)
+    : manager_(std::make_shared<RetryQueueManager>(std::move(db_manager),
+                                                   io_context_, limits)) {}
+
+RetryWorker::~RetryWorker() { stop(); }
+
+void RetryWorker::start() {
+  if (thread_.joinable()) {
+    return;
+  }
+  work_.emplace(io_context_.get_executor());
+  thread_ = std::thread([this] { io_context_.run(); });
+  manager_->start();
+}
+
+void RetryWorker::stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  // 不强行停止 io_context：处理协程退出、进行中的重试结束（等待 Bot 发送的
+  // 重试被 stop() 打断）后 run() 返回
+  manager_->stop();
+  work_.reset();
+  thread_.join();
+  io_context_.restart();
+}
+
+} // namespace bridge
@@ -5,26 +5,67 @@
 #include "database_manager.hpp"
 #include "interfaces/bot.hpp"
 
+#include <atomic>
 #include <boost/asio.hpp>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <queue>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <variant>
 #include <vector>
 
 namespace bridge {
 
+/**
+ * @brief 重试的并发参数
+ *
+ * 发送速率由目标 Bot 的发送调度器统一限制，这里只限制并发数。
+ */
+struct RetryLimits {
+  // 同时进行的重试数上限，0 表示不限
+  std::size_t max_concurrent = 8;
+  // stop() 等待 Bot 上已启动的发送结束的最长时间
+  std::chrono::milliseconds stop_timeout = std::chrono::seconds(30);
+};
+
 /**
  * @brief 重试队列管理器
  *
  * 负责管理消息发送重试和媒体下载重试的队列处理
  * 实现指数退避算法，避免频繁重试导致的系统压力
+ *
+ * 待重试的记录保存在内存中，按下次重试时间放入最小堆，定时器设在堆顶
+ * 的到期时间，到期即处理，没有待重试记录时不查询数据库。启动时从数据库
+ * 加载未完成的记录，之后数据库只负责持久化。
+ *
+ * 到期的重试并发执行，数量受 RetryLimits::max_concurrent 限制。消息重发
+ * 的速率由发送回调所用的 Bot 发送调度器限制（低优先级通道），这里不再
+ * 另设令牌桶；目标平台返回 retry_after 时按要求推迟，不计入重试次数。
  */
 class RetryQueueManager {
 public:
+  /**
+   * @brief 一次消息重发的结果
+   */
+  struct SendResult {
+    // 发送成功时的目标消息ID
+    std::optional<std::string> message_id;
+    // 目标平台要求等待的时间（如 Telegram 429 响应的 retry_after）
+    std::optional<std::chrono::seconds> retry_after;
+  };
+
   using MessageSendCallback =
-      std::function<boost::asio::awaitable<std::optional<std::string>>(
+      std::function<boost::asio::awaitable<SendResult>(
           const obcx::storage::MessageRetryInfo &retry_info,
           const obcx::common::Message &message)>;
 
@@ -37,9 +78,11 @@ public:
    * @brief 构造函数
    * @param db_manager 数据库管理器
    * @param io_context ASIO IO上下文
+   * @param limits 并发与限速参数
    */
   RetryQueueManager(std::shared_ptr<obcx::storage::DatabaseManager> db_manager,
-                    boost::asio::io_context &io_context);
+                    boost::asio::io_context &io_context,
+                    RetryLimits limits = {});
 
   /**
    * @brief 析构函数
@@ -53,11 +96,16 @@ public:
 
   /**
    * @brief 停止重试队列处理
+   *
+   * 打断 run_send 的等待，并等待已在 Bot 上启动的发送结束（最长
+   * RetryLimits::stop_timeout）后返回。
    */
   void stop();
 
   /**
    * @brief 添加消息发送重试
+   *
+   * 立即返回，记录的持久化与排期在 strand_ 上进行。
    * @param source_platform 源平台
    * @param target_platform 目标平台
    * @param source_message_id 源消息ID
@@ -77,6 +125,8 @@ public:
 
   /**
    * @brief 添加媒体下载重试
+   *
+   * 立即返回，记录的持久化与排期在 strand_ 上进行。
    * @param platform 平台
    * @param file_id 文件ID
    * @param file_type 文件类型
@@ -110,17 +160,90 @@ public:
   void register_media_download_callback(const std::string &platform,
                                         MediaDownloadCallback callback);
 
+  /**
+   * @brief 在 Bot 的 io_context 上运行一次发送并等待响应
+   *
+   * 供消息发送回调使用。make_send 在 Bot 的 io_context 上调用，它与发送
+   * 协程同生命周期，发送用到的参数应按值捕获；先存为具名变量再传入，GCC 12
+   * 会让 co_await 表达式里由临时 lambda 构造的参数引用调用方的协程帧。
+   * stop() 会打断等待并抛出
+   * operation_aborted，返回前等待已启动的发送结束。Bot 的 io_context 已
+   * 停止时不再启动发送；停止后留在其中的发送只持有自己的参数，随 Bot
+   * 一起销毁。
+   * @param bot_context 发送所在的 io_context
+   * @param make_send 创建返回 API 响应的发送协程
+   * @return API 响应
+   */
+  boost::asio::awaitable<std::string>
+  run_send(boost::asio::io_context &bot_context,
+           std::function<boost::asio::awaitable<std::string>()> make_send);
+
   /**
    * @brief 获取重试统计信息
    * @return 统计信息字符串
    */
   std::string get_retry_statistics() const;
 
+  /**
+   * @brief 从 Telegram Bot API 的错误响应中取出 retry_after
+   * @param response API 返回的 JSON
+   * @return 响应不是限流错误时返回nullopt
+   */
+  static auto retry_after_from_response(std::string_view response)
+      -> std::optional<std::chrono::seconds>;
+
+  /**
+   * @brief 把目标平台发送接口的响应转换为重发结果
+   * @param response Telegram 或 OneBot 11 的 API 响应
+   * @return 取出消息ID或 retry_after，都没有时表示发送失败
+   */
+  static auto send_result_from_response(std::string_view response)
+      -> SendResult;
+
 private:
+  enum class RetryKind { message_send, media_download };
+
+  // 消息为 (source_platform, source_message_id, target_platform)，
+  // 媒体为 (platform, file_id, "")
+  using RetryKey = std::tuple<std::string, std::string, std::string>;
+
+  using DueRetry = std::variant<obcx::storage::MessageRetryInfo,
+                                obcx::storage::MediaDownloadRetryInfo>;
+
+  struct ScheduledRetry {
+    std::chrono::system_clock::time_point due;
+    RetryKind kind;
+    RetryKey key;
+
+    auto operator>(const ScheduledRetry &other) const -> bool {
+      return due > other.due;
+    }
+  };
+
   std::shared_ptr<obcx::storage::DatabaseManager> db_manager_;
   boost::asio::io_context &io_context_;
-  std::unique_ptr<boost::asio::steady_timer> retry_timer_;
-  bool running_;
+  // 处理协程与定时器都在 strand_ 上运行，add_* 可以从任意线程调用
+  boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+  std::unique_ptr<boost::asio::system_timer> retry_timer_;
+  std::atomic<bool> running_;
+  const RetryLimits limits_;
+
+  // 只在 strand_ 上访问
+  std::size_t in_flight_ = 0;
+  // 正在等待 run_send 结果的定时器，stop() 时取消；只在 strand_ 上访问
+  std::unordered_set<boost::asio::steady_timer *> send_waits_;
+  // 已在 Bot 上启动的发送。完成处理器也持有它，不依赖本对象的生命周期
+  struct SendRegistry;
+  std::shared_ptr<SendRegistry> sends_;
+
+  mutable std::mutex schedule_mutex_;
+  // 按下次重试时间排序的最小堆。重新安排或完成的记录不从堆中删除，
+  // 出堆时与下面表中的 next_retry_at 不一致即丢弃
+  std::priority_queue<ScheduledRetry, std::vector<ScheduledRetry>,
+                      std::greater<>>
+      schedule_;
+  std::map<RetryKey, obcx::storage::MessageRetryInfo> message_retries_;
+  std::map<RetryKey, obcx::storage::MediaDownloadRetryInfo> media_retries_;
 
   // 回调函数映射
   std::unordered_map<std::string, MessageSendCallback> message_send_callbacks_;
@@ -131,25 +254,74 @@ private:
   static constexpr int DEFAULT_MESSAGE_RETRY_INTERVAL_SECONDS = 2;
   static constexpr int DEFAULT_MEDIA_RETRY_INTERVAL_SECONDS = 5;
   static constexpr int MAX_RETRY_INTERVAL_SECONDS = 300; // 5分钟
-  static constexpr int RETRY_QUEUE_CHECK_INTERVAL_SECONDS = 10;
 
   /**
-   * @brief 定期检查重试队列
+   * @brief 等待最早到期的重试，在并发上限内逐个启动
    */
   boost::asio::awaitable<void> process_retry_queues();
 
   /**
-   * @brief 处理消息发送重试
+   * @brief 执行一次重试，结束后释放并发名额
    */
-  boost::asio::awaitable<void> process_message_retries();
+  boost::asio::awaitable<void> run_retry(DueRetry retry);
 
   /**
-   * @brief 处理媒体下载重试
+   * @brief 处理一次消息发送重试
    */
-  boost::asio::awaitable<void> process_media_download_retries();
+  boost::asio::awaitable<void> process_message_retry(
+      const obcx::storage::MessageRetryInfo &retry_info);
 
   /**
-   * @brief 计算下次重试时间（指数退避）
+   * @brief 处理一次媒体下载重试
+   */
+  boost::asio::awaitable<void> process_media_download_retry(
+      const obcx::storage::MediaDownloadRetryInfo &retry_info);
+
+  /**
+   * @brief 从数据库加载所有未完成的重试
+   */
+  void load_pending_retries();
+
+  /**
+   * @brief 放入（或替换）内存中的重试记录，必要时提前唤醒定时器
+   */
+  void schedule_retry(const obcx::storage::MessageRetryInfo &retry_info);
+  void schedule_retry(const obcx::storage::MediaDownloadRetryInfo &retry_info);
+
+  bool is_scheduled(RetryKind kind, const RetryKey &key) const;
+
+  /**
+   * @brief 重试完成或放弃后从内存中删除，期间被重新安排的记录保留
+   */
+  void finish_retry(RetryKind kind, const RetryKey &key,
+                    std::chrono::system_clock::time_point due);
+
+  /**
+   * @brief 取出最多 limit 个已到期的重试，按到期时间排序
+   */
+  std::vector<DueRetry> take_due_retries(std::size_t limit);
+
+  /**
+   * @brief 最早的重试时间，没有待重试记录时返回 time_point::max()
+   */
+  std::chrono::system_clock::time_point next_retry_time();
+
+  /**
+   * @brief 有比当前等待更早的重试时取消定时器，可从任意线程调用
+   */
+  void wake_up(std::chrono::system_clock::time_point due);
+
+  // 以下函数调用方须持有 schedule_mutex_
+  bool is_current(const ScheduledRetry &entry) const;
+  void drop_stale_entries();
+
+  static auto message_key(const obcx::storage::MessageRetryInfo &retry_info)
+      -> RetryKey;
+  static auto media_key(const obcx::storage::MediaDownloadRetryInfo &retry_info)
+      -> RetryKey;
+
+  /**
+   * @brief 计算下次重试时间（带随机抖动的指数退避）
    * @param retry_count 当前重试次数
    * @param base_interval_seconds 基础间隔秒数
    * @return 下次重试时间点
@@ -171,11 +343,52 @@ private:
    */
   std::optional<obcx::common::Message> deserialize_message(
       const std::string &json_string) const;
+};
+
+/**
+ * @brief 在独立线程上运行重试队列
+ *
+ * 持有重试专用的 io_context 及运行它的线程。先通过 manager() 注册回调，
+ * 再调用 start()；manager() 的其他持有者须先于本对象释放。
+ */
+class RetryWorker {
+public:
+  RetryWorker(std::shared_ptr<obcx::storage::DatabaseManager> db_manager,
+              RetryLimits limits = {});
 
   /**
-   * @brief 启动重试队列处理定时器
+   * @brief 析构函数，停止处理并等待线程退出
    */
-  void schedule_retry_check();
+  ~RetryWorker();
+
+  RetryWorker(const RetryWorker &) = delete;
+  auto operator=(const RetryWorker &) -> RetryWorker & = delete;
+
+  auto manager() const -> const std::shared_ptr<RetryQueueManager> & {
+    return manager_;
+  }
+
+  /**
+   * @brief 启动线程并开始处理重试队列
+   */
+  void start();
+
+  /**
+   * @brief 停止处理并等待线程退出
+   *
+   * 进行中的重试会执行完，其中通过 run_send 等待 Bot 的发送立即放弃，
+   * 记录留在数据库中等下次启动；返回后不再调用已注册的回调，Bot 上也
+   * 没有仍在运行的重发。
+   */
+  void stop();
+
+private:
+  boost::asio::io_context io_context_;
+  std::shared_ptr<RetryQueueManager> manager_;
+  std::optional<
+      boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>
+      work_;
+  std::thread thread_;
 };
 
 } // namespace bridge
\ No newline at end of file
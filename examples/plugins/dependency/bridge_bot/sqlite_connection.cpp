@@ -0,0 +1,80 @@
+#include "sqlite_connection.hpp"
+#include "common/logger.hpp"
+#include <fmt/format.h>
+
+namespace obcx::storage {
+
+SqliteConnection::~SqliteConnection() {
+  for (const auto &[sql, stmt] : statements_) {
+    sqlite3_finalize(stmt);
+  }
+  if (db_ != nullptr) {
+    sqlite3_close(db_);
+  }
+}
+
+auto SqliteConnection::open(const std::string &path,
+                            const DatabaseOptions &options, bool read_only)
+    -> bool {
+  const int flags = read_only ? SQLITE_OPEN_READONLY
+                              : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+  if (sqlite3_open_v2(path.c_str(), &db_, flags | SQLITE_OPEN_NOMUTEX,
+                      nullptr) != SQLITE_OK) {
+    OBCX_ERROR("Cannot open database: {}", sqlite3_errmsg(db_));
+    return false;
+  }
+
+  // 两个桥接插件并行初始化时会同时建表，锁冲突时等待而不是直接失败
+  sqlite3_busy_timeout(db_, 5000);
+
+  // 只对尚未建表的新数据库生效，之后删除记录释放的页可以用
+  // PRAGMA incremental_vacuum 归还给文件系统
+  if (!read_only && !execute("PRAGMA auto_vacuum = INCREMENTAL;")) {
+    return false;
+  }
+
+  if (!read_only && options.wal) {
+    // WAL 下读写互不阻塞；NORMAL 只在检查点时 fsync，崩溃最多丢失最近的
+    // 提交而不会损坏数据库
+    if (!execute("PRAGMA journal_mode = WAL;") ||
+        !execute("PRAGMA synchronous = NORMAL;")) {
+      return false;
+    }
+  }
+  return execute(fmt::format("PRAGMA mmap_size = {};", options.mmap_size)) &&
+         execute(fmt::format("PRAGMA cache_size = -{};",
+                             options.cache_size_kib)) &&
+         execute("PRAGMA foreign_keys = ON;");
+}
+
+auto SqliteConnection::prepare(std::string_view sql, CachedStatement &stmt)
+    -> int {
+  auto it = statements_.find(sql);
+  if (it == statements_.end()) {
+    sqlite3_stmt *raw = nullptr;
+    const int rc =
+        sqlite3_prepare_v3(db_, sql.data(), static_cast<int>(sql.size()),
+                           SQLITE_PREPARE_PERSISTENT, &raw, nullptr);
+    if (rc != SQLITE_OK) {
+      return rc;
+    }
+    it = statements_.emplace(std::string(sql), raw).first;
+  }
+  stmt = CachedStatement(it->second);
+  return SQLITE_OK;
+}
+
+auto SqliteConnection::execute(const std::string &sql) -> bool {
+  char *error_msg = nullptr;
+  const int rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &error_msg);
+
+  if (rc != SQLITE_OK) {
+    OBCX_ERROR("SQL error: {}", error_msg);
+    sqlite3_free(error_msg);
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace obcx::storage
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <sqlite3.h>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace obcx::storage {
+
+/**
+ * @brief SQLite 连接、写入批次、缓存与保留策略的参数
+ */
+struct DatabaseOptions {
+  // 只读连接数，同时也是 *_async 读线程数；0 表示读写共用写连接
+  std::size_t read_connections = 2;
+  // PRAGMA mmap_size（字节），0 表示不使用内存映射
+  int64_t mmap_size = int64_t{256} << 20;
+  // 每个连接的页缓存大小（KiB），对应 PRAGMA cache_size = -N
+  int64_t cache_size_kib = 16 * 1024;
+  // 使用 WAL 日志；关闭时回退到回滚日志，读连接也随之禁用
+  bool wal = true;
+  // 消息、用户、映射与心跳的写入先进入内存队列，每隔 batch_interval 或
+  // 积攒 batch_max_rows 行后在一个事务中提交；0 表示每次写入立即提交
+  std::chrono::milliseconds batch_interval{50};
+  std::size_t batch_max_rows = 256;
+  // 用户信息缓存的条目数（0 表示不缓存）、存活时间，以及"用户不存在"
+  // 这类否定结果的存活时间
+  std::size_t user_cache_size = 4096;
+  std::chrono::seconds user_cache_ttl{600};
+  std::chrono::seconds user_negative_ttl{60};
+  // 最近消息ID映射的双向缓存条目数（0 表示不缓存）与存活时间
+  std::size_t mapping_cache_size = 8192;
+  std::chrono::seconds mapping_cache_ttl{3600};
+  // 消息表与消息ID映射表的保留策略：早于 retention_age 或超出
+  // retention_max_rows 的最旧记录由后台任务分批移出；均为 0 时不清理
+  std::chrono::hours retention_age{0};
+  std::size_t retention_max_rows = 0;
+  // 移出的记录按创建月份写入该目录下的归档库，为空时直接删除
+  std::string archive_dir;
+  // 后台清理的检查间隔，以及每批（一个事务）最多移出的行数
+  std::chrono::seconds retention_interval{600};
+  std::size_t retention_batch_rows = 1000;
+};
+
+/**
+ * @brief 从语句缓存借出的预编译语句
+ *
+ * 析构时 reset 并清除绑定，语句本身留在缓存中供下次复用。reset 也会
+ * 结束语句持有的读事务，避免长期占住 WAL 快照。
+ */
+class CachedStatement {
+public:
+  CachedStatement() = default;
+  explicit CachedStatement(sqlite3_stmt *stmt) noexcept : stmt_(stmt) {}
+  ~CachedStatement() { release(); }
+
+  CachedStatement(CachedStatement &&other) noexcept
+      : stmt_(std::exchange(other.stmt_, nullptr)) {}
+  auto operator=(CachedStatement &&other) noexcept -> CachedStatement & {
+    if (this != &other) {
+      release();
+      stmt_ = std::exchange(other.stmt_, nullptr);
+    }
+    return *this;
+  }
+
+  CachedStatement(const CachedStatement &) = delete;
+  auto operator=(const CachedStatement &) -> CachedStatement & = delete;
+
+  // 允许直接传给 sqlite3_bind_* / sqlite3_step / sqlite3_column_*
+  operator sqlite3_stmt *() const noexcept { return stmt_; }
+
+private:
+  void release() noexcept {
+    if (stmt_ != nullptr) {
+      sqlite3_reset(stmt_);
+      sqlite3_clear_bindings(stmt_);
+      stmt_ = nullptr;
+    }
+  }
+
+  sqlite3_stmt *stmt_ = nullptr;
+};
+
+/**
+ * @brief 带预编译语句缓存的 SQLite 连接
+ *
+ * 同一条 SQL 只在第一次使用时 sqlite3_prepare_v3，之后从缓存取出。
+ * 连接本身不是线程安全的，调用方需持有 mutex()。
+ */
+class SqliteConnection {
+public:
+  SqliteConnection() = default;
+  ~SqliteConnection();
+
+  SqliteConnection(const SqliteConnection &) = delete;
+  auto operator=(const SqliteConnection &) -> SqliteConnection & = delete;
+
+  /**
+   * @brief 打开数据库并应用 options 中的 PRAGMA
+   * @param read_only 以只读方式打开（不修改日志模式）
+   * @return 成功返回true，失败返回false
+   */
+  auto open(const std::string &path, const DatabaseOptions &options,
+            bool read_only = false) -> bool;
+
+  /**
+   * @brief 取出 sql 对应的缓存语句，没有时编译并放入缓存
+   * @return sqlite3_prepare_v3 的返回码
+   */
+  auto prepare(std::string_view sql, CachedStatement &stmt) -> int;
+
+  /**
+   * @brief 执行不带参数、不返回行的 SQL（建表、PRAGMA 等）
+   * @return 成功返回true，失败返回false
+   */
+  auto execute(const std::string &sql) -> bool;
+
+  [[nodiscard]] auto handle() const noexcept -> sqlite3 * { return db_; }
+
+  [[nodiscard]] auto mutex() noexcept -> std::mutex & { return mutex_; }
+
+  /// 缓存中的语句数
+  [[nodiscard]] auto cached_statements() const noexcept -> std::size_t {
+    return statements_.size();
+  }
+
+private:
+  struct StringHash {
+    using is_transparent = void;
+    auto operator()(std::string_view text) const noexcept -> std::size_t {
+      return std::hash<std::string_view>{}(text);
+    }
+  };
+
+  sqlite3 *db_ = nullptr;
+  std::mutex mutex_;
+  std::unordered_map<std::string, sqlite3_stmt *, StringHash, std::equal_to<>>
+      statements_;
+};
+
+} // namespace obcx::storage
@@ -15,7 +15,7 @@ auto TelegramCommandHandler::handle_recall_command(
     -> boost::asio::awaitable<void> {
 
   try {
-    const std::string telegram_group_id = event.group_id.value();
+    const std::string telegram_group_id = event.group_id->str();
 
     // 检查是否回复了消息
     if (!event.data.contains("reply_to_message")) {
@@ -38,18 +38,11 @@ auto TelegramCommandHandler::handle_recall_command(
     OBCX_INFO("/recall 命令：尝试撤回回复的Telegram消息 {} 对应的QQ消息",
               replied_message_id);
 
-    // 查找被回复消息对应的QQ消息ID
-    std::optional<std::string> target_qq_message_id;
-
-    // 首先查找该Telegram消息是否已被转发到QQ（回复的是已转发的消息）
-    target_qq_message_id = db_manager_->get_target_message_id(
-        "telegram", replied_message_id, "qq");
-
-    // 如果没找到，再查找该消息是否来源于QQ（回复的是从QQ转发过来的消息）
-    if (!target_qq_message_id.has_value()) {
-      target_qq_message_id = db_manager_->get_source_message_id(
-          "telegram", replied_message_id, "qq");
-    }
+    // 查找被回复消息对应的QQ消息ID：该Telegram消息已被转发到QQ（回复的是
+    // 已转发的消息），或来源于QQ（回复的是从QQ转发过来的消息）
+    auto target_qq_message_id =
+        co_await db_manager_->find_linked_message_id_async(
+            "telegram", replied_message_id, "qq");
 
     if (!target_qq_message_id.has_value()) {
       // 没有找到对应的QQ消息
@@ -77,8 +70,8 @@ auto TelegramCommandHandler::handle_recall_command(
                   target_qq_message_id.value());
 
         // 撤回成功，删除数据库映射
-        db_manager_->delete_message_mapping("telegram", replied_message_id,
-                                            "qq");
+        co_await db_manager_->delete_message_mapping_async(
+            "telegram", replied_message_id, "qq");
         OBCX_DEBUG("已删除消息映射: telegram:{} -> qq:{}", replied_message_id,
                    target_qq_message_id.value());
 
@@ -120,7 +113,7 @@ auto TelegramCommandHandler::handle_recall_command(
 
 auto TelegramCommandHandler::send_reply_message(
     obcx::core::IBot &telegram_bot, const std::string &telegram_group_id,
-    const std::string &reply_to_message_id, const std::string &text)
+    const obcx::common::MessageId &reply_to_message_id, const std::string &text)
     -> boost::asio::awaitable<void> {
 
   try {
@@ -128,7 +121,7 @@ auto TelegramCommandHandler::send_reply_message(
 
     obcx::common::MessageSegment reply_segment;
     reply_segment.type = "reply";
-    reply_segment.data["id"] = reply_to_message_id;
+    reply_segment.data["id"] = reply_to_message_id.str();
     message.push_back(reply_segment);
 
     obcx::common::MessageSegment text_segment;
@@ -148,12 +141,14 @@ auto TelegramCommandHandler::handle_checkalive_command(
     -> boost::asio::awaitable<void> {
 
   try {
-    const std::string telegram_group_id = event.group_id.value();
+    const std::string telegram_group_id = event.group_id->str();
 
     // 获取QQ平台的心跳信息
-    auto qq_heartbeat = db_manager_->get_platform_heartbeat("qq");
+    auto qq_heartbeat =
+        co_await db_manager_->get_platform_heartbeat_async("qq");
     // 获取Telegram平台的心跳信息
-    auto telegram_heartbeat = db_manager_->get_platform_heartbeat("telegram");
+    auto telegram_heartbeat =
+        co_await db_manager_->get_platform_heartbeat_async("telegram");
 
     std::string response_text;
 
@@ -64,7 +64,7 @@ private:
    */
   auto send_reply_message(obcx::core::IBot &telegram_bot,
                           const std::string &telegram_group_id,
-                          const std::string &reply_to_message_id,
+                          const obcx::common::MessageId &reply_to_message_id,
                           const std::string &text)
       -> boost::asio::awaitable<void>;
 };
@@ -40,13 +40,13 @@ auto TelegramEventHandler::handle_message_edited(
       co_return;
     }
 
-    const std::string telegram_group_id = event.group_id.value();
+    const std::string telegram_group_id = event.group_id->str();
     OBCX_INFO("处理Telegram群 {} 中消息 {} 的编辑事件", telegram_group_id,
               event.message_id);
 
     // 查找对应的QQ消息ID
-    auto target_message_id =
-        db_manager_->get_target_message_id("telegram", event.message_id, "qq");
+    auto target_message_id = co_await db_manager_->get_target_message_id_async(
+        "telegram", event.message_id, "qq");
 
     if (!target_message_id.has_value()) {
       OBCX_DEBUG("未找到Telegram消息 {} 对应的QQ消息映射", event.message_id);
@@ -79,6 +79,7 @@ auto TelegramEventHandler::handle_message_edited(
     OBCX_INFO("开始重发编辑后的消息到QQ (撤回状态: {})",
               recall_success ? "成功" : "失败");
 
+    bool resend_failed = false;
     try {
       // 标记此消息为编辑消息，以便forward_function_可以识别并更新映射而非创建新映射
       // 通过在event.data中添加标记
@@ -91,13 +92,18 @@ auto TelegramEventHandler::handle_message_edited(
 
     } catch (const std::exception &e) {
       OBCX_ERROR("重发编辑后的消息时出错: {}", e.what());
+      resend_failed = true;
+    }
 
+    // co_await 不能出现在 catch 块中，失败处理移到块外
+    if (resend_failed) {
       // 如果是撤回成功但重发失败的情况，需要恢复映射或处理
       if (recall_success) {
         OBCX_WARN("撤回成功但重发失败，原QQ消息已被撤回但新消息发送失败");
       } else {
         // 撤回失败且重发也失败时，删除映射避免数据不一致
-        db_manager_->delete_message_mapping("telegram", event.message_id, "qq");
+        co_await db_manager_->delete_message_mapping_async(
+            "telegram", event.message_id, "qq");
         OBCX_WARN("撤回和重发都失败，已删除消息映射");
       }
       co_return;
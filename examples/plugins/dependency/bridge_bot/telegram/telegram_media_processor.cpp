@@ -538,7 +538,8 @@ auto TelegramMediaProcessor::download_sticker_with_cache(
       OBCX_DEBUG("表情包缓存查找，使用file_unique_id: {}", cache_key);
 
       // 查询缓存
-      auto cache_info = db_manager_->get_sticker_cache("telegram", cache_key);
+      auto cache_info =
+          co_await db_manager_->get_sticker_cache_async("telegram", cache_key);
       if (cache_info.has_value()) {
         // 缓存命中，但需要验证文件是否真实存在
         bool file_exists = false;
@@ -563,7 +564,7 @@ auto TelegramMediaProcessor::download_sticker_with_cache(
           // 更新最后使用时间
           obcx::storage::StickerCacheInfo update_info = *cache_info;
           update_info.last_used_at = std::chrono::system_clock::now();
-          db_manager_->save_sticker_cache(update_info);
+          co_await db_manager_->save_sticker_cache_async(update_info);
 
           OBCX_DEBUG("表情包缓存命中: {} -> {}", cache_key,
                      cache_info->container_path);
@@ -725,7 +726,7 @@ auto TelegramMediaProcessor::download_sticker_with_cache(
       }
 
       // 保存到缓存数据库
-      if (!db_manager_->save_sticker_cache(new_cache_info)) {
+      if (!co_await db_manager_->save_sticker_cache_async(new_cache_info)) {
         OBCX_WARN("保存表情包缓存失败，但文件已下载: {}", final_file_path);
       }
     } else {
@@ -766,7 +767,8 @@ auto TelegramMediaProcessor::download_animation_with_cache(
 
       // 查询缓存 - 使用专门的animation缓存表
       auto cache_info =
-          db_manager_->get_sticker_cache("telegram_animation", cache_key);
+          co_await db_manager_->get_sticker_cache_async("telegram_animation",
+                                                        cache_key);
       if (cache_info.has_value()) {
         // 缓存命中，但需要验证文件是否真实存在
         bool file_exists = false;
@@ -791,7 +793,7 @@ auto TelegramMediaProcessor::download_animation_with_cache(
           // 更新最后使用时间
           obcx::storage::StickerCacheInfo update_info = *cache_info;
           update_info.last_used_at = std::chrono::system_clock::now();
-          db_manager_->save_sticker_cache(update_info);
+          co_await db_manager_->save_sticker_cache_async(update_info);
 
           OBCX_DEBUG("动画缓存命中: {} -> {}", cache_key,
                      cache_info->container_path);
@@ -955,7 +957,7 @@ auto TelegramMediaProcessor::download_animation_with_cache(
       }
 
       // 保存到缓存数据库
-      if (!db_manager_->save_sticker_cache(new_cache_info)) {
+      if (!co_await db_manager_->save_sticker_cache_async(new_cache_info)) {
         OBCX_WARN("保存动画缓存失败，但文件已下载: {}", final_file_path);
       }
     } else {
@@ -9,7 +9,7 @@ namespace bridge::telegram {
 auto TelegramMessageFormatter::format_sender_info(
     const obcx::common::MessageEvent &event,
     const GroupBridgeConfig *bridge_config,
-    const std::string &telegram_group_id,
+    const obcx::common::ChatId &telegram_group_id,
     std::vector<obcx::common::MessageSegment> &message_to_send) -> void {
 
   // 根据配置决定是否添加发送者信息
@@ -22,7 +22,7 @@ auto TelegramMessageFormatter::format_sender_info(
     if (event.data.contains("message_thread_id")) {
       message_thread_id = event.data["message_thread_id"].get<int64_t>();
     }
-    const TopicBridgeConfig *topic_config =
+    const auto topic_config =
         get_topic_config(telegram_group_id, message_thread_id);
     show_sender = topic_config ? topic_config->show_tg_to_qq_sender : false;
   }
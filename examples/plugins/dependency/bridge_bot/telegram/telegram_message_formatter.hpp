@@ -26,7 +26,7 @@ public:
   static auto format_sender_info(
       const obcx::common::MessageEvent &event,
       const GroupBridgeConfig *bridge_config,
-      const std::string &telegram_group_id,
+      const obcx::common::ChatId &telegram_group_id,
       std::vector<obcx::common::MessageSegment> &message_to_send) -> void;
 
   /**
@@ -35,8 +35,8 @@ auto TelegramHandler::forward_to_qq(obcx::core::IBot &telegram_bot,
 
   // 更新Telegram平台心跳时间
   if (db_manager_) {
-    db_manager_->update_platform_heartbeat("telegram",
-                                           std::chrono::system_clock::now());
+    co_await db_manager_->update_platform_heartbeat_async(
+        "telegram", std::chrono::system_clock::now());
   }
 
   // 确保是群消息
@@ -44,17 +44,15 @@ auto TelegramHandler::forward_to_qq(obcx::core::IBot &telegram_bot,
     co_return;
   }
 
-  const std::string telegram_group_id = event.group_id.value();
+  const obcx::common::ChatId &telegram_group_id = *event.group_id;
   std::string qq_group_id;
-  const GroupBridgeConfig *bridge_config = nullptr;
 
-  // 查找对应的QQ群ID和桥接配置
-  auto it = GROUP_MAP.find(telegram_group_id);
-  if (it == GROUP_MAP.end()) {
+  // 查找对应的QQ群ID和桥接配置；持有所在的映射快照直到处理结束
+  const auto bridge_config = get_bridge_config(telegram_group_id);
+  if (!bridge_config) {
     OBCX_DEBUG("Telegram群 {} 没有对应的QQ群配置", telegram_group_id);
     co_return;
   }
-  bridge_config = &it->second;
 
   // 根据桥接模式处理转发逻辑
   if (bridge_config->mode == BridgeMode::GROUP_TO_GROUP) {
@@ -75,7 +73,7 @@ auto TelegramHandler::forward_to_qq(obcx::core::IBot &telegram_bot,
       message_thread_id = event.data["message_thread_id"].get<int64_t>();
     }
 
-    const TopicBridgeConfig *topic_config =
+    const auto topic_config =
         get_topic_config(telegram_group_id, message_thread_id);
     if (!topic_config) {
       OBCX_DEBUG("Telegram消息来自topic {}，没有对应的QQ群配置，跳过转发",
@@ -106,7 +104,7 @@ auto TelegramHandler::forward_to_qq(obcx::core::IBot &telegram_bot,
   // 检查是否是 /checkalive 命令
   if (event.raw_message.starts_with("/checkalive")) {
     // 检查群组是否在配置中
-    if (GROUP_MAP.find(telegram_group_id) == GROUP_MAP.end()) {
+    if (!get_bridge_config(telegram_group_id)) {
       OBCX_DEBUG("Telegram群 {} 不在配置中，忽略 /checkalive 命令",
                  telegram_group_id);
       co_return;
@@ -130,7 +128,8 @@ auto TelegramHandler::forward_to_qq(obcx::core::IBot &telegram_bot,
 
   // 检查消息是否已转发（避免重复），但编辑重发时跳过此检查
   if (!is_edited_resend &&
-      db_manager_->get_target_message_id("telegram", event.message_id, "qq")
+      (co_await db_manager_->get_target_message_id_async(
+           "telegram", event.message_id, "qq"))
           .has_value()) {
     OBCX_DEBUG("Telegram消息 {} 已转发到QQ，跳过重复处理", event.message_id);
     co_return;
@@ -145,10 +144,10 @@ auto TelegramHandler::forward_to_qq(obcx::core::IBot &telegram_bot,
 
   try {
     // 保存/更新用户信息
-    db_manager_->save_user_from_event(event, "telegram");
+    co_await db_manager_->save_user_from_event_async(event, "telegram");
 
     // 保存消息信息
-    db_manager_->save_message_from_event(event, "telegram");
+    co_await db_manager_->save_message_from_event_async(event, "telegram");
 
     // 处理回复消息
     std::optional<std::string> reply_to_message_id;
@@ -160,14 +159,10 @@ auto TelegramHandler::forward_to_qq(obcx::core::IBot &telegram_bot,
 
         // 查找被回复消息对应的QQ消息ID
         // 情况1: 如果被回复的TG消息曾经转发到QQ过，找到QQ的消息ID
-        reply_to_message_id = db_manager_->get_target_message_id(
-            "telegram", replied_message_id, "qq");
-
         // 情况2: 如果被回复的TG消息来源于QQ，找到QQ的原始消息ID
-        if (!reply_to_message_id.has_value()) {
-          reply_to_message_id = db_manager_->get_source_message_id(
-              "telegram", replied_message_id, "qq");
-        }
+        reply_to_message_id =
+            co_await db_manager_->find_linked_message_id_async(
+                "telegram", replied_message_id, "qq");
 
         // 如果最终仍未找到映射，从事件数据中移除reply_to_message以避免显示回复提示
         if (!reply_to_message_id.has_value()) {
@@ -189,7 +184,7 @@ auto TelegramHandler::forward_to_qq(obcx::core::IBot &telegram_bot,
 
     // 格式化发送者信息
     telegram::TelegramMessageFormatter::format_sender_info(
-        event, bridge_config, telegram_group_id, message_to_send);
+        event, bridge_config.get(), telegram_group_id, message_to_send);
 
     // 处理媒体文件（从message segments中提取）
     for (const auto &segment : event.message) {
@@ -234,9 +229,9 @@ auto TelegramHandler::forward_to_qq(obcx::core::IBot &telegram_bot,
             // 保存或更新消息映射
             if (is_edited_resend) {
               // 编辑重发：更新现有映射
-              if (!db_manager_->update_message_mapping("telegram",
-                                                       event.message_id, "qq",
-                                                       qq_message_id.value())) {
+              if (!co_await db_manager_->update_message_mapping_async(
+                      "telegram", event.message_id, "qq",
+                      qq_message_id.value())) {
                 OBCX_WARN("更新消息映射失败: telegram:{} -> qq:{}",
                           event.message_id, qq_message_id.value());
               } else {
@@ -252,7 +247,7 @@ auto TelegramHandler::forward_to_qq(obcx::core::IBot &telegram_bot,
               mapping.target_message_id = qq_message_id.value();
               mapping.created_at = std::chrono::system_clock::now();
 
-              if (!db_manager_->add_message_mapping(mapping)) {
+              if (!co_await db_manager_->add_message_mapping_async(mapping)) {
                 OBCX_WARN("保存消息映射失败: telegram:{} -> qq:{}",
                           event.message_id, qq_message_id.value());
               }
@@ -280,9 +275,9 @@ auto TelegramHandler::forward_to_qq(obcx::core::IBot &telegram_bot,
         OBCX_INFO("消息发送失败，添加到重试队列: {} -> {}", event.message_id,
                   qq_group_id);
         retry_manager_->add_message_retry(
-            "telegram", "qq", event.message_id, message_to_send, qq_group_id,
-            telegram_group_id, -1, config::MESSAGE_RETRY_MAX_ATTEMPTS,
-            failure_reason);
+            "telegram", "qq", event.message_id.str(), message_to_send,
+            qq_group_id, telegram_group_id.str(), -1,
+            config::MESSAGE_RETRY_MAX_ATTEMPTS, failure_reason);
       } else if (!qq_message_id.has_value()) {
         // 如果没有启用重试或没有重试管理器，记录错误
         OBCX_ERROR("消息发送失败且未启用重试: {}", failure_reason);
@@ -312,8 +307,8 @@ auto TelegramHandler::handle_message_edited(obcx::core::IBot &telegram_bot,
     -> boost::asio::awaitable<void> {
   // 更新Telegram平台心跳时间
   if (db_manager_) {
-    db_manager_->update_platform_heartbeat("telegram",
-                                           std::chrono::system_clock::now());
+    co_await db_manager_->update_platform_heartbeat_async(
+        "telegram", std::chrono::system_clock::now());
   }
 
   co_await event_handler_->handle_message_edited(telegram_bot, qq_bot, event);
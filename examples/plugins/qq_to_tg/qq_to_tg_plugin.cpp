@@ -1,9 +1,12 @@
 #include "qq_to_tg_plugin.hpp"
 #include "common/logger.hpp"
+#include "onebot11/adapter/event_converter.hpp"
 #include "core/qq_bot.hpp"
 #include "core/tg_bot.hpp"
+#include "network/http_client.hpp"
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/detached.hpp>
+#include <boost/asio/use_awaitable.hpp>
 
 #include "../dependency/bridge_bot/config.hpp"
 #include "../dependency/bridge_bot/database_manager.hpp"
@@ -19,12 +22,23 @@ QQToTGPlugin::~QQToTGPlugin() {
   OBCX_DEBUG("QQToTGPlugin destructor called");
 }
 
-std::string QQToTGPlugin::get_name() const { return "qq_to_tg"; }
+auto QQToTGPlugin::metadata() -> const obcx::interface::PluginMetadata & {
+  static constexpr obcx::interface::PluginMetadata kMetadata{
+      .name = "qq_to_tg",
+      .version = "1.0.0",
+      .description =
+          "QQ to Telegram message forwarding plugin (simplified version)",
+      // 两个桥接插件在 initialize() 中打开并迁移同一个 SQLite 文件
+      .concurrent_init = false};
+  return kMetadata;
+}
+
+std::string QQToTGPlugin::get_name() const { return metadata().name; }
 
-std::string QQToTGPlugin::get_version() const { return "1.0.0"; }
+std::string QQToTGPlugin::get_version() const { return metadata().version; }
 
 std::string QQToTGPlugin::get_description() const {
-  return "QQ to Telegram message forwarding plugin (simplified version)";
+  return metadata().description;
 }
 
 bool QQToTGPlugin::initialize() {
@@ -41,8 +55,19 @@ bool QQToTGPlugin::initialize() {
     }
 
     // Initialize database manager
-    db_manager_ =
-        std::make_shared<obcx::storage::DatabaseManager>(config_.database_file);
+    db_manager_ = std::make_shared<obcx::storage::DatabaseManager>(
+        config_.database_file,
+        obcx::storage::DatabaseOptions{
+            .read_connections = config_.database_read_connections,
+            .mmap_size = config_.database_mmap_mb << 20,
+            .cache_size_kib = config_.database_cache_mb * 1024,
+            .batch_interval = std::chrono::milliseconds(
+                config_.database_batch_interval_ms),
+            .batch_max_rows = config_.database_batch_max_rows,
+            .retention_age =
+                std::chrono::hours(24 * config_.database_retention_days),
+            .retention_max_rows = config_.database_retention_max_rows,
+            .archive_dir = config_.database_archive_dir});
     if (!db_manager_->initialize()) {
       OBCX_ERROR("Failed to initialize database");
       return false;
@@ -50,16 +75,36 @@ bool QQToTGPlugin::initialize() {
 
     // Initialize retry queue manager if enabled
     if (config_.enable_retry_queue) {
-      // Create a dedicated io_context for retry queue
-      static boost::asio::io_context retry_io_context;
-      retry_manager_ = std::make_shared<bridge::RetryQueueManager>(
-          db_manager_, retry_io_context);
+      // 重试队列在独立线程上运行，失败的转发由它按退避时间重发到 Telegram
+      retry_worker_ = std::make_unique<bridge::RetryWorker>(
+          db_manager_, bridge::RetryLimits{.max_concurrent =
+                                               config_.retry_max_concurrent});
+      retry_manager_ = retry_worker_->manager();
+      retry_manager_->register_message_send_callback(
+          "telegram",
+          [this](const obcx::storage::MessageRetryInfo &retry_info,
+                 const obcx::common::Message &message)
+              -> boost::asio::awaitable<
+                  bridge::RetryQueueManager::SendResult> {
+            co_return co_await resend_to_telegram(retry_info, message);
+          });
+      retry_worker_->start();
     }
 
     // Create QQHandler instance
     qq_handler_ =
         std::make_unique<bridge::QQHandler>(db_manager_, retry_manager_);
 
+    // 内置的通知转换器不保留原始字段，撤回处理需要 message_id
+    obcx::adapter::onebot11::EventConverter::register_converter(
+        "notice.group_recall",
+        [](const nlohmann::json &j) -> std::optional<obcx::common::Event> {
+          obcx::common::NoticeEvent event;
+          event.from_json(j);
+          event.data = j;
+          return event;
+        });
+
     // Register event callbacks
     try {
       // 获取所有bot实例的带锁访问
@@ -68,14 +113,22 @@ bool QQToTGPlugin::initialize() {
       // 找到QQ bot并注册消息回调和心跳回调
       for (auto &bot_ptr : bots) {
         if (auto *qq_bot = dynamic_cast<obcx::core::QQBot *>(bot_ptr.get())) {
-          // 注册消息事件回调
-          qq_bot->on_event<obcx::common::MessageEvent>(
+          qq_bot_ = qq_bot;
+          mappings_ = bridge::group_mappings();
+          register_message_handler();
+          OBCX_INFO("Registered QQ message callback for QQ to TG plugin");
+
+          // 注册通知事件回调（撤回同步）
+          qq_bot->on_event<obcx::common::NoticeEvent>(
+              [](const obcx::common::NoticeEvent &event) {
+                return event.notice_type == "group_recall";
+              },
               [this](obcx::core::IBot &bot,
-                     const obcx::common::MessageEvent &event)
+                     const obcx::common::NoticeEvent &event)
                   -> boost::asio::awaitable<void> {
-                co_await handle_qq_message(bot, event);
+                co_await handle_qq_notice(bot, event);
               });
-          OBCX_INFO("Registered QQ message callback for QQ to TG plugin");
+          OBCX_INFO("Registered QQ notice callback for QQ to TG plugin");
 
           // 注册心跳事件回调
           qq_bot->on_event<obcx::common::HeartbeatEvent>(
@@ -94,6 +147,10 @@ bool QQToTGPlugin::initialize() {
       return false;
     }
 
+    // 群映射变化后重建消息过滤条件，否则新增的群收不到消息
+    config_subscription_ = obcx::common::ConfigLoader::instance().subscribe(
+        [this](const auto &) { reload_group_mappings(); });
+
     OBCX_INFO("QQ to TG Plugin initialized successfully");
     return true;
   } catch (const std::exception &e) {
@@ -105,6 +162,19 @@ bool QQToTGPlugin::initialize() {
 void QQToTGPlugin::deinitialize() {
   try {
     OBCX_INFO("Deinitializing QQ to TG Plugin...");
+    obcx::common::ConfigLoader::instance().unsubscribe(config_subscription_);
+    // 等进行中的重发结束或被打断，之后重试线程不再访问 bot
+    if (retry_worker_) {
+      retry_worker_->stop();
+    }
+    {
+      // 等待进行中的重新加载结束，之后不再访问 bot
+      std::lock_guard lock(reload_mutex_);
+      qq_bot_ = nullptr;
+    }
+    // 转换器存放于 obcx_core 中，必须在插件卸载前移除
+    obcx::adapter::onebot11::EventConverter::unregister_converter(
+        "notice.group_recall");
     // Note: Bot callbacks will be automatically cleaned up when plugin is
     // unloaded If needed, specific cleanup can be added here
     OBCX_INFO("QQ to TG Plugin deinitialized successfully");
@@ -128,21 +198,10 @@ boost::asio::awaitable<void> QQToTGPlugin::handle_qq_message(
   // 确保这是QQ bot的消息
   if (auto *qq_bot = dynamic_cast<obcx::core::QQBot *>(&bot)) {
     OBCX_INFO("QQ to TG Plugin: Processing QQ message from group {}",
-              event.group_id.value_or("unknown"));
+              event.group_id ? event.group_id->view() : "unknown");
 
     try {
-      if (!tg_bot_) {
-        auto [lock, bots] = get_bots();
-
-        for (auto &bot_ptr : bots) {
-          if (auto *tg = dynamic_cast<obcx::core::TGBot *>(bot_ptr.get())) {
-            tg_bot_ = tg;
-            break;
-          }
-        }
-      }
-
-      if (tg_bot_ && qq_handler_) {
+      if (find_tg_bot() && qq_handler_) {
         OBCX_INFO("Found Telegram bot, performing QQ->TG message forwarding "
                   "using QQHandler");
         co_await qq_handler_->forward_to_telegram(*tg_bot_, *qq_bot, event);
@@ -157,14 +216,30 @@ boost::asio::awaitable<void> QQToTGPlugin::handle_qq_message(
   co_return;
 }
 
+boost::asio::awaitable<void> QQToTGPlugin::handle_qq_notice(
+    obcx::core::IBot &bot, const obcx::common::NoticeEvent &event) {
+  if (auto *qq_bot = dynamic_cast<obcx::core::QQBot *>(&bot)) {
+    try {
+      if (find_tg_bot() && qq_handler_) {
+        co_await qq_handler_->handle_recall_event(*tg_bot_, *qq_bot,
+                                                  obcx::common::Event{event});
+      }
+    } catch (const std::exception &e) {
+      OBCX_ERROR("Error handling QQ recall event: {}", e.what());
+    }
+  }
+
+  co_return;
+}
+
 boost::asio::awaitable<void> QQToTGPlugin::handle_qq_heartbeat(
     obcx::core::IBot &bot, const obcx::common::HeartbeatEvent &event) {
   // 确保这是QQ bot的心跳
   if (auto *qq_bot = dynamic_cast<obcx::core::QQBot *>(&bot)) {
     // 更新QQ平台的心跳时间
     if (db_manager_) {
-      db_manager_->update_platform_heartbeat("qq",
-                                             std::chrono::system_clock::now());
+      co_await db_manager_->update_platform_heartbeat_async(
+          "qq", std::chrono::system_clock::now());
       OBCX_DEBUG("QQ platform heartbeat updated, interval: {}ms",
                  event.interval);
     }
@@ -173,6 +248,105 @@ boost::asio::awaitable<void> QQToTGPlugin::handle_qq_heartbeat(
   co_return;
 }
 
+auto QQToTGPlugin::message_filter() const -> obcx::core::MessageFilter {
+  // 只接收已配置桥接的群
+  return obcx::core::MessageFilter{
+      .group_ids = bridge::bridged_qq_group_ids(*mappings_),
+      .message_type = "group"};
+}
+
+void QQToTGPlugin::register_message_handler() {
+  message_token_ = qq_bot_->on_event(
+      message_filter(),
+      [this](obcx::core::IBot &bot, const obcx::common::MessageEvent &event)
+          -> boost::asio::awaitable<void> {
+        co_await handle_qq_message(bot, event);
+      },
+      // 同一群的消息按顺序转发，不同群之间并行
+      obcx::core::HandlerPolicy{
+          .name = "qq_to_tg.message",
+          .max_in_flight = config_.max_in_flight,
+          .serial_key = &obcx::core::HandlerPolicy::chat_key});
+}
+
+void QQToTGPlugin::reload_group_mappings() {
+  std::lock_guard lock(reload_mutex_);
+  if (!qq_bot_) {
+    return;
+  }
+
+  // 新映射在一旁构建后整体替换，进行中的转发继续使用各自取得的旧映射，
+  // 不需要暂停分发
+  bridge::load_group_mappings();
+  auto mappings = bridge::group_mappings();
+  if (mappings == mappings_) {
+    return;
+  }
+  mappings_ = std::move(mappings);
+  qq_bot_->dispatcher().replace_filter(message_token_, message_filter());
+  OBCX_INFO("QQ to TG Plugin: message filter rebuilt for {} groups",
+            mappings_->qq_routes.size());
+}
+
+auto QQToTGPlugin::resend_to_telegram(
+    const obcx::storage::MessageRetryInfo &retry_info,
+    const obcx::common::Message &message)
+    -> boost::asio::awaitable<bridge::RetryQueueManager::SendResult> {
+  // 在重试线程上运行，不写入 tg_bot_
+  obcx::core::TGBot *tg_bot = nullptr;
+  {
+    auto [lock, bots] = get_bots();
+    for (auto &bot_ptr : bots) {
+      if (auto *tg = dynamic_cast<obcx::core::TGBot *>(bot_ptr.get())) {
+        tg_bot = tg;
+        break;
+      }
+    }
+  }
+  if (tg_bot == nullptr) {
+    OBCX_WARN("Telegram bot not found for retry to {}", retry_info.group_id);
+    co_return bridge::RetryQueueManager::SendResult{};
+  }
+
+  try {
+    // 发送在 bot 的事件循环上运行，连接状态不跨线程访问；这里只等待结果，
+    // 重试线程停止时放弃等待，所以参数按值交给发送。重发走批量队列，由 bot
+    // 的调度器统一限速，不挡住新消息
+    auto send = [tg_bot, group_id = retry_info.group_id,
+                 topic_id = retry_info.target_topic_id, message] {
+      constexpr auto kPriority = obcx::core::SendPriority::bulk;
+      return topic_id == -1
+                 ? tg_bot->send_group_message(group_id, message, kPriority)
+                 : tg_bot->send_topic_message(group_id, topic_id, message,
+                                              kPriority);
+    };
+    const auto response = co_await retry_manager_->run_send(
+        tg_bot->get_io_context(), std::move(send));
+    co_return bridge::RetryQueueManager::send_result_from_response(response);
+  } catch (const obcx::network::HttpRateLimitError &e) {
+    co_return bridge::RetryQueueManager::SendResult{.retry_after =
+                                                        e.retry_after()};
+  } catch (const std::exception &e) {
+    OBCX_WARN("Retry send to Telegram {} failed: {}", retry_info.group_id,
+              e.what());
+  }
+  co_return bridge::RetryQueueManager::SendResult{};
+}
+
+obcx::core::TGBot *QQToTGPlugin::find_tg_bot() {
+  if (!tg_bot_) {
+    auto [lock, bots] = get_bots();
+
+    for (auto &bot_ptr : bots) {
+      if (auto *tg = dynamic_cast<obcx::core::TGBot *>(bot_ptr.get())) {
+        tg_bot_ = tg;
+        break;
+      }
+    }
+  }
+  return tg_bot_;
+}
+
 bool QQToTGPlugin::load_configuration() {
   try {
     // 从插件配置加载设置
@@ -180,6 +354,26 @@ bool QQToTGPlugin::load_configuration() {
                                 .value_or("bridge_bot.db");
     config_.enable_retry_queue =
         get_config_value<bool>("enable_retry_queue").value_or(false);
+    config_.retry_max_concurrent = static_cast<std::size_t>(
+        get_config_value<int64_t>("retry_max_concurrent").value_or(8));
+    config_.max_in_flight = static_cast<std::size_t>(
+        get_config_value<int64_t>("max_in_flight").value_or(8));
+    config_.database_read_connections = static_cast<std::size_t>(
+        get_config_value<int64_t>("database_read_connections").value_or(2));
+    config_.database_mmap_mb =
+        get_config_value<int64_t>("database_mmap_mb").value_or(256);
+    config_.database_cache_mb =
+        get_config_value<int64_t>("database_cache_mb").value_or(16);
+    config_.database_batch_interval_ms =
+        get_config_value<int64_t>("database_batch_interval_ms").value_or(50);
+    config_.database_batch_max_rows = static_cast<std::size_t>(
+        get_config_value<int64_t>("database_batch_max_rows").value_or(256));
+    config_.database_retention_days =
+        get_config_value<int64_t>("database_retention_days").value_or(0);
+    config_.database_retention_max_rows = static_cast<std::size_t>(
+        get_config_value<int64_t>("database_retention_max_rows").value_or(0));
+    config_.database_archive_dir =
+        get_config_value<std::string>("database_archive_dir").value_or("");
 
     OBCX_INFO("QQ to TG configuration loaded: database={}, retry_queue={}",
               config_.database_file, config_.enable_retry_queue);
@@ -2,20 +2,24 @@
 
 #include "interfaces/plugin.hpp"
 #include <memory>
+#include <mutex>
 
 #include "core/tg_bot.hpp"
 
+#include "../dependency/bridge_bot/retry_queue_manager.hpp"
+
 // Forward declarations
 namespace bridge {
 class QQHandler;
+struct GroupMappings;
 }
 
 namespace obcx::storage {
 class DatabaseManager;
 }
 
-namespace bridge {
-class RetryQueueManager;
+namespace obcx::core {
+class QQBot;
 }
 
 namespace plugins {
@@ -31,6 +35,9 @@ public:
 
   ~QQToTGPlugin() override;
 
+  // 静态元数据，加载器无需构造实例即可读取
+  static auto metadata() -> const obcx::interface::PluginMetadata &;
+
   // IPlugin interface
   std::string get_name() const override;
 
@@ -46,17 +53,54 @@ public:
 
 private:
   obcx::core::TGBot *tg_bot_{nullptr};
+  obcx::core::QQBot *qq_bot_{nullptr};
 
   struct Config {
     std::string database_file = "bridge_bot.db";
     bool enable_retry_queue = false;
+    // 同时进行的重试数上限，0 表示不限
+    std::size_t retry_max_concurrent = 8;
+    // 同时转发的消息数上限，0 表示不限
+    std::size_t max_in_flight = 8;
+    // 数据库只读连接数，0 表示读写共用一个连接
+    std::size_t database_read_connections = 2;
+    // 每个数据库连接的内存映射与页缓存大小（MiB）
+    int64_t database_mmap_mb = 256;
+    int64_t database_cache_mb = 16;
+    // 写入批次的提交间隔（毫秒）与行数上限，间隔为 0 时每次写入立即提交
+    int64_t database_batch_interval_ms = 50;
+    std::size_t database_batch_max_rows = 256;
+    // 消息与映射的保留天数与行数上限，均为 0 时不清理；归档目录为空时
+    // 过期记录直接删除
+    int64_t database_retention_days = 0;
+    std::size_t database_retention_max_rows = 0;
+    std::string database_archive_dir;
   };
 
   bool load_configuration();
 
+  obcx::core::TGBot *find_tg_bot();
+
+  // 重试队列的发送回调，在重试线程上运行
+  auto resend_to_telegram(const obcx::storage::MessageRetryInfo &retry_info,
+                          const obcx::common::Message &message)
+      -> boost::asio::awaitable<bridge::RetryQueueManager::SendResult>;
+
+  // 按 mappings_ 中桥接的群生成消息过滤条件
+  auto message_filter() const -> obcx::core::MessageFilter;
+
+  // 注册只接收已桥接群消息的处理器
+  void register_message_handler();
+
+  // 配置重新加载后重建群映射与消息过滤条件；在配置加载线程上调用
+  void reload_group_mappings();
+
   boost::asio::awaitable<void> handle_qq_message(
       obcx::core::IBot &bot, const obcx::common::MessageEvent &event);
 
+  boost::asio::awaitable<void> handle_qq_notice(
+      obcx::core::IBot &bot, const obcx::common::NoticeEvent &event);
+
   boost::asio::awaitable<void> handle_qq_heartbeat(
       obcx::core::IBot &bot, const obcx::common::HeartbeatEvent &event);
 
@@ -65,7 +109,17 @@ private:
 
   // Bridge components
   std::shared_ptr<obcx::storage::DatabaseManager> db_manager_;
+  // 重试队列及运行它的线程，须在持有 retry_manager_ 的组件之后析构
+  std::unique_ptr<bridge::RetryWorker> retry_worker_;
   std::shared_ptr<bridge::RetryQueueManager> retry_manager_;
   std::unique_ptr<bridge::QQHandler> qq_handler_;
+
+  // 消息处理器的令牌，重建过滤条件时据此替换
+  obcx::core::HandlerToken message_token_;
+  // 生成当前过滤条件的群映射
+  std::shared_ptr<const bridge::GroupMappings> mappings_;
+  uint64_t config_subscription_ = 0;
+  // 串行化配置重新加载与 deinitialize()
+  std::mutex reload_mutex_;
 };
 } // namespace plugins
@@ -4,11 +4,13 @@
 #include "core/tg_bot.hpp"
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/detached.hpp>
+#include <boost/asio/use_awaitable.hpp>
 
 #include "../dependency/bridge_bot/config.hpp"
 #include "../dependency/bridge_bot/database_manager.hpp"
 #include "../dependency/bridge_bot/retry_queue_manager.hpp"
 #include "../dependency/bridge_bot/telegram_handler.hpp"
+#include "common/config_loader.hpp"
 
 namespace plugins {
 TGToQQPlugin::TGToQQPlugin() { OBCX_DEBUG("TGToQQPlugin constructor called"); }
@@ -18,12 +20,23 @@ TGToQQPlugin::~TGToQQPlugin() {
   OBCX_DEBUG("TGToQQPlugin destructor called");
 }
 
-std::string TGToQQPlugin::get_name() const { return "tg_to_qq"; }
+auto TGToQQPlugin::metadata() -> const obcx::interface::PluginMetadata & {
+  static constexpr obcx::interface::PluginMetadata kMetadata{
+      .name = "tg_to_qq",
+      .version = "1.0.0",
+      .description =
+          "Telegram to QQ message forwarding plugin (simplified version)",
+      // 两个桥接插件在 initialize() 中打开并迁移同一个 SQLite 文件
+      .concurrent_init = false};
+  return kMetadata;
+}
+
+std::string TGToQQPlugin::get_name() const { return metadata().name; }
 
-std::string TGToQQPlugin::get_version() const { return "1.0.0"; }
+std::string TGToQQPlugin::get_version() const { return metadata().version; }
 
 std::string TGToQQPlugin::get_description() const {
-  return "Telegram to QQ message forwarding plugin (simplified version)";
+  return metadata().description;
 }
 
 bool TGToQQPlugin::initialize() {
@@ -40,8 +53,19 @@ bool TGToQQPlugin::initialize() {
     }
 
     // Initialize database manager
-    db_manager_ =
-        std::make_shared<obcx::storage::DatabaseManager>(config_.database_file);
+    db_manager_ = std::make_shared<obcx::storage::DatabaseManager>(
+        config_.database_file,
+        obcx::storage::DatabaseOptions{
+            .read_connections = config_.database_read_connections,
+            .mmap_size = config_.database_mmap_mb << 20,
+            .cache_size_kib = config_.database_cache_mb * 1024,
+            .batch_interval = std::chrono::milliseconds(
+                config_.database_batch_interval_ms),
+            .batch_max_rows = config_.database_batch_max_rows,
+            .retention_age =
+                std::chrono::hours(24 * config_.database_retention_days),
+            .retention_max_rows = config_.database_retention_max_rows,
+            .archive_dir = config_.database_archive_dir});
     if (!db_manager_->initialize()) {
       OBCX_ERROR("Failed to initialize database");
       return false;
@@ -49,10 +73,20 @@ bool TGToQQPlugin::initialize() {
 
     // Initialize retry queue manager if enabled
     if (config_.enable_retry_queue) {
-      // Create a dedicated io_context for retry queue
-      static boost::asio::io_context retry_io_context;
-      retry_manager_ = std::make_shared<bridge::RetryQueueManager>(
-          db_manager_, retry_io_context);
+      // 重试队列在独立线程上运行，失败的转发由它按退避时间重发到 QQ
+      retry_worker_ = std::make_unique<bridge::RetryWorker>(
+          db_manager_, bridge::RetryLimits{.max_concurrent =
+                                               config_.retry_max_concurrent});
+      retry_manager_ = retry_worker_->manager();
+      retry_manager_->register_message_send_callback(
+          "qq",
+          [this](const obcx::storage::MessageRetryInfo &retry_info,
+                 const obcx::common::Message &message)
+              -> boost::asio::awaitable<
+                  bridge::RetryQueueManager::SendResult> {
+            co_return co_await resend_to_qq(retry_info, message);
+          });
+      retry_worker_->start();
     }
 
     // Create TelegramHandler instance
@@ -67,12 +101,9 @@ bool TGToQQPlugin::initialize() {
       // 找到Telegram bot并注册消息回调
       for (auto &bot_ptr : bots) {
         if (auto *tg_bot = dynamic_cast<obcx::core::TGBot *>(bot_ptr.get())) {
-          tg_bot->on_event<obcx::common::MessageEvent>(
-              [this](obcx::core::IBot &bot,
-                     const obcx::common::MessageEvent &event)
-                  -> boost::asio::awaitable<void> {
-                co_await handle_tg_message(bot, event);
-              });
+          tg_bot_ = tg_bot;
+          mappings_ = bridge::group_mappings();
+          register_message_handler();
           OBCX_INFO("Registered Telegram message callback for TG to QQ plugin");
           break;
         }
@@ -82,6 +113,10 @@ bool TGToQQPlugin::initialize() {
       return false;
     }
 
+    // 群映射变化后重建消息过滤条件，否则新增的群收不到消息
+    config_subscription_ = obcx::common::ConfigLoader::instance().subscribe(
+        [this](const auto &) { reload_group_mappings(); });
+
     OBCX_INFO("TG to QQ Plugin initialized successfully");
     return true;
   } catch (const std::exception &e) {
@@ -93,6 +128,16 @@ bool TGToQQPlugin::initialize() {
 void TGToQQPlugin::deinitialize() {
   try {
     OBCX_INFO("Deinitializing TG to QQ Plugin...");
+    obcx::common::ConfigLoader::instance().unsubscribe(config_subscription_);
+    // 等进行中的重发结束或被打断，之后重试线程不再访问 bot
+    if (retry_worker_) {
+      retry_worker_->stop();
+    }
+    {
+      // 等待进行中的重新加载结束，之后不再访问 bot
+      std::lock_guard lock(reload_mutex_);
+      tg_bot_ = nullptr;
+    }
     // Note: Bot callbacks will be automatically cleaned up when plugin is
     // unloaded If needed, specific cleanup can be added here
     OBCX_INFO("TG to QQ Plugin deinitialized successfully");
@@ -111,12 +156,52 @@ void TGToQQPlugin::shutdown() {
   }
 }
 
+auto TGToQQPlugin::message_filter() const -> obcx::core::MessageFilter {
+  // 只接收已配置桥接的群
+  return obcx::core::MessageFilter{
+      .group_ids = bridge::bridged_telegram_group_ids(*mappings_),
+      .message_type = "group"};
+}
+
+void TGToQQPlugin::register_message_handler() {
+  message_token_ = tg_bot_->on_event(
+      message_filter(),
+      [this](obcx::core::IBot &bot, const obcx::common::MessageEvent &event)
+          -> boost::asio::awaitable<void> {
+        co_await handle_tg_message(bot, event);
+      },
+      // 同一群的消息按顺序转发，不同群之间并行
+      obcx::core::HandlerPolicy{
+          .name = "tg_to_qq.message",
+          .max_in_flight = config_.max_in_flight,
+          .serial_key = &obcx::core::HandlerPolicy::chat_key});
+}
+
+void TGToQQPlugin::reload_group_mappings() {
+  std::lock_guard lock(reload_mutex_);
+  if (!tg_bot_) {
+    return;
+  }
+
+  // 新映射在一旁构建后整体替换，进行中的转发继续使用各自取得的旧映射，
+  // 不需要暂停分发
+  bridge::load_group_mappings();
+  auto mappings = bridge::group_mappings();
+  if (mappings == mappings_) {
+    return;
+  }
+  mappings_ = std::move(mappings);
+  tg_bot_->dispatcher().replace_filter(message_token_, message_filter());
+  OBCX_INFO("TG to QQ Plugin: message filter rebuilt for {} groups",
+            mappings_->groups.size());
+}
+
 boost::asio::awaitable<void> TGToQQPlugin::handle_tg_message(
     obcx::core::IBot &bot, const obcx::common::MessageEvent &event) {
   // 确保这是Telegram bot的消息
   if (auto *tg_bot = dynamic_cast<obcx::core::TGBot *>(&bot)) {
     OBCX_INFO("TG to QQ Plugin: Processing Telegram message from chat {}",
-              event.group_id.value_or("unknown"));
+              event.group_id ? event.group_id->view() : "unknown");
 
     try {
       // 获取所有bot实例的带锁访问
@@ -158,12 +243,68 @@ boost::asio::awaitable<void> TGToQQPlugin::handle_tg_message(
   co_return;
 }
 
+auto TGToQQPlugin::resend_to_qq(
+    const obcx::storage::MessageRetryInfo &retry_info,
+    const obcx::common::Message &message)
+    -> boost::asio::awaitable<bridge::RetryQueueManager::SendResult> {
+  // 在重试线程上运行，不写入 qq_bot_
+  obcx::core::QQBot *qq_bot = nullptr;
+  {
+    auto [lock, bots] = get_bots();
+    for (auto &bot_ptr : bots) {
+      if (auto *qq = dynamic_cast<obcx::core::QQBot *>(bot_ptr.get())) {
+        qq_bot = qq;
+        break;
+      }
+    }
+  }
+  if (qq_bot == nullptr) {
+    OBCX_WARN("QQ bot not found for retry to {}", retry_info.group_id);
+    co_return bridge::RetryQueueManager::SendResult{};
+  }
+
+  try {
+    // 发送在 bot 的事件循环上运行，连接状态不跨线程访问；这里只等待结果，
+    // 重试线程停止时放弃等待，所以参数按值交给发送
+    auto send = [qq_bot, group_id = retry_info.group_id, message] {
+      return qq_bot->send_group_message(group_id, message);
+    };
+    const auto response = co_await retry_manager_->run_send(
+        qq_bot->get_io_context(), std::move(send));
+    co_return bridge::RetryQueueManager::send_result_from_response(response);
+  } catch (const std::exception &e) {
+    OBCX_WARN("Retry send to QQ {} failed: {}", retry_info.group_id,
+              e.what());
+  }
+  co_return bridge::RetryQueueManager::SendResult{};
+}
+
 bool TGToQQPlugin::load_configuration() {
   try {
     config_.database_file = get_config_value<std::string>("database_file")
                                 .value_or("bridge_bot.db");
     config_.enable_retry_queue =
         get_config_value<bool>("enable_retry_queue").value_or(false);
+    config_.retry_max_concurrent = static_cast<std::size_t>(
+        get_config_value<int64_t>("retry_max_concurrent").value_or(8));
+    config_.max_in_flight = static_cast<std::size_t>(
+        get_config_value<int64_t>("max_in_flight").value_or(8));
+    config_.database_read_connections = static_cast<std::size_t>(
+        get_config_value<int64_t>("database_read_connections").value_or(2));
+    config_.database_mmap_mb =
+        get_config_value<int64_t>("database_mmap_mb").value_or(256);
+    config_.database_cache_mb =
+        get_config_value<int64_t>("database_cache_mb").value_or(16);
+    config_.database_batch_interval_ms =
+        get_config_value<int64_t>("database_batch_interval_ms").value_or(50);
+    config_.database_batch_max_rows = static_cast<std::size_t>(
+        get_config_value<int64_t>("database_batch_max_rows").value_or(256));
+    config_.database_retention_days =
+        get_config_value<int64_t>("database_retention_days").value_or(0);
+    config_.database_retention_max_rows = static_cast<std::size_t>(
+        get_config_value<int64_t>("database_retention_max_rows").value_or(0));
+    config_.database_archive_dir =
+        get_config_value<std::string>("database_archive_dir").value_or("");
 
     OBCX_INFO("TG to QQ configuration loaded: database={}, retry_queue={}",
               config_.database_file, config_.enable_retry_queue);
@@ -35,15 +35,26 @@ TorrentDownloaderPlugin::~TorrentDownloaderPlugin() {
   OBCX_DEBUG("TorrentDownloaderPlugin destructor called");
 }
 
+auto TorrentDownloaderPlugin::metadata()
+    -> const obcx::interface::PluginMetadata & {
+  static constexpr obcx::interface::PluginMetadata kMetadata{
+      .name = "torrent_downloader",
+      .version = "2.0.0",
+      .description = "Torrent downloader plugin with qBittorrent WebAPI and "
+                     "Google Drive upload"};
+  return kMetadata;
+}
+
 std::string TorrentDownloaderPlugin::get_name() const {
-  return "torrent_downloader";
+  return metadata().name;
 }
 
-std::string TorrentDownloaderPlugin::get_version() const { return "2.0.0"; }
+std::string TorrentDownloaderPlugin::get_version() const {
+  return metadata().version;
+}
 
 std::string TorrentDownloaderPlugin::get_description() const {
-  return "Torrent downloader plugin with qBittorrent WebAPI and Google Drive "
-         "upload";
+  return metadata().description;
 }
 
 bool TorrentDownloaderPlugin::initialize() {
@@ -64,7 +75,15 @@ bool TorrentDownloaderPlugin::initialize() {
 
       for (auto &bot_ptr : bots) {
         if (auto *tg_bot = dynamic_cast<obcx::core::TGBot *>(bot_ptr.get())) {
-          tg_bot->on_event<obcx::common::MessageEvent>(
+          tg_bot->on_event(
+              obcx::core::MessageFilter{.commands = {"/status", "/reupload"}},
+              [this](obcx::core::IBot &bot,
+                     const obcx::common::MessageEvent &event)
+                  -> boost::asio::awaitable<void> {
+                co_await handle_tg_command(bot, event);
+              });
+          tg_bot->on_event(
+              obcx::core::MessageFilter{.predicate = &is_download_request},
               [this](obcx::core::IBot &bot,
                      const obcx::common::MessageEvent &event)
                   -> boost::asio::awaitable<void> {
@@ -220,16 +239,30 @@ bool TorrentDownloaderPlugin::load_configuration() {
   }
 }
 
-boost::asio::awaitable<void> TorrentDownloaderPlugin::handle_tg_message(
-    obcx::core::IBot &bot, const obcx::common::MessageEvent &event) {
+bool TorrentDownloaderPlugin::is_download_request(
+    const obcx::common::MessageEvent &event) {
+  if (event.raw_message.find("magnet:?xt=urn:btih:") != std::string::npos) {
+    return true;
+  }
+  for (const auto &segment : event.message) {
+    if (segment.type == "file" || segment.type == "document") {
+      auto it = segment.data.find("file_name");
+      if (it != segment.data.end() && it->is_string() &&
+          it->get_ref<const std::string &>().ends_with(".torrent")) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
 
-  auto *tg_bot = dynamic_cast<obcx::core::TGBot *>(&bot);
-  if (!tg_bot) {
+boost::asio::awaitable<void> TorrentDownloaderPlugin::handle_tg_command(
+    obcx::core::IBot &bot, const obcx::common::MessageEvent &event) {
+  if (dynamic_cast<obcx::core::TGBot *>(&bot) == nullptr) {
     co_return;
   }
 
-  std::string chat_id =
-      event.group_id.has_value() ? event.group_id.value() : event.user_id;
+  std::string chat_id = event.group_id.value_or(event.user_id).str();
 
   // Check for /status command
   if (event.raw_message.starts_with("/status")) {
@@ -254,9 +287,19 @@ boost::asio::awaitable<void> TorrentDownloaderPlugin::handle_tg_message(
     } else {
       co_await handle_reupload_command(bot, chat_id, task_id);
     }
+  }
+}
+
+boost::asio::awaitable<void> TorrentDownloaderPlugin::handle_tg_message(
+    obcx::core::IBot &bot, const obcx::common::MessageEvent &event) {
+
+  auto *tg_bot = dynamic_cast<obcx::core::TGBot *>(&bot);
+  if (!tg_bot) {
     co_return;
   }
 
+  std::string chat_id = event.group_id.value_or(event.user_id).str();
+
   std::string error_msg;
   bool has_error = false;
 
@@ -28,6 +28,9 @@ public:
   TorrentDownloaderPlugin();
   ~TorrentDownloaderPlugin() override;
 
+  // 静态元数据，加载器无需构造实例即可读取
+  static auto metadata() -> const obcx::interface::PluginMetadata &;
+
   // IPlugin interface
   std::string get_name() const override;
   std::string get_version() const override;
@@ -87,6 +90,12 @@ private:
   boost::asio::awaitable<void> handle_tg_message(
       obcx::core::IBot &bot, const obcx::common::MessageEvent &event);
 
+  boost::asio::awaitable<void> handle_tg_command(
+      obcx::core::IBot &bot, const obcx::common::MessageEvent &event);
+
+  // 消息中是否含有磁力链接或 .torrent 文件，在分发时同步判断
+  static bool is_download_request(const obcx::common::MessageEvent &event);
+
   // Download handlers
   boost::asio::awaitable<void> start_download(obcx::core::TGBot &bot,
                                               const std::string &chat_id,
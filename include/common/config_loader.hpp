@@ -1,34 +1,59 @@
 #pragma once
 
+#include "common/config_snapshot.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <toml++/toml.hpp>
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace obcx::common {
 
-struct BotConfig {
-  std::string type;
-  bool enabled;
-  toml::table connection;
-  std::vector<std::string> plugins;
-};
-
-struct PluginConfig {
-  std::string name;
-  bool enabled;
-  toml::table config;
-  std::vector<std::string> callbacks;
-};
-
+/**
+ * \~chinese
+ * @brief 全局配置加载器
+ *
+ * 配置以不可变的 ConfigSnapshot 发布，读取时只原子地取出当前快照，不加锁
+ * 也不拷贝 TOML 树。load_config() 与 reload_config() 解析成功后原子地替换
+ * 快照并通知订阅者；解析失败时保留原快照。
+ *
+ * \~english
+ * @brief Process-wide configuration loader.
+ *
+ * Configuration is published as an immutable ConfigSnapshot; readers
+ * atomically take the current snapshot without locking or copying the TOML
+ * tree. load_config() and reload_config() swap in a new snapshot after a
+ * successful parse and notify subscribers; a failed parse keeps the
+ * previous snapshot.
+ */
 class ConfigLoader {
+public:
+  using Listener =
+      std::function<void(const std::shared_ptr<const ConfigSnapshot> &)>;
+
+private:
   ConfigLoader() = default;
+  // 串行化加载，使快照与通知按版本顺序发生；读者只读取 snapshot_
+  std::mutex load_mutex_;
+  // 保护路径、订阅者列表与正在调用的订阅者
   mutable std::mutex mutex_;
-  std::unique_ptr<toml::table> config_data_;
+  // 正在调用的订阅者结束时通知，unsubscribe() 在此等待
+  std::condition_variable listener_done_;
+  std::atomic<std::shared_ptr<const ConfigSnapshot>> snapshot_;
   std::string config_path_;
+  uint64_t version_ = 0;
+  uint64_t next_listener_ = 1;
+  std::vector<std::pair<uint64_t, Listener>> listeners_;
+  // 正在调用的订阅者 ID（0 表示没有）及调用它的线程
+  uint64_t notifying_ = 0;
+  std::thread::id notifying_thread_;
 
 public:
   static ConfigLoader &instance() {
@@ -43,6 +68,52 @@ public:
 
   bool load_config(const std::string &config_path);
 
+  /**
+   * \~chinese
+   * @brief 当前配置快照，未加载时为空
+   *
+   * 无锁读取。返回的快照在持有期间保持有效，即使之后发布了新快照；
+   * 热路径上可以持有一份快照读取多个键。
+   *
+   * \~english
+   * @brief Current configuration snapshot; null before loading.
+   *
+   * Lock-free. The returned snapshot stays valid while held, even after a
+   * newer one is published; hot paths may hold one snapshot for several
+   * lookups.
+   */
+  std::shared_ptr<const ConfigSnapshot> snapshot() const {
+    return snapshot_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * \~chinese
+   * @brief 订阅配置重新加载，新快照发布后在加载线程上调用
+   * @return 传给 unsubscribe() 的 ID
+   *
+   * \~english
+   * @brief Subscribes to config reloads; called on the loading thread after
+   * a new snapshot is published.
+   * @return ID to pass to unsubscribe().
+   */
+  uint64_t subscribe(Listener listener);
+
+  /**
+   * \~chinese
+   * @brief 取消订阅
+   *
+   * 该订阅者正在其他线程上被调用时，等到调用返回；返回后不会再被调用。
+   * 可以在订阅者内部取消自己的订阅。
+   *
+   * \~english
+   * @brief Unsubscribes a listener.
+   *
+   * If the listener is running on another thread, waits for it to return;
+   * it is never called after this returns. A listener may unsubscribe
+   * itself.
+   */
+  void unsubscribe(uint64_t id);
+
   std::vector<BotConfig> get_bot_configs() const;
 
   std::optional<PluginConfig> get_plugin_config(
@@ -52,50 +123,30 @@ public:
 
   template <typename T>
   std::optional<T> get_value(const std::string &key) const {
-    std::lock_guard lock(mutex_);
-    if (!config_data_) {
+    const auto current = snapshot();
+    if (!current) {
       return std::nullopt;
     }
-
-    auto node = config_data_->at_path(key);
-    if (!node) {
-      return std::nullopt;
-    }
-
-    if constexpr (std::is_same_v<T, std::string>) {
-      if (auto val = node.value<std::string>()) {
-        return *val;
-      }
-    } else if constexpr (std::is_same_v<T, int64_t>) {
-      if (auto val = node.value<int64_t>()) {
-        return *val;
-      }
-    } else if constexpr (std::is_same_v<T, double>) {
-      if (auto val = node.value<double>()) {
-        return *val;
-      }
-    } else if constexpr (std::is_same_v<T, bool>) {
-      if (auto val = node.value<bool>()) {
-        return *val;
-      }
-    }
-
-    return std::nullopt;
+    return current->get<T>(key);
   }
 
   std::optional<toml::table> get_section(const std::string &section_name) const;
 
-  void reload_config();
+  /**
+   * \~chinese @brief 从上次加载的路径重新加载
+   * @return 是否发布了新快照
+   *
+   * \~english @brief Reloads from the last loaded path.
+   * @return Whether a new snapshot was published.
+   */
+  bool reload_config();
 
-  bool is_loaded() const {
-    std::lock_guard lock(mutex_);
-    return config_data_ != nullptr;
-  }
+  bool is_loaded() const { return snapshot() != nullptr; }
 
-  const std::string &get_config_path() const {
+  std::string get_config_path() const {
     std::lock_guard lock(mutex_);
     return config_path_;
   }
 };
 
-} // namespace obcx::common
\ No newline at end of file
+} // namespace obcx::common
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <toml++/toml.hpp>
+#include <type_traits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace obcx::common {
+
+struct BotConfig {
+  std::string type;
+  bool enabled;
+  toml::table connection;
+  std::vector<std::string> plugins;
+};
+
+struct PluginConfig {
+  std::string name;
+  bool enabled;
+  toml::table config;
+  std::vector<std::string> callbacks;
+};
+
+/**
+ * \~chinese
+ * @brief 展平后的配置标量表
+ *
+ * 构造时遍历 TOML 表，把每个字符串、整数、浮点数和布尔值按路径存入
+ * 哈希表。路径与 toml++ 的 at_path 语法一致（a.b.c、list[0]），查找只是
+ * 一次哈希查询，不再遍历 TOML 树。
+ *
+ * \~english
+ * @brief Flattened table of config scalars.
+ *
+ * The constructor walks a TOML table and stores every string, integer,
+ * float and boolean under its path. Paths use toml++'s at_path syntax
+ * (a.b.c, list[0]), so a lookup is one hash probe instead of a tree walk.
+ */
+class ConfigValues {
+public:
+  using Value = std::variant<bool, int64_t, double, std::string>;
+
+  ConfigValues() = default;
+  explicit ConfigValues(const toml::table &table);
+
+  /**
+   * \~chinese
+   * @brief 按路径读取一个值
+   *
+   * 与 toml++ 的 value<T>() 相同，整数与浮点数在无损时可以互相转换，
+   * 其余类型不匹配时返回 std::nullopt。
+   *
+   * \~english
+   * @brief Reads a value by path.
+   *
+   * Like toml++'s value<T>(), integers and floats convert into each other
+   * when lossless; any other type mismatch yields std::nullopt.
+   */
+  template <typename T>
+  [[nodiscard]] auto get(std::string_view key) const -> std::optional<T> {
+    static_assert(std::is_same_v<T, std::string> ||
+                      std::is_same_v<T, int64_t> ||
+                      std::is_same_v<T, double> || std::is_same_v<T, bool>,
+                  "配置值只支持 std::string、int64_t、double 与 bool");
+    const auto *value = find(key);
+    if (value == nullptr) {
+      return std::nullopt;
+    }
+    if (const auto *exact = std::get_if<T>(value)) {
+      return *exact;
+    }
+    if constexpr (std::is_same_v<T, double>) {
+      if (const auto *integer = std::get_if<int64_t>(value)) {
+        return static_cast<double>(*integer);
+      }
+    } else if constexpr (std::is_same_v<T, int64_t>) {
+      if (const auto *number = std::get_if<double>(value);
+          number != nullptr && std::trunc(*number) == *number &&
+          *number >= -0x1p63 && *number < 0x1p63) {
+        return static_cast<int64_t>(*number);
+      }
+    }
+    return std::nullopt;
+  }
+
+  /// 路径对应的值，不存在时返回 nullptr / Value at a path, or nullptr
+  [[nodiscard]] auto find(std::string_view key) const -> const Value *;
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    return values_.size();
+  }
+
+private:
+  struct StringHash {
+    using is_transparent = void;
+    auto operator()(std::string_view text) const noexcept -> std::size_t {
+      return std::hash<std::string_view>{}(text);
+    }
+  };
+
+  std::unordered_map<std::string, Value, StringHash, std::equal_to<>>
+      values_;
+};
+
+/**
+ * \~chinese @brief 快照中一个插件的配置，values 以 config 表为根
+ * \~english @brief One plugin's config in a snapshot; values are rooted at
+ * the config table.
+ */
+struct PluginSnapshot {
+  PluginConfig info;
+  ConfigValues values;
+};
+
+/**
+ * \~chinese
+ * @brief 不可变的配置快照
+ *
+ * 一次加载配置文件的完整结果：原始 TOML 表、展平的标量、以及预先解析的
+ * Bot 与插件配置。快照创建后不再修改，可以不加锁地在任意线程读取；
+ * ConfigLoader 重新加载时发布新快照，持有旧快照的读者不受影响。
+ *
+ * \~english
+ * @brief Immutable configuration snapshot.
+ *
+ * The complete result of loading a config file: the raw TOML table, the
+ * flattened scalars, and pre-parsed bot and plugin configs. A snapshot is
+ * never modified after construction, so any thread may read it without
+ * locking; ConfigLoader publishes a new snapshot on reload and readers
+ * holding the old one are unaffected.
+ */
+class ConfigSnapshot {
+public:
+  /**
+   * \~chinese @param version 发布序号，每次重新加载递增
+   * \~english @param version Publication number, incremented on every
+   * reload.
+   */
+  ConfigSnapshot(toml::table root, uint64_t version);
+
+  ConfigSnapshot(const ConfigSnapshot &) = delete;
+  auto operator=(const ConfigSnapshot &) -> ConfigSnapshot & = delete;
+
+  /// 原始 TOML 表 / The raw TOML table
+  [[nodiscard]] auto table() const noexcept -> const toml::table & {
+    return root_;
+  }
+
+  [[nodiscard]] auto version() const noexcept -> uint64_t { return version_; }
+
+  /// 按完整路径读取标量，如 "metrics.port" / Reads a scalar by full path
+  template <typename T>
+  [[nodiscard]] auto get(std::string_view key) const -> std::optional<T> {
+    return values_.get<T>(key);
+  }
+
+  /**
+   * \~chinese @brief [plugins.<name>] 的配置；没有该插件时返回 nullptr
+   * \~english @brief Config of [plugins.<name>], or nullptr if absent.
+   */
+  [[nodiscard]] auto plugin(std::string_view name) const
+      -> const PluginSnapshot *;
+
+  /// 按名称排序的全部插件 / All plugins, ordered by name
+  [[nodiscard]] auto plugins() const noexcept
+      -> const std::vector<PluginSnapshot> & {
+    return plugins_;
+  }
+
+  /// 按名称排序的全部 Bot / All bots, ordered by name
+  [[nodiscard]] auto bots() const noexcept -> const std::vector<BotConfig> & {
+    return bots_;
+  }
+
+private:
+  toml::table root_;
+  uint64_t version_;
+  ConfigValues values_;
+  std::vector<BotConfig> bots_;
+  std::vector<PluginSnapshot> plugins_;
+};
+
+} // namespace obcx::common
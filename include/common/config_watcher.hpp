@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace obcx::common {
+
+/**
+ * \~chinese
+ * @brief 监视配置文件的变化
+ *
+ * 在后台线程上用 inotify 监视配置文件所在目录，文件被写入、替换
+ * （编辑器常用的写临时文件再 rename）或重新创建后，等待 debounce 时长内
+ * 不再有新的变化，再调用一次回调。回调通常是 ConfigLoader::reload_config()，
+ * 新快照在监视线程上解析和发布，Bot 的事件循环不会停顿。
+ *
+ * \~english
+ * @brief Watches the configuration file for changes.
+ *
+ * A background thread watches the file's directory with inotify. After the
+ * file is written, replaced (editors often write a temp file and rename it)
+ * or recreated, and no further change arrives within the debounce period,
+ * the callback runs once. The callback is usually
+ * ConfigLoader::reload_config(), so the new snapshot is parsed and published
+ * on the watcher thread without pausing any bot's event loop.
+ */
+class ConfigWatcher {
+public:
+  static constexpr std::chrono::milliseconds kDefaultDebounce{200};
+
+  ConfigWatcher(std::string path, std::function<void()> on_change,
+                std::chrono::milliseconds debounce = kDefaultDebounce);
+  ~ConfigWatcher();
+
+  ConfigWatcher(const ConfigWatcher &) = delete;
+  auto operator=(const ConfigWatcher &) -> ConfigWatcher & = delete;
+
+  /**
+   * \~chinese @brief 开始监视
+   * @return inotify 不可用或目录无法监视时返回 false
+   *
+   * \~english @brief Starts watching.
+   * @return false if inotify is unavailable or the directory cannot be
+   * watched.
+   */
+  auto start() -> bool;
+
+  /// 停止并等待监视线程退出 / Stops and joins the watcher thread
+  void stop();
+
+private:
+  void run();
+
+  std::string path_;
+  std::function<void()> on_change_;
+  std::chrono::milliseconds debounce_;
+  int inotify_fd_ = -1;
+  // 写入后唤醒监视线程以退出
+  int wake_fd_ = -1;
+  std::thread thread_;
+};
+
+} // namespace obcx::common
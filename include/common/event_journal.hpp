@@ -0,0 +1,234 @@
+#pragma once
+
+#include "common/message_type.hpp"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace obcx::common {
+
+/**
+ * \~chinese
+ * @brief 日志记录的方向
+ *
+ * \~english
+ * @brief Direction of a journal record.
+ */
+enum class JournalDirection : uint8_t {
+  inbound = 0, ///< 收到的原始帧 / raw frame received
+  outbound = 1 ///< 发出的动作请求 / action request sent
+};
+
+/**
+ * \~chinese
+ * @brief 一条日志记录
+ *
+ * \~english
+ * @brief One journal record.
+ */
+struct JournalRecord {
+  JournalDirection direction = JournalDirection::inbound;
+  /// 自日志打开起的单调时钟时间 / Monotonic time since the journal opened
+  std::chrono::nanoseconds timestamp{0};
+  std::string payload;
+};
+
+/**
+ * \~chinese
+ * @brief 连接层流量日志的写入端
+ *
+ * 把收到的原始帧与发出的动作请求按到达顺序追加到二进制文件，用于离线回放
+ * 与压测。文件格式：
+ * - 文件头："OBCXJNL\0"、版本号（u8）、标志（u8，bit0 表示 zstd 压缩）、
+ *   协议名（u16 长度 + 字节）、打开时的系统时间（u64，Unix 纳秒），
+ *   整数均为小端序；
+ * - 记录：方向（u8）、与上一条记录的时间差（varint，纳秒）、
+ *   负载长度（varint）、负载。启用压缩时，全部记录构成一个 zstd 流。
+ *
+ * 记录先写入内存缓冲区，缓冲区满、flush() 或析构时才写入文件，
+ * 进程崩溃时可能丢失最后一个缓冲区。线程安全。
+ *
+ * \~english
+ * @brief Writer for the connection-level traffic journal.
+ *
+ * Appends raw inbound frames and outbound action requests, in arrival order,
+ * to a binary file for offline replay and load testing. File format:
+ * - header: "OBCXJNL\0", version (u8), flags (u8, bit0 = zstd), protocol name
+ *   (u16 length + bytes), wall-clock time at open (u64, Unix nanoseconds);
+ *   integers are little-endian;
+ * - records: direction (u8), time since the previous record (varint, ns),
+ *   payload length (varint), payload. With compression, all records form a
+ *   single zstd stream.
+ *
+ * Records are buffered in memory and written out when the buffer fills, on
+ * flush() or on destruction; a crash may lose the last buffer. Thread-safe.
+ */
+class JournalWriter {
+public:
+  struct Options {
+    /// 使用 zstd 压缩；构建时未启用 OBCX_JOURNAL_ZSTD 则忽略
+    bool compress = false;
+    /// 写入文件前在内存中累积的字节数
+    std::size_t buffer_size = 64 * 1024;
+  };
+
+  /**
+   * \~chinese
+   * @brief 创建（覆盖）日志文件
+   * @param path 文件路径
+   * @param protocol 协议名，回放时据此选择协议适配器（"onebot11"、"telegram"）
+   * @param options 压缩与缓冲选项
+   * @throws std::runtime_error 无法打开文件时
+   *
+   * \~english
+   * @brief Creates (truncates) the journal file.
+   * @param path File path.
+   * @param protocol Protocol name used by replay to pick the adapter
+   * ("onebot11", "telegram").
+   * @param options Compression and buffering options.
+   * @throws std::runtime_error If the file cannot be opened.
+   */
+  JournalWriter(const std::string &path, std::string_view protocol,
+                Options options);
+  JournalWriter(const std::string &path, std::string_view protocol)
+      : JournalWriter(path, protocol, Options{}) {}
+
+  ~JournalWriter();
+
+  JournalWriter(const JournalWriter &) = delete;
+  auto operator=(const JournalWriter &) -> JournalWriter & = delete;
+
+  /**
+   * \~chinese
+   * @brief 按连接配置打开日志
+   * @return 未配置 journal_path 或打开失败（已记录错误日志）时返回 nullptr
+   *
+   * \~english
+   * @brief Opens a journal as configured on the connection.
+   * @return nullptr if journal_path is unset or opening failed (logged).
+   */
+  static auto open_for(const ConnectionConfig &config,
+                       std::string_view protocol)
+      -> std::unique_ptr<JournalWriter>;
+
+  /**
+   * \~chinese
+   * @brief 当前构建是否支持 zstd 压缩
+   *
+   * \~english
+   * @brief Whether this build supports zstd compression.
+   */
+  static auto compression_supported() noexcept -> bool;
+
+  /**
+   * \~chinese
+   * @brief 追加一条记录
+   *
+   * \~english
+   * @brief Appends one record.
+   */
+  void record(JournalDirection direction, std::string_view payload);
+
+  /**
+   * \~chinese
+   * @brief 把缓冲的记录写入文件
+   *
+   * \~english
+   * @brief Writes buffered records to the file.
+   */
+  void flush();
+
+private:
+  struct Compressor;
+
+  // 调用方需持有 mutex_
+  void write_out(bool flush_stream);
+
+  std::mutex mutex_;
+  std::ofstream file_;
+  Options options_;
+  std::unique_ptr<Compressor> compressor_;
+  std::string buffer_;
+  std::chrono::steady_clock::time_point last_;
+};
+
+/**
+ * \~chinese
+ * @brief 按顺序读取 JournalWriter 写出的日志
+ *
+ * \~english
+ * @brief Reads a journal written by JournalWriter, in order.
+ */
+class JournalReader {
+public:
+  /**
+   * \~chinese
+   * @brief 打开日志并读取文件头
+   * @throws std::runtime_error 文件无法打开、格式不符，或为压缩日志而当前
+   * 构建不支持 zstd
+   *
+   * \~english
+   * @brief Opens the journal and reads its header.
+   * @throws std::runtime_error If the file cannot be opened, is not a journal,
+   * or is compressed and this build lacks zstd support.
+   */
+  explicit JournalReader(const std::string &path);
+  ~JournalReader();
+
+  JournalReader(const JournalReader &) = delete;
+  auto operator=(const JournalReader &) -> JournalReader & = delete;
+
+  [[nodiscard]] auto protocol() const noexcept -> const std::string & {
+    return protocol_;
+  }
+  [[nodiscard]] auto compressed() const noexcept -> bool { return compressed_; }
+  /// 日志打开时的系统时间 / Wall-clock time when the journal was opened
+  [[nodiscard]] auto started_at() const noexcept
+      -> std::chrono::system_clock::time_point {
+    return started_at_;
+  }
+
+  /**
+   * \~chinese
+   * @brief 读取下一条记录，时间戳为自日志打开起的累计时间
+   * @return 读到文件末尾时返回 std::nullopt
+   *
+   * \~english
+   * @brief Reads the next record; its timestamp is cumulative since open.
+   * @return std::nullopt at end of file.
+   */
+  auto next() -> std::optional<JournalRecord>;
+
+  /**
+   * \~chinese
+   * @brief 文件是否在记录中间结束（写入端未正常关闭）
+   *
+   * \~english
+   * @brief Whether the file ended mid-record (writer was not closed cleanly).
+   */
+  [[nodiscard]] auto truncated() const noexcept -> bool { return truncated_; }
+
+private:
+  struct Decompressor;
+
+  /// 确保缓冲区中至少有 n 个未读字节
+  auto ensure(std::size_t n) -> bool;
+  auto read_varint(uint64_t &value) -> bool;
+
+  std::ifstream file_;
+  std::unique_ptr<Decompressor> decompressor_;
+  std::string protocol_;
+  bool compressed_ = false;
+  bool truncated_ = false;
+  std::chrono::system_clock::time_point started_at_;
+  std::chrono::nanoseconds elapsed_{0};
+  std::string pending_;
+  std::size_t pos_ = 0;
+};
+
+} // namespace obcx::common
@@ -0,0 +1,315 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fmt/format.h>
+#include <functional>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace obcx::common {
+
+/**
+ * \if CHINESE
+ * @brief ID所属平台
+ * \endif
+ * \if ENGLISH
+ * @brief Platform an ID belongs to
+ * \endif
+ */
+enum class Platform : uint8_t { unknown, qq, telegram };
+
+namespace detail {
+
+/// 驻留池中的一条非数字ID文本，最后一个引用它的 Id 析构时从池中删除
+struct InternedText {
+  std::string text;
+  std::atomic<uint32_t> refs{1};
+};
+
+} // namespace detail
+
+/**
+ * \if CHINESE
+ * @brief 紧凑的聊天/用户/消息ID值类型
+ *
+ * 数字ID以64位整数保存，并在对象内部缓存其十进制文本，因此转换为
+ * std::string_view 不需要任何堆分配；非数字ID（如 Telegram 的
+ * `@channel`）会被驻留到全局字符串池中，只保存一个指针。
+ * 比较和哈希只涉及整数或指针，对象大小为32字节。池中的文本按引用计数，
+ * 复制非数字ID只增加计数，最后一个引用它的 Id 析构时从池中删除，池的
+ * 大小只取决于仍在使用的ID。
+ * \endif
+ * \if ENGLISH
+ * @brief Compact chat/user/message ID value type
+ *
+ * Numeric IDs are stored as a 64-bit integer with their decimal text cached
+ * inline, so converting to std::string_view never allocates. Non-numeric IDs
+ * (e.g. Telegram `@channel` names) are interned into a process-wide pool and
+ * only a pointer is kept. Comparison and hashing touch an integer or pointer
+ * only; the object is 32 bytes. Pooled text is reference counted: copying a
+ * non-numeric ID bumps the count and the entry is removed when the last Id
+ * referring to it is destroyed, so the pool only holds IDs still in use.
+ * \endif
+ */
+class Id {
+public:
+  constexpr Id() noexcept = default;
+
+  Id(const Id &other) noexcept {
+    copy_fields(other);
+    retain();
+  }
+
+  Id(Id &&other) noexcept {
+    copy_fields(other);
+    other.forget_text();
+  }
+
+  auto operator=(const Id &other) noexcept -> Id & {
+    if (this != &other) {
+      release();
+      copy_fields(other);
+      retain();
+    }
+    return *this;
+  }
+
+  auto operator=(Id &&other) noexcept -> Id & {
+    if (this != &other) {
+      release();
+      copy_fields(other);
+      other.forget_text();
+    }
+    return *this;
+  }
+
+  ~Id() { release(); }
+
+  /**
+   * \if CHINESE
+   * @brief 从整数构造数字ID
+   * \endif
+   * \if ENGLISH
+   * @brief Constructs a numeric ID
+   * \endif
+   */
+  explicit Id(int64_t value, Platform platform = Platform::unknown) noexcept;
+
+  /**
+   * \if CHINESE
+   * @brief 从文本构造ID，规范的十进制整数会被存为数字ID
+   * \endif
+   * \if ENGLISH
+   * @brief Constructs an ID from text; canonical decimal integers are stored
+   * as numeric IDs
+   * \endif
+   */
+  explicit Id(std::string_view text, Platform platform = Platform::unknown);
+
+  /**
+   * \if CHINESE
+   * @brief 从无符号整数构造ID，超出 int64_t 范围的值按十进制文本保存
+   * \endif
+   * \if ENGLISH
+   * @brief Constructs an ID from an unsigned integer; values beyond the
+   * int64_t range are kept as decimal text
+   * \endif
+   */
+  [[nodiscard]] static auto from_unsigned(uint64_t value,
+                                          Platform platform = Platform::unknown)
+      -> Id;
+
+  [[nodiscard]] auto platform() const noexcept -> Platform {
+    return platform_;
+  }
+  [[nodiscard]] auto is_numeric() const noexcept -> bool {
+    return kind_ == Kind::numeric;
+  }
+  [[nodiscard]] auto empty() const noexcept -> bool {
+    return kind_ == Kind::empty;
+  }
+
+  /**
+   * \if CHINESE
+   * @brief 获取数字值，非数字ID返回 std::nullopt
+   * \endif
+   * \if ENGLISH
+   * @brief Returns the numeric value, or std::nullopt for non-numeric IDs
+   * \endif
+   */
+  [[nodiscard]] auto as_int() const noexcept -> std::optional<int64_t> {
+    if (kind_ == Kind::numeric) {
+      return number_;
+    }
+    return std::nullopt;
+  }
+
+  [[nodiscard]] auto view() const noexcept -> std::string_view {
+    if (kind_ == Kind::text) {
+      return interned_->text;
+    }
+    return {digits_, length_};
+  }
+
+  /**
+   * \if CHINESE
+   * @brief 以NUL结尾的文本，生命周期与ID相同
+   * \endif
+   * \if ENGLISH
+   * @brief NUL-terminated text, valid as long as the ID
+   * \endif
+   */
+  [[nodiscard]] auto c_str() const noexcept -> const char * {
+    return kind_ == Kind::text ? interned_->text.c_str() : digits_;
+  }
+
+  [[nodiscard]] auto str() const -> std::string { return std::string(view()); }
+
+  [[nodiscard]] auto hash() const noexcept -> std::size_t;
+
+  /**
+   * \if CHINESE
+   * @brief 驻留池中的非数字ID文本数
+   * \endif
+   * \if ENGLISH
+   * @brief Number of non-numeric ID texts in the intern pool
+   * \endif
+   */
+  [[nodiscard]] static auto interned_count() -> std::size_t;
+
+  operator std::string_view() const noexcept { return view(); }
+
+  /**
+   * \if CHINESE
+   * @brief 两个ID相等要求平台标记也相同：QQ群 123 与 Telegram 群 123
+   * 不是同一个会话
+   * \endif
+   * \if ENGLISH
+   * @brief IDs are equal only if their platform tags match too: QQ group 123
+   * and Telegram group 123 are different chats
+   * \endif
+   */
+  friend auto operator==(const Id &lhs, const Id &rhs) noexcept -> bool {
+    if (lhs.kind_ != rhs.kind_ || lhs.platform_ != rhs.platform_) {
+      return false;
+    }
+    switch (lhs.kind_) {
+    case Kind::numeric:
+      return lhs.number_ == rhs.number_;
+    case Kind::text:
+      return lhs.interned_ == rhs.interned_;
+    default:
+      return true;
+    }
+  }
+
+  /**
+   * \if CHINESE
+   * @brief 只比较文本，忽略平台标记。用于和配置文件等不带平台信息的
+   * 字符串比较；需要区分平台时先构造带标记的 Id 再比较
+   * \endif
+   * \if ENGLISH
+   * @brief Compares the text only and ignores the platform tag. Meant for
+   * strings without platform information such as config values; construct a
+   * tagged Id first when the platform matters
+   * \endif
+   */
+  friend auto operator==(const Id &lhs, std::string_view rhs) noexcept
+      -> bool {
+    return lhs.view() == rhs;
+  }
+
+private:
+  enum class Kind : uint8_t { empty, numeric, text };
+
+  // "-9223372036854775808" 加 NUL
+  static constexpr std::size_t kMaxDigits = 21;
+
+  /// 减少驻留文本的引用计数，归零时从池中删除
+  static void release_text(detail::InternedText *text) noexcept;
+
+  void copy_fields(const Id &other) noexcept {
+    if (other.kind_ == Kind::text) {
+      interned_ = other.interned_;
+    } else {
+      number_ = other.number_;
+    }
+    platform_ = other.platform_;
+    kind_ = other.kind_;
+    length_ = other.length_;
+    std::copy(std::begin(other.digits_), std::end(other.digits_), digits_);
+  }
+
+  void retain() const noexcept {
+    if (kind_ == Kind::text) {
+      interned_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  void release() noexcept {
+    if (kind_ == Kind::text) {
+      release_text(interned_);
+    }
+  }
+
+  // 引用已转交给另一个 Id；数字ID照常保留原值
+  void forget_text() noexcept {
+    if (kind_ == Kind::text) {
+      number_ = 0;
+      kind_ = Kind::empty;
+    }
+  }
+
+  union {
+    int64_t number_ = 0;
+    detail::InternedText *interned_;
+  };
+  Platform platform_ = Platform::unknown;
+  Kind kind_ = Kind::empty;
+  uint8_t length_ = 0;
+  char digits_[kMaxDigits] = {};
+};
+
+/**
+ * \if CHINESE
+ * @brief 语义别名，底层均为 Id
+ * \endif
+ * \if ENGLISH
+ * @brief Semantic aliases, all backed by Id
+ * \endif
+ */
+using ChatId = Id;
+using UserId = Id;
+using MessageId = Id;
+
+/*
+ * \if CHINESE
+ * JSON 序列化：数字ID输出为数字，其余输出为字符串
+ * \endif
+ * \if ENGLISH
+ * JSON serialization: numeric IDs are written as numbers, others as strings
+ * \endif
+ */
+void to_json(nlohmann::json &j, const Id &id);
+void from_json(const nlohmann::json &j, Id &id);
+
+} // namespace obcx::common
+
+template <> struct std::hash<obcx::common::Id> {
+  auto operator()(const obcx::common::Id &id) const noexcept -> std::size_t {
+    return id.hash();
+  }
+};
+
+template <>
+struct fmt::formatter<obcx::common::Id> : fmt::formatter<std::string_view> {
+  auto format(const obcx::common::Id &id, format_context &ctx) const
+      -> format_context::iterator {
+    return fmt::formatter<std::string_view>::format(id.view(), ctx);
+  }
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string_view>
+
+namespace obcx::common {
+
+/**
+ * \~chinese
+ * @brief 入站JSON解析后端
+ *
+ * 接收路径（OneBot 事件、Telegram 更新）统一经由此处解析。编译时通过
+ * CMake 选项 OBCX_JSON_SIMDJSON 选择 simdjson，否则使用 nlohmann。
+ * 面向插件的接口始终是 nlohmann::json，后端只影响解析速度。
+ *
+ * \~english
+ * @brief Inbound JSON parsing backend
+ *
+ * The receive path (OneBot events, Telegram updates) parses through here. The
+ * CMake option OBCX_JSON_SIMDJSON selects simdjson at build time, otherwise
+ * nlohmann is used. The plugin-facing API is always nlohmann::json; the backend
+ * only affects parsing speed.
+ */
+namespace JsonBackend {
+
+enum class Kind { nlohmann, simdjson };
+
+/**
+ * \~chinese
+ * @brief 编译时选定的后端
+ *
+ * \~english
+ * @brief The backend selected at build time.
+ */
+auto active() noexcept -> Kind;
+
+/**
+ * \~chinese
+ * @brief 后端名称，用于日志与基准测试输出
+ *
+ * \~english
+ * @brief Backend name, for logs and benchmark output.
+ */
+auto name() noexcept -> std::string_view;
+
+/**
+ * \~chinese
+ * @brief 使用当前后端解析JSON文本，并构造为 nlohmann::json
+ * @param text JSON文本
+ * @return 解析结果；文本无效时返回 std::nullopt（不抛异常）
+ *
+ * \~english
+ * @brief Parses JSON text with the active backend into an nlohmann::json.
+ * @param text The JSON text.
+ * @return The parsed value; std::nullopt on invalid input (never throws).
+ */
+auto parse(std::string_view text) -> std::optional<nlohmann::json>;
+
+/**
+ * \~chinese
+ * @brief 不构造 DOM，从JSON文本中读出顶层对象某个字段的原始值
+ *
+ * 只跟踪括号深度与字符串边界，找到字段后即返回，不检查其后的文本。用于
+ * 在完整解析前区分消息种类，例如 OneBot 的事件与 API 响应。
+ * @param text JSON文本
+ * @param key 字段名，不含转义字符
+ * @return 字段值的原始文本，字符串带引号且不反转义；顶层对象没有该字段
+ *         时返回空视图；文本不是对象、格式错误或字段值为对象/数组时返回
+ *         std::nullopt
+ *
+ * \~english
+ * @brief Reads the raw value of a top-level field without building a DOM.
+ *
+ * Only bracket depth and string boundaries are tracked, and the scan stops at
+ * the field, so the rest of the text is not validated. Used to classify a
+ * message before parsing it, e.g. OneBot events versus API responses.
+ * @param text The JSON text.
+ * @param key The field name, without escape sequences.
+ * @return The raw value text, strings quoted and still escaped; an empty view
+ *         if the top-level object has no such field; std::nullopt if the text
+ *         is not an object, is malformed, or the value is an object/array.
+ */
+auto peek_field(std::string_view text, std::string_view key)
+    -> std::optional<std::string_view>;
+
+} // namespace JsonBackend
+
+} // namespace obcx::common
@@ -1,8 +1,13 @@
 #pragma once
 
+#include "id.hpp"
+
+#include <initializer_list>
 #include <nlohmann/json.hpp>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace obcx::common {
 
@@ -34,11 +39,12 @@ namespace JsonUtils {
  * @return The retrieved value or the default value.
  */
 template <typename T>
-auto get_value(const json &j, const std::string &key,
+auto get_value(const json &j, std::string_view key,
                const T &default_value = T{}) -> T {
-  if (j.contains(key) && !j[key].is_null()) {
+  auto it = j.find(key);
+  if (it != j.end() && !it->is_null()) {
     try {
-      return j[key].get<T>();
+      return it->template get<T>();
     } catch (const json::exception &) {
       return default_value;
     }
@@ -62,10 +68,11 @@ auto get_value(const json &j, const std::string &key,
  * @return An std::optional-wrapped value.
  */
 template <typename T>
-std::optional<T> get_optional(const json &j, const std::string &key) {
-  if (j.contains(key) && !j[key].is_null()) {
+std::optional<T> get_optional(const json &j, std::string_view key) {
+  auto it = j.find(key);
+  if (it != j.end() && !it->is_null()) {
     try {
-      return j[key].get<T>();
+      return it->template get<T>();
     } catch (const json::exception &) {
       return std::nullopt;
     }
@@ -91,7 +98,7 @@ std::optional<T> get_optional(const json &j, const std::string &key) {
  * @return std::string The ID as a string. Returns empty string if not found or
  * not a string/number.
  */
-auto get_id_as_string(const json &j, const std::string &key) -> std::string;
+auto get_id_as_string(const json &j, std::string_view key) -> std::string;
 
 /**
  * \~chinese
@@ -111,9 +118,41 @@ auto get_id_as_string(const json &j, const std::string &key) -> std::string;
  * @return std::optional<std::string> The ID as a string if present, otherwise
  * std::nullopt.
  */
-auto get_optional_id_as_string(const json &j, const std::string &key)
+auto get_optional_id_as_string(const json &j, std::string_view key)
     -> std::optional<std::string>;
 
+/**
+ * \~chinese
+ * @brief 从JSON中获取一个ID字段并构造为紧凑的 Id，数字ID不会经过字符串转换。
+ *
+ * @param j JSON对象
+ * @param key ID字段名
+ * @param platform ID所属平台
+ * @return Id 字段不存在或不是字符串/数字时返回空ID
+ *
+ * \~english
+ * @brief Gets an ID field from JSON as a compact Id; numeric IDs never go
+ * through a string conversion.
+ *
+ * @param j The json object.
+ * @param key The key for the ID field.
+ * @param platform The platform the ID belongs to.
+ * @return Id An empty Id if not found or not a string/number.
+ */
+auto get_id(const json &j, std::string_view key,
+            Platform platform = Platform::unknown) -> Id;
+
+/**
+ * \~chinese
+ * @brief 从JSON中获取一个可选的ID字段并构造为紧凑的 Id。
+ *
+ * \~english
+ * @brief Gets an optional ID field from JSON as a compact Id.
+ */
+auto get_optional_id(const json &j, std::string_view key,
+                     Platform platform = Platform::unknown)
+    -> std::optional<Id>;
+
 /**
  * \~chinese
  * @brief 安全地设置JSON值
@@ -130,7 +169,7 @@ auto get_optional_id_as_string(const json &j, const std::string &key)
  * @param value The value.
  */
 template <typename T>
-void set_value(json &j, const std::string &key, const T &value) {
+void set_value(json &j, std::string_view key, const T &value) {
   j[key] = value;
 }
 
@@ -150,7 +189,7 @@ void set_value(json &j, const std::string &key, const T &value) {
  * @param value The optional value.
  */
 template <typename T>
-void set_optional(json &j, const std::string &key,
+void set_optional(json &j, std::string_view key,
                   const std::optional<T> &value) {
   if (value.has_value()) {
     j[key] = value.value();
@@ -173,6 +212,17 @@ void set_optional(json &j, const std::string &key,
 bool validate_required_fields(const json &j,
                               const std::vector<std::string> &required_fields);
 
+/**
+ * \~chinese
+ * @brief 验证JSON是否包含必需的字段（字面量列表，不构造临时字符串）
+ *
+ * \~english
+ * @brief Validates required fields given as literals, without building
+ * temporary strings.
+ */
+bool validate_required_fields(
+    const json &j, std::initializer_list<std::string_view> required_fields);
+
 /**
  * \~chinese
  * @brief 合并两个JSON对象
@@ -214,7 +264,62 @@ auto pretty_print(const json &j, int indent = 2) -> std::string;
  * @param str The JSON string.
  * @return An optional containing the parsed result.
  */
-std::optional<json> parse(const std::string &str);
+std::optional<json> parse(std::string_view str);
+
+/**
+ * \~chinese
+ * @brief 预先解析的JSON指针路径
+ *
+ * 构造时一次性完成分段与 ~0/~1 反转义，之后的查找不再分配内存，适合在
+ * 热路径中以 static 常量形式复用。路径格式非法时 valid() 为 false，
+ * 查找总是失败。
+ *
+ * \~english
+ * @brief A pre-parsed JSON pointer path
+ *
+ * Splitting and ~0/~1 unescaping happen once at construction; lookups then
+ * never allocate, so instances are meant to be reused as static constants on
+ * hot paths. When the path is malformed valid() is false and every lookup
+ * fails.
+ */
+class JsonPath {
+public:
+  explicit JsonPath(std::string_view path);
+
+  [[nodiscard]] auto valid() const noexcept -> bool { return valid_; }
+  [[nodiscard]] auto tokens() const noexcept
+      -> const std::vector<std::string> & {
+    return tokens_;
+  }
+
+private:
+  std::vector<std::string> tokens_;
+  bool valid_ = true;
+};
+
+/**
+ * \~chinese
+ * @brief 按JSON指针路径查找值，不抛出异常
+ * @param j JSON对象
+ * @param path JSON指针路径 (如 "/data/message")
+ * @return 指向目标值的指针；路径不存在或格式非法时返回 nullptr
+ *
+ * \~english
+ * @brief Looks up a value by JSON pointer path without throwing.
+ * @param j The JSON object.
+ * @param path The JSON pointer path (e.g., "/data/message").
+ * @return A pointer to the value; nullptr if absent or malformed.
+ */
+auto find_path(const json &j, std::string_view path) noexcept -> const json *;
+
+/**
+ * \~chinese
+ * @brief 按预先解析的路径查找值，不抛出异常，不分配内存
+ *
+ * \~english
+ * @brief Looks up a value by a pre-parsed path; never throws or allocates.
+ */
+auto find_path(const json &j, const JsonPath &path) noexcept -> const json *;
 
 /**
  * \~chinese
@@ -229,12 +334,15 @@ std::optional<json> parse(const std::string &str);
  * @param path The JSON pointer path (e.g., "/data/message").
  * @return True if the path exists, false otherwise.
  */
-auto has_path(const json &j, const std::string &path) -> bool;
+auto has_path(const json &j, std::string_view path) -> bool;
+
+auto has_path(const json &j, const JsonPath &path) -> bool;
 
 /**
  * \~chinese
  * @brief 通过路径获取JSON值
  * @tparam T 值类型
+ * @tparam Path std::string_view 或 JsonPath
  * @param j JSON对象
  * @param path JSON指针路径
  * @param default_value 默认值
@@ -243,24 +351,26 @@ auto has_path(const json &j, const std::string &path) -> bool;
  * \~english
  * @brief Gets a JSON value by path.
  * @tparam T The value type.
+ * @tparam Path std::string_view or JsonPath.
  * @param j The JSON object.
  * @param path The JSON pointer path.
  * @param default_value The default value.
  * @return The retrieved value or the default value.
  */
-template <typename T>
-auto get_by_path(const json &j, const std::string &path,
-                 const T &default_value = T{}) -> T {
+template <typename T, typename Path = std::string_view>
+auto get_by_path(const json &j, const Path &path, const T &default_value = T{})
+    -> T {
+  const json *value = find_path(j, path);
+  if (value == nullptr || value->is_null()) {
+    return default_value;
+  }
   try {
-    auto ptr = json::json_pointer(path);
-    if (j.contains(ptr)) {
-      return j[ptr].get<T>();
-    }
+    return value->template get<T>();
   } catch (const json::exception &) {
-    // \~chinese 忽略路径错误
-    // \~english Ignore path errors
+    // \~chinese 类型不匹配时返回默认值
+    // \~english Fall back to the default value on type mismatch
+    return default_value;
   }
-  return default_value;
 }
 } // namespace JsonUtils
 
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <mutex>
+#include <spdlog/async_logger.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/spdlog.h>
 #include <string>
+#include <vector>
 
 /*
  * \if CHINESE
@@ -21,6 +26,46 @@
 
 namespace obcx::common {
 
+/**
+ * \if CHINESE
+ * @brief 异步日志选项
+ * \endif
+ * \if ENGLISH
+ * @brief Options for asynchronous logging.
+ * \endif
+ */
+struct AsyncLogOptions {
+  /**
+   * \if CHINESE
+   * 队列容量（条）
+   * \endif
+   * \if ENGLISH
+   * Queue capacity in messages
+   * \endif
+   */
+  std::size_t queue_size = 8192;
+  /**
+   * \if CHINESE
+   * 后台写日志的线程数；多于 1 个时不同线程写出的日志可能乱序
+   * \endif
+   * \if ENGLISH
+   * Number of background writer threads; with more than one, messages
+   * may be written out of order
+   * \endif
+   */
+  std::size_t threads = 1;
+  /**
+   * \if CHINESE
+   * 队列满时的策略：block 等待空位；overrun_oldest 丢弃最旧的一条
+   * \endif
+   * \if ENGLISH
+   * Policy when the queue is full: block waits for space, overrun_oldest
+   * drops the oldest queued message
+   * \endif
+   */
+  spdlog::async_overflow_policy overflow = spdlog::async_overflow_policy::block;
+};
+
 /**
  * \if CHINESE
  * @brief 日志管理器，提供统一的日志接口
@@ -56,6 +101,28 @@ public:
    */
   static auto get() -> std::shared_ptr<spdlog::logger>;
 
+  /**
+   * \if CHINESE
+   * @brief 获取默认日志器的裸指针，供日志宏使用
+   *
+   * 不复制 shared_ptr，没有引用计数的原子操作。被替换的日志器连同其使用
+   * 的线程池会一直保留，因此返回的指针在进程内始终有效、始终可写。
+   * \endif
+   * \if ENGLISH
+   * @brief Gets a raw pointer to the default logger, used by the macros.
+   *
+   * Avoids copying the shared_ptr and its atomic refcount. Replaced loggers
+   * are kept alive together with their thread pools, so the pointer stays
+   * valid and usable for the whole process.
+   * \endif
+   */
+  static auto raw() -> spdlog::logger * {
+    if (auto *logger = raw_logger_.load(std::memory_order_acquire)) {
+      return logger;
+    }
+    return get().get();
+  }
+
   /**
    * \if CHINESE
    * @brief 获取指定名称的日志器
@@ -86,17 +153,109 @@ public:
    */
   static void flush();
 
+  /**
+   * \if CHINESE
+   * @brief 切换到异步模式：日志调用只把消息放入队列，由后台线程写入输出
+   *
+   * 沿用当前日志器的输出与级别。已处于异步模式时按新选项重建，旧队列中
+   * 的日志在返回前写出。
+   * @param options 队列容量、线程数与队列满时的策略
+   * \endif
+   * \if ENGLISH
+   * @brief Switches to asynchronous mode: log calls only enqueue the message
+   * and background threads write it to the sinks.
+   *
+   * Keeps the sinks and level of the current logger. Rebuilds with the new
+   * options if already asynchronous; the old queue is written out before
+   * returning.
+   * @param options Queue capacity, thread count and overflow policy.
+   * \endif
+   */
+  static void enable_async(const AsyncLogOptions &options = {});
+
+  /**
+   * \if CHINESE
+   * @brief 切换回同步模式，写完队列中剩余的日志后停止后台线程
+   *
+   * 退出前调用，以免丢失尚未写出的日志。
+   * \endif
+   * \if ENGLISH
+   * @brief Switches back to synchronous mode, writing out everything still
+   * queued before stopping the background threads.
+   *
+   * Call before exiting so that queued messages are not lost.
+   * \endif
+   */
+  static void disable_async();
+
+  /**
+   * \if CHINESE
+   * @brief 异步模式下因队列满被丢弃的日志条数
+   * \endif
+   * \if ENGLISH
+   * @brief Number of messages dropped because the async queue was full.
+   * \endif
+   */
+  static auto dropped() -> std::size_t;
+
 private:
-  static std::shared_ptr<spdlog::logger> default_logger_;
-  static bool initialized_;
+  /**
+   * \if CHINESE
+   * 替换默认日志器，调用方持有 mutex_。旧日志器连同当前线程池移入
+   * retired_：其他线程可能刚通过 raw() 取得旧日志器，仍会向该线程池写入
+   * \endif
+   * \if ENGLISH
+   * Replaces the default logger; the caller holds mutex_. The old logger
+   * moves to retired_ together with the current thread pool, since other
+   * threads may have just fetched it through raw() and still enqueue to
+   * that pool
+   * \endif
+   */
+  static void install(std::shared_ptr<spdlog::logger> logger);
+
+  struct Retired {
+    std::shared_ptr<spdlog::logger> logger;
+    // 异步日志器只持有线程池的 weak_ptr，由这里保活
+    std::shared_ptr<spdlog::details::thread_pool> pool;
+  };
+
+  // 串行化初始化与日志器替换；读者只读取 default_logger_ 与 raw_logger_
+  static std::mutex mutex_;
+  static std::atomic<std::shared_ptr<spdlog::logger>> default_logger_;
+  static std::atomic<spdlog::logger *> raw_logger_;
+  static std::vector<Retired> retired_;
+  static std::shared_ptr<spdlog::details::thread_pool> thread_pool_;
+  static std::size_t pool_threads_;
+  static std::atomic<bool> initialized_;
 };
 
 /*
  * \if CHINESE
- * 便利宏定义
+ * 编译期日志级别下限，取 SPDLOG_LEVEL_* 的值。低于该级别的 OBCX_* 调用
+ * 在编译时被整体移除，参数不会被求值。由 CMake 选项 OBCX_ACTIVE_LEVEL 设置
+ * \endif
+ * \if ENGLISH
+ * Lowest log level compiled in, as a SPDLOG_LEVEL_* value. OBCX_* calls
+ * below it are removed at compile time and their arguments are never
+ * evaluated. Set through the CMake option OBCX_ACTIVE_LEVEL
+ * \endif
+ */
+#ifndef OBCX_ACTIVE_LEVEL
+#define OBCX_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
+
+#define OBCX_LEVEL_ACTIVE(__level)                                             \
+  (static_cast<int>(spdlog::level::__level) >= OBCX_ACTIVE_LEVEL)
+
+/*
+ * \if CHINESE
+ * 便利宏定义。运行时级别在求值参数之前检查，被过滤的日志不会执行参数中的
+ * 表达式（如 j.dump()）
  * \endif
  * \if ENGLISH
- * Convenience macro definitions
+ * Convenience macro definitions. The runtime level is checked before the
+ * arguments are evaluated, so filtered calls never run expressions such as
+ * j.dump()
  * \endif
  */
 #ifdef OBCX_DEBUG_TRACE
@@ -110,13 +269,17 @@ private:
  */
 #define OBCX_LOG_IMPL(__level, __fmt_str, ...)                                 \
   do {                                                                         \
-    if (obcx::common::Logger::get()->should_log(spdlog::level::__level)) {     \
-      obcx::common::Logger::get()->log(                                        \
-          spdlog::level::__level,                                              \
-          fmt::format("{} " __fmt_str,                                         \
-                      fmt::styled(fmt::format("[{}:{}]", __FILE__, __LINE__),  \
-                                  fmt::fg(fmt::color::dark_orange)),           \
-                      ##__VA_ARGS__));                                         \
+    if constexpr (OBCX_LEVEL_ACTIVE(__level)) {                                \
+      if (auto *obcx_logger_ = obcx::common::Logger::raw();                    \
+          obcx_logger_->should_log(spdlog::level::__level)) {                  \
+        obcx_logger_->log(                                                     \
+            spdlog::level::__level,                                            \
+            fmt::format(                                                       \
+                "{} " __fmt_str,                                               \
+                fmt::styled(fmt::format("[{}:{}]", __FILE__, __LINE__),        \
+                            fmt::fg(fmt::color::dark_orange)),                 \
+                ##__VA_ARGS__));                                               \
+      }                                                                        \
     }                                                                          \
   } while (false)
 
@@ -135,13 +298,22 @@ private:
  * Logging macros for normal mode
  * \endif
  */
-#define OBCX_TRACE(...) obcx::common::Logger::get()->trace(__VA_ARGS__)
+#define OBCX_LOG_IMPL(__level, ...)                                            \
+  do {                                                                         \
+    if constexpr (OBCX_LEVEL_ACTIVE(__level)) {                                \
+      if (auto *obcx_logger_ = obcx::common::Logger::raw();                    \
+          obcx_logger_->should_log(spdlog::level::__level)) {                  \
+        obcx_logger_->log(spdlog::level::__level, __VA_ARGS__);                \
+      }                                                                        \
+    }                                                                          \
+  } while (false)
 
-#define OBCX_DEBUG(...) obcx::common::Logger::get()->debug(__VA_ARGS__)
-#define OBCX_INFO(...) obcx::common::Logger::get()->info(__VA_ARGS__)
-#define OBCX_WARN(...) obcx::common::Logger::get()->warn(__VA_ARGS__)
-#define OBCX_ERROR(...) obcx::common::Logger::get()->error(__VA_ARGS__)
-#define OBCX_CRITICAL(...) obcx::common::Logger::get()->critical(__VA_ARGS__)
+#define OBCX_TRACE(...) OBCX_LOG_IMPL(trace, __VA_ARGS__)
+#define OBCX_DEBUG(...) OBCX_LOG_IMPL(debug, __VA_ARGS__)
+#define OBCX_INFO(...) OBCX_LOG_IMPL(info, __VA_ARGS__)
+#define OBCX_WARN(...) OBCX_LOG_IMPL(warn, __VA_ARGS__)
+#define OBCX_ERROR(...) OBCX_LOG_IMPL(err, __VA_ARGS__)
+#define OBCX_CRITICAL(...) OBCX_LOG_IMPL(critical, __VA_ARGS__)
 #endif
 
 } // namespace obcx::common
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "id.hpp"
 #include "json_utils.hpp"
 #include <chrono>
 #include <optional>
@@ -92,9 +93,11 @@ enum class EventType { message, notice, request, meta_event };
 struct BaseEvent {
   EventType type;
   std::chrono::system_clock::time_point time;
-  std::string self_id;
+  UserId self_id;
   std::string post_type;
   json data;
+  // 延迟追踪 ID，0 表示未追踪；只在进程内有效，不参与序列化
+  uint64_t trace_id = 0;
 
   /*
    * \if CHINESE
@@ -153,8 +156,8 @@ using Message = std::vector<MessageSegment>;
 struct MessageEvent : public BaseEvent {
   std::string message_type; // private, group, channel
   std::string sub_type;
-  std::string message_id;
-  std::string user_id;
+  MessageId message_id;
+  UserId user_id;
   Message message;
   std::string raw_message;
   int32_t font;
@@ -167,7 +170,7 @@ struct MessageEvent : public BaseEvent {
    * Group message specific fields
    * \endif
    */
-  std::optional<std::string> group_id;
+  std::optional<ChatId> group_id;
   std::optional<std::string> anonymous;
 
   /*
@@ -178,8 +181,8 @@ struct MessageEvent : public BaseEvent {
    * Channel message specific fields
    * \endif
    */
-  std::optional<std::string> guild_id;
-  std::optional<std::string> channel_id;
+  std::optional<ChatId> guild_id;
+  std::optional<ChatId> channel_id;
 
   /*
    * \if CHINESE
@@ -203,8 +206,8 @@ struct MessageEvent : public BaseEvent {
  */
 struct NoticeEvent : public BaseEvent {
   std::string notice_type;
-  std::string user_id;
-  std::optional<std::string> group_id;
+  UserId user_id;
+  std::optional<ChatId> group_id;
 
   /*
    * \if CHINESE
@@ -228,7 +231,7 @@ struct NoticeEvent : public BaseEvent {
  */
 struct RequestEvent : public BaseEvent {
   std::string request_type;
-  std::string user_id;
+  UserId user_id;
   std::string comment;
   std::string flag;
 
@@ -320,10 +323,11 @@ struct HeartbeatEvent : public MetaEvent {
 struct ErrorEvent {
   std::string error_type;                     // 异常类型
   std::string error_message;                  // 异常消息
-  std::string target_id;                      // 目标ID（用户ID或群组ID）
+  ChatId target_id;                           // 目标ID（用户ID或群组ID）
   bool is_group;                              // 是否为群组
   std::chrono::system_clock::time_point time; // 异常发生时间
   json context;                               // 异常上下文信息
+  uint64_t trace_id = 0;                      // 延迟追踪 ID，不参与序列化
 
   /*
    * \if CHINESE
@@ -372,6 +376,10 @@ struct ConnectionConfig {
   std::string proxy_username;
   std::string proxy_password;
 
+  // Traffic journal (optional): raw frames are appended to this file
+  std::string journal_path;
+  bool journal_compress = false;
+
   /*
    * \if CHINESE
    * 序列化支持
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace obcx::common {
+
+/**
+ * \~chinese
+ * @brief 指标标签，按给定顺序输出
+ *
+ * \~english
+ * @brief Metric labels, rendered in the given order.
+ */
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+namespace detail {
+
+/// 计数器与直方图的分片数 / Number of shards per counter and histogram
+inline constexpr std::size_t kMetricShards = 8;
+
+/// 为新线程分配分片下标（轮转）/ Assigns a shard to a new thread
+auto next_metric_shard() noexcept -> std::size_t;
+
+/// 当前线程使用的分片 / Shard used by the calling thread
+inline auto metric_shard() noexcept -> std::size_t {
+  thread_local const std::size_t shard = next_metric_shard();
+  return shard;
+}
+
+} // namespace detail
+
+/**
+ * \~chinese
+ * @brief 单调递增的计数器
+ *
+ * 按线程分片，每个分片独占一条缓存行；inc() 只是一次 relaxed 原子加法，
+ * 不同线程之间没有伪共享。value() 汇总全部分片。
+ *
+ * \~english
+ * @brief Monotonically increasing counter.
+ *
+ * Sharded per thread with one cache line per shard; inc() is a single
+ * relaxed atomic add with no false sharing between threads. value() sums
+ * all shards.
+ */
+class Counter {
+public:
+  void inc(uint64_t n = 1) noexcept {
+    shards_[detail::metric_shard()].value.fetch_add(n,
+                                                    std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto value() const noexcept -> uint64_t;
+
+private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> value{0};
+  };
+  std::array<Shard, detail::kMetricShards> shards_;
+};
+
+/**
+ * \~chinese
+ * @brief 可增可减的瞬时值
+ *
+ * \~english
+ * @brief Instantaneous value that can go up and down.
+ */
+class Gauge {
+public:
+  void set(int64_t value) noexcept {
+    value_.store(value, std::memory_order_relaxed);
+  }
+  void inc(int64_t n = 1) noexcept {
+    value_.fetch_add(n, std::memory_order_relaxed);
+  }
+  void dec(int64_t n = 1) noexcept {
+    value_.fetch_sub(n, std::memory_order_relaxed);
+  }
+  [[nodiscard]] auto value() const noexcept -> int64_t {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<int64_t> value_{0};
+};
+
+/**
+ * \~chinese
+ * @brief 直方图某一时刻的汇总
+ *
+ * \~english
+ * @brief Point-in-time summary of a histogram.
+ */
+struct HistogramSnapshot {
+  uint64_t count = 0;
+  /// 全部记录值之和（纳秒）/ Sum of all recorded values, in nanoseconds
+  uint64_t sum = 0;
+  std::vector<uint64_t> buckets;
+
+  /**
+   * \~chinese
+   * @brief 估算分位数
+   * @param q 0 到 1 之间的分位
+   * @return 所在桶的上界（纳秒），相对误差不超过 12.5%；没有记录时为 0
+   *
+   * \~english
+   * @brief Estimates a quantile.
+   * @param q Quantile between 0 and 1.
+   * @return Upper bound of the containing bucket in nanoseconds, within
+   * 12.5% relative error; 0 when nothing was recorded.
+   */
+  [[nodiscard]] auto quantile(double q) const -> uint64_t;
+};
+
+/**
+ * \~chinese
+ * @brief 延迟直方图，记录纳秒级耗时
+ *
+ * HDR 风格的对数线性分桶：每个 2 的幂区间再等分为 8 个子桶，
+ * 覆盖 1ns 到约 68s，超出部分计入最后一个桶。记录一次只需定位桶
+ * 并做三次 relaxed 原子加法，按线程分片，不加锁、不分配。
+ *
+ * \~english
+ * @brief Latency histogram recording durations in nanoseconds.
+ *
+ * HDR-style log-linear buckets: every power-of-two range is split into 8
+ * sub-buckets, covering 1ns to about 68s; larger values land in the last
+ * bucket. Recording locates the bucket and does three relaxed atomic adds
+ * on a per-thread shard, without locks or allocation.
+ */
+class Histogram {
+public:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr std::size_t kSubBuckets = std::size_t{1} << kSubBucketBits;
+  static constexpr int kMaxExponent = 35;
+  static constexpr std::size_t kBuckets =
+      (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+  void record(std::chrono::nanoseconds duration) noexcept {
+    record(static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0)));
+  }
+
+  void record(uint64_t nanoseconds) noexcept {
+    auto &shard = shards_[detail::metric_shard()];
+    shard.buckets[bucket_of(nanoseconds)].fetch_add(1,
+                                                    std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto snapshot() const -> HistogramSnapshot;
+
+  /// 值所在的桶 / Bucket holding a value
+  static constexpr auto bucket_of(uint64_t value) noexcept -> std::size_t {
+    if (value < kSubBuckets) {
+      return static_cast<std::size_t>(value);
+    }
+    const int exponent = std::min<int>(std::bit_width(value) - 1, kMaxExponent);
+    if (exponent == kMaxExponent && value >> (kMaxExponent + 1) != 0) {
+      return kBuckets - 1;
+    }
+    const auto sub = (value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return static_cast<std::size_t>(exponent - kSubBucketBits + 1) *
+               kSubBuckets +
+           static_cast<std::size_t>(sub);
+  }
+
+  /// 桶的上界（不含）/ Exclusive upper bound of a bucket
+  static constexpr auto bucket_upper_bound(std::size_t bucket) noexcept
+      -> uint64_t {
+    if (bucket < kSubBuckets) {
+      return bucket + 1;
+    }
+    const auto exponent =
+        static_cast<int>(bucket / kSubBuckets) + kSubBucketBits - 1;
+    const auto sub = bucket % kSubBuckets;
+    return (kSubBuckets + sub + 1) << (exponent - kSubBucketBits);
+  }
+
+private:
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::array<std::atomic<uint64_t>, kBuckets> buckets{};
+  };
+  std::array<Shard, detail::kMetricShards> shards_;
+};
+
+/**
+ * \~chinese
+ * @brief 作用域计时器，析构时把经过的时间记入直方图
+ *
+ * \~english
+ * @brief Scoped timer that records the elapsed time into a histogram on
+ * destruction.
+ */
+class ScopedTimer {
+public:
+  explicit ScopedTimer(Histogram &histogram) noexcept
+      : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+  ~ScopedTimer() {
+    histogram_.record(std::chrono::steady_clock::now() - start_);
+  }
+
+  ScopedTimer(const ScopedTimer &) = delete;
+  auto operator=(const ScopedTimer &) -> ScopedTimer & = delete;
+
+private:
+  Histogram &histogram_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+class MetricsRegistry;
+
+/**
+ * \~chinese
+ * @brief 回调指标的注册句柄，析构时注销
+ *
+ * \~english
+ * @brief Handle of a callback metric; unregisters it on destruction.
+ */
+class MetricsRegistration {
+public:
+  MetricsRegistration() = default;
+  MetricsRegistration(MetricsRegistry *registry, uint64_t id)
+      : registry_(registry), id_(id) {}
+  ~MetricsRegistration() { reset(); }
+
+  MetricsRegistration(MetricsRegistration &&other) noexcept
+      : registry_(std::exchange(other.registry_, nullptr)), id_(other.id_) {}
+  auto operator=(MetricsRegistration &&other) noexcept
+      -> MetricsRegistration & {
+    if (this != &other) {
+      reset();
+      registry_ = std::exchange(other.registry_, nullptr);
+      id_ = other.id_;
+    }
+    return *this;
+  }
+  MetricsRegistration(const MetricsRegistration &) = delete;
+  auto operator=(const MetricsRegistration &) -> MetricsRegistration & = delete;
+
+  void reset();
+
+private:
+  MetricsRegistry *registry_ = nullptr;
+  uint64_t id_ = 0;
+};
+
+/**
+ * \~chinese
+ * @brief 进程内的指标注册表
+ *
+ * 同名同标签的指标只创建一次，返回的引用在进程生命周期内有效，调用方应
+ * 缓存引用，避免在热路径上查表。回调指标在导出时求值，同名同标签的
+ * 多个回调取和（例如多个 Bot 各自的待响应请求数）。
+ *
+ * 直方图以 Prometheus summary 导出：0.5/0.9/0.99/0.999 分位（秒）及
+ * _sum、_count，统计范围为进程启动以来的全部记录。
+ *
+ * \~english
+ * @brief Process-wide metrics registry.
+ *
+ * A metric with a given name and labels is created once and the returned
+ * reference stays valid for the life of the process; callers should cache
+ * it rather than look it up on hot paths. Callback metrics are evaluated at
+ * export time, and callbacks sharing a name and labels are summed (e.g.
+ * pending requests of several bots).
+ *
+ * Histograms are exported as Prometheus summaries: the 0.5/0.9/0.99/0.999
+ * quantiles in seconds plus _sum and _count, covering everything recorded
+ * since process start.
+ */
+class MetricsRegistry {
+public:
+  /**
+   * \~chinese
+   * @brief 全局注册表；插件通过 IPlugin::metrics() 访问同一个实例
+   *
+   * \~english
+   * @brief Global registry; plugins reach the same instance through
+   * IPlugin::metrics().
+   */
+  static auto instance() -> MetricsRegistry &;
+
+  MetricsRegistry() = default;
+  MetricsRegistry(const MetricsRegistry &) = delete;
+  auto operator=(const MetricsRegistry &) -> MetricsRegistry & = delete;
+
+  /**
+   * \~chinese
+   * @brief 获取或创建计数器
+   * @param name 指标名，须符合 Prometheus 命名规则，计数器应以 _total 结尾
+   * @param help 说明文字，以首次注册时为准
+   * @param labels 标签
+   * @throws std::invalid_argument 名称非法，或该名称已注册为其他类型
+   *
+   * \~english
+   * @brief Gets or creates a counter.
+   * @param name Metric name following Prometheus rules; counters should end
+   * in _total.
+   * @param help Help text; the first registration wins.
+   * @param labels Labels.
+   * @throws std::invalid_argument If the name is invalid or already
+   * registered with another type.
+   */
+  auto counter(std::string_view name, std::string_view help,
+               const MetricLabels &labels = {}) -> Counter &;
+
+  /**
+   * \~chinese
+   * @brief 获取或创建瞬时值，参数同 counter()
+   *
+   * \~english
+   * @brief Gets or creates a gauge; parameters as for counter().
+   */
+  auto gauge(std::string_view name, std::string_view help,
+             const MetricLabels &labels = {}) -> Gauge &;
+
+  /**
+   * \~chinese
+   * @brief 获取或创建延迟直方图，参数同 counter()，名称应以 _seconds 结尾
+   *
+   * \~english
+   * @brief Gets or creates a latency histogram; parameters as for counter(),
+   * the name should end in _seconds.
+   */
+  auto histogram(std::string_view name, std::string_view help,
+                 const MetricLabels &labels = {}) -> Histogram &;
+
+  /**
+   * \~chinese
+   * @brief 注册一个在导出时求值的瞬时值
+   *
+   * 回调在导出线程上调用，须线程安全；句柄析构前回调引用的对象必须有效。
+   * @return 注册句柄，析构时注销
+   *
+   * \~english
+   * @brief Registers a gauge evaluated at export time.
+   *
+   * The callback runs on the exporting thread and must be thread-safe;
+   * whatever it references must outlive the returned handle.
+   * @return Registration handle that unregisters on destruction.
+   */
+  [[nodiscard]] auto observe(std::string_view name, std::string_view help,
+                             const MetricLabels &labels,
+                             std::function<double()> read)
+      -> MetricsRegistration;
+
+  /**
+   * \~chinese
+   * @brief 以 Prometheus 文本格式（0.0.4）导出全部指标
+   *
+   * \~english
+   * @brief Renders all metrics in the Prometheus text format (0.0.4).
+   */
+  [[nodiscard]] auto render_prometheus() const -> std::string;
+
+private:
+  friend class MetricsRegistration;
+
+  enum class Type { counter, gauge, histogram };
+
+  struct Callback {
+    std::string labels;
+    std::function<double()> read;
+  };
+
+  struct Family {
+    Type type;
+    std::string help;
+    // 键为渲染后的标签串，如 {type="message"}
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    std::map<uint64_t, Callback> callbacks;
+  };
+
+  auto family(std::string_view name, std::string_view help, Type type)
+      -> Family &;
+  void unregister(uint64_t id);
+
+  mutable std::mutex mutex_;
+  std::map<std::string, Family, std::less<>> families_;
+  // 回调 id 到指标名，注销时使用
+  std::map<uint64_t, std::string> callback_names_;
+  uint64_t next_callback_id_ = 1;
+};
+
+} // namespace obcx::common
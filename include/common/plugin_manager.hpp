@@ -2,14 +2,68 @@
 
 #include "interfaces/bot.hpp"
 #include "interfaces/plugin.hpp"
+#include <chrono>
 #include <dlfcn.h>
+#include <filesystem>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 namespace obcx::common {
 
+/**
+ * @brief 插件描述
+ *
+ * 优先取自插件导出的静态元数据；旧插件没有元数据时取自实例的虚函数，
+ * 此时没有依赖信息，且按独占方式初始化。
+ */
+struct PluginInfo {
+  std::string name;
+  std::string version;
+  std::string description;
+  std::vector<std::string> dependencies;
+  bool concurrent_init = false;
+  /// 是否来自 obcx_plugin_metadata 符号
+  bool has_metadata = false;
+};
+
+/**
+ * @brief 单个插件的启动耗时
+ */
+struct PluginStartup {
+  std::string name;
+  /// dlopen 与构造实例的耗时
+  std::chrono::nanoseconds load_time{0};
+  /// initialize() 的耗时，未初始化时为 0
+  std::chrono::nanoseconds init_time{0};
+  bool initialized = false;
+};
+
+namespace detail {
+
+struct PluginInitTask {
+  std::string name;
+  std::vector<std::string> dependencies;
+  /// 为 true 时运行期间不与任何其他任务并行
+  bool exclusive = false;
+};
+
+/**
+ * @brief 按依赖顺序执行初始化任务，互不依赖的任务在各自线程上并行
+ *
+ * 依赖缺失、依赖失败或处于依赖环中的任务不会执行，结果记为失败。
+ * init 抛出的异常视为失败。所有任务结束后才返回。
+ * @return 任务名到是否成功
+ */
+auto run_init_tasks(const std::vector<PluginInitTask> &tasks,
+                    const std::function<bool(const std::string &)> &init)
+    -> std::unordered_map<std::string, bool>;
+
+} // namespace detail
+
 class SafePluginWrapper {
 public:
   SafePluginWrapper(void *plugin_ptr, void *handle,
@@ -80,6 +134,14 @@ private:
 struct LoadedPlugin {
   std::unique_ptr<SafePluginWrapper> wrapper;
   std::string path;
+  PluginInfo info;
+  /// initialize() 期间注册的处理器的所属者，每次加载都不同
+  core::HandlerOwner owner = 0;
+  /// 加载时插件库文件的修改时间
+  std::filesystem::file_time_type modified{};
+  std::chrono::nanoseconds load_time{0};
+  std::chrono::nanoseconds init_time{0};
+  bool initialized = false;
 
   LoadedPlugin() = default;
 
@@ -117,6 +179,61 @@ public:
 
   bool initialize_plugin(const std::string &plugin_name);
 
+  /**
+   * @brief 按元数据中的依赖顺序初始化多个插件
+   *
+   * 互不依赖且声明 concurrent_init 的插件并行初始化；没有元数据的旧插件
+   * 独占执行。结束后按耗时输出每个插件的启动时间。
+   * @return 是否全部初始化成功
+   */
+  bool initialize_plugins(const std::vector<std::string> &plugin_names);
+
+  /**
+   * @brief 已加载插件的描述
+   */
+  const PluginInfo *get_plugin_info(const std::string &plugin_name) const;
+
+  /**
+   * @brief 各插件的加载与初始化耗时，按总耗时从高到低排列
+   */
+  std::vector<PluginStartup> startup_report() const;
+
+  /**
+   * @brief 只读取插件库的静态元数据，不构造插件实例
+   * @return 插件库无法打开或未导出元数据时返回 std::nullopt
+   */
+  static std::optional<PluginInfo> read_metadata(
+      const std::string &plugin_path);
+
+  /// reload_plugin() 等待旧插件处理器结束的默认时长
+  static constexpr std::chrono::milliseconds kDefaultReloadTimeout{10000};
+
+  /**
+   * @brief 不重启 Bot 地重新加载插件
+   *
+   * 先暂存所有 Bot 的新事件，等待旧插件注册的处理器协程全部结束，再
+   * deinitialize/shutdown 旧插件、注销其处理器并 dlclose，然后从同一路径
+   * dlopen 并初始化新插件，最后按原顺序分发暂存的事件。连接不受影响，
+   * 期间的事件不会丢失，只会延后处理。
+   *
+   * 插件自行启动的协程、线程和注册到框架的回调（如事件转换器）须在
+   * deinitialize() 或 shutdown() 中结束或移除。
+   * @param timeout 等待旧处理器结束的最长时间；超时则放弃重载，旧插件
+   *                继续工作
+   * @return 新插件是否加载并初始化成功
+   */
+  bool reload_plugin(const std::string &plugin_name,
+                     std::chrono::milliseconds timeout = kDefaultReloadTimeout);
+
+  /**
+   * @brief 重新加载插件库文件自加载以来被修改过的插件
+   *
+   * 新版本的库应以替换文件（写到临时文件后 rename）的方式安装；原地覆写
+   * 已映射的库会使正在运行的进程崩溃。
+   * @return 成功重载的插件数
+   */
+  std::size_t reload_modified_plugins();
+
   void deinitialize_plugin(const std::string &plugin_name);
 
   void shutdown_plugin(const std::string &plugin_name);
@@ -129,7 +246,10 @@ private:
   std::string find_plugin_file(const std::string &plugin_name);
 
   std::unique_ptr<SafePluginWrapper> load_plugin_library(
-      const std::string &plugin_path);
+      const std::string &plugin_path, PluginInfo &info);
+
+  /// 加载插件库并填写 loaded 中除 path 外的加载信息
+  bool load_into(const std::string &plugin_path, LoadedPlugin &loaded);
 
   std::unordered_map<std::string, LoadedPlugin> loaded_plugins_;
   std::vector<std::string> plugin_directories_;
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+namespace obcx::common {
+
+/**
+ * @brief 令牌桶限流器
+ *
+ * 以 rate 个/秒的速度补充令牌，最多积攒 burst 个，每次发送消耗一个。
+ * 服务端返回 retry_after 时用 pause_until() 暂停发放。不是线程安全的。
+ */
+class TokenBucket {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @param rate 每秒补充的令牌数，0 表示不限速
+   * @param burst 桶容量，初始时是满的
+   */
+  TokenBucket(double rate, double burst, Clock::time_point now = Clock::now())
+      : rate_(rate), burst_(std::max(burst, 1.0)), tokens_(burst_),
+        updated_at_(now) {}
+
+  /**
+   * @brief 距离下一个令牌可用还要等待的时间，已有令牌时返回 0
+   */
+  [[nodiscard]] auto wait_time(Clock::time_point now) -> Clock::duration {
+    refill(now);
+    if (now < paused_until_) {
+      return paused_until_ - now;
+    }
+    if (rate_ <= 0.0 || tokens_ >= 1.0) {
+      return Clock::duration::zero();
+    }
+    return std::chrono::ceil<Clock::duration>(
+        std::chrono::duration<double>((1.0 - tokens_) / rate_));
+  }
+
+  /**
+   * @brief 桶已满且未暂停，与新建的桶等价，可以丢弃
+   */
+  [[nodiscard]] auto idle(Clock::time_point now) const -> bool {
+    if (now < paused_until_) {
+      return false;
+    }
+    const std::chrono::duration<double> elapsed =
+        now - std::min(now, updated_at_);
+    return rate_ <= 0.0 || tokens_ + elapsed.count() * rate_ >= burst_;
+  }
+
+  /**
+   * @brief 消耗一个令牌，调用前应确认 wait_time() 为 0
+   */
+  void consume() { tokens_ = std::max(tokens_ - 1.0, 0.0); }
+
+  /**
+   * @brief 在 until 之前不发放令牌，到时只放行一个，之后按速率补充
+   */
+  void pause_until(Clock::time_point until) {
+    if (until > paused_until_) {
+      paused_until_ = until;
+      tokens_ = 1.0;
+      updated_at_ = until;
+    }
+  }
+
+private:
+  void refill(Clock::time_point now) {
+    if (now <= updated_at_) {
+      return;
+    }
+    const std::chrono::duration<double> elapsed = now - updated_at_;
+    tokens_ = std::min(burst_, tokens_ + elapsed.count() * rate_);
+    updated_at_ = now;
+  }
+
+  double rate_;
+  double burst_;
+  double tokens_;
+  Clock::time_point updated_at_;
+  Clock::time_point paused_until_{};
+};
+
+} // namespace obcx::common
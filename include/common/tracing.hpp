@@ -0,0 +1,316 @@
+#pragma once
+
+#include <atomic>
+#include <boost/asio/execution.hpp>
+#include <boost/asio/prefer.hpp>
+#include <boost/asio/query.hpp>
+#include <boost/asio/require.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace obcx::common {
+
+/**
+ * \~chinese
+ * @brief 一条已结束的跨度记录
+ *
+ * name 必须是静态存储期的字符串（通常为字面量），记录中只保存指针。
+ *
+ * \~english
+ * @brief One finished span.
+ *
+ * name must have static storage duration (usually a literal); only the
+ * pointer is stored.
+ */
+struct SpanRecord {
+  const char *name = nullptr;
+  /// 所属事件的追踪 ID / Trace ID of the event this span belongs to
+  uint64_t trace_id = 0;
+  /// 相对 Tracer 起点的纳秒数 / Nanoseconds since the tracer epoch
+  uint64_t start_ns = 0;
+  uint64_t duration_ns = 0;
+  /// 记录线程的序号 / Index of the recording thread
+  uint32_t thread = 0;
+  /**
+   * \~chinese 跨越协程挂起点的跨度，同一线程上可能与其他跨度交错
+   * \~english Span crossing coroutine suspensions; may interleave with
+   * other spans on the same thread.
+   */
+  bool async = false;
+};
+
+/**
+ * \~chinese
+ * @brief 事件延迟追踪器
+ *
+ * 每个入站事件在读到时分配一个追踪 ID，沿解析、分发、处理器协程和
+ * 出站 API 调用记录跨度。跨度写入固定容量的环形缓冲区，写满后覆盖最旧
+ * 的记录；写入是无锁的（每个槽位一个序列号），读取时跳过正在被覆盖的
+ * 槽位。export_chrome_json() 输出 Chrome trace-event 格式，可直接在
+ * Perfetto 或 chrome://tracing 中打开。
+ *
+ * 未调用 start() 时所有记录操作只是一次原子读。
+ *
+ * \~english
+ * @brief Per-event latency tracer.
+ *
+ * Every inbound event gets a trace ID when it is read; spans are recorded
+ * along parsing, dispatch, handler coroutines and outbound API calls.
+ * Spans go to a fixed-capacity ring buffer that overwrites the oldest
+ * records; writes are lock-free (one sequence number per slot) and readers
+ * skip slots that are being overwritten. export_chrome_json() emits the
+ * Chrome trace-event format, loadable in Perfetto or chrome://tracing.
+ *
+ * Until start() is called every recording call is a single atomic load.
+ */
+class Tracer {
+public:
+  /// 默认缓冲区容量 / Default ring buffer capacity
+  static constexpr std::size_t kDefaultCapacity = 65536;
+
+  Tracer() = default;
+  ~Tracer() = default;
+
+  Tracer(const Tracer &) = delete;
+  auto operator=(const Tracer &) -> Tracer & = delete;
+
+  /// 全局追踪器 / Process-wide tracer
+  static auto instance() -> Tracer &;
+
+  /**
+   * \~chinese
+   * @brief 分配缓冲区并开始记录
+   * @param capacity 容量，向上取整到 2 的幂；缓冲区只分配一次，
+   *                 再次调用时忽略该参数
+   *
+   * \~english
+   * @brief Allocates the buffer and starts recording.
+   * @param capacity Capacity, rounded up to a power of two; the buffer is
+   *                 allocated once and later calls ignore this argument.
+   */
+  void start(std::size_t capacity = kDefaultCapacity);
+
+  /// 停止记录，已记录的跨度保留 / Stops recording; keeps recorded spans
+  void stop() noexcept { enabled_.store(false, std::memory_order_release); }
+
+  [[nodiscard]] auto enabled() const noexcept -> bool {
+    return enabled_.load(std::memory_order_acquire);
+  }
+
+  /// 相对追踪器起点的纳秒数 / Nanoseconds since the tracer epoch
+  static auto now() noexcept -> uint64_t;
+
+  /**
+   * \~chinese @brief 分配新的追踪 ID；未启用时返回 0
+   * \~english @brief Allocates a new trace ID; 0 when disabled.
+   */
+  auto new_trace() noexcept -> uint64_t {
+    if (!enabled()) {
+      return 0;
+    }
+    return next_trace_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /// 记录一个已结束的跨度 / Records a finished span
+  void record(const char *name, uint64_t trace_id, uint64_t start_ns,
+              uint64_t end_ns, bool async = false) noexcept;
+
+  /**
+   * \~chinese @brief 按开始时间排序的现存跨度
+   * \~english @brief Spans currently in the buffer, ordered by start time.
+   */
+  [[nodiscard]] auto snapshot() const -> std::vector<SpanRecord>;
+
+  /// Chrome trace-event JSON / Chrome trace-event JSON
+  [[nodiscard]] auto export_chrome_json() const -> std::string;
+
+  /**
+   * \~chinese @brief 将 export_chrome_json() 写入文件
+   * @return 写入是否成功
+   *
+   * \~english @brief Writes export_chrome_json() to a file.
+   * @return Whether the write succeeded.
+   */
+  auto write_chrome_json(const std::string &path) const -> bool;
+
+private:
+  // 字段逐个原子存取，读者依靠 seq 判断记录是否完整
+  struct alignas(64) Slot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<uint64_t> trace_id{0};
+    std::atomic<uint64_t> start_ns{0};
+    std::atomic<uint64_t> duration_ns{0};
+    std::atomic<uint32_t> thread{0};
+    std::atomic<bool> async{false};
+  };
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<uint64_t> next_trace_{1};
+  std::atomic<uint64_t> head_{0};
+  std::unique_ptr<Slot[]> slots_;
+  std::size_t mask_ = 0;
+};
+
+/**
+ * \~chinese @brief 当前线程（或当前协程，见 TraceExecutor）的追踪 ID
+ * \~english @brief Trace ID of the calling thread (or coroutine, see
+ * TraceExecutor).
+ */
+auto current_trace_id() noexcept -> uint64_t;
+
+/**
+ * \~chinese
+ * @brief 在作用域内设置当前线程的追踪 ID，析构时恢复
+ *
+ * \~english
+ * @brief Sets the calling thread's trace ID for a scope and restores it on
+ * destruction.
+ */
+class TraceScope {
+public:
+  explicit TraceScope(uint64_t trace_id) noexcept;
+  ~TraceScope();
+
+  TraceScope(const TraceScope &) = delete;
+  auto operator=(const TraceScope &) -> TraceScope & = delete;
+
+private:
+  uint64_t previous_;
+};
+
+/**
+ * \~chinese
+ * @brief RAII 跨度，析构时以当前追踪 ID 记录
+ *
+ * 当前没有追踪 ID（或追踪器未启用）时不记录任何内容。在协程中跨越
+ * co_await 的跨度应传 async = true。
+ *
+ * \~english
+ * @brief RAII span recorded under the current trace ID on destruction.
+ *
+ * Records nothing without a current trace ID (or while the tracer is
+ * disabled). Pass async = true for spans that cross a co_await.
+ */
+class Span {
+public:
+  explicit Span(const char *name, bool async = false) noexcept
+      : name_(name), trace_id_(current_trace_id()), async_(async) {
+    if (trace_id_ != 0) {
+      start_ns_ = Tracer::now();
+    }
+  }
+
+  ~Span() {
+    if (trace_id_ != 0) {
+      Tracer::instance().record(name_, trace_id_, start_ns_, Tracer::now(),
+                                async_);
+    }
+  }
+
+  Span(const Span &) = delete;
+  auto operator=(const Span &) -> Span & = delete;
+
+private:
+  const char *name_;
+  uint64_t trace_id_;
+  uint64_t start_ns_ = 0;
+  bool async_;
+};
+
+/**
+ * \~chinese
+ * @brief 协程的追踪上下文，可在协程运行期间切换到另一个追踪 ID
+ *
+ * \~english
+ * @brief Trace context of a coroutine; may switch to another trace ID while
+ * the coroutine runs.
+ */
+struct TraceContext {
+  explicit TraceContext(uint64_t id) noexcept : trace_id(id) {}
+
+  /**
+   * \~chinese @brief 切换追踪 ID，当前线程立即生效直到协程下次挂起
+   * \~english @brief Switches the trace ID; takes effect on the calling
+   * thread immediately, until the coroutine next suspends.
+   */
+  void switch_to(uint64_t id) noexcept;
+
+  std::atomic<uint64_t> trace_id;
+};
+
+/**
+ * \~chinese
+ * @brief 在每次恢复协程前设置当前追踪 ID 的执行器包装
+ *
+ * 线程局部的追踪 ID 无法跨越 co_await：协程可能在另一个线程上、或在
+ * 其他协程之后恢复。以该执行器 co_spawn 的协程，每次被调度执行时都会
+ * 进入 TraceContext 中的追踪 ID，结束时恢复原值，因此协程及其
+ * co_await 的子协程内的 Span 都归属同一事件。
+ *
+ * \~english
+ * @brief Executor wrapper that sets the current trace ID before every
+ * coroutine resumption.
+ *
+ * A thread-local trace ID cannot cross a co_await: the coroutine may resume
+ * on another thread or after other coroutines. A coroutine co_spawned on
+ * this executor enters the trace ID from its TraceContext each time it is
+ * scheduled and restores the previous value afterwards, so Spans in the
+ * coroutine and in everything it co_awaits belong to the same event.
+ */
+template <typename Inner> class TraceExecutor {
+public:
+  TraceExecutor(Inner inner, std::shared_ptr<TraceContext> context) noexcept
+      : inner_(std::move(inner)), context_(std::move(context)) {}
+
+  template <typename Property>
+  auto query(const Property &property) const
+      -> decltype(boost::asio::query(std::declval<const Inner &>(),
+                                     property)) {
+    return boost::asio::query(inner_, property);
+  }
+
+  template <typename Property>
+  auto require(const Property &property) const
+      -> TraceExecutor<std::decay_t<decltype(boost::asio::require(
+          std::declval<const Inner &>(), property))>> {
+    return {boost::asio::require(inner_, property), context_};
+  }
+
+  template <typename Property>
+  auto prefer(const Property &property) const
+      -> TraceExecutor<std::decay_t<decltype(boost::asio::prefer(
+          std::declval<const Inner &>(), property))>> {
+    return {boost::asio::prefer(inner_, property), context_};
+  }
+
+  template <typename Function> void execute(Function &&function) const {
+    inner_.execute([context = context_,
+                    function = std::forward<Function>(function)]() mutable {
+      const TraceScope scope(
+          context->trace_id.load(std::memory_order_relaxed));
+      std::move(function)();
+    });
+  }
+
+  friend auto operator==(const TraceExecutor &a,
+                         const TraceExecutor &b) noexcept -> bool {
+    return a.inner_ == b.inner_ && a.context_ == b.context_;
+  }
+
+  friend auto operator!=(const TraceExecutor &a,
+                         const TraceExecutor &b) noexcept -> bool {
+    return !(a == b);
+  }
+
+private:
+  Inner inner_;
+  std::shared_ptr<TraceContext> context_;
+};
+
+} // namespace obcx::common
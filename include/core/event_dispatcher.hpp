@@ -2,12 +2,22 @@
 
 #include "common/logger.hpp"
 #include "common/message_type.hpp"
-#include <any>
+#include "common/metrics.hpp"
+#include "common/tracing.hpp"
+#include "core/handler_policy.hpp"
+#include "core/message_filter.hpp"
+#include <array>
+#include <atomic>
 #include <boost/asio.hpp>
 #include <boost/core/demangle.hpp>
+#include <chrono>
 #include <functional>
-#include <map>
-#include <typeindex>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include <variant>
 #include <vector>
 
 namespace obcx::core {
@@ -15,89 +25,417 @@ namespace asio = boost::asio;
 
 class IBot;
 
+namespace detail {
+
+/**
+ * @brief 编译期求出 T 在 std::variant 中的下标
+ */
+template <typename T, typename... Ts>
+consteval auto variant_index(std::type_identity<std::variant<Ts...>>)
+    -> std::size_t {
+  constexpr bool matches[] = {std::is_same_v<T, Ts>...};
+  for (std::size_t i = 0; i < sizeof...(Ts); ++i) {
+    if (matches[i]) {
+      return i;
+    }
+  }
+  return sizeof...(Ts);
+}
+
+} // namespace detail
+
+/// 处理器的所属者，0 表示不属于任何所属者
+using HandlerOwner = uint64_t;
+
+/**
+ * @brief 注册处理器时返回的令牌，传给 EventDispatcher::off() 注销处理器
+ */
+struct HandlerToken {
+  uint64_t id = 0;
+
+  explicit operator bool() const noexcept { return id != 0; }
+};
+
+/**
+ * @brief 在作用域内为当前线程注册的处理器标记所属者，析构时恢复
+ *
+ * PluginManager 在插件 initialize() 期间设置，热重载时据此注销插件注册的
+ * 全部处理器并等待其协程结束。
+ */
+class HandlerOwnerScope {
+public:
+  explicit HandlerOwnerScope(HandlerOwner owner) noexcept;
+  ~HandlerOwnerScope();
+
+  HandlerOwnerScope(const HandlerOwnerScope &) = delete;
+  auto operator=(const HandlerOwnerScope &) -> HandlerOwnerScope & = delete;
+
+  /// 当前线程的所属者
+  static auto current() noexcept -> HandlerOwner;
+
+private:
+  HandlerOwner previous_;
+};
+
 /**
  * @brief 事件分发器，负责类型安全地注册和调用事件处理器
+ *
+ * 处理器按 common::Event 的变体下标存放在定长数组中，分发时无需查表或
+ * 类型擦除的拷贝。同一事件只拷贝一次到 shared_ptr<const Event>，由该事件
+ * 的全部处理器协程共享。每个处理器可以附带 HandlerPolicy，限制并发数或
+ * 按键串行处理。
+ *
+ * 所有处理器协程都会被跟踪并绑定取消槽，停止时通过 drain() 等待其完成，
+ * 超时后再取消。
+ *
+ * 分发的事件数、处理器耗时与异常数按事件类型记入 MetricsRegistry，
+ * 处理中的协程数在导出时读取。
+ *
+ * 处理器可在运行期间注册与注销（读写锁保护处理器表）。hold() 期间到达
+ * 的事件暂存，release() 后按原顺序分发，配合 off_owner() 与
+ * wait_idle() 可以在不丢事件的前提下替换一组处理器。
  */
 class EventDispatcher {
 public:
+  /**
+   * @brief 类型擦除后的处理器，接收整个事件变体
+   *
+   * 由 on() 生成，调用前已保证变体持有对应的事件类型。
+   */
+  using Handler =
+      std::function<asio::awaitable<void>(IBot &, const common::Event &)>;
+
   /**
    * @brief 构造函数
    * @param io_context Asio的io_context引用，用于启动协程
    */
-  explicit EventDispatcher(asio::io_context &io_context)
-      : io_context_(io_context) {}
+  explicit EventDispatcher(asio::io_context &io_context);
 
   /**
    * @brief 注册一个事件处理器 (新版本，支持Bot引用)
    * @tparam EventType 要处理的事件类型 (如: common::MessageEvent)
    * @param handler 一个接受Bot引用和事件，返回 asio::awaitable<void>
-   * 的协程函数
+   * 的协程函数。事件以常量引用传入，在处理器协程结束前始终有效
+   * @param policy 调度策略，默认不限并发
+   * @return 注销用的令牌
    */
   template <typename EventType>
-  void on(std::function<asio::awaitable<void>(IBot &, EventType)> handler) {
-    const auto type_idx = std::type_index(typeid(EventType));
-
-    auto wrapper = [handler](IBot *bot,
-                             std::any event_any) -> asio::awaitable<void> {
-      try {
-        if (auto *event = std::any_cast<EventType>(&event_any)) {
-          co_await handler(*bot, *event);
-        } else {
-          OBCX_WARN("EventDispatcher: 在包装器中类型转换失败 for type {}",
-                    typeid(EventType).name());
-        }
-      } catch (const std::bad_any_cast &e) {
-        OBCX_ERROR("EventDispatcher: any_cast 异常: {}", e.what());
-      }
-      co_return;
-    };
-
-    handlers_[type_idx].push_back(std::move(wrapper));
+  auto on(std::function<asio::awaitable<void>(IBot &, const EventType &)>
+              handler,
+          HandlerPolicy policy = {}) -> HandlerToken {
+    return on<EventType>(std::function<bool(const EventType &)>{},
+                         std::move(handler), std::move(policy));
+  }
+
+  /**
+   * @brief 注册一个带谓词的事件处理器
+   * @tparam EventType 要处理的事件类型
+   * @param predicate 在分发时同步调用；返回 false 时不会为该处理器启动协程
+   * @param handler 协程事件处理器
+   * @param policy 调度策略，默认不限并发
+   * @return 注销用的令牌
+   */
+  template <typename EventType>
+  auto on(std::function<bool(const EventType &)> predicate,
+          std::function<asio::awaitable<void>(IBot &, const EventType &)>
+              handler,
+          HandlerPolicy policy = {}) -> HandlerToken {
+    constexpr auto index = index_of<EventType>();
+
+    Subscriber subscriber{
+        .route = make_route<EventType>(std::move(handler), std::move(policy)),
+        .predicate = {}};
+    if (predicate) {
+      subscriber.predicate = [predicate = std::move(predicate)](
+                                 const common::Event &event) {
+        return predicate(*std::get_if<index>(&event));
+      };
+    }
+    std::lock_guard routes_lock(routes_mutex_);
+    auto subscribers =
+        handlers_[index] ? std::make_shared<Subscribers>(*handlers_[index])
+                         : std::make_shared<Subscribers>();
+    std::unique_lock lock(handlers_mutex_);
+    subscriber.route.id = next_handler_id_++;
+    const HandlerToken token{.id = subscriber.route.id};
+    subscribers->push_back(std::move(subscriber));
+    // 旧表在锁外析构
+    auto previous = std::exchange(handlers_[index], std::move(subscribers));
+    lock.unlock();
     OBCX_DEBUG("已为事件类型 {} 注册处理函数",
                boost::core::demangle(typeid(EventType).name()));
+    return token;
   }
 
+  /**
+   * @brief 注册一个带声明式过滤条件的消息处理器
+   *
+   * 过滤条件编入索引（群号哈希、命令前缀树），不匹配的处理器不会被启动。
+   * @param filter 过滤条件
+   * @param handler 协程消息处理器
+   * @param policy 调度策略，默认不限并发
+   * @return 注销用的令牌
+   */
+  auto on(MessageFilter filter,
+          std::function<asio::awaitable<void>(IBot &,
+                                              const common::MessageEvent &)>
+              handler,
+          HandlerPolicy policy = {}) -> HandlerToken;
+
+  /**
+   * @brief 替换带过滤条件的消息处理器的过滤条件
+   *
+   * 处理器、调度策略与令牌不变。新条件对此后选出处理器的分发生效，不需要
+   * hold()：分发读到的要么是旧条件，要么是新条件。
+   * @param token on() 返回的令牌
+   * @param filter 新的过滤条件
+   * @return 令牌是否对应一个带过滤条件的处理器
+   */
+  auto replace_filter(HandlerToken token, MessageFilter filter) -> bool;
+
+  /**
+   * @brief 注销一个处理器
+   *
+   * 返回后不会再为它启动新协程；已在运行或已排队的事件仍会处理完。
+   * @return 令牌对应的处理器是否存在
+   */
+  auto off(HandlerToken token) -> bool;
+
+  /**
+   * @brief 注销某所属者注册的全部处理器
+   * @return 注销的处理器数量
+   */
+  auto off_owner(HandlerOwner owner) -> std::size_t;
+
+  /**
+   * @brief 暂存此后到达的事件，直到 release()
+   *
+   * 暂存的事件不会被丢弃，但 drain() 之后 release() 的事件按 drain 规则
+   * 处理。可以嵌套，与 release() 一一配对，最外层的 release() 才回放。
+   *
+   * 返回前等待正在选出处理器的分发完成登记，此后 wait_idle() 能看到所有
+   * 已选出的处理器。不能在谓词中调用。
+   */
+  void hold();
+
+  /**
+   * @brief 结束 hold()，在 io_context 上按到达顺序分发暂存的事件
+   *
+   * 分发完成前新到达的事件继续排在暂存事件之后。io_context 已停止时在
+   * 调用线程上分发。
+   *
+   * 仍有未配对的 hold() 时只减少嵌套层数。回放执行前若又调用了 hold()，
+   * 暂存的事件留到与之配对的 release() 一并回放。
+   */
+  void release();
+
   /**
    * @brief 分发一个事件给所有已注册的处理器
    * @param bot Bot实例的引用，会传递给事件处理器
    * @param event 从适配器层传入的事件变体
    */
-  void dispatch(IBot *bot, const common::Event &event) {
-    std::visit(
-        [this, bot](const auto &concrete_event) {
-          using ConcreteEventType = std::decay_t<decltype(concrete_event)>;
-          const auto type_idx = std::type_index(typeid(ConcreteEventType));
-
-          if (handlers_.contains(type_idx)) {
-            auto &handlers_for_type = handlers_.at(type_idx);
-            OBCX_DEBUG("事件 {} 调用 {} 个处理函数",
-                       boost::core::demangle(typeid(ConcreteEventType).name()),
-                       handlers_for_type.size());
-
-            for (const auto &handler : handlers_for_type) {
-              // 使用 co_spawn 启动用户的协程事件处理器
-              // 我们传递 concrete_event 的一个拷贝以确保生命周期
-              asio::co_spawn(
-                  io_context_,
-                  [handler, bot, concrete_event]() -> asio::awaitable<void> {
-                    co_await handler(bot, concrete_event);
-                  },
-                  asio::detached // 目前，我们不关心处理器的返回结果
-              );
-            }
-          } else {
-            OBCX_DEBUG("没有为事件类型 {} 注册的处理函数",
-                       boost::core::demangle(typeid(ConcreteEventType).name()));
-          }
-        },
-        event);
+  void dispatch(IBot *bot, const common::Event &event);
+
+  /**
+   * @brief 分发一个已共享的事件，不再拷贝
+   * @param bot Bot实例的引用，会传递给事件处理器
+   * @param event 事件变体，由各处理器协程共同持有
+   */
+  void dispatch(IBot *bot, std::shared_ptr<const common::Event> event);
+
+  /**
+   * @brief 某事件类型已注册的处理器数量
+   */
+  template <typename EventType>
+  [[nodiscard]] auto handler_count() const -> std::size_t {
+    std::shared_lock lock(handlers_mutex_);
+    const auto &subscribers = handlers_[index_of<EventType>()];
+    auto count = subscribers ? subscribers->size() : 0;
+    if constexpr (std::is_same_v<EventType, common::MessageEvent>) {
+      count += filters_->index.size();
+    }
+    return count;
   }
 
+  /**
+   * @brief 带名称策略的处理器的排队统计
+   */
+  [[nodiscard]] auto handler_stats() const -> std::vector<HandlerStats>;
+
+  /// drain() 取消处理器后等待其退出的最长时间
+  static constexpr std::chrono::milliseconds kCancelTimeout{1000};
+
+  /**
+   * @brief 停止接收新事件，等待处理中的处理器协程完成，超时后取消其余协程
+   *
+   * 阻塞调用。超时后发出取消，再最多等待 kCancelTimeout 让被取消的协程
+   * 退出。在 io_context 的线程内调用，或 io_context 已停止时，无法等待
+   * 处理器推进，因此不等待而直接在调用线程上取消。
+   * @param timeout 取消前的最长等待时间
+   * @return 返回时仍未结束的处理器协程数；0 表示全部已结束
+   */
+  auto drain(std::chrono::milliseconds timeout) -> std::size_t;
+
+  /**
+   * @brief 撤销 drain() 的效果，重新开始接收事件
+   */
+  void resume();
+
+  /**
+   * @brief 是否已调用 drain() 且尚未 resume()
+   */
+  [[nodiscard]] auto draining() const -> bool;
+
+  /**
+   * @brief 正在运行的处理器协程数
+   */
+  [[nodiscard]] auto in_flight() const -> std::size_t;
+
+  /**
+   * @brief 某所属者正在运行的处理器协程数，包括排队等待运行的事件所在的
+   * 协程，以及已选出、尚未启动协程的处理器
+   */
+  [[nodiscard]] auto in_flight(HandlerOwner owner) const -> std::size_t;
+
+  /**
+   * @brief 等待某所属者的处理器协程全部结束
+   *
+   * 阻塞调用，不取消任何协程。与 drain() 相同，在 io_context 的线程内
+   * 调用或 io_context 已停止时不等待。通常先 hold() 或 off_owner()，
+   * 否则期间仍可能启动新协程。
+   * @return 是否已没有该所属者的协程
+   */
+  auto wait_idle(HandlerOwner owner, std::chrono::milliseconds timeout)
+      -> bool;
+
 private:
+  static constexpr std::size_t kEventKinds =
+      std::variant_size_v<common::Event>;
+
+  struct Route {
+    std::shared_ptr<const Handler> handler;
+    /// 为空表示默认策略：不排队，直接启动
+    std::shared_ptr<HandlerQueue> queue;
+    /// HandlerToken 的 id
+    uint64_t id = 0;
+    HandlerOwner owner = 0;
+  };
+
+  struct Subscriber {
+    Route route;
+    /// 为空表示接收全部该类型事件
+    std::function<bool(const common::Event &)> predicate;
+  };
+
+  using Subscribers = std::vector<Subscriber>;
+
+  // 带 MessageFilter 的消息处理器及其索引，发布后不再修改
+  struct FilterTable {
+    MessageFilterIndex index;
+    /// 下标与 index 的槽位一致；已注销的槽位 handler 为空
+    std::vector<Route> routes;
+  };
+
+  template <typename EventType>
+  static consteval auto index_of() -> std::size_t {
+    constexpr auto index =
+        detail::variant_index<EventType>(std::type_identity<common::Event>{});
+    static_assert(index < kEventKinds, "EventType 不是 common::Event 的成员");
+    return index;
+  }
+
+  template <typename EventType>
+  static auto make_route(
+      std::function<asio::awaitable<void>(IBot &, const EventType &)> handler,
+      HandlerPolicy policy) -> Route {
+    Route route{.handler = std::make_shared<const Handler>(
+                    [handler = std::move(handler)](
+                        IBot &bot,
+                        const common::Event &event) -> asio::awaitable<void> {
+                      return handler(
+                          bot, *std::get_if<index_of<EventType>()>(&event));
+                    }),
+                .queue = {},
+                .owner = HandlerOwnerScope::current()};
+    if (policy.max_in_flight != 0 || policy.serial_key) {
+      route.queue = std::make_shared<HandlerQueue>(std::move(policy));
+    }
+    return route;
+  }
+
+  /// 选出的处理器。释放 handlers_mutex_ 后再启动协程：处理器可能在
+  /// co_spawn 内同步运行，并在其中注册、注销或再次分发。所在的表发布后
+  /// 不再修改，持有快照即可，不逐个拷贝 Route
+  struct Selection {
+    std::shared_ptr<const Subscribers> subscribers;
+    std::shared_ptr<const FilterTable> filters;
+    std::vector<const Route *> routes;
+    /// 有带所属者的处理器时才需要登记到跟踪表
+    bool owned = false;
+  };
+
+  /// 找出接收该事件的处理器；调用方须持有 handlers_mutex_
+  auto select(const common::Event &event) const -> Selection;
+
+  /// 选出处理器、登记到跟踪表后启动协程。已 hold() 时不选出并返回
+  /// false，stash 为 true 时把事件暂存到 held_ 末尾
+  auto route(IBot *bot, const std::shared_ptr<const common::Event> &event,
+             bool stash) -> bool;
+
+  /// hold() 期间返回持有 held_mutex_ 的锁，否则返回空锁；调用方须持有
+  /// handlers_mutex_ 的读锁
+  auto lock_if_held() -> std::unique_lock<std::mutex>;
+
+  /// 分发 hold() 期间暂存的事件并结束暂存
+  void replay_held();
+
+  /// 注销满足条件的处理器，返回注销数量
+  template <typename Matches>
+  auto remove_routes(Matches matches) -> std::size_t;
+
+  /// 替换 filters_；调用方须持有 routes_mutex_。旧表在返回后析构，
+  /// 不在 handlers_mutex_ 内释放谓词
+  void publish(std::shared_ptr<const FilterTable> filters);
+
+  void spawn(IBot *bot, const Selection &selection,
+             const std::shared_ptr<const common::Event> &event);
+
+  /// 启动一个受跟踪的处理器协程，完成后自动移出跟踪表；
+  /// trace 非空时协程在该追踪上下文中运行
+  template <typename Coroutine>
+  void spawn_tracked(Coroutine coroutine,
+                     std::shared_ptr<common::TraceContext> trace,
+                     HandlerOwner owner);
+
+  /// 运行一个经过 HandlerQueue 的任务，结束后接着运行同一队列放行的任务
+  void run_queued(IBot *bot, const Route &route, HandlerQueue::Job job);
+
+  // 处理中协程的跟踪表，由协程共同持有，生命周期可长于分发器
+  struct Tracker;
+
   asio::io_context &io_context_;
-  std::map<std::type_index,
-           std::vector<std::function<asio::awaitable<void>(IBot *, std::any)>>>
-      handlers_;
+  std::shared_ptr<Tracker> tracker_;
+  common::MetricsRegistration in_flight_metric_;
+  // 注册与注销持写锁；分发只在选出处理器期间持读锁
+  mutable std::shared_mutex handlers_mutex_;
+  uint64_t next_handler_id_ = 1;
+  // 按事件类型的处理器表，为空表示没有处理器。与 filters_ 相同，修改时
+  // 在 handlers_mutex_ 之外拷贝整张表，写锁只用于替换指针；分发持读锁
+  // 取得当前表的快照。处理器以 shared_ptr 持有，已被注销时正在执行的
+  // 处理器对象依然有效
+  std::array<std::shared_ptr<const Subscribers>, kEventKinds> handlers_;
+  // 带 MessageFilter 的消息处理器，修改方式同上，分发不会等待索引重建
+  std::shared_ptr<const FilterTable> filters_;
+  // 串行化 handlers_ 与 filters_ 的修改
+  std::mutex routes_mutex_;
+
+  // hold() 期间暂存的事件；holding_ 与 hold_depth_ 仅在 held_mutex_ 内修改。
+  // 回放时不持锁，holding_ 保持置位到回放结束，期间到达的事件排在后面
+  std::atomic<bool> holding_{false};
+  std::size_t hold_depth_ = 0;
+  bool replaying_ = false;
+  std::mutex held_mutex_;
+  std::vector<std::pair<IBot *, std::shared_ptr<const common::Event>>> held_;
 };
 
-} // namespace obcx::core
\ No newline at end of file
+} // namespace obcx::core
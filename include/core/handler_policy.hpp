@@ -0,0 +1,110 @@
+#pragma once
+
+#include "common/message_type.hpp"
+#include "common/metrics.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace obcx::core {
+
+/**
+ * @brief 单个事件处理器的调度策略
+ *
+ * 默认策略与旧行为一致：每个事件立即启动一个协程，没有并发上限。
+ */
+struct HandlerPolicy {
+  /// 处理器名称，用于统计输出与 obcx_handler_* 指标的 handler 标签；
+  /// 为空时不出现在统计中
+  std::string name;
+  /// 同时运行的协程数上限；0 表示不限
+  std::size_t max_in_flight = 0;
+  /// 串行键：键相同的事件按到达顺序逐个处理，不同键之间并行。
+  /// 返回空字符串的事件不参与串行
+  std::function<std::string(const common::Event &)> serial_key;
+
+  /**
+   * @brief 按会话串行的键：群消息、群通知取群号，其余消息与通知取用户ID
+   */
+  static auto chat_key(const common::Event &event) -> std::string;
+};
+
+/**
+ * @brief 处理器的排队统计
+ */
+struct HandlerStats {
+  std::string name;
+  /// 正在运行的协程数
+  std::size_t in_flight = 0;
+  /// 等待中的事件数（含并发上限与串行键造成的排队）
+  std::size_t queued = 0;
+  /// 排队深度的历史最大值
+  std::size_t peak_queued = 0;
+  /// 已完成的事件数
+  uint64_t completed = 0;
+};
+
+/**
+ * @brief 按 HandlerPolicy 调度事件的排队状态
+ *
+ * 只负责决定“哪个事件现在可以运行”，不启动协程：submit/complete
+ * 返回的 Job 由调用方负责运行，运行结束后必须调用 complete。线程安全。
+ */
+class HandlerQueue {
+public:
+  struct Job {
+    std::shared_ptr<const common::Event> event;
+    /// 串行键，为空表示不参与串行
+    std::string key;
+  };
+
+  explicit HandlerQueue(HandlerPolicy policy);
+
+  /**
+   * @brief 提交一个事件
+   * @return 可立即运行的任务；需要排队时返回 std::nullopt
+   */
+  auto submit(std::shared_ptr<const common::Event> event)
+      -> std::optional<Job>;
+
+  /**
+   * @brief 报告一个任务运行结束
+   * @return 因此可以开始运行的下一个任务
+   */
+  auto complete(const Job &job) -> std::optional<Job>;
+
+  [[nodiscard]] auto stats() const -> HandlerStats;
+
+  [[nodiscard]] auto policy() const noexcept -> const HandlerPolicy & {
+    return policy_;
+  }
+
+private:
+  // 调用方需持有 mutex_
+  auto start_next() -> std::optional<Job>;
+
+  HandlerPolicy policy_;
+  mutable std::mutex mutex_;
+  // 已满足串行约束、等待并发名额的任务
+  std::deque<Job> ready_;
+  // 每个正在处理的串行键后面排队的事件；键存在即表示该键正忙
+  std::unordered_map<std::string,
+                     std::deque<std::shared_ptr<const common::Event>>>
+      lanes_;
+  std::size_t in_flight_ = 0;
+  std::size_t queued_ = 0;
+  std::size_t peak_queued_ = 0;
+  uint64_t completed_ = 0;
+
+  // 有名称时按名称导出的排队数与运行数；最后声明，先于其余成员注销
+  common::MetricsRegistration queued_metric_;
+  common::MetricsRegistration in_flight_metric_;
+};
+
+} // namespace obcx::core
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "common/message_type.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace obcx::core {
+
+/**
+ * @brief 声明式的消息过滤条件
+ *
+ * 各字段之间为“与”关系，留空的字段不参与过滤。群号按文本比较，与 ID
+ * 所属平台无关，可直接使用配置文件中的字符串。
+ */
+struct MessageFilter {
+  /// 只接收这些群的消息；为空表示不限
+  std::vector<std::string> group_ids;
+  /// 只接收该类型的消息（private、group 等）；为空表示不限
+  std::string message_type;
+  /// raw_message 以其中任一命令开头，命令后须为结尾、空白或 '@'
+  std::vector<std::string> commands;
+  /// 消息中须包含 at 机器人自身的消息段（OneBot 的 at 段，比较 self_id）
+  bool mention_self = false;
+  /// 其余条件都满足后再调用的同步谓词；为空表示不限
+  std::function<bool(const common::MessageEvent &)> predicate;
+};
+
+/**
+ * @brief MessageFilter 的索引
+ *
+ * 带命令的过滤器挂在命令前缀树上，带群号的过滤器按群号哈希，其余的逐个
+ * 检查。匹配时只检查索引命中的候选项，结果按注册顺序返回。移除后空出
+ * 的槽位会被之后加入的过滤器复用，反复注册、注销时槽位数不会增长。
+ *
+ * 可以拷贝：EventDispatcher 在副本上增删过滤器，再整体替换正在使用的
+ * 索引，匹配期间索引不会被修改。
+ */
+class MessageFilterIndex {
+public:
+  /**
+   * @brief 加入一个过滤器
+   * @return 过滤器的槽位；优先复用已移除的槽位，否则从 0 开始递增
+   */
+  auto add(MessageFilter filter) -> uint32_t;
+
+  /**
+   * @brief 移除一个过滤器
+   *
+   * 其余过滤器的槽位保持不变，空出的槽位留给之后的 add()。过滤器（包括
+   * 其中的谓词）在返回前析构。
+   * @param slot add() 返回的槽位；已移除或不存在时什么也不做
+   */
+  void remove(uint32_t slot);
+
+  /**
+   * @brief 替换一个过滤器的条件
+   *
+   * 槽位与注册顺序不变，匹配结果中仍排在原来的位置。
+   * @param slot add() 返回的槽位；已移除或不存在时什么也不做
+   */
+  void replace(uint32_t slot, MessageFilter filter);
+
+  /**
+   * @brief 找出接受该消息的全部过滤器
+   * @param event 消息事件
+   * @param matches 输出参数，按注册顺序追加匹配的槽位
+   */
+  void match(const common::MessageEvent &event,
+             std::vector<uint32_t> &matches) const;
+
+  /// 未被移除的过滤器数量
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    return entries_.size() - free_slots_.size();
+  }
+
+private:
+  struct StringHash {
+    using is_transparent = void;
+    auto operator()(std::string_view text) const noexcept -> std::size_t {
+      return std::hash<std::string_view>{}(text);
+    }
+  };
+
+  using StringSet =
+      std::unordered_set<std::string, StringHash, std::equal_to<>>;
+
+  struct Entry {
+    MessageFilter filter;
+    StringSet groups;
+    // 加入时的序号，复用槽位后仍能按注册顺序排列匹配结果
+    uint64_t order = 0;
+    bool removed = false;
+  };
+
+  struct TrieNode {
+    std::vector<std::pair<char, uint32_t>> children;
+    std::vector<uint32_t> entries;
+  };
+
+  [[nodiscard]] auto accepts(const Entry &entry,
+                             const common::MessageEvent &event) const -> bool;
+
+  /// 把过滤器放入槽位并挂到对应的索引上
+  void place(uint32_t slot, MessageFilter filter, uint64_t order);
+
+  /// 把槽位上的过滤器从索引中摘除，不修改槽位本身
+  void unlink(uint32_t slot);
+
+  void insert_command(std::string_view command, uint32_t slot);
+
+  /// 命令在前缀树中的节点；不存在时返回 0（根节点不对应任何命令）
+  [[nodiscard]] auto find_command(std::string_view command) const
+      -> uint32_t;
+
+  std::vector<Entry> entries_;
+  std::vector<TrieNode> trie_{1};
+  std::unordered_map<std::string, std::vector<uint32_t>, StringHash,
+                     std::equal_to<>>
+      by_group_;
+  std::vector<uint32_t> unindexed_;
+  std::vector<uint32_t> free_slots_;
+  uint64_t next_order_ = 0;
+};
+
+} // namespace obcx::core
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "common/metrics.hpp"
+#include "common/token_bucket.hpp"
+#include <array>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace obcx::core {
+
+namespace asio = boost::asio;
+
+/**
+ * @brief 发送优先级，令牌不足时高优先级的消息先发
+ */
+enum class SendPriority {
+  /// 用户消息与命令回复
+  interactive,
+  /// 批量转发、重发
+  bulk,
+  /// 通知类消息
+  notification,
+};
+
+/**
+ * @brief 发送限速参数，默认值对应 Telegram Bot API 的限制
+ */
+struct SendLimits {
+  // 所有会话合计每秒发送数与突发量
+  double global_rate = 30;
+  double global_burst = 30;
+  // 每个群组每秒发送数（约 20 条/分钟）与突发量
+  double group_rate = 20.0 / 60;
+  double group_burst = 3;
+  // 每个私聊每秒发送数与突发量
+  double private_rate = 1;
+  double private_burst = 1;
+  // 被服务端以 429 拒绝后按 retry_after 重发的次数上限
+  int max_rate_limited_retries = 3;
+};
+
+/**
+ * @brief 出站消息调度器
+ *
+ * 每次发送先从全局令牌桶和目标会话的令牌桶各取一个令牌，取不到时排队；
+ * 排队的请求按优先级、再按提交顺序获得令牌，某个会话受限时不阻塞其他
+ * 会话。请求被服务端以 429 拒绝时暂停该会话 retry_after 秒后自动重发。
+ *
+ * 令牌的分配在内部 strand 上进行，可以从任意线程的协程调用 submit()；
+ * 请求本身仍在调用方的执行器上运行。所属 io_context 必须在运行。
+ */
+class SendScheduler {
+public:
+  using Request = std::function<asio::awaitable<std::string>()>;
+
+  explicit SendScheduler(asio::io_context &io_context, SendLimits limits = {});
+
+  SendScheduler(const SendScheduler &) = delete;
+  auto operator=(const SendScheduler &) -> SendScheduler & = delete;
+
+  /**
+   * @brief 等到令牌可用后执行请求
+   * @param chat_id 目标会话ID，负数为群组，其余按私聊限速
+   * @param priority 排队时的优先级
+   * @param request 实际发送请求的协程
+   * @return 请求的响应，在消息真正发出后返回
+   * @throws network::HttpRateLimitError 超过重发次数上限时
+   * @throws boost::system::system_error 等待令牌时被取消（operation_aborted）
+   */
+  auto submit(std::string chat_id, SendPriority priority, Request request)
+      -> asio::awaitable<std::string>;
+
+private:
+  struct Waiter;
+
+  auto acquire(std::string chat_id, SendPriority priority)
+      -> asio::awaitable<void>;
+
+  // 按优先级把可用令牌分给排队的请求，并在下一个令牌可用时再次运行；
+  // 只在 strand_ 上调用
+  void pump();
+
+  auto bucket(const std::string &chat_id) -> common::TokenBucket &;
+
+  // 丢弃已经补满的会话令牌桶，需要时按初始状态重建；至多每
+  // kChatExpiryInterval 扫描一次
+  void expire_idle_chats(common::TokenBucket::Clock::time_point now);
+
+  static constexpr std::chrono::seconds kChatExpiryInterval{60};
+
+  const SendLimits limits_;
+  asio::strand<asio::io_context::executor_type> strand_;
+  asio::steady_timer pump_timer_;
+  common::TokenBucket global_;
+  std::unordered_map<std::string, common::TokenBucket> chats_;
+  common::TokenBucket::Clock::time_point next_chat_expiry_{};
+  std::array<std::deque<std::shared_ptr<Waiter>>, 3> lanes_;
+
+  common::Counter &rate_limited_;
+  common::Histogram &queue_wait_;
+};
+
+} // namespace obcx::core
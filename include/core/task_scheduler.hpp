@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common/logger.hpp"
+#include "common/metrics.hpp"
 #include <boost/asio/any_io_executor.hpp>
 #include <boost/asio/awaitable.hpp>
 #include <boost/asio/post.hpp>
@@ -17,6 +18,35 @@
 
 namespace obcx::core {
 
+namespace detail {
+
+/**
+ * @brief 所有 TaskScheduler 共用的指标
+ */
+struct TaskSchedulerMetrics {
+  common::Gauge &queued;
+  common::Histogram &queue_wait;
+  common::Histogram &run_time;
+
+  static auto get() -> TaskSchedulerMetrics & {
+    static TaskSchedulerMetrics metrics = [] {
+      auto &registry = common::MetricsRegistry::instance();
+      return TaskSchedulerMetrics{
+          .queued = registry.gauge(
+              "obcx_scheduler_queued_tasks",
+              "Heavy tasks posted to the thread pool and not yet started"),
+          .queue_wait = registry.histogram(
+              "obcx_scheduler_queue_wait_seconds",
+              "Time a heavy task waited for a pool thread"),
+          .run_time = registry.histogram("obcx_scheduler_task_duration_seconds",
+                                         "Run time of a heavy task")};
+    }();
+    return metrics;
+  }
+};
+
+} // namespace detail
+
 /**
  * @brief 基于 Boost.Asio async_compose 的优雅任务调度器
  *
@@ -96,7 +126,13 @@ public:
     auto future = promise->get_future();
 
     // 提交任务到线程池
-    asio::post(thread_pool_, [task = std::move(task), promise]() mutable {
+    detail::TaskSchedulerMetrics::get().queued.inc();
+    const auto since = std::chrono::steady_clock::now();
+    auto job = [task = std::move(task), promise, since]() mutable {
+      auto &metrics = detail::TaskSchedulerMetrics::get();
+      metrics.queued.dec();
+      metrics.queue_wait.record(std::chrono::steady_clock::now() - since);
+      const common::ScopedTimer timer(metrics.run_time);
       try {
         std::stringstream worker_ss;
         worker_ss << std::this_thread::get_id();
@@ -117,7 +153,8 @@ public:
         OBCX_ERROR("TaskScheduler: 重负载任务执行时发生异常");
         promise->set_exception(std::current_exception());
       }
-    });
+    };
+    asio::post(thread_pool_, std::move(job));
 
     // 使用协程等待结果
     while (future.wait_for(std::chrono::milliseconds(1)) !=
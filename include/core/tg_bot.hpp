@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/send_scheduler.hpp"
 #include "interfaces/bot.hpp"
 
 #include "telegram/adapter/protocol_adapter.hpp"
@@ -25,10 +26,17 @@ struct MediaFileInfo {
 
 /**
  * @brief TelegramBot 类，继承自 Bot 基类，实现 Telegram 机器人功能
+ *
+ * 发送消息的接口经过 SendScheduler 按全局与会话限速排队，返回时消息已经
+ * 发出；被限流（429）的请求会自动按 retry_after 重发。
  */
 class TGBot : public IBot {
 public:
-  TGBot(adapter::telegram::ProtocolAdapter adapter);
+  /**
+   * @param send_limits 出站消息的限速参数
+   */
+  TGBot(adapter::telegram::ProtocolAdapter adapter,
+        SendLimits send_limits = {});
   ~TGBot() override;
 
   /**
@@ -83,27 +91,42 @@ public:
   asio::awaitable<std::string> send_group_message(
       std::string_view group_id, const common::Message &message) override;
 
+  /**
+   * @brief 按指定优先级发送群消息
+   * @param group_id 群组ID
+   * @param message 消息内容
+   * @param priority 排队时的优先级
+   * @return 操作结果的JSON响应
+   */
+  asio::awaitable<std::string> send_group_message(
+      std::string_view group_id, const common::Message &message,
+      SendPriority priority);
+
   /**
    * @brief 发送消息到特定的forum topic
    * @param group_id 群组ID
    * @param topic_id 话题ID
    * @param message 消息内容
+   * @param priority 排队时的优先级
    * @return 操作结果的JSON响应
    */
   asio::awaitable<std::string> send_topic_message(
       std::string_view group_id, int64_t topic_id,
-      const common::Message &message);
+      const common::Message &message,
+      SendPriority priority = SendPriority::interactive);
 
   /**
    * @brief 发送照片到群组
    * @param group_id 群组ID
    * @param photo_data 照片数据（file_id或URL）
    * @param caption 照片描述（可选）
+   * @param priority 排队时的优先级
    * @return 操作结果的JSON响应
    */
-  asio::awaitable<std::string> send_group_photo(std::string_view group_id,
-                                                std::string_view photo_data,
-                                                std::string_view caption = "");
+  asio::awaitable<std::string> send_group_photo(
+      std::string_view group_id, std::string_view photo_data,
+      std::string_view caption = "",
+      SendPriority priority = SendPriority::interactive);
 
   // --- 消息管理 API ---
 
@@ -456,6 +479,20 @@ private:
   void ensure_connection_manager() const;
 
   auto get_telegram_adapter() const -> adapter::telegram::ProtocolAdapter &;
+
+  /**
+   * @brief 经发送调度器排队后调用 API
+   * @param chat_id 目标会话ID
+   * @param priority 排队时的优先级
+   * @param payload 序列化后的请求
+   * @param echo_id 用于匹配响应的 echo ID
+   * @return 响应的 JSON 字符串
+   */
+  auto send_scheduled(std::string_view chat_id, SendPriority priority,
+                      std::string payload, uint64_t echo_id)
+      -> asio::awaitable<std::string>;
+
+  std::unique_ptr<SendScheduler> send_scheduler_;
 };
 
 } // namespace obcx::core
\ No newline at end of file
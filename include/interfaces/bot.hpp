@@ -1,13 +1,16 @@
 #pragma once
 #include "common/message_type.hpp"
+#include "common/metrics.hpp"
 #include "core/event_dispatcher.hpp"
 #include "core/task_scheduler.hpp"
 #include "interfaces/connection_manager.hpp"
 
 #include "interfaces/protocol_adapter.hpp"
 #include <boost/asio/awaitable.hpp>
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace obcx::core {
@@ -29,12 +32,94 @@ public:
   /**
    * @brief 注册事件处理器的语法糖 (新版本，支持Bot引用)
    * @tparam EventType 事件类型
-   * @param handler 协程事件处理器，接受Bot引用和事件参数
+   * @param handler 协程事件处理器，接受Bot引用和事件参数。按值接收事件的
+   * 处理器依然可用，但会为每次调用拷贝一次事件
+   * @param policy 调度策略（并发上限、按键串行），默认不限并发
+   * @return 传给 off_event() 的令牌
    */
   template <typename EventType>
-  void on_event(
-      std::function<asio::awaitable<void>(IBot &, EventType)> handler) {
-    dispatcher_->on<EventType>(std::move(handler));
+  auto on_event(
+      std::function<asio::awaitable<void>(IBot &, const EventType &)> handler,
+      HandlerPolicy policy = {}) -> HandlerToken {
+    return dispatcher_->on<EventType>(std::move(handler), std::move(policy));
+  }
+
+  /**
+   * @brief 注册带谓词的事件处理器，谓词不成立时不会启动协程
+   * @tparam EventType 事件类型
+   * @param predicate 分发时同步调用的过滤谓词
+   * @param handler 协程事件处理器
+   * @param policy 调度策略，默认不限并发
+   * @return 传给 off_event() 的令牌
+   */
+  template <typename EventType>
+  auto on_event(
+      std::function<bool(const EventType &)> predicate,
+      std::function<asio::awaitable<void>(IBot &, const EventType &)> handler,
+      HandlerPolicy policy = {}) -> HandlerToken {
+    return dispatcher_->on<EventType>(std::move(predicate), std::move(handler),
+                                      std::move(policy));
+  }
+
+  /**
+   * @brief 注册带声明式过滤条件的消息处理器
+   * @param filter 过滤条件（群号、消息类型、命令前缀、@机器人等）
+   * @param handler 协程消息处理器
+   * @param policy 调度策略，默认不限并发
+   * @return 传给 off_event() 的令牌
+   */
+  auto on_event(MessageFilter filter,
+                std::function<asio::awaitable<void>(
+                    IBot &, const common::MessageEvent &)>
+                    handler,
+                HandlerPolicy policy = {}) -> HandlerToken {
+    return dispatcher_->on(std::move(filter), std::move(handler),
+                           std::move(policy));
+  }
+
+  /**
+   * @brief 注销 on_event() 注册的处理器，已在处理的事件仍会处理完
+   * @return 处理器是否存在
+   */
+  auto off_event(HandlerToken token) -> bool {
+    return dispatcher_->off(token);
+  }
+
+  /**
+   * @brief 事件分发器，供 PluginManager 等需要暂存事件或按所属者管理
+   * 处理器的组件使用
+   */
+  [[nodiscard]] auto dispatcher() -> EventDispatcher & { return *dispatcher_; }
+
+  /**
+   * @brief Bot 的事件循环，连接状态只在其上访问
+   *
+   * 在其他线程上调用 API 时，先用 co_spawn 把调用投递到这里再等待结果。
+   */
+  [[nodiscard]] auto get_io_context() -> asio::io_context & {
+    return *io_context_;
+  }
+
+  /**
+   * @brief 带名称调度策略的事件处理器的排队统计
+   */
+  [[nodiscard]] auto handler_stats() const -> std::vector<HandlerStats> {
+    return dispatcher_->handler_stats();
+  }
+
+  /// stop() 与析构时等待处理中事件的默认时长
+  static constexpr std::chrono::milliseconds kDefaultDrainTimeout{5000};
+
+  /**
+   * @brief 停止接收事件，等待处理中的事件处理器完成，超时后取消其余处理器
+   *
+   * 阻塞调用，应在运行事件循环的线程之外调用；stop() 在尚未 drain 时会以
+   * 默认时长调用它。
+   * @param timeout 取消前的最长等待时间
+   * @return 取消后仍未结束的处理器数
+   */
+  auto drain(std::chrono::milliseconds timeout) -> std::size_t {
+    return dispatcher_->drain(timeout);
   }
 
   /**
@@ -67,6 +152,9 @@ public:
 
   /**
    * @brief 停止 Bot 的事件循环
+   *
+   * 先以 kDefaultDrainTimeout 调用 drain()，再断开连接并停止事件循环。
+   * 调用前已经 drain() 过时不再等待，已被取消的处理器不会再计一次时。
    */
   virtual void stop() = 0;
 
@@ -396,12 +484,29 @@ public:
   }
 
 protected:
+  /**
+   * @brief 通过连接管理器发送 API 请求并等待响应
+   *
+   * 各 API 实现统一经由此处调用，按连接类型记录调用耗时与失败次数。
+   * @param payload 序列化后的请求
+   * @param echo_id 用于匹配响应的 echo ID
+   * @return 响应的 JSON 字符串
+   */
+  auto call_api(std::string payload, uint64_t echo_id)
+      -> asio::awaitable<std::string>;
+
   std::shared_ptr<asio::io_context> io_context_;
   std::unique_ptr<adapter::BaseProtocolAdapter> adapter_;
   std::unique_ptr<EventDispatcher> dispatcher_;
   std::unique_ptr<TaskScheduler> task_scheduler_;
   std::unique_ptr<network::IConnectionManager> connection_manager_;
   common::ConnectionConfig conection_config_;
+
+private:
+  // API 调用指标，首次调用时按连接类型创建
+  std::once_flag api_metrics_once_;
+  common::Histogram *api_duration_ = nullptr;
+  common::Counter *api_errors_ = nullptr;
 };
 
 } // namespace obcx::core
\ No newline at end of file
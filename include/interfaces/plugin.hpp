@@ -2,8 +2,11 @@
 
 #include "common/config_loader.hpp"
 #include "common/message_type.hpp"
+#include "common/metrics.hpp"
 #include "interfaces/bot.hpp"
 #include <boost/asio/awaitable.hpp>
+#include <concepts>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -23,6 +26,32 @@ enum class CallbackType {
   ERROR
 };
 
+/// PluginMetadata 的结构版本，字段变化时递增
+inline constexpr uint32_t kPluginMetadataVersion = 1;
+
+/**
+ * @brief 插件的静态元数据
+ *
+ * 插件类提供 `static auto metadata() -> const PluginMetadata &` 时，
+ * OBCX_PLUGIN_EXPORT 会以 obcx_plugin_metadata 符号导出它，加载器无需
+ * 构造插件实例即可读取名称与依赖。所有字符串须为静态存储期。
+ */
+struct PluginMetadata {
+  uint32_t struct_version = kPluginMetadataVersion;
+  const char *name = nullptr;
+  const char *version = nullptr;
+  const char *description = nullptr;
+  /// 必须先完成初始化的插件名，以 nullptr 结尾；为 nullptr 表示没有依赖
+  const char *const *dependencies = nullptr;
+  /// initialize() 能否与其他插件的 initialize() 并行执行
+  bool concurrent_init = true;
+};
+
+template <typename T>
+concept HasPluginMetadata = requires {
+  { T::metadata() } -> std::same_as<const PluginMetadata &>;
+};
+
 class IPlugin {
 public:
   virtual ~IPlugin() = default;
@@ -45,36 +74,32 @@ public:
   static void set_bots(std::vector<std::unique_ptr<core::IBot>> *bots,
                        std::mutex *mutex);
 
+  /**
+   * @brief 进程内的指标注册表
+   *
+   * 可读取框架自身的指标，也可注册插件自己的计数器与延迟直方图，
+   * 它们会随框架指标一同导出。返回的指标引用应缓存，不要在热路径上查表。
+   */
+  static auto metrics() -> common::MetricsRegistry &;
+
+  /**
+   * @brief 读取 [plugins.<name>.config] 中的值
+   *
+   * 从当前配置快照中无锁读取预先展平的值，可以在热路径上调用；配置文件
+   * 重新加载后读到的是新值。
+   * @param key 相对 config 表的路径，如 "qbt_port" 或 "limits.max[0]"
+   */
   template <typename T>
   auto get_config_value(const std::string &key) const -> std::optional<T> {
-    auto config =
-        common::ConfigLoader::instance().get_plugin_config(get_name());
-    if (!config)
+    const auto snapshot = common::ConfigLoader::instance().snapshot();
+    if (!snapshot) {
       return std::nullopt;
-
-    auto node = config->config.at_path(key);
-    if (!node)
+    }
+    const auto *plugin = snapshot->plugin(get_name());
+    if (plugin == nullptr) {
       return std::nullopt;
-
-    if constexpr (std::is_same_v<T, std::string>) {
-      if (auto val = node.value<std::string>()) {
-        return *val;
-      }
-    } else if constexpr (std::is_same_v<T, int64_t>) {
-      if (auto val = node.value<int64_t>()) {
-        return *val;
-      }
-    } else if constexpr (std::is_same_v<T, double>) {
-      if (auto val = node.value<double>()) {
-        return *val;
-      }
-    } else if constexpr (std::is_same_v<T, bool>) {
-      if (auto val = node.value<bool>()) {
-        return *val;
-      }
     }
-
-    return std::nullopt;
+    return plugin->values.get<T>(key);
   }
 
   std::optional<toml::table> get_config_section(
@@ -110,24 +135,39 @@ private:
       }                                                                        \
     }                                                                          \
   }                                                                            \
+  const obcx::interface::PluginMetadata *obcx_plugin_metadata() {              \
+    if constexpr (obcx::interface::HasPluginMetadata<PluginClass>) {           \
+      return &PluginClass::metadata();                                         \
+    } else {                                                                   \
+      return nullptr;                                                          \
+    }                                                                          \
+  }                                                                            \
   const char *obcx_get_plugin_name() {                                         \
-    static thread_local std::string name;                                      \
-    try {                                                                      \
-      PluginClass temp;                                                        \
-      name = temp.get_name();                                                  \
-      return name.c_str();                                                     \
-    } catch (...) {                                                            \
-      return "unknown";                                                        \
+    if constexpr (obcx::interface::HasPluginMetadata<PluginClass>) {           \
+      return PluginClass::metadata().name;                                     \
+    } else {                                                                   \
+      static thread_local std::string name;                                    \
+      try {                                                                    \
+        PluginClass temp;                                                      \
+        name = temp.get_name();                                                \
+        return name.c_str();                                                   \
+      } catch (...) {                                                          \
+        return "unknown";                                                      \
+      }                                                                        \
     }                                                                          \
   }                                                                            \
   const char *obcx_get_plugin_version() {                                      \
-    static thread_local std::string version;                                   \
-    try {                                                                      \
-      PluginClass temp;                                                        \
-      version = temp.get_version();                                            \
-      return version.c_str();                                                  \
-    } catch (...) {                                                            \
-      return "unknown";                                                        \
+    if constexpr (obcx::interface::HasPluginMetadata<PluginClass>) {           \
+      return PluginClass::metadata().version;                                  \
+    } else {                                                                   \
+      static thread_local std::string version;                                 \
+      try {                                                                    \
+        PluginClass temp;                                                      \
+        version = temp.get_version();                                          \
+        return version.c_str();                                                \
+      } catch (...) {                                                          \
+        return "unknown";                                                      \
+      }                                                                        \
     }                                                                          \
   }                                                                            \
   }
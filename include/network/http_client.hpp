@@ -2,9 +2,11 @@
 
 #include "common/logger.hpp"
 #include "common/message_type.hpp"
+#include "common/metrics.hpp"
 #include <boost/asio.hpp>
 #include <boost/beast.hpp>
 #include <boost/beast/ssl.hpp>
+#include <chrono>
 #include <functional>
 #include <future>
 #include <memory>
@@ -38,6 +40,23 @@ public:
       : std::runtime_error(message.data()) {}
 };
 
+/**
+ * @brief 服务端以 429 拒绝请求时抛出，携带要求的等待时间
+ */
+class HttpRateLimitError : public HttpClientError {
+public:
+  HttpRateLimitError(std::string_view message,
+                     std::chrono::seconds retry_after)
+      : HttpClientError(message), retry_after_(retry_after) {}
+
+  [[nodiscard]] auto retry_after() const noexcept -> std::chrono::seconds {
+    return retry_after_;
+  }
+
+private:
+  std::chrono::seconds retry_after_;
+};
+
 /**
  * @brief 异步HTTP客户端
  * 基于Boost.Beast，支持HTTP和HTTPS
@@ -136,6 +155,21 @@ public:
    */
   virtual void close();
 
+protected:
+  /**
+   * @brief 一类请求的耗时直方图与失败计数
+   */
+  struct RequestMetrics {
+    common::Histogram &duration;
+    common::Counter &errors;
+  };
+
+  /**
+   * @brief 按请求方法与路径类型（direct/proxy）取得请求指标
+   */
+  static auto request_metrics(std::string_view method, std::string_view via)
+      -> RequestMetrics;
+
 private:
   struct Impl;
   std::unique_ptr<Impl> pimpl_;
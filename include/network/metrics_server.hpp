@@ -0,0 +1,68 @@
+#pragma once
+
+#include "common/metrics.hpp"
+#include <boost/asio.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace obcx::network {
+
+namespace asio = boost::asio;
+
+/**
+ * @brief 以 Prometheus 文本格式导出指标的本地 HTTP 服务
+ *
+ * 在独立的线程与 io_context 上运行，对 GET /metrics 返回
+ * MetricsRegistry::render_prometheus() 的结果，GET /trace 返回
+ * Tracer::export_chrome_json() 的结果，其他路径返回 404。
+ * 每个连接只处理一个请求，不支持 keep-alive；默认只监听本机地址。
+ */
+class MetricsServer {
+public:
+  /**
+   * @brief 构造函数，不会立即监听
+   * @param host 监听地址
+   * @param port 监听端口，0 表示由系统分配
+   * @param registry 导出的注册表
+   */
+  MetricsServer(std::string host, uint16_t port,
+                common::MetricsRegistry &registry =
+                    common::MetricsRegistry::instance());
+
+  ~MetricsServer();
+
+  MetricsServer(const MetricsServer &) = delete;
+  auto operator=(const MetricsServer &) -> MetricsServer & = delete;
+
+  /**
+   * @brief 绑定端口并在后台线程开始服务
+   * @throws boost::system::system_error 地址无效或端口被占用时
+   */
+  void start();
+
+  /**
+   * @brief 停止服务并等待后台线程退出
+   */
+  void stop();
+
+  /**
+   * @brief 实际监听的端口，start() 之后有效
+   */
+  [[nodiscard]] auto port() const -> uint16_t { return bound_port_; }
+
+private:
+  auto accept_loop() -> asio::awaitable<void>;
+  auto serve(asio::ip::tcp::socket socket) -> asio::awaitable<void>;
+
+  std::string host_;
+  uint16_t port_;
+  uint16_t bound_port_ = 0;
+  common::MetricsRegistry &registry_;
+  asio::io_context ioc_;
+  asio::ip::tcp::acceptor acceptor_;
+  std::thread thread_;
+};
+
+} // namespace obcx::network
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "common/message_type.hpp"
+#include "core/event_dispatcher.hpp"
+#include <chrono>
+#include <functional>
 #include <optional>
 #include <string_view>
 
@@ -45,6 +48,93 @@ namespace EventConverter {
  * event.
  */
 auto from_v11_json(std::string_view json_str) -> std::optional<common::Event>;
+
+/**
+ * \~chinese
+ * @brief 扩展事件转换函数，输入为完整的事件 JSON 对象。
+ *
+ * \~english
+ * @brief Extension event converter; receives the whole event JSON object.
+ */
+using Converter =
+    std::function<std::optional<common::Event>(const nlohmann::json &)>;
+
+/**
+ * \~chinese
+ * @brief 为 OneBot 扩展事件注册转换函数，无需修改核心代码。
+ *
+ * 键的格式为 "post_type" 或 "post_type.子类型"，子类型分别取自
+ * message_type / notice_type / request_type / meta_event_type，例如
+ * "notice.group_recall"。带子类型的键优先于只有 post_type 的键，两者都优先
+ * 于内置转换；未知的 post_type 只有注册了转换函数才会被接受。
+ * 同一个键重复注册会覆盖旧的函数。插件必须在卸载前调用
+ * unregister_converter，否则注册表会持有已卸载代码的函数。
+ *
+ * @param event_key 事件键
+ * @param converter 转换函数，返回 std::nullopt 表示丢弃该事件
+ *
+ * \~english
+ * @brief Registers a converter for a OneBot extension event without touching
+ * the core.
+ *
+ * Keys are "post_type" or "post_type.subtype", where the subtype comes from
+ * message_type / notice_type / request_type / meta_event_type, e.g.
+ * "notice.group_recall". A subtype key wins over a bare post_type key, and both
+ * win over the built-in conversion; unknown post_types are only accepted when a
+ * converter is registered. Registering the same key again replaces the old
+ * converter. Plugins must call unregister_converter before they are unloaded,
+ * otherwise the registry keeps functions from unloaded code.
+ *
+ * @param event_key The event key.
+ * @param converter The converter; returning std::nullopt drops the event.
+ */
+void register_converter(std::string_view event_key, Converter converter);
+
+/**
+ * \~chinese
+ * @brief 注销扩展事件转换函数。
+ * @return 是否存在并已移除
+ *
+ * \~english
+ * @brief Unregisters an extension event converter.
+ * @return True if a converter was registered and has been removed.
+ */
+auto unregister_converter(std::string_view event_key) -> bool;
+
+/**
+ * \~chinese
+ * @brief 注销某所属者注册的全部扩展事件转换函数。
+ *
+ * 转换函数注册时记录 HandlerOwnerScope::current()。热重载在卸载插件前调用，
+ * 兜底移除插件没有自行注销的转换函数。
+ * @return 注销的数量
+ *
+ * \~english
+ * @brief Unregisters every extension converter registered by an owner.
+ *
+ * Converters remember HandlerOwnerScope::current() at registration. Hot reload
+ * calls this before unloading a plugin to drop converters the plugin did not
+ * unregister itself.
+ * @return The number of converters removed.
+ */
+auto unregister_owner(core::HandlerOwner owner) -> std::size_t;
+
+/**
+ * \~chinese
+ * @brief 等待某所属者的转换函数调用全部结束。
+ *
+ * 阻塞调用。先注销该所属者的转换函数，返回 true 后不会再运行其代码。
+ * @return 是否已没有该所属者的调用
+ *
+ * \~english
+ * @brief Waits until no converter call of an owner is running.
+ *
+ * Blocking. Unregister the owner's converters first; once this returns true
+ * none of its code runs any more.
+ * @return True if no call of the owner is running.
+ */
+auto wait_idle(core::HandlerOwner owner, std::chrono::milliseconds timeout)
+    -> bool;
 }; // namespace EventConverter
 
 } // namespace obcx::adapter::onebot11
\ No newline at end of file
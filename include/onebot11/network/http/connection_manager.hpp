@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/event_journal.hpp"
 #include "common/message_type.hpp"
 #include "interfaces/connection_manager.hpp"
 #include "network/http_client.hpp"
@@ -73,6 +74,9 @@ private:
 
   // 轮询间隔（毫秒）
   std::chrono::milliseconds poll_interval_{1000};
+
+  // 流量日志，未配置 journal_path 时为空
+  std::unique_ptr<common::JournalWriter> journal_;
 };
 
 } // namespace obcx::network
\ No newline at end of file
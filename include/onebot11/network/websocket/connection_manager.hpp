@@ -1,6 +1,8 @@
 #pragma once
 
+#include "common/event_journal.hpp"
 #include "common/message_type.hpp"
+#include "common/metrics.hpp"
 #include "interfaces/connection_manager.hpp"
 #include "network/websocket_client.hpp"
 #include <boost/asio.hpp>
@@ -111,6 +113,12 @@ private:
 
   // 连接状态跟踪
   std::atomic_bool is_connected_ = false;
+
+  // 流量日志，未配置 journal_path 时为空
+  std::unique_ptr<common::JournalWriter> journal_;
+
+  // 导出时读取 pending_requests_ 的大小；最先析构，之后不再访问本对象
+  common::MetricsRegistration pending_requests_metric_;
 };
 
 } // namespace obcx::network
\ No newline at end of file
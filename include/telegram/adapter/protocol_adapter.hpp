@@ -29,6 +29,18 @@ public:
   auto parse_event(std::string_view json_str)
       -> std::optional<common::Event> override;
 
+  /**
+   * @brief 解析已经反序列化的单个更新对象。
+   *
+   * getUpdates 的响应整体解析一次后逐条交给此函数，避免每条更新再
+   * dump 成字符串重新解析。
+   * @param update_json 单个 Update 对象。
+   * @return 如果是有效事件，则返回转换后的内部 Event 对象；否则返回
+   * std::nullopt。
+   */
+  auto parse_update(const nlohmann::json &update_json)
+      -> std::optional<common::Event>;
+
 private:
   /**
    * @brief 解析消息事件
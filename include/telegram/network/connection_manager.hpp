@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/event_journal.hpp"
 #include "common/message_type.hpp"
 #include "interfaces/connection_manager.hpp"
 #include "network/http_client.hpp"
@@ -87,6 +88,9 @@ private:
 
   // 更新偏移量
   int update_offset_{0};
+
+  // 流量日志，未配置 journal_path 时为空
+  std::unique_ptr<common::JournalWriter> journal_;
 };
 
 } // namespace obcx::network
\ No newline at end of file
@@ -1,169 +1,140 @@
 #include "common/config_loader.hpp"
 #include "common/logger.hpp"
-#include <fstream>
+
+#include <algorithm>
 
 namespace obcx::common {
 
 bool ConfigLoader::load_config(const std::string &config_path) {
-  std::lock_guard lock(mutex_);
+  std::lock_guard load_lock(load_mutex_);
 
+  std::shared_ptr<const ConfigSnapshot> next;
   try {
-    config_path_ = config_path;
-    config_data_ = std::make_unique<toml::table>(toml::parse_file(config_path));
-    OBCX_INFO("Config loaded successfully from: {}", config_path);
-    return true;
+    next = std::make_shared<const ConfigSnapshot>(
+        toml::parse_file(config_path), version_ + 1);
   } catch (const toml::parse_error &e) {
     OBCX_INFO("Failed to parse config file {}: {}", config_path, e.what());
-    config_data_.reset();
     return false;
   } catch (const std::exception &e) {
     OBCX_INFO("Failed to load config file {}: {}", config_path, e.what());
-    config_data_.reset();
     return false;
   }
+
+  std::vector<uint64_t> ids;
+  {
+    std::lock_guard lock(mutex_);
+    config_path_ = config_path;
+    ++version_;
+    ids.reserve(listeners_.size());
+    for (const auto &[id, listener] : listeners_) {
+      ids.push_back(id);
+    }
+  }
+  snapshot_.store(next, std::memory_order_release);
+  OBCX_INFO("Config loaded successfully from: {} (version {})", config_path,
+            next->version());
+
+  // 逐个在锁外调用，调用前确认仍在订阅，并登记为正在调用，使
+  // unsubscribe() 能等它返回
+  for (const auto id : ids) {
+    Listener listener;
+    {
+      std::lock_guard lock(mutex_);
+      const auto it = std::ranges::find(
+          listeners_, id, &std::pair<uint64_t, Listener>::first);
+      if (it == listeners_.end()) {
+        continue;
+      }
+      listener = it->second;
+      notifying_ = id;
+      notifying_thread_ = std::this_thread::get_id();
+    }
+    try {
+      listener(next);
+    } catch (const std::exception &e) {
+      OBCX_ERROR("Config reload listener threw: {}", e.what());
+    }
+    {
+      std::lock_guard lock(mutex_);
+      notifying_ = 0;
+    }
+    listener_done_.notify_all();
+  }
+  return true;
 }
 
-std::vector<BotConfig> ConfigLoader::get_bot_configs() const {
+uint64_t ConfigLoader::subscribe(Listener listener) {
   std::lock_guard lock(mutex_);
-  std::vector<BotConfig> bot_configs;
+  const auto id = next_listener_++;
+  listeners_.emplace_back(id, std::move(listener));
+  return id;
+}
 
-  if (!config_data_) {
-    return bot_configs;
+void ConfigLoader::unsubscribe(uint64_t id) {
+  std::unique_lock lock(mutex_);
+  std::erase_if(listeners_,
+                [id](const auto &listener) { return listener.first == id; });
+  // 在订阅者内部取消自己时不能等待自己返回
+  if (notifying_thread_ != std::this_thread::get_id()) {
+    listener_done_.wait(lock, [this, id] { return notifying_ != id; });
   }
+}
 
-  if (auto bots_section = config_data_->get("bots")) {
-    if (auto bots_table = bots_section->as_table()) {
-      for (const auto &[bot_name, bot_config] : *bots_table) {
-        if (auto bot_table = bot_config.as_table()) {
-          BotConfig config;
-          config.type = bot_table->get("type")->value_or<std::string>("");
-          config.enabled = bot_table->get("enabled")->value_or<bool>(false);
-
-          if (auto conn_section = bot_table->get("connection")) {
-            if (auto conn_table = conn_section->as_table()) {
-              config.connection = *conn_table;
-            }
-          }
-
-          if (auto plugins_section = bot_table->get("plugins")) {
-            if (auto plugins_array = plugins_section->as_array()) {
-              for (const auto &plugin : *plugins_array) {
-                if (auto plugin_str = plugin.value<std::string>()) {
-                  config.plugins.push_back(*plugin_str);
-                }
-              }
-            }
-          }
-
-          bot_configs.push_back(std::move(config));
-        }
-      }
-    }
+std::vector<BotConfig> ConfigLoader::get_bot_configs() const {
+  const auto current = snapshot();
+  if (!current) {
+    return {};
   }
-
-  return bot_configs;
+  return current->bots();
 }
 
 std::optional<PluginConfig> ConfigLoader::get_plugin_config(
     const std::string &plugin_name) const {
-  std::lock_guard lock(mutex_);
-
-  if (!config_data_) {
+  const auto current = snapshot();
+  if (!current) {
     return std::nullopt;
   }
-
-  std::string plugin_path = "plugins." + plugin_name;
-  if (auto plugin_section = config_data_->at_path(plugin_path)) {
-    if (auto plugin_table = plugin_section.as_table()) {
-      PluginConfig config;
-      config.name = plugin_name;
-      config.enabled = plugin_table->get("enabled")->value_or<bool>(false);
-
-      if (auto config_section = plugin_table->get("config")) {
-        if (auto config_table = config_section->as_table()) {
-          config.config = *config_table;
-        }
-      }
-
-      if (auto callbacks_section = plugin_table->get("callbacks")) {
-        if (auto callbacks_array = callbacks_section->as_array()) {
-          for (const auto &callback : *callbacks_array) {
-            if (auto callback_str = callback.value<std::string>()) {
-              config.callbacks.push_back(*callback_str);
-            }
-          }
-        }
-      }
-
-      return config;
-    }
+  if (const auto *plugin = current->plugin(plugin_name)) {
+    return plugin->info;
   }
-
   return std::nullopt;
 }
 
 std::vector<PluginConfig> ConfigLoader::get_all_plugin_configs() const {
-  std::lock_guard lock(mutex_);
   std::vector<PluginConfig> plugin_configs;
-
-  if (!config_data_) {
+  const auto current = snapshot();
+  if (!current) {
     return plugin_configs;
   }
-
-  if (auto plugins_section = config_data_->get("plugins")) {
-    if (auto plugins_table = plugins_section->as_table()) {
-      for (const auto &[plugin_name, plugin_config] : *plugins_table) {
-        if (auto plugin_table = plugin_config.as_table()) {
-          PluginConfig config;
-          config.name = std::string{plugin_name};
-          config.enabled = plugin_table->get("enabled")->value_or<bool>(false);
-
-          if (auto config_section = plugin_table->get("config")) {
-            if (auto config_table = config_section->as_table()) {
-              config.config = *config_table;
-            }
-          }
-
-          if (auto callbacks_section = plugin_table->get("callbacks")) {
-            if (auto callbacks_array = callbacks_section->as_array()) {
-              for (const auto &callback : *callbacks_array) {
-                if (auto callback_str = callback.value<std::string>()) {
-                  config.callbacks.push_back(*callback_str);
-                }
-              }
-            }
-          }
-
-          plugin_configs.push_back(std::move(config));
-        }
-      }
-    }
+  plugin_configs.reserve(current->plugins().size());
+  for (const auto &plugin : current->plugins()) {
+    plugin_configs.push_back(plugin.info);
   }
-
   return plugin_configs;
 }
 
 std::optional<toml::table> ConfigLoader::get_section(
     const std::string &section_name) const {
-  std::lock_guard lock(mutex_);
-
-  if (!config_data_) {
+  const auto current = snapshot();
+  if (!current) {
     return std::nullopt;
   }
 
-  if (auto section = config_data_->get(section_name)) {
-    if (auto section_table = section->as_table()) {
-      return *section_table;
-    }
+  // 支持 "bots.qq_bot.connection" 这样的路径
+  if (const auto *section_table =
+          current->table().at_path(section_name).as_table()) {
+    return *section_table;
   }
 
   return std::nullopt;
 }
 
-void ConfigLoader::reload_config() {
-  if (!config_path_.empty()) {
-    load_config(config_path_);
+bool ConfigLoader::reload_config() {
+  const auto path = get_config_path();
+  if (path.empty()) {
+    return false;
   }
+  return load_config(path);
 }
 
-} // namespace obcx::common
\ No newline at end of file
+} // namespace obcx::common
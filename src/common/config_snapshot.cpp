@@ -0,0 +1,116 @@
+#include "common/config_snapshot.hpp"
+
+#include <algorithm>
+
+namespace obcx::common {
+
+namespace {
+
+auto string_list(const toml::node_view<const toml::node> &node)
+    -> std::vector<std::string> {
+  std::vector<std::string> items;
+  if (const auto *array = node.as_array()) {
+    for (const auto &item : *array) {
+      if (auto text = item.value<std::string>()) {
+        items.push_back(std::move(*text));
+      }
+    }
+  }
+  return items;
+}
+
+auto sub_table(const toml::node_view<const toml::node> &node)
+    -> toml::table {
+  if (const auto *table = node.as_table()) {
+    return *table;
+  }
+  return {};
+}
+
+} // namespace
+
+ConfigValues::ConfigValues(const toml::table &table) {
+  // path 在递归中复用，进入子节点时追加、返回时截断
+  std::string path;
+  auto flatten = [this, &path](auto &self, const toml::node &node) -> void {
+    if (const auto *child_table = node.as_table()) {
+      for (const auto &[key, child] : *child_table) {
+        const auto length = path.size();
+        if (!path.empty()) {
+          path += '.';
+        }
+        path += key.str();
+        self(self, child);
+        path.resize(length);
+      }
+    } else if (const auto *array = node.as_array()) {
+      for (std::size_t i = 0; i < array->size(); ++i) {
+        const auto length = path.size();
+        path += '[';
+        path += std::to_string(i);
+        path += ']';
+        self(self, (*array)[i]);
+        path.resize(length);
+      }
+    } else if (const auto *text = node.as_string()) {
+      values_.emplace(path, text->get());
+    } else if (const auto *integer = node.as_integer()) {
+      values_.emplace(path, integer->get());
+    } else if (const auto *number = node.as_floating_point()) {
+      values_.emplace(path, number->get());
+    } else if (const auto *flag = node.as_boolean()) {
+      values_.emplace(path, flag->get());
+    }
+    // 日期与时间不展平，可通过 ConfigSnapshot::table() 读取
+  };
+  flatten(flatten, table);
+}
+
+auto ConfigValues::find(std::string_view key) const -> const Value * {
+  const auto it = values_.find(key);
+  return it != values_.end() ? &it->second : nullptr;
+}
+
+ConfigSnapshot::ConfigSnapshot(toml::table root, uint64_t version)
+    : root_(std::move(root)), version_(version), values_(root_) {
+  if (const auto *bots = root_["bots"].as_table()) {
+    for (const auto &[name, node] : *bots) {
+      if (!node.is_table()) {
+        continue;
+      }
+      const toml::node_view<const toml::node> bot{node};
+      bots_.push_back({.type = bot["type"].value_or<std::string>(""),
+                       .enabled = bot["enabled"].value_or(false),
+                       .connection = sub_table(bot["connection"]),
+                       .plugins = string_list(bot["plugins"])});
+    }
+  }
+
+  if (const auto *plugins = root_["plugins"].as_table()) {
+    for (const auto &[name, node] : *plugins) {
+      if (!node.is_table()) {
+        continue;
+      }
+      const toml::node_view<const toml::node> plugin{node};
+      PluginSnapshot snapshot{
+          .info = {.name = std::string(name.str()),
+                   .enabled = plugin["enabled"].value_or(false),
+                   .config = sub_table(plugin["config"]),
+                   .callbacks = string_list(plugin["callbacks"])},
+          .values = {}};
+      snapshot.values = ConfigValues(snapshot.info.config);
+      plugins_.push_back(std::move(snapshot));
+    }
+  }
+}
+
+auto ConfigSnapshot::plugin(std::string_view name) const
+    -> const PluginSnapshot * {
+  // 插件通常只有几个，线性查找比哈希更快
+  const auto it = std::ranges::find(plugins_, name, [](const auto &plugin) {
+    return std::string_view(plugin.info.name);
+  });
+  return it != plugins_.end() ? &*it : nullptr;
+}
+
+} // namespace obcx::common
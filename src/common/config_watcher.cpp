@@ -0,0 +1,108 @@
+#include "common/config_watcher.hpp"
+#include "common/logger.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace obcx::common {
+
+ConfigWatcher::ConfigWatcher(std::string path, std::function<void()> on_change,
+                             std::chrono::milliseconds debounce)
+    : path_(std::move(path)), on_change_(std::move(on_change)),
+      debounce_(debounce) {}
+
+ConfigWatcher::~ConfigWatcher() { stop(); }
+
+auto ConfigWatcher::start() -> bool {
+  if (thread_.joinable()) {
+    return true;
+  }
+  auto directory = std::filesystem::path(path_).parent_path();
+  if (directory.empty()) {
+    directory = ".";
+  }
+
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (inotify_fd_ < 0 || wake_fd_ < 0 ||
+      inotify_add_watch(inotify_fd_, directory.c_str(),
+                        IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+    OBCX_ERROR("Cannot watch config file {}: {}", path_,
+               std::strerror(errno));
+    stop();
+    return false;
+  }
+
+  thread_ = std::thread([this] { run(); });
+  OBCX_INFO("Watching {} for changes", path_);
+  return true;
+}
+
+void ConfigWatcher::stop() {
+  if (thread_.joinable()) {
+    const uint64_t one = 1;
+    [[maybe_unused]] auto written = write(wake_fd_, &one, sizeof(one));
+    thread_.join();
+  }
+  for (int *fd : {&inotify_fd_, &wake_fd_}) {
+    if (*fd >= 0) {
+      close(*fd);
+      *fd = -1;
+    }
+  }
+}
+
+void ConfigWatcher::run() {
+  const auto file_name = std::filesystem::path(path_).filename().string();
+  std::array<pollfd, 2> fds{
+      pollfd{.fd = inotify_fd_, .events = POLLIN, .revents = 0},
+      pollfd{.fd = wake_fd_, .events = POLLIN, .revents = 0}};
+  // 事件缓冲区须按 inotify_event 对齐
+  alignas(inotify_event) std::array<char, 4096> buffer{};
+  bool pending = false;
+
+  while (true) {
+    const int timeout = pending ? static_cast<int>(debounce_.count()) : -1;
+    const int ready = poll(fds.data(), fds.size(), timeout);
+    if (ready < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      OBCX_ERROR("Config watcher poll failed: {}", std::strerror(errno));
+      return;
+    }
+    if ((fds[1].revents & POLLIN) != 0) {
+      return;
+    }
+    if (ready == 0) {
+      // debounce 时长内没有新的变化
+      pending = false;
+      try {
+        on_change_();
+      } catch (const std::exception &e) {
+        OBCX_ERROR("Config change handler threw: {}", e.what());
+      }
+      continue;
+    }
+
+    ssize_t length = 0;
+    while ((length = read(inotify_fd_, buffer.data(), buffer.size())) > 0) {
+      for (ssize_t offset = 0; offset < length;) {
+        const auto *event =
+            reinterpret_cast<const inotify_event *>(buffer.data() + offset);
+        if (event->len > 0 && file_name == event->name) {
+          pending = true;
+        }
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+      }
+    }
+  }
+}
+
+} // namespace obcx::common
@@ -0,0 +1,328 @@
+#include "common/event_journal.hpp"
+#include "common/logger.hpp"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+#ifdef OBCX_JOURNAL_ZSTD
+#include <zstd.h>
+#endif
+
+namespace obcx::common {
+
+namespace {
+
+constexpr std::string_view kMagic{"OBCXJNL\0", 8};
+constexpr uint8_t kVersion = 1;
+constexpr uint8_t kFlagZstd = 0x01;
+constexpr std::size_t kReadChunk = 64 * 1024;
+
+void put_le(std::string &out, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; ++i) {
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+auto get_le(std::string_view in, int bytes) -> uint64_t {
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(in[i])) << (8 * i);
+  }
+  return value;
+}
+
+void put_varint(std::string &out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+} // namespace
+
+#ifdef OBCX_JOURNAL_ZSTD
+struct JournalWriter::Compressor {
+  ZSTD_CCtx *ctx = ZSTD_createCCtx();
+  std::string out = std::string(ZSTD_CStreamOutSize(), '\0');
+
+  Compressor() { ZSTD_CCtx_setParameter(ctx, ZSTD_c_compressionLevel, 3); }
+  ~Compressor() { ZSTD_freeCCtx(ctx); }
+  Compressor(const Compressor &) = delete;
+  auto operator=(const Compressor &) -> Compressor & = delete;
+
+  void write(std::string_view data, ZSTD_EndDirective mode,
+             std::ofstream &file) {
+    ZSTD_inBuffer input{data.data(), data.size(), 0};
+    bool done = false;
+    while (!done) {
+      ZSTD_outBuffer output{out.data(), out.size(), 0};
+      const auto remaining = ZSTD_compressStream2(ctx, &output, &input, mode);
+      if (ZSTD_isError(remaining) != 0) {
+        throw std::runtime_error(std::string("zstd 压缩失败: ") +
+                                 ZSTD_getErrorName(remaining));
+      }
+      file.write(out.data(), static_cast<std::streamsize>(output.pos));
+      done = mode == ZSTD_e_continue ? input.pos == input.size : remaining == 0;
+    }
+  }
+};
+
+struct JournalReader::Decompressor {
+  ZSTD_DCtx *ctx = ZSTD_createDCtx();
+  std::string in = std::string(ZSTD_DStreamInSize(), '\0');
+  std::string out = std::string(ZSTD_DStreamOutSize(), '\0');
+  ZSTD_inBuffer input{in.data(), 0, 0};
+
+  ~Decompressor() { ZSTD_freeDCtx(ctx); }
+
+  // 解压出至少一个字节后返回 true；输入耗尽时返回 false
+  auto fill(std::ifstream &file, std::string &pending) -> bool {
+    while (true) {
+      if (input.pos == input.size) {
+        file.read(in.data(), static_cast<std::streamsize>(in.size()));
+        const auto n = static_cast<std::size_t>(file.gcount());
+        if (n == 0) {
+          return false;
+        }
+        input = {in.data(), n, 0};
+      }
+      ZSTD_outBuffer output{out.data(), out.size(), 0};
+      const auto ret = ZSTD_decompressStream(ctx, &output, &input);
+      if (ZSTD_isError(ret) != 0) {
+        throw std::runtime_error(std::string("zstd 解压失败: ") +
+                                 ZSTD_getErrorName(ret));
+      }
+      if (output.pos > 0) {
+        pending.append(out.data(), output.pos);
+        return true;
+      }
+    }
+  }
+};
+#else
+struct JournalWriter::Compressor {};
+struct JournalReader::Decompressor {};
+#endif
+
+auto JournalWriter::compression_supported() noexcept -> bool {
+#ifdef OBCX_JOURNAL_ZSTD
+  return true;
+#else
+  return false;
+#endif
+}
+
+JournalWriter::JournalWriter(const std::string &path, std::string_view protocol,
+                             Options options)
+    : file_(path, std::ios::binary | std::ios::trunc), options_(options),
+      last_(std::chrono::steady_clock::now()) {
+  if (!file_) {
+    throw std::runtime_error("无法打开日志文件: " + path);
+  }
+  if (options_.compress && !compression_supported()) {
+    OBCX_WARN("构建未启用 OBCX_JOURNAL_ZSTD，日志 {} 将不压缩", path);
+    options_.compress = false;
+  }
+#ifdef OBCX_JOURNAL_ZSTD
+  if (options_.compress) {
+    compressor_ = std::make_unique<Compressor>();
+  }
+#endif
+
+  std::string header(kMagic);
+  header.push_back(static_cast<char>(kVersion));
+  header.push_back(static_cast<char>(options_.compress ? kFlagZstd : 0));
+  put_le(header, protocol.size(), 2);
+  header.append(protocol);
+  const auto now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch());
+  put_le(header, static_cast<uint64_t>(now.count()), 8);
+  file_.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+  buffer_.reserve(options_.buffer_size + 1024);
+}
+
+JournalWriter::~JournalWriter() {
+  try {
+    std::lock_guard lock(mutex_);
+    write_out(true);
+#ifdef OBCX_JOURNAL_ZSTD
+    if (compressor_) {
+      // 结束 zstd 帧，写入校验信息
+      compressor_->write({}, ZSTD_e_end, file_);
+    }
+#endif
+  } catch (const std::exception &e) {
+    OBCX_ERROR("关闭日志文件失败: {}", e.what());
+  }
+}
+
+auto JournalWriter::open_for(const ConnectionConfig &config,
+                             std::string_view protocol)
+    -> std::unique_ptr<JournalWriter> {
+  if (config.journal_path.empty()) {
+    return nullptr;
+  }
+  try {
+    auto journal = std::make_unique<JournalWriter>(
+        config.journal_path, protocol,
+        Options{.compress = config.journal_compress});
+    OBCX_INFO("流量日志已开启: {}", config.journal_path);
+    return journal;
+  } catch (const std::exception &e) {
+    OBCX_ERROR("无法开启流量日志: {}", e.what());
+    return nullptr;
+  }
+}
+
+void JournalWriter::record(JournalDirection direction,
+                           std::string_view payload) {
+  const auto now = std::chrono::steady_clock::now();
+  std::lock_guard lock(mutex_);
+  // 多线程记录时取锁顺序可能与取时间的顺序相反，时间差按 0 计
+  const auto delta =
+      std::max(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_)
+                   .count(),
+               int64_t{0});
+  last_ = std::max(last_, now);
+
+  buffer_.push_back(static_cast<char>(direction));
+  put_varint(buffer_, static_cast<uint64_t>(delta));
+  put_varint(buffer_, payload.size());
+  buffer_.append(payload);
+  if (buffer_.size() >= options_.buffer_size) {
+    write_out(false);
+  }
+}
+
+void JournalWriter::flush() {
+  std::lock_guard lock(mutex_);
+  write_out(true);
+}
+
+void JournalWriter::write_out(bool flush_stream) {
+#ifdef OBCX_JOURNAL_ZSTD
+  if (compressor_) {
+    compressor_->write(buffer_, flush_stream ? ZSTD_e_flush : ZSTD_e_continue,
+                       file_);
+  } else
+#endif
+  {
+    file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+  }
+  buffer_.clear();
+  if (flush_stream) {
+    file_.flush();
+  }
+}
+
+JournalReader::JournalReader(const std::string &path)
+    : file_(path, std::ios::binary) {
+  if (!file_) {
+    throw std::runtime_error("无法打开日志文件: " + path);
+  }
+
+  std::array<char, 12> fixed{};
+  file_.read(fixed.data(), fixed.size());
+  const std::string_view head(fixed.data(),
+                              static_cast<std::size_t>(file_.gcount()));
+  if (head.size() < fixed.size() || head.substr(0, kMagic.size()) != kMagic) {
+    throw std::runtime_error("不是 OBCX 流量日志: " + path);
+  }
+  if (static_cast<uint8_t>(head[8]) != kVersion) {
+    throw std::runtime_error("不支持的日志版本: " +
+                             std::to_string(static_cast<uint8_t>(head[8])));
+  }
+  compressed_ = (static_cast<uint8_t>(head[9]) & kFlagZstd) != 0;
+
+  protocol_.resize(get_le(head.substr(10), 2));
+  std::array<char, 8> started{};
+  file_.read(protocol_.data(), static_cast<std::streamsize>(protocol_.size()));
+  file_.read(started.data(), started.size());
+  if (!file_) {
+    throw std::runtime_error("日志文件头不完整: " + path);
+  }
+  started_at_ = std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::nanoseconds(static_cast<int64_t>(
+              get_le({started.data(), started.size()}, 8)))));
+
+  if (compressed_) {
+#ifdef OBCX_JOURNAL_ZSTD
+    decompressor_ = std::make_unique<Decompressor>();
+#else
+    throw std::runtime_error(
+        "日志经 zstd 压缩，但构建未启用 OBCX_JOURNAL_ZSTD");
+#endif
+  }
+}
+
+JournalReader::~JournalReader() = default;
+
+auto JournalReader::next() -> std::optional<JournalRecord> {
+  // 丢弃已读部分，避免缓冲区无限增长；只在记录边界整理，读取中的下标不失效
+  if (pos_ >= kReadChunk) {
+    pending_.erase(0, pos_);
+    pos_ = 0;
+  }
+  if (!ensure(1)) {
+    return std::nullopt;
+  }
+  const auto record_start = pos_;
+  JournalRecord record;
+  record.direction = static_cast<JournalDirection>(pending_[pos_++]);
+
+  uint64_t delta = 0;
+  uint64_t length = 0;
+  if (!read_varint(delta) || !read_varint(length) || !ensure(length)) {
+    truncated_ = true;
+    pos_ = record_start;
+    return std::nullopt;
+  }
+  elapsed_ += std::chrono::nanoseconds(delta);
+  record.timestamp = elapsed_;
+  record.payload.assign(pending_, pos_, length);
+  pos_ += length;
+  return record;
+}
+
+auto JournalReader::ensure(std::size_t n) -> bool {
+  while (pending_.size() - pos_ < n) {
+#ifdef OBCX_JOURNAL_ZSTD
+    if (decompressor_) {
+      if (!decompressor_->fill(file_, pending_)) {
+        return false;
+      }
+      continue;
+    }
+#endif
+    const auto old_size = pending_.size();
+    pending_.resize(old_size + kReadChunk);
+    file_.read(pending_.data() + old_size, kReadChunk);
+    const auto n_read = static_cast<std::size_t>(file_.gcount());
+    pending_.resize(old_size + n_read);
+    if (n_read == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+auto JournalReader::read_varint(uint64_t &value) -> bool {
+  value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (!ensure(1)) {
+      return false;
+    }
+    const auto byte = static_cast<uint8_t>(pending_[pos_++]);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  throw std::runtime_error("日志记录损坏：varint 过长");
+}
+
+} // namespace obcx::common
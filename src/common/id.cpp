@@ -0,0 +1,150 @@
+#include "common/id.hpp"
+
+#include <charconv>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace obcx::common {
+
+namespace {
+
+// 非数字ID的驻留池。键指向条目自身的文本，条目由 unique_ptr 持有，地址
+// 在 rehash 后依然稳定。引用计数只在持有写锁时从 1 降到 0 并随即删除
+// 条目，因此持读锁查到的条目计数至少为 1。
+struct InternPool {
+  std::shared_mutex mutex;
+  std::unordered_map<std::string_view, std::unique_ptr<detail::InternedText>>
+      entries;
+};
+
+// 不析构：静态存储期的 Id 可能在退出时晚于池析构
+auto intern_pool() -> InternPool & {
+  static auto *instance = new InternPool;
+  return *instance;
+}
+
+auto intern(std::string_view text) -> detail::InternedText * {
+  auto &pool = intern_pool();
+  {
+    std::shared_lock lock(pool.mutex);
+    if (auto it = pool.entries.find(text); it != pool.entries.end()) {
+      it->second->refs.fetch_add(1, std::memory_order_relaxed);
+      return it->second.get();
+    }
+  }
+  std::unique_lock lock(pool.mutex);
+  if (auto it = pool.entries.find(text); it != pool.entries.end()) {
+    it->second->refs.fetch_add(1, std::memory_order_relaxed);
+    return it->second.get();
+  }
+  auto entry = std::make_unique<detail::InternedText>();
+  entry->text = text;
+  auto *interned = entry.get();
+  pool.entries.emplace(interned->text, std::move(entry));
+  return interned;
+}
+
+} // namespace
+
+void Id::release_text(detail::InternedText *text) noexcept {
+  auto refs = text->refs.load(std::memory_order_relaxed);
+  while (refs > 1) {
+    if (text->refs.compare_exchange_weak(refs, refs - 1,
+                                         std::memory_order_acq_rel)) {
+      return;
+    }
+  }
+  // 可能是最后一个引用：在写锁内递减，此时没有读者能再取得该条目
+  auto &pool = intern_pool();
+  std::unique_lock lock(pool.mutex);
+  if (text->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    // 键指向条目自身的文本，先定位再删除
+    pool.entries.erase(pool.entries.find(text->text));
+  }
+}
+
+auto Id::interned_count() -> std::size_t {
+  auto &pool = intern_pool();
+  std::shared_lock lock(pool.mutex);
+  return pool.entries.size();
+}
+
+Id::Id(int64_t value, Platform platform) noexcept
+    : number_{value}, platform_{platform}, kind_{Kind::numeric} {
+  auto [end, ec] = std::to_chars(digits_, digits_ + kMaxDigits - 1, value);
+  *end = '\0';
+  length_ = static_cast<uint8_t>(end - digits_);
+}
+
+Id::Id(std::string_view text, Platform platform) : platform_{platform} {
+  if (text.empty()) {
+    return;
+  }
+
+  int64_t value = 0;
+  auto [ptr, ec] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+  if (ec == std::errc{} && ptr == text.data() + text.size()) {
+    *this = Id(value, platform);
+    // 只有能原样往返的文本才按数字保存，"007"、"-0" 之类保留原文
+    if (view() == text) {
+      return;
+    }
+  }
+
+  kind_ = Kind::text;
+  length_ = 0;
+  digits_[0] = '\0';
+  interned_ = intern(text);
+}
+
+auto Id::from_unsigned(uint64_t value, Platform platform) -> Id {
+  if (value <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+    return Id(static_cast<int64_t>(value), platform);
+  }
+  char digits[kMaxDigits];
+  auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), value);
+  return Id(std::string_view(digits, end - digits), platform);
+}
+
+auto Id::hash() const noexcept -> std::size_t {
+  std::size_t seed = static_cast<std::size_t>(platform_);
+  switch (kind_) {
+  case Kind::numeric:
+    seed ^= std::hash<int64_t>{}(number_) + 0x9e3779b97f4a7c15ULL +
+            (seed << 6) + (seed >> 2);
+    break;
+  case Kind::text:
+    seed ^= std::hash<const void *>{}(interned_) + 0x9e3779b97f4a7c15ULL +
+            (seed << 6) + (seed >> 2);
+    break;
+  default:
+    break;
+  }
+  return seed;
+}
+
+void to_json(nlohmann::json &j, const Id &id) {
+  if (auto number = id.as_int()) {
+    j = *number;
+  } else {
+    j = id.view();
+  }
+}
+
+void from_json(const nlohmann::json &j, Id &id) {
+  if (j.is_number_unsigned()) {
+    id = Id::from_unsigned(j.get<uint64_t>(), id.platform());
+  } else if (j.is_number_integer()) {
+    id = Id(j.get<int64_t>(), id.platform());
+  } else if (j.is_string()) {
+    id = Id(j.get_ref<const std::string &>(), id.platform());
+  } else {
+    id = Id{};
+  }
+}
+
+} // namespace obcx::common
@@ -0,0 +1,162 @@
+#include "common/json_backend.hpp"
+
+#ifdef OBCX_JSON_SIMDJSON
+#include <simdjson.h>
+#endif
+
+namespace obcx::common {
+
+#ifdef OBCX_JSON_SIMDJSON
+namespace {
+
+// simdjson 的 DOM 只在解析器存活期间有效，这里立即拷贝为 nlohmann::json
+auto to_nlohmann(simdjson::dom::element element) -> nlohmann::json {
+  switch (element.type()) {
+  case simdjson::dom::element_type::OBJECT: {
+    auto result = nlohmann::json::object();
+    simdjson::dom::object object = element.get_object().value_unsafe();
+    for (auto [key, value] : object) {
+      result.emplace(key, to_nlohmann(value));
+    }
+    return result;
+  }
+  case simdjson::dom::element_type::ARRAY: {
+    auto result = nlohmann::json::array();
+    simdjson::dom::array array = element.get_array().value_unsafe();
+    result.get_ref<nlohmann::json::array_t &>().reserve(array.size());
+    for (auto value : array) {
+      result.push_back(to_nlohmann(value));
+    }
+    return result;
+  }
+  case simdjson::dom::element_type::STRING:
+    return element.get_string().value_unsafe();
+  case simdjson::dom::element_type::INT64:
+    return element.get_int64().value_unsafe();
+  case simdjson::dom::element_type::UINT64:
+    return element.get_uint64().value_unsafe();
+  case simdjson::dom::element_type::DOUBLE:
+    return element.get_double().value_unsafe();
+  case simdjson::dom::element_type::BOOL:
+    return element.get_bool().value_unsafe();
+  case simdjson::dom::element_type::NULL_VALUE:
+  default:
+    return nullptr;
+  }
+}
+
+} // namespace
+#endif
+
+auto JsonBackend::active() noexcept -> Kind {
+#ifdef OBCX_JSON_SIMDJSON
+  return Kind::simdjson;
+#else
+  return Kind::nlohmann;
+#endif
+}
+
+auto JsonBackend::name() noexcept -> std::string_view {
+  return active() == Kind::simdjson ? "simdjson" : "nlohmann";
+}
+
+auto JsonBackend::parse(std::string_view text)
+    -> std::optional<nlohmann::json> {
+#ifdef OBCX_JSON_SIMDJSON
+  // 解析器内部缓冲区按线程复用，避免每个事件重新分配
+  thread_local simdjson::dom::parser parser;
+  simdjson::dom::element root;
+  if (parser.parse(text.data(), text.size()).get(root)) {
+    return std::nullopt;
+  }
+  return to_nlohmann(root);
+#else
+  auto result = nlohmann::json::parse(text, nullptr, false);
+  if (result.is_discarded()) {
+    return std::nullopt;
+  }
+  return result;
+#endif
+}
+
+auto JsonBackend::peek_field(std::string_view text, std::string_view key)
+    -> std::optional<std::string_view> {
+  constexpr std::string_view kSpace = " \t\r\n";
+  int depth = 0;
+  bool expect_key = false;
+  bool seen_object = false;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    const char c = text[i];
+    if (c == '"') {
+      const auto start = ++i;
+      bool escaped = false;
+      for (; i < text.size() && text[i] != '"'; ++i) {
+        if (text[i] == '\\') {
+          escaped = true;
+          ++i;
+        }
+      }
+      if (i >= text.size()) {
+        return std::nullopt;
+      }
+      if (depth != 1 || !expect_key) {
+        continue;
+      }
+      expect_key = false;
+      if (escaped || text.substr(start, i - start) != key) {
+        continue;
+      }
+      const auto colon = text.find_first_not_of(kSpace, i + 1);
+      if (colon == std::string_view::npos || text[colon] != ':') {
+        return std::nullopt;
+      }
+      const auto value = text.find_first_not_of(kSpace, colon + 1);
+      if (value == std::string_view::npos || text[value] == '{' ||
+          text[value] == '[') {
+        return std::nullopt;
+      }
+      if (text[value] != '"') {
+        const auto end = text.find_first_of(",}] \t\r\n", value);
+        if (end == std::string_view::npos) {
+          return std::nullopt;
+        }
+        return text.substr(value, end - value);
+      }
+      for (auto end = value + 1; end < text.size(); ++end) {
+        if (text[end] == '\\') {
+          ++end;
+        } else if (text[end] == '"') {
+          return text.substr(value, end - value + 1);
+        }
+      }
+      return std::nullopt;
+    }
+    switch (c) {
+    case '{':
+    case '[':
+      if (depth++ == 0) {
+        if (c != '{' || seen_object) {
+          return std::nullopt;
+        }
+        seen_object = true;
+        expect_key = true;
+      }
+      break;
+    case '}':
+    case ']':
+      --depth;
+      break;
+    case ',':
+      expect_key = depth == 1;
+      break;
+    default:
+      break;
+    }
+  }
+  if (depth != 0 || !seen_object) {
+    return std::nullopt;
+  }
+  return std::string_view{};
+}
+
+} // namespace obcx::common
@@ -1,13 +1,24 @@
 #include "common/json_utils.hpp"
 #include "common/logger.hpp"
 #include <algorithm>
+#include <charconv>
 
 namespace obcx::common {
 
 auto JsonUtils::validate_required_fields(
     const json &j, const std::vector<std::string> &required_fields) -> bool {
   return std::ranges::all_of(required_fields, [&j](const std::string &field) {
-    return j.contains(field) && !j[field].is_null();
+    auto it = j.find(field);
+    return it != j.end() && !it->is_null();
+  });
+}
+
+auto JsonUtils::validate_required_fields(
+    const json &j, std::initializer_list<std::string_view> required_fields)
+    -> bool {
+  return std::ranges::all_of(required_fields, [&j](std::string_view field) {
+    auto it = j.find(field);
+    return it != j.end() && !it->is_null();
   });
 }
 
@@ -31,7 +42,7 @@ auto JsonUtils::pretty_print(const json &j, int indent) -> std::string {
   }
 }
 
-auto JsonUtils::parse(const std::string &str) -> std::optional<json> {
+auto JsonUtils::parse(std::string_view str) -> std::optional<json> {
   try {
     return json::parse(str);
   } catch (const json::exception &e) {
@@ -40,41 +51,184 @@ auto JsonUtils::parse(const std::string &str) -> std::optional<json> {
   }
 }
 
-auto JsonUtils::has_path(const json &j, const std::string &path) -> bool {
-  try {
-    auto ptr = json::json_pointer(path);
-    return j.contains(ptr);
-  } catch (const json::exception &) {
+namespace {
+
+// RFC 6901 数组下标：十进制、无前导零；"-" 指向末尾之后，不可解析
+auto parse_array_index(std::string_view token, std::size_t &index) noexcept
+    -> bool {
+  if (token.empty() || (token.size() > 1 && token.front() == '0')) {
     return false;
   }
+  auto [ptr, ec] =
+      std::from_chars(token.data(), token.data() + token.size(), index);
+  return ec == std::errc{} && ptr == token.data() + token.size();
 }
 
-auto JsonUtils::get_id_as_string(const json &j, const std::string &key)
-    -> std::string {
-  if (j.contains(key)) {
-    const auto &value = j.at(key);
-    if (value.is_string()) {
-      return value.get<std::string>();
+auto step(const json *current, std::string_view token) noexcept
+    -> const json * {
+  if (current->is_object()) {
+    auto it = current->find(token);
+    return it != current->end() ? &*it : nullptr;
+  }
+  if (current->is_array()) {
+    std::size_t index = 0;
+    if (parse_array_index(token, index) && index < current->size()) {
+      return &(*current)[index];
+    }
+  }
+  return nullptr;
+}
+
+// ~1 -> '/', ~0 -> '~'；其他 '~' 序列非法
+auto unescape_token(std::string_view token, std::string &out) -> bool {
+  out.clear();
+  for (std::size_t i = 0; i < token.size(); ++i) {
+    if (token[i] != '~') {
+      out.push_back(token[i]);
+      continue;
+    }
+    char next = i + 1 < token.size() ? token[i + 1] : '\0';
+    if (next != '0' && next != '1') {
+      return false;
+    }
+    out.push_back(next == '0' ? '~' : '/');
+    ++i;
+  }
+  return true;
+}
+
+} // namespace
+
+JsonUtils::JsonPath::JsonPath(std::string_view path) {
+  if (path.empty()) {
+    return;
+  }
+  if (path.front() != '/') {
+    valid_ = false;
+    return;
+  }
+  path.remove_prefix(1);
+  while (true) {
+    auto slash = path.find('/');
+    std::string token;
+    if (!unescape_token(path.substr(0, slash), token)) {
+      valid_ = false;
+      tokens_.clear();
+      return;
+    }
+    tokens_.push_back(std::move(token));
+    if (slash == std::string_view::npos) {
+      break;
+    }
+    path.remove_prefix(slash + 1);
+  }
+}
+
+auto JsonUtils::find_path(const json &j, std::string_view path) noexcept
+    -> const json * {
+  if (path.empty()) {
+    return &j;
+  }
+  if (path.front() != '/') {
+    return nullptr;
+  }
+
+  const json *current = &j;
+  path.remove_prefix(1);
+  while (current != nullptr) {
+    auto slash = path.find('/');
+    auto token = path.substr(0, slash);
+    if (token.find('~') == std::string_view::npos) {
+      current = step(current, token);
+    } else {
+      // 只有含转义的分段才需要临时缓冲区
+      try {
+        std::string unescaped;
+        if (!unescape_token(token, unescaped)) {
+          return nullptr;
+        }
+        current = step(current, unescaped);
+      } catch (const std::bad_alloc &) {
+        return nullptr;
+      }
     }
-    if (value.is_number()) {
-      return std::to_string(value.get<long long>());
+    if (slash == std::string_view::npos) {
+      break;
+    }
+    path.remove_prefix(slash + 1);
+  }
+  return current;
+}
+
+auto JsonUtils::find_path(const json &j, const JsonPath &path) noexcept
+    -> const json * {
+  if (!path.valid()) {
+    return nullptr;
+  }
+  const json *current = &j;
+  for (const auto &token : path.tokens()) {
+    current = step(current, token);
+    if (current == nullptr) {
+      break;
     }
   }
-  return "";
+  return current;
+}
+
+auto JsonUtils::has_path(const json &j, std::string_view path) -> bool {
+  return find_path(j, path) != nullptr;
+}
+
+auto JsonUtils::has_path(const json &j, const JsonPath &path) -> bool {
+  return find_path(j, path) != nullptr;
+}
+
+auto JsonUtils::get_id_as_string(const json &j, std::string_view key)
+    -> std::string {
+  return get_optional_id_as_string(j, key).value_or("");
 }
 
-auto JsonUtils::get_optional_id_as_string(const json &j, const std::string &key)
+auto JsonUtils::get_optional_id_as_string(const json &j, std::string_view key)
     -> std::optional<std::string> {
-  if (j.contains(key)) {
-    const auto &value = j.at(key);
-    if (value.is_string()) {
-      return value.get<std::string>();
+  auto it = j.find(key);
+  if (it != j.end()) {
+    if (it->is_string()) {
+      return it->get<std::string>();
+    }
+    if (it->is_number_unsigned()) {
+      return std::to_string(it->get<uint64_t>());
     }
-    if (value.is_number()) {
-      return std::to_string(value.get<long long>());
+    if (it->is_number()) {
+      return std::to_string(it->get<long long>());
     }
   }
   return std::nullopt;
 }
 
+auto JsonUtils::get_id(const json &j, std::string_view key, Platform platform)
+    -> Id {
+  return get_optional_id(j, key, platform).value_or(Id{});
+}
+
+auto JsonUtils::get_optional_id(const json &j, std::string_view key,
+                                Platform platform) -> std::optional<Id> {
+  auto it = j.find(key);
+  if (it == j.end()) {
+    return std::nullopt;
+  }
+  if (it->is_number_unsigned()) {
+    return Id::from_unsigned(it->get<uint64_t>(), platform);
+  }
+  if (it->is_number_integer()) {
+    return Id(it->get<int64_t>(), platform);
+  }
+  if (it->is_number()) {
+    return Id(it->get<long long>(), platform);
+  }
+  if (it->is_string()) {
+    return Id(it->get_ref<const std::string &>(), platform);
+  }
+  return std::nullopt;
+}
+
 } // namespace obcx::common
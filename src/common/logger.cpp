@@ -1,15 +1,86 @@
 #include "common/logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <spdlog/async.h>
+#include <utility>
 #include <vector>
 
 namespace obcx::common {
 
-std::shared_ptr<spdlog::logger> Logger::default_logger_ = nullptr;
-bool Logger::initialized_ = false;
+namespace {
+
+/*
+ * \if CHINESE
+ * 线程池的每个后台线程各取走一条屏障消息后停下，全部到齐时之前入队的
+ * 日志都已写出。overrun_oldest 策略下屏障可能被挤出队列，因此两边都只
+ * 等待有限时间
+ * \endif
+ * \if ENGLISH
+ * Each worker of the pool takes one barrier message and stops; once all
+ * have arrived, everything queued earlier has been written. Under
+ * overrun_oldest a barrier may be pushed out of the queue, so both sides
+ * wait a bounded time
+ * \endif
+ */
+class BarrierSink final : public spdlog::sinks::sink {
+public:
+  explicit BarrierSink(std::size_t parties) : parties_(parties) {}
+
+  void log(const spdlog::details::log_msg & /*msg*/) override {
+    std::unique_lock lock(mutex_);
+    ++arrived_;
+    all_arrived_.notify_all();
+    all_arrived_.wait_for(lock, kTimeout, [this] { return done(); });
+  }
+
+  void flush() override {}
+  void set_pattern(const std::string & /*pattern*/) override {}
+  void set_formatter(
+      std::unique_ptr<spdlog::formatter> /*formatter*/) override {}
+
+  auto wait() -> bool {
+    std::unique_lock lock(mutex_);
+    return all_arrived_.wait_for(lock, kTimeout, [this] { return done(); });
+  }
+
+private:
+  static constexpr std::chrono::seconds kTimeout{5};
+
+  [[nodiscard]] auto done() const -> bool { return arrived_ >= parties_; }
+
+  const std::size_t parties_;
+  std::size_t arrived_ = 0;
+  std::mutex mutex_;
+  std::condition_variable all_arrived_;
+};
+
+// 等待线程池写完此前入队的日志；线程池本身不析构
+void write_out(const std::shared_ptr<spdlog::details::thread_pool> &pool,
+               std::size_t threads) {
+  auto barrier = std::make_shared<BarrierSink>(threads);
+  auto logger = std::make_shared<spdlog::async_logger>(
+      "obcx_barrier", barrier, pool, spdlog::async_overflow_policy::block);
+  for (std::size_t i = 0; i < threads; ++i) {
+    logger->info("barrier");
+  }
+  barrier->wait();
+}
+
+} // namespace
+
+std::mutex Logger::mutex_;
+std::atomic<std::shared_ptr<spdlog::logger>> Logger::default_logger_;
+std::atomic<spdlog::logger *> Logger::raw_logger_ = nullptr;
+std::vector<Logger::Retired> Logger::retired_;
+std::shared_ptr<spdlog::details::thread_pool> Logger::thread_pool_;
+std::size_t Logger::pool_threads_ = 0;
+std::atomic<bool> Logger::initialized_ = false;
 
 void Logger::initialize(spdlog::level::level_enum level,
                         const std::string &log_file) {
-  if (initialized_) {
+  std::lock_guard lock(mutex_);
+  if (initialized_.load(std::memory_order_acquire)) {
     return;
   }
 
@@ -61,23 +132,13 @@ void Logger::initialize(spdlog::level::level_enum level,
      * Create default logger
      * \endif
      */
-    default_logger_ =
+    auto logger =
         std::make_shared<spdlog::logger>("obcx", sinks.begin(), sinks.end());
-    default_logger_->set_level(level);
-    default_logger_->flush_on(spdlog::level::warn);
+    logger->set_level(level);
+    logger->flush_on(spdlog::level::warn);
+    install(std::move(logger));
 
-    /*
-     * \if CHINESE
-     * 注册为默认日志器
-     * \endif
-     * \if ENGLISH
-     * Register as default logger
-     * \endif
-     */
-    spdlog::register_logger(default_logger_);
-    spdlog::set_default_logger(default_logger_);
-
-    initialized_ = true;
+    initialized_.store(true, std::memory_order_release);
 
     OBCX_INFO("Logger initialized successfully");
   } catch (const spdlog::spdlog_ex &ex) {
@@ -87,7 +148,7 @@ void Logger::initialize(spdlog::level::level_enum level,
 }
 
 auto Logger::get() -> std::shared_ptr<spdlog::logger> {
-  if (!initialized_) {
+  if (!initialized_.load(std::memory_order_acquire)) {
     /*
      * \if CHINESE
      * 使用默认设置初始化
@@ -98,11 +159,11 @@ auto Logger::get() -> std::shared_ptr<spdlog::logger> {
      */
     initialize();
   }
-  return default_logger_;
+  return default_logger_.load(std::memory_order_acquire);
 }
 
 auto Logger::get(const std::string &name) -> std::shared_ptr<spdlog::logger> {
-  if (!initialized_) {
+  if (!initialized_.load(std::memory_order_acquire)) {
     /*
      * \if CHINESE
      * 使用默认设置初始化
@@ -124,25 +185,114 @@ auto Logger::get(const std::string &name) -> std::shared_ptr<spdlog::logger> {
      * Create a new logger with the same configuration as the default logger
      * \endif
      */
-    logger = default_logger_->clone(name);
+    logger = default_logger_.load(std::memory_order_acquire)->clone(name);
     spdlog::register_logger(logger);
   }
   return logger;
 }
 
 void Logger::set_level(spdlog::level::level_enum level) {
-  if (default_logger_) {
-    default_logger_->set_level(level);
+  if (auto logger = default_logger_.load(std::memory_order_acquire)) {
+    logger->set_level(level);
     spdlog::set_level(level);
   }
 }
 
 void Logger::flush() {
-  if (default_logger_) {
-    default_logger_->flush();
+  if (auto logger = default_logger_.load(std::memory_order_acquire)) {
+    logger->flush();
   }
   spdlog::apply_all(
       [](const std::shared_ptr<spdlog::logger> &l) { l->flush(); });
 }
 
+void Logger::enable_async(const AsyncLogOptions &options) {
+  get();
+  const auto threads = std::max<std::size_t>(options.threads, 1);
+  auto pool = std::make_shared<spdlog::details::thread_pool>(
+      options.queue_size, threads);
+
+  std::shared_ptr<spdlog::details::thread_pool> previous;
+  std::size_t previous_threads = 0;
+  {
+    std::lock_guard lock(mutex_);
+    auto current = default_logger_.load(std::memory_order_acquire);
+    auto logger = std::make_shared<spdlog::async_logger>(
+        current->name(), current->sinks().begin(), current->sinks().end(),
+        pool, options.overflow);
+    logger->set_level(current->level());
+    logger->flush_on(spdlog::level::warn);
+
+    // 旧日志器连同旧线程池一起保留，之后才换上新线程池
+    install(std::move(logger));
+    previous = std::exchange(thread_pool_, std::move(pool));
+    previous_threads = std::exchange(pool_threads_, threads);
+  }
+  if (previous) {
+    write_out(previous, previous_threads);
+  }
+
+  OBCX_INFO("Async logging enabled: queue_size={}, threads={}, overflow={}",
+            options.queue_size, options.threads,
+            options.overflow == spdlog::async_overflow_policy::block
+                ? "block"
+                : "overrun_oldest");
+}
+
+void Logger::disable_async() {
+  std::shared_ptr<spdlog::details::thread_pool> previous;
+  std::size_t previous_threads = 0;
+  {
+    std::lock_guard lock(mutex_);
+    if (!thread_pool_) {
+      return;
+    }
+    auto current = default_logger_.load(std::memory_order_acquire);
+    auto logger = std::make_shared<spdlog::logger>(
+        current->name(), current->sinks().begin(), current->sinks().end());
+    logger->set_level(current->level());
+    logger->flush_on(spdlog::level::warn);
+    install(std::move(logger));
+    previous = std::exchange(thread_pool_, nullptr);
+    previous_threads = std::exchange(pool_threads_, 0);
+  }
+
+  /*
+   * \if CHINESE
+   * 等待后台线程写完队列中剩余的日志；线程池随旧日志器保留，不在此析构
+   * \endif
+   * \if ENGLISH
+   * Wait for the workers to write out the queue; the pool stays alive with
+   * the retired logger and is not destroyed here
+   * \endif
+   */
+  write_out(previous, previous_threads);
+  flush();
+}
+
+auto Logger::dropped() -> std::size_t {
+  std::lock_guard lock(mutex_);
+  return thread_pool_ ? thread_pool_->overrun_counter() : 0;
+}
+
+void Logger::install(std::shared_ptr<spdlog::logger> logger) {
+  if (auto previous = default_logger_.load(std::memory_order_acquire)) {
+    spdlog::drop(previous->name());
+    retired_.push_back({.logger = std::move(previous), .pool = thread_pool_});
+  }
+
+  /*
+   * \if CHINESE
+   * 注册为默认日志器
+   * \endif
+   * \if ENGLISH
+   * Register as default logger
+   * \endif
+   */
+  spdlog::register_logger(logger);
+  spdlog::set_default_logger(logger);
+  raw_logger_.store(logger.get(), std::memory_order_release);
+  default_logger_.store(std::move(logger), std::memory_order_release);
+}
+
 } // namespace obcx::common
\ No newline at end of file
@@ -12,6 +12,9 @@ template <typename T> struct remove_optional<std::optional<T>> {
 template <typename T>
 using remove_optional_t = typename remove_optional<T>::type;
 
+// 这些结构体的 from_json 按 OneBot v11 格式反序列化，ID 均属于 QQ 平台
+constexpr Platform kOneBotPlatform = Platform::qq;
+
 // BaseResponse 序列化
 void BaseResponse::to_json(json &j) const {
   j["status"] = (status == MessageStatus::ok)       ? "ok"
@@ -100,7 +103,7 @@ void BaseEvent::from_json(const json &j) {
   time = std::chrono::system_clock::time_point(
       std::chrono::duration_cast<std::chrono::system_clock::duration>(
           std::chrono::duration<double>(time_double)));
-  DESERIALIZE_FIELD(j, *this, self_id);
+  self_id = JsonUtils::get_id(j, "self_id", kOneBotPlatform);
   DESERIALIZE_FIELD(j, *this, post_type);
 }
 
@@ -125,20 +128,20 @@ void MessageEvent::from_json(const json &j) {
   DESERIALIZE_FIELD(j, *this, message_type);
   DESERIALIZE_FIELD(j, *this, sub_type);
 
-  message_id = JsonUtils::get_id_as_string(j, "message_id");
-  user_id = JsonUtils::get_id_as_string(j, "user_id");
+  message_id = JsonUtils::get_id(j, "message_id", kOneBotPlatform);
+  user_id = JsonUtils::get_id(j, "user_id", kOneBotPlatform);
 
-  if (j.contains("message")) {
-    message = j.at("message").get<Message>();
+  if (auto it = j.find("message"); it != j.end()) {
+    message = it->get<Message>();
   }
   DESERIALIZE_FIELD(j, *this, raw_message);
   DESERIALIZE_FIELD(j, *this, font);
 
-  group_id = JsonUtils::get_optional_id_as_string(j, "group_id");
+  group_id = JsonUtils::get_optional_id(j, "group_id", kOneBotPlatform);
 
   DESERIALIZE_OPTIONAL_FIELD(j, *this, anonymous);
-  DESERIALIZE_OPTIONAL_FIELD(j, *this, guild_id);
-  DESERIALIZE_OPTIONAL_FIELD(j, *this, channel_id);
+  guild_id = JsonUtils::get_optional_id(j, "guild_id", kOneBotPlatform);
+  channel_id = JsonUtils::get_optional_id(j, "channel_id", kOneBotPlatform);
 }
 
 // NoticeEvent
@@ -152,8 +155,8 @@ void NoticeEvent::to_json(json &j) const {
 void NoticeEvent::from_json(const json &j) {
   BaseEvent::from_json(j);
   DESERIALIZE_FIELD(j, *this, notice_type);
-  user_id = JsonUtils::get_id_as_string(j, "user_id");
-  group_id = JsonUtils::get_optional_id_as_string(j, "group_id");
+  user_id = JsonUtils::get_id(j, "user_id", kOneBotPlatform);
+  group_id = JsonUtils::get_optional_id(j, "group_id", kOneBotPlatform);
 }
 
 // RequestEvent
@@ -169,7 +172,7 @@ void RequestEvent::from_json(const json &j) {
   BaseEvent::from_json(j);
 
   DESERIALIZE_FIELD(j, *this, request_type);
-  user_id = JsonUtils::get_id_as_string(j, "user_id");
+  user_id = JsonUtils::get_id(j, "user_id", kOneBotPlatform);
   DESERIALIZE_FIELD(j, *this, comment);
   DESERIALIZE_FIELD(j, *this, flag);
 }
@@ -205,6 +208,12 @@ void ErrorEvent::to_json(json &j) const {
   SERIALIZE_FIELD(j, *this, error_type);
   SERIALIZE_FIELD(j, *this, error_message);
   SERIALIZE_FIELD(j, *this, target_id);
+  // 目标ID的平台标记，反序列化时据此恢复
+  if (target_id.platform() == Platform::telegram) {
+    j["platform"] = "telegram";
+  } else if (target_id.platform() == Platform::qq) {
+    j["platform"] = "qq";
+  }
   SERIALIZE_FIELD(j, *this, is_group);
   JsonUtils::set_value(
       j, "time",
@@ -217,7 +226,11 @@ void ErrorEvent::to_json(json &j) const {
 void ErrorEvent::from_json(const json &j) {
   DESERIALIZE_FIELD(j, *this, error_type);
   DESERIALIZE_FIELD(j, *this, error_message);
-  DESERIALIZE_FIELD(j, *this, target_id);
+  // 与其他事件一致，未注明平台时按 OneBot 事件处理
+  const auto platform = JsonUtils::get_value(j, "platform", std::string());
+  target_id = JsonUtils::get_id(
+      j, "target_id",
+      platform == "telegram" ? Platform::telegram : kOneBotPlatform);
   DESERIALIZE_FIELD(j, *this, is_group);
   auto time_double = JsonUtils::get_value<double>(j, "time");
   time = std::chrono::system_clock::time_point(
@@ -247,6 +260,11 @@ void ConnectionConfig::to_json(json &j) const {
       j["proxy_password"] = proxy_password;
     }
   }
+
+  if (!journal_path.empty()) {
+    j["journal_path"] = journal_path;
+    j["journal_compress"] = journal_compress;
+  }
 }
 
 void ConnectionConfig::from_json(const json &j) {
@@ -265,6 +283,9 @@ void ConnectionConfig::from_json(const json &j) {
   proxy_port = JsonUtils::get_value(j, "proxy_port", uint16_t(0));
   proxy_username = JsonUtils::get_value(j, "proxy_username", std::string(""));
   proxy_password = JsonUtils::get_value(j, "proxy_password", std::string(""));
+
+  journal_path = JsonUtils::get_value(j, "journal_path", std::string(""));
+  journal_compress = JsonUtils::get_value(j, "journal_compress", false);
 }
 
 // AdapterConfig 序列化
@@ -281,8 +302,8 @@ void AdapterConfig::to_json(json &j) const {
 }
 
 void AdapterConfig::from_json(const json &j) {
-  if (j.contains("v11_config")) {
-    v11_config.from_json(j["v11_config"]);
+  if (auto it = j.find("v11_config"); it != j.end()) {
+    v11_config.from_json(*it);
   }
 
   v12_impl_name = JsonUtils::get_value(j, "v12_impl_name", std::string("obcx"));
@@ -0,0 +1,280 @@
+#include "common/metrics.hpp"
+
+#include <cmath>
+#include <fmt/format.h>
+#include <stdexcept>
+
+namespace obcx::common {
+
+namespace detail {
+
+auto next_metric_shard() noexcept -> std::size_t {
+  static std::atomic<std::size_t> next{0};
+  return next.fetch_add(1, std::memory_order_relaxed) % kMetricShards;
+}
+
+} // namespace detail
+
+namespace {
+
+constexpr std::array<double, 4> kQuantiles{0.5, 0.9, 0.99, 0.999};
+
+auto valid_name(std::string_view name) -> bool {
+  if (name.empty()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < name.size(); ++i) {
+    const char c = name[i];
+    const bool alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                       c == '_' || c == ':';
+    if (!alpha && (i == 0 || c < '0' || c > '9')) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void append_escaped(std::string &out, std::string_view value) {
+  for (const char c : value) {
+    switch (c) {
+    case '\\':
+      out += "\\\\";
+      break;
+    case '"':
+      out += "\\\"";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    default:
+      out.push_back(c);
+    }
+  }
+}
+
+// 渲染为 {k="v",...}；没有标签时为空串
+auto render_labels(const MetricLabels &labels) -> std::string {
+  std::string out;
+  for (const auto &[key, value] : labels) {
+    if (!valid_name(key) || key.find(':') != std::string::npos) {
+      throw std::invalid_argument("非法的指标标签名: " + key);
+    }
+    out += out.empty() ? "{" : ",";
+    out += key;
+    out += "=\"";
+    append_escaped(out, value);
+    out += '"';
+  }
+  if (!out.empty()) {
+    out += '}';
+  }
+  return out;
+}
+
+// 在已渲染的标签串中追加一个标签
+auto with_label(const std::string &labels, std::string_view extra)
+    -> std::string {
+  if (labels.empty()) {
+    return fmt::format("{{{}}}", extra);
+  }
+  return fmt::format("{},{}}}", labels.substr(0, labels.size() - 1), extra);
+}
+
+auto format_double(double value) -> std::string {
+  if (std::isnan(value)) {
+    return "NaN";
+  }
+  if (std::isinf(value)) {
+    return value > 0 ? "+Inf" : "-Inf";
+  }
+  return fmt::format("{}", value);
+}
+
+auto seconds(uint64_t nanoseconds) -> std::string {
+  return format_double(static_cast<double>(nanoseconds) / 1e9);
+}
+
+} // namespace
+
+auto Counter::value() const noexcept -> uint64_t {
+  uint64_t total = 0;
+  for (const auto &shard : shards_) {
+    total += shard.value.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+auto HistogramSnapshot::quantile(double q) const -> uint64_t {
+  if (count == 0) {
+    return 0;
+  }
+  // 目标为第 rank 个记录值（从 1 开始）
+  const auto rank = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) *
+                                         static_cast<double>(count))));
+  uint64_t seen = 0;
+  for (std::size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return Histogram::bucket_upper_bound(i);
+    }
+  }
+  return Histogram::bucket_upper_bound(buckets.size() - 1);
+}
+
+auto Histogram::snapshot() const -> HistogramSnapshot {
+  HistogramSnapshot snapshot;
+  snapshot.buckets.assign(kBuckets, 0);
+  for (const auto &shard : shards_) {
+    for (std::size_t i = 0; i < kBuckets; ++i) {
+      snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+    }
+    snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+  }
+  // count 取桶之和，保证分位数与 _count 一致
+  for (const auto n : snapshot.buckets) {
+    snapshot.count += n;
+  }
+  return snapshot;
+}
+
+void MetricsRegistration::reset() {
+  if (registry_ != nullptr) {
+    registry_->unregister(id_);
+    registry_ = nullptr;
+  }
+}
+
+auto MetricsRegistry::instance() -> MetricsRegistry & {
+  // 有意不析构：静态对象析构期间仍可能有线程在更新指标
+  static auto *registry = new MetricsRegistry;
+  return *registry;
+}
+
+auto MetricsRegistry::family(std::string_view name, std::string_view help,
+                             Type type) -> Family & {
+  auto it = families_.find(name);
+  if (it == families_.end()) {
+    if (!valid_name(name)) {
+      throw std::invalid_argument("非法的指标名: " + std::string(name));
+    }
+    it = families_
+             .emplace(std::string(name),
+                      Family{.type = type,
+                             .help = std::string(help),
+                             .counters = {},
+                             .gauges = {},
+                             .histograms = {},
+                             .callbacks = {}})
+             .first;
+  } else if (it->second.type != type) {
+    throw std::invalid_argument("指标 " + std::string(name) +
+                                " 已注册为其他类型");
+  }
+  return it->second;
+}
+
+auto MetricsRegistry::counter(std::string_view name, std::string_view help,
+                              const MetricLabels &labels) -> Counter & {
+  auto key = render_labels(labels);
+  std::lock_guard lock(mutex_);
+  auto &slot = family(name, help, Type::counter).counters[std::move(key)];
+  if (!slot) {
+    slot = std::make_unique<Counter>();
+  }
+  return *slot;
+}
+
+auto MetricsRegistry::gauge(std::string_view name, std::string_view help,
+                            const MetricLabels &labels) -> Gauge & {
+  auto key = render_labels(labels);
+  std::lock_guard lock(mutex_);
+  auto &slot = family(name, help, Type::gauge).gauges[std::move(key)];
+  if (!slot) {
+    slot = std::make_unique<Gauge>();
+  }
+  return *slot;
+}
+
+auto MetricsRegistry::histogram(std::string_view name, std::string_view help,
+                                const MetricLabels &labels) -> Histogram & {
+  auto key = render_labels(labels);
+  std::lock_guard lock(mutex_);
+  auto &slot = family(name, help, Type::histogram).histograms[std::move(key)];
+  if (!slot) {
+    slot = std::make_unique<Histogram>();
+  }
+  return *slot;
+}
+
+auto MetricsRegistry::observe(std::string_view name, std::string_view help,
+                              const MetricLabels &labels,
+                              std::function<double()> read)
+    -> MetricsRegistration {
+  auto key = render_labels(labels);
+  std::lock_guard lock(mutex_);
+  auto &target = family(name, help, Type::gauge);
+  const auto id = next_callback_id_++;
+  target.callbacks.emplace(id, Callback{std::move(key), std::move(read)});
+  callback_names_.emplace(id, std::string(name));
+  return {this, id};
+}
+
+void MetricsRegistry::unregister(uint64_t id) {
+  std::lock_guard lock(mutex_);
+  auto it = callback_names_.find(id);
+  if (it == callback_names_.end()) {
+    return;
+  }
+  if (auto family = families_.find(it->second); family != families_.end()) {
+    family->second.callbacks.erase(id);
+  }
+  callback_names_.erase(it);
+}
+
+auto MetricsRegistry::render_prometheus() const -> std::string {
+  std::string out;
+  std::lock_guard lock(mutex_);
+  for (const auto &[name, family] : families_) {
+    const auto *type = family.type == Type::counter  ? "counter"
+                       : family.type == Type::gauge ? "gauge"
+                                                    : "summary";
+    out += fmt::format("# HELP {} {}\n# TYPE {} {}\n", name, family.help, name,
+                       type);
+
+    for (const auto &[labels, counter] : family.counters) {
+      out += fmt::format("{}{} {}\n", name, labels, counter->value());
+    }
+
+    // 同一标签的固定值与回调值合并输出
+    std::map<std::string, double> gauges;
+    for (const auto &[labels, gauge] : family.gauges) {
+      gauges[labels] += static_cast<double>(gauge->value());
+    }
+    for (const auto &[id, callback] : family.callbacks) {
+      try {
+        gauges[callback.labels] += callback.read();
+      } catch (...) {
+        // 单个回调失败不影响其余指标
+      }
+    }
+    for (const auto &[labels, value] : gauges) {
+      out += fmt::format("{}{} {}\n", name, labels, format_double(value));
+    }
+
+    for (const auto &[labels, histogram] : family.histograms) {
+      const auto snapshot = histogram->snapshot();
+      for (const auto q : kQuantiles) {
+        const auto quantile_labels =
+            with_label(labels, fmt::format("quantile=\"{}\"", q));
+        out += fmt::format("{}{} {}\n", name, quantile_labels,
+                           seconds(snapshot.quantile(q)));
+      }
+      out += fmt::format("{}_sum{} {}\n", name, labels, seconds(snapshot.sum));
+      out += fmt::format("{}_count{} {}\n", name, labels, snapshot.count);
+    }
+  }
+  return out;
+}
+
+} // namespace obcx::common
@@ -1,10 +1,219 @@
 #include "common/plugin_manager.hpp"
 #include "common/logger.hpp"
+#include "onebot11/adapter/event_converter.hpp"
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <filesystem>
+#include <mutex>
+#include <thread>
 
 namespace obcx::common {
 
+namespace {
+
+auto to_millis(std::chrono::nanoseconds duration) -> double {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// 每次加载插件分配一个新的处理器所属者
+auto next_owner() -> core::HandlerOwner {
+  static std::atomic<core::HandlerOwner> next{1};
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 在作用域内暂存各分发器的新事件，析构时按顺序放行
+class EventHold {
+public:
+  explicit EventHold(std::vector<core::EventDispatcher *> dispatchers)
+      : dispatchers_(std::move(dispatchers)) {
+    for (auto *dispatcher : dispatchers_) {
+      dispatcher->hold();
+    }
+  }
+
+  ~EventHold() {
+    for (auto *dispatcher : dispatchers_) {
+      dispatcher->release();
+    }
+  }
+
+  EventHold(const EventHold &) = delete;
+  auto operator=(const EventHold &) -> EventHold & = delete;
+
+private:
+  std::vector<core::EventDispatcher *> dispatchers_;
+};
+
+// 调用 obcx_plugin_metadata；未导出或插件类没有静态元数据时返回空
+auto exported_metadata(void *handle) -> const interface::PluginMetadata * {
+  using plugin_metadata_t = const interface::PluginMetadata *(*)();
+  dlerror();
+  auto get_metadata = reinterpret_cast<plugin_metadata_t>(
+      dlsym(handle, "obcx_plugin_metadata"));
+  if (dlerror() != nullptr || get_metadata == nullptr) {
+    return nullptr;
+  }
+  return get_metadata();
+}
+
+// 检查并转换导出的元数据；缺少名称或结构版本过旧时返回空
+auto info_from_metadata(const interface::PluginMetadata &metadata)
+    -> std::optional<PluginInfo> {
+  // 字段只会追加，较新版本的结构体同样可以按当前版本读取
+  if (metadata.name == nullptr ||
+      metadata.struct_version < interface::kPluginMetadataVersion) {
+    return std::nullopt;
+  }
+
+  PluginInfo info{
+      .name = metadata.name,
+      .version = metadata.version != nullptr ? metadata.version : "",
+      .description =
+          metadata.description != nullptr ? metadata.description : "",
+      .dependencies = {},
+      .concurrent_init = metadata.concurrent_init,
+      .has_metadata = true};
+  for (const auto *dependency = metadata.dependencies;
+       dependency != nullptr && *dependency != nullptr; ++dependency) {
+    info.dependencies.emplace_back(*dependency);
+  }
+  return info;
+}
+
+// 读取 obcx_plugin_metadata 导出的元数据；未导出或不合格时返回空
+auto metadata_from_handle(void *handle) -> std::optional<PluginInfo> {
+  const auto *metadata = exported_metadata(handle);
+  if (metadata == nullptr) {
+    return std::nullopt;
+  }
+  return info_from_metadata(*metadata);
+}
+
+} // namespace
+
+namespace detail {
+
+auto run_init_tasks(const std::vector<PluginInitTask> &tasks,
+                    const std::function<bool(const std::string &)> &init)
+    -> std::unordered_map<std::string, bool> {
+  enum class State { pending, running, succeeded, failed };
+
+  std::unordered_map<std::string, std::size_t> index;
+  for (std::size_t i = 0; i < tasks.size(); ++i) {
+    index.emplace(tasks[i].name, i);
+  }
+
+  std::vector<State> state(tasks.size(), State::pending);
+  std::mutex mutex;
+  std::condition_variable finished;
+  std::size_t running = 0;
+  bool exclusive_running = false;
+  std::vector<std::thread> workers;
+
+  // 返回 true 表示依赖均已成功；broken 表示依赖缺失或失败
+  auto dependencies_ready = [&](const PluginInitTask &task, bool &broken) {
+    bool ready = true;
+    for (const auto &dependency : task.dependencies) {
+      const auto it = index.find(dependency);
+      if (it == index.end()) {
+        OBCX_ERROR("Plugin {} depends on {}, which is not loaded", task.name,
+                   dependency);
+        broken = true;
+      } else if (state[it->second] == State::failed) {
+        OBCX_ERROR("Plugin {} skipped because dependency {} failed",
+                   task.name, dependency);
+        broken = true;
+      } else if (state[it->second] != State::succeeded) {
+        ready = false;
+      }
+      if (broken) {
+        return false;
+      }
+    }
+    return ready;
+  };
+
+  std::unique_lock lock(mutex);
+  while (true) {
+    bool pending = false;
+    bool progressed = false;
+    for (std::size_t i = 0; i < tasks.size() && !exclusive_running; ++i) {
+      const auto &task = tasks[i];
+      if (state[i] != State::pending) {
+        continue;
+      }
+      pending = true;
+      bool broken = false;
+      if (!dependencies_ready(task, broken)) {
+        if (broken) {
+          state[i] = State::failed;
+          progressed = true;
+        }
+        continue;
+      }
+      if (task.exclusive && running > 0) {
+        continue;
+      }
+
+      state[i] = State::running;
+      ++running;
+      exclusive_running = task.exclusive;
+      progressed = true;
+      workers.emplace_back([&, i] {
+        bool ok = false;
+        try {
+          ok = init(tasks[i].name);
+        } catch (const std::exception &e) {
+          OBCX_ERROR("Exception during plugin {} initialization: {}",
+                     tasks[i].name, e.what());
+        } catch (...) {
+          OBCX_ERROR("Unknown exception during plugin {} initialization",
+                     tasks[i].name);
+        }
+        std::lock_guard guard(mutex);
+        state[i] = ok ? State::succeeded : State::failed;
+        --running;
+        if (tasks[i].exclusive) {
+          exclusive_running = false;
+        }
+        finished.notify_all();
+      });
+    }
+
+    if (!pending && running == 0) {
+      break;
+    }
+    if (!progressed) {
+      if (running == 0) {
+        // 没有任务在运行却无法推进：剩余任务处于依赖环中
+        for (std::size_t i = 0; i < tasks.size(); ++i) {
+          if (state[i] == State::pending) {
+            OBCX_ERROR("Plugin {} is part of a dependency cycle",
+                       tasks[i].name);
+            state[i] = State::failed;
+          }
+        }
+        continue;
+      }
+      finished.wait(lock);
+    }
+  }
+  lock.unlock();
+
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  std::unordered_map<std::string, bool> results;
+  for (std::size_t i = 0; i < tasks.size(); ++i) {
+    results[tasks[i].name] = state[i] == State::succeeded;
+  }
+  return results;
+}
+
+} // namespace detail
+
 PluginManager::~PluginManager() {
   shutdown_all_plugins();
   unload_all_plugins();
@@ -48,17 +257,16 @@ bool PluginManager::load_plugin_from_path(const std::string &plugin_path) {
     return true;
   }
 
-  auto wrapper = load_plugin_library(plugin_path);
-  if (!wrapper) {
-    return false;
-  }
-
   LoadedPlugin loaded_plugin;
-  loaded_plugin.wrapper = std::move(wrapper);
   loaded_plugin.path = plugin_path;
+  if (!load_into(plugin_path, loaded_plugin)) {
+    return false;
+  }
+  const auto load_ms = to_millis(loaded_plugin.load_time);
   loaded_plugins_[plugin_name] = std::move(loaded_plugin);
 
-  OBCX_INFO("Plugin {} loaded successfully from {}", plugin_name, plugin_path);
+  OBCX_INFO("Plugin {} loaded successfully from {} in {:.1f} ms",
+            plugin_name, plugin_path, load_ms);
   return true;
 }
 
@@ -117,25 +325,226 @@ void PluginManager::deinitialize_plugin(const std::string &plugin_name) {
 }
 
 bool PluginManager::initialize_plugin(const std::string &plugin_name) {
-  auto *plugin = get_plugin(plugin_name);
-  if (!plugin) {
+  auto it = loaded_plugins_.find(plugin_name);
+  if (it == loaded_plugins_.end() || !it->second.wrapper) {
     OBCX_ERROR("Plugin {} not found", plugin_name);
     return false;
   }
+  auto &loaded = it->second;
 
+  const auto started = std::chrono::steady_clock::now();
+  bool ok = false;
   try {
-    if (plugin->initialize()) {
-      OBCX_INFO("Plugin {} initialized successfully", plugin_name);
-      return true;
-    } else {
-      OBCX_ERROR("Plugin {} failed to initialize", plugin_name);
-      return false;
-    }
+    // 插件在 initialize() 中注册的处理器归属于本次加载，重载时据此注销
+    const core::HandlerOwnerScope owner(loaded.owner);
+    ok = loaded.wrapper->get()->initialize();
   } catch (const std::exception &e) {
     OBCX_ERROR("Exception during plugin {} initialization: {}", plugin_name,
                e.what());
+  }
+  // 并行初始化时各线程只写各自插件的记录
+  loaded.init_time = std::chrono::steady_clock::now() - started;
+  loaded.initialized = ok;
+
+  if (ok) {
+    OBCX_INFO("Plugin {} initialized successfully in {:.1f} ms", plugin_name,
+              to_millis(loaded.init_time));
+  } else {
+    OBCX_ERROR("Plugin {} failed to initialize", plugin_name);
+  }
+  return ok;
+}
+
+bool PluginManager::initialize_plugins(
+    const std::vector<std::string> &plugin_names) {
+  std::vector<detail::PluginInitTask> tasks;
+  tasks.reserve(plugin_names.size());
+  for (const auto &name : plugin_names) {
+    const auto *info = get_plugin_info(name);
+    if (info == nullptr) {
+      OBCX_ERROR("Plugin {} not found", name);
+      continue;
+    }
+    tasks.push_back({.name = name,
+                     .dependencies = info->dependencies,
+                     .exclusive = !info->concurrent_init});
+  }
+
+  const auto started = std::chrono::steady_clock::now();
+  const auto results =
+      detail::run_init_tasks(tasks, [this](const std::string &name) {
+        return initialize_plugin(name);
+      });
+  const auto elapsed = std::chrono::steady_clock::now() - started;
+
+  const auto succeeded = static_cast<std::size_t>(std::ranges::count_if(
+      results, [](const auto &result) { return result.second; }));
+  OBCX_INFO("Initialized {}/{} plugins in {:.1f} ms", succeeded,
+            plugin_names.size(), to_millis(elapsed));
+  for (const auto &startup : startup_report()) {
+    OBCX_INFO("  {:<24} load {:>8.1f} ms  init {:>8.1f} ms{}", startup.name,
+              to_millis(startup.load_time), to_millis(startup.init_time),
+              startup.initialized ? "" : "  (not initialized)");
+  }
+  return succeeded == plugin_names.size();
+}
+
+const PluginInfo *PluginManager::get_plugin_info(
+    const std::string &plugin_name) const {
+  auto it = loaded_plugins_.find(plugin_name);
+  return it != loaded_plugins_.end() ? &it->second.info : nullptr;
+}
+
+std::vector<PluginStartup> PluginManager::startup_report() const {
+  std::vector<PluginStartup> report;
+  report.reserve(loaded_plugins_.size());
+  for (const auto &[name, plugin] : loaded_plugins_) {
+    report.push_back({.name = name,
+                      .load_time = plugin.load_time,
+                      .init_time = plugin.init_time,
+                      .initialized = plugin.initialized});
+  }
+  std::ranges::sort(report, std::greater<>{}, [](const PluginStartup &s) {
+    return s.load_time + s.init_time;
+  });
+  return report;
+}
+
+std::optional<PluginInfo> PluginManager::read_metadata(
+    const std::string &plugin_path) {
+  void *handle = dlopen(plugin_path.c_str(), RTLD_LAZY | RTLD_LOCAL);
+  if (!handle) {
+    OBCX_ERROR("Failed to open plugin library {}: {}", plugin_path, dlerror());
+    return std::nullopt;
+  }
+  auto info = metadata_from_handle(handle);
+  dlclose(handle);
+  return info;
+}
+
+bool PluginManager::reload_plugin(const std::string &plugin_name,
+                                  std::chrono::milliseconds timeout) {
+  auto it = loaded_plugins_.find(plugin_name);
+  if (it == loaded_plugins_.end()) {
+    OBCX_ERROR("Plugin {} not found", plugin_name);
+    return false;
+  }
+  auto &loaded = it->second;
+
+  std::vector<core::EventDispatcher *> dispatchers;
+  try {
+    auto [lock, bots] = interface::IPlugin::get_bots();
+    for (auto &bot : bots) {
+      dispatchers.push_back(&bot->dispatcher());
+    }
+  } catch (const std::exception &e) {
+    OBCX_ERROR("Cannot reload plugin {}: {}", plugin_name, e.what());
+    return false;
+  }
+
+  const auto started = std::chrono::steady_clock::now();
+  // 从这里到返回，新事件只暂存不分发，不会再启动旧插件的处理器
+  const EventHold hold(dispatchers);
+  const auto deadline = started + timeout;
+  for (auto *dispatcher : dispatchers) {
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+    if (!dispatcher->wait_idle(
+            loaded.owner,
+            std::max(remaining, std::chrono::milliseconds::zero()))) {
+      OBCX_ERROR("Plugin {} still has {} handlers running after {} ms, "
+                 "reload aborted",
+                 plugin_name, dispatcher->in_flight(loaded.owner),
+                 timeout.count());
+      return false;
+    }
+  }
+
+  if (loaded.initialized) {
+    deinitialize_plugin(plugin_name);
+  }
+  shutdown_plugin(plugin_name);
+  std::size_t replaced = 0;
+  for (auto *dispatcher : dispatchers) {
+    replaced += dispatcher->off_owner(loaded.owner);
+  }
+  // 转换函数在收包线程上同步运行，不受 hold() 约束：注销后等正在运行的
+  // 调用结束。调用都很短，超时只记录警告，仍须等到结束才能卸载
+  namespace converters = adapter::onebot11::EventConverter;
+  converters::unregister_owner(loaded.owner);
+  while (!converters::wait_idle(loaded.owner, timeout)) {
+    OBCX_WARN("Plugin {} still has event converters running", plugin_name);
+  }
+  // 处理器已全部析构，此后不再有代码引用旧库
+  loaded.wrapper.reset();
+
+  // 含 STB_GNU_UNIQUE 符号等情况下 dlclose 不会卸载库，再次 dlopen
+  // 同一路径只会拿回旧代码；此时改为加载一份临时副本
+  std::string library_path = loaded.path;
+  std::filesystem::path copy;
+  if (void *resident = dlopen(loaded.path.c_str(), RTLD_LAZY | RTLD_NOLOAD)) {
+    dlclose(resident);
+    copy = std::filesystem::temp_directory_path() /
+           fmt::format("obcx-{}-{}{}", plugin_name, loaded.owner,
+                       std::filesystem::path(loaded.path).extension().string());
+    std::error_code ec;
+    std::filesystem::copy_file(
+        loaded.path, copy, std::filesystem::copy_options::overwrite_existing,
+        ec);
+    if (ec) {
+      OBCX_WARN("Plugin {} is still resident and copying it failed: {}",
+                plugin_name, ec.message());
+      copy.clear();
+    } else {
+      OBCX_WARN("Plugin {} is still resident after dlclose, loading a copy",
+                plugin_name);
+      library_path = copy.string();
+    }
+  }
+
+  const bool loaded_ok = load_into(library_path, loaded);
+  if (!copy.empty()) {
+    // 已映射的库在文件删除后依然有效
+    std::error_code ec;
+    std::filesystem::remove(copy, ec);
+  }
+  if (!loaded_ok) {
+    OBCX_ERROR("Plugin {} failed to reload from {} and is now unloaded",
+               plugin_name, loaded.path);
+    loaded_plugins_.erase(it);
     return false;
   }
+
+  const bool ok = initialize_plugin(plugin_name);
+  OBCX_INFO("Plugin {} reloaded in {:.1f} ms, {} handlers replaced",
+            plugin_name,
+            to_millis(std::chrono::steady_clock::now() - started), replaced);
+  return ok;
+}
+
+std::size_t PluginManager::reload_modified_plugins() {
+  std::vector<std::string> modified;
+  for (const auto &[name, plugin] : loaded_plugins_) {
+    std::error_code ec;
+    const auto time = std::filesystem::last_write_time(plugin.path, ec);
+    if (!ec && time != plugin.modified) {
+      modified.push_back(name);
+    }
+  }
+  if (modified.empty()) {
+    OBCX_INFO("No plugin library changed since it was loaded");
+    return 0;
+  }
+
+  std::size_t reloaded = 0;
+  for (const auto &name : modified) {
+    OBCX_INFO("Plugin library of {} changed, reloading", name);
+    if (reload_plugin(name)) {
+      ++reloaded;
+    }
+  }
+  return reloaded;
 }
 
 void PluginManager::shutdown_plugin(const std::string &plugin_name) {
@@ -152,9 +561,7 @@ void PluginManager::shutdown_plugin(const std::string &plugin_name) {
 }
 
 void PluginManager::initialize_all_plugins() {
-  for (const auto &[name, plugin] : loaded_plugins_) {
-    initialize_plugin(name);
-  }
+  initialize_plugins(get_loaded_plugin_names());
 }
 
 void PluginManager::shutdown_all_plugins() {
@@ -179,14 +586,46 @@ std::string PluginManager::find_plugin_file(const std::string &plugin_name) {
   return "";
 }
 
+bool PluginManager::load_into(const std::string &plugin_path,
+                              LoadedPlugin &loaded) {
+  const auto started = std::chrono::steady_clock::now();
+  PluginInfo info;
+  auto wrapper = load_plugin_library(plugin_path, info);
+  if (!wrapper) {
+    return false;
+  }
+
+  loaded.wrapper = std::move(wrapper);
+  loaded.info = std::move(info);
+  loaded.owner = next_owner();
+  std::error_code ec;
+  loaded.modified = std::filesystem::last_write_time(loaded.path, ec);
+  loaded.load_time = std::chrono::steady_clock::now() - started;
+  loaded.init_time = std::chrono::nanoseconds{0};
+  loaded.initialized = false;
+  return true;
+}
+
 std::unique_ptr<SafePluginWrapper> PluginManager::load_plugin_library(
-    const std::string &plugin_path) {
+    const std::string &plugin_path, PluginInfo &info) {
   void *handle = dlopen(plugin_path.c_str(), RTLD_LAZY);
   if (!handle) {
     OBCX_ERROR("Failed to load plugin library {}: {}", plugin_path, dlerror());
     return nullptr;
   }
 
+  // 先检查静态元数据，不合格的插件不构造实例
+  std::optional<PluginInfo> metadata_info;
+  if (const auto *metadata = exported_metadata(handle)) {
+    metadata_info = info_from_metadata(*metadata);
+    if (!metadata_info) {
+      OBCX_ERROR("Plugin {} exports invalid metadata (struct version {})",
+                 plugin_path, metadata->struct_version);
+      dlclose(handle);
+      return nullptr;
+    }
+  }
+
   dlerror();
 
   using create_plugin_t = void *(*)();
@@ -221,8 +660,23 @@ std::unique_ptr<SafePluginWrapper> PluginManager::load_plugin_library(
       return nullptr;
     }
 
-    return std::make_unique<SafePluginWrapper>(plugin_ptr, handle,
-                                               destroy_plugin);
+    auto wrapper = std::make_unique<SafePluginWrapper>(plugin_ptr, handle,
+                                                       destroy_plugin);
+    if (metadata_info) {
+      info = std::move(*metadata_info);
+    } else {
+      // 旧插件没有静态元数据，从实例读取且按独占方式初始化
+      info = PluginInfo{};
+      try {
+        info.name = (*wrapper)->get_name();
+        info.version = (*wrapper)->get_version();
+        info.description = (*wrapper)->get_description();
+      } catch (const std::exception &e) {
+        OBCX_WARN("Failed to read plugin info from {}: {}", plugin_path,
+                  e.what());
+      }
+    }
+    return wrapper;
   } catch (const std::exception &e) {
     OBCX_ERROR("Exception during plugin creation from {}: {}", plugin_path,
                e.what());
@@ -0,0 +1,174 @@
+#include "common/tracing.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <fmt/format.h>
+#include <fstream>
+
+namespace obcx::common {
+
+namespace {
+
+thread_local uint64_t current_trace = 0;
+
+auto thread_index() noexcept -> uint32_t {
+  static std::atomic<uint32_t> next{1};
+  thread_local const uint32_t index =
+      next.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+void append_escaped(std::string &out, const char *value) {
+  for (const char *p = value; *p != '\0'; ++p) {
+    const char c = *p;
+    if (c == '"' || c == '\\') {
+      out.push_back('\\');
+      out.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out += fmt::format("\\u{:04x}", static_cast<unsigned>(c));
+    } else {
+      out.push_back(c);
+    }
+  }
+}
+
+// trace-event 的时间单位为微秒
+auto micros(uint64_t nanoseconds) -> std::string {
+  return fmt::format("{}.{:03}", nanoseconds / 1000, nanoseconds % 1000);
+}
+
+} // namespace
+
+auto Tracer::instance() -> Tracer & {
+  // 有意不析构：静态对象析构期间仍可能有线程在记录
+  static auto *tracer = new Tracer;
+  return *tracer;
+}
+
+void Tracer::start(std::size_t capacity) {
+  if (!slots_) {
+    capacity = std::bit_ceil(std::max<std::size_t>(capacity, 2));
+    slots_ = std::make_unique<Slot[]>(capacity);
+    mask_ = capacity - 1;
+  }
+  enabled_.store(true, std::memory_order_release);
+}
+
+auto Tracer::now() noexcept -> uint64_t {
+  static const auto epoch = std::chrono::steady_clock::now();
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - epoch)
+          .count());
+}
+
+void Tracer::record(const char *name, uint64_t trace_id, uint64_t start_ns,
+                    uint64_t end_ns, bool async) noexcept {
+  if (!enabled()) {
+    return;
+  }
+  const auto index = head_.fetch_add(1, std::memory_order_relaxed);
+  auto &slot = slots_[index & mask_];
+  // 奇数表示写入中，写完后置为 2 * index + 2
+  slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.trace_id.store(trace_id, std::memory_order_relaxed);
+  slot.start_ns.store(start_ns, std::memory_order_relaxed);
+  slot.duration_ns.store(end_ns > start_ns ? end_ns - start_ns : 0,
+                         std::memory_order_relaxed);
+  slot.thread.store(thread_index(), std::memory_order_relaxed);
+  slot.async.store(async, std::memory_order_relaxed);
+  slot.seq.store(2 * index + 2, std::memory_order_release);
+}
+
+auto Tracer::snapshot() const -> std::vector<SpanRecord> {
+  std::vector<SpanRecord> spans;
+  if (!slots_) {
+    return spans;
+  }
+  const auto head = head_.load(std::memory_order_acquire);
+  const auto capacity = mask_ + 1;
+  const auto begin = head > capacity ? head - capacity : 0;
+  spans.reserve(head - begin);
+  for (auto index = begin; index < head; ++index) {
+    const auto &slot = slots_[index & mask_];
+    const auto seq = slot.seq.load(std::memory_order_acquire);
+    if (seq != 2 * index + 2) {
+      continue; // 仍在写入或已被覆盖
+    }
+    SpanRecord span{
+        .name = slot.name.load(std::memory_order_relaxed),
+        .trace_id = slot.trace_id.load(std::memory_order_relaxed),
+        .start_ns = slot.start_ns.load(std::memory_order_relaxed),
+        .duration_ns = slot.duration_ns.load(std::memory_order_relaxed),
+        .thread = slot.thread.load(std::memory_order_relaxed),
+        .async = slot.async.load(std::memory_order_relaxed)};
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.seq.load(std::memory_order_relaxed) == seq) {
+      spans.push_back(span);
+    }
+  }
+  std::ranges::stable_sort(spans, {}, &SpanRecord::start_ns);
+  return spans;
+}
+
+auto Tracer::export_chrome_json() const -> std::string {
+  const auto spans = snapshot();
+  std::string out = R"({"displayTimeUnit":"ms","traceEvents":[)";
+  out += R"({"name":"process_name","ph":"M","pid":1,"tid":0,)"
+         R"("args":{"name":"obcx"}})";
+
+  uint64_t async_id = 0;
+  for (const auto &span : spans) {
+    auto event = [&](std::string_view phase, uint64_t ts) {
+      out += R"(,{"name":")";
+      append_escaped(out, span.name);
+      out += fmt::format(R"(","cat":"obcx","ph":"{}","ts":{},"pid":1,)"
+                         R"("tid":{},)",
+                         phase, micros(ts), span.thread);
+    };
+    if (span.async) {
+      // 异步跨度会与同一线程上的其他跨度交错，用 b/e 对单独成轨
+      ++async_id;
+      event("b", span.start_ns);
+      out += fmt::format(R"("id":"0x{:x}","args":{{"trace_id":{}}}}})",
+                         async_id, span.trace_id);
+      event("e", span.start_ns + span.duration_ns);
+      out += fmt::format(R"("id":"0x{:x}"}})", async_id);
+    } else {
+      event("X", span.start_ns);
+      out += fmt::format(R"("dur":{},"args":{{"trace_id":{}}}}})",
+                         micros(span.duration_ns), span.trace_id);
+    }
+  }
+  out += "]}";
+  return out;
+}
+
+auto Tracer::write_chrome_json(const std::string &path) const -> bool {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return false;
+  }
+  file << export_chrome_json();
+  return static_cast<bool>(file);
+}
+
+auto current_trace_id() noexcept -> uint64_t { return current_trace; }
+
+TraceScope::TraceScope(uint64_t trace_id) noexcept
+    : previous_(current_trace) {
+  current_trace = trace_id;
+}
+
+TraceScope::~TraceScope() { current_trace = previous_; }
+
+void TraceContext::switch_to(uint64_t id) noexcept {
+  trace_id.store(id, std::memory_order_relaxed);
+  // TraceExecutor 的 TraceScope 会在本次恢复结束时还原线程局部值
+  current_trace = id;
+}
+
+} // namespace obcx::common
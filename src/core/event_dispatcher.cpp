@@ -0,0 +1,729 @@
+#include "core/event_dispatcher.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace obcx::core {
+
+namespace {
+
+thread_local HandlerOwner current_owner = 0;
+
+// 变体下标到事件类型名，仅用于日志
+auto event_name(std::size_t index) -> const std::string & {
+  static const auto names = []<std::size_t... I>(std::index_sequence<I...>) {
+    return std::array<std::string, sizeof...(I)>{boost::core::demangle(
+        typeid(std::variant_alternative_t<I, common::Event>).name())...};
+  }(std::make_index_sequence<std::variant_size_v<common::Event>>{});
+  return names[index];
+}
+
+// 各事件类型的指标，首次分发时创建
+struct DispatcherMetrics {
+  static constexpr auto kKinds = std::variant_size_v<common::Event>;
+
+  std::array<common::Counter *, kKinds> events{};
+  std::array<common::Histogram *, kKinds> handler_duration{};
+  common::Counter *dropped = nullptr;
+  common::Counter *handler_errors = nullptr;
+
+  static auto get() -> DispatcherMetrics & {
+    static DispatcherMetrics metrics = [] {
+      auto &registry = common::MetricsRegistry::instance();
+      DispatcherMetrics m;
+      for (std::size_t i = 0; i < kKinds; ++i) {
+        // 标签只保留类型名，去掉命名空间
+        const auto &name = event_name(i);
+        const auto scope = name.rfind("::");
+        const common::MetricLabels labels{
+            {"event",
+             scope == std::string::npos ? name : name.substr(scope + 2)}};
+        m.events[i] = &registry.counter(
+            "obcx_events_dispatched_total", "Events passed to the dispatcher",
+            labels);
+        m.handler_duration[i] = &registry.histogram(
+            "obcx_handler_duration_seconds",
+            "Wall time of one event handler coroutine", labels);
+      }
+      m.dropped = &registry.counter(
+          "obcx_events_dropped_total",
+          "Events discarded because the dispatcher was draining");
+      m.handler_errors = &registry.counter(
+          "obcx_handler_errors_total", "Event handlers that threw");
+      return m;
+    }();
+    return metrics;
+  }
+};
+
+auto trace_id_of(const common::Event &event) -> uint64_t {
+  return std::visit([](const auto &e) { return e.trace_id; }, event);
+}
+
+// 拷贝事件供处理器协程共享，读取事件时分配的追踪 ID 随之进入协程
+auto share_event(const common::Event &event)
+    -> std::shared_ptr<const common::Event> {
+  auto shared = std::make_shared<common::Event>(event);
+  if (const auto trace_id = common::current_trace_id(); trace_id != 0) {
+    std::visit([trace_id](auto &e) { e.trace_id = trace_id; }, *shared);
+  }
+  return shared;
+}
+
+// 追踪器启用时为处理器协程创建追踪上下文，否则返回空
+auto make_trace_context(const common::Event &event)
+    -> std::shared_ptr<common::TraceContext> {
+  if (!common::Tracer::instance().enabled()) {
+    return nullptr;
+  }
+  return std::make_shared<common::TraceContext>(trace_id_of(event));
+}
+
+// 在处理器协程开始运行时记录其自分发起的等待时间
+void record_handler_wait(uint64_t spawned_at) {
+  if (const auto trace_id = common::current_trace_id(); trace_id != 0) {
+    common::Tracer::instance().record("handler.wait", trace_id, spawned_at,
+                                      common::Tracer::now(), true);
+  }
+}
+
+} // namespace
+
+HandlerOwnerScope::HandlerOwnerScope(HandlerOwner owner) noexcept
+    : previous_(current_owner) {
+  current_owner = owner;
+}
+
+HandlerOwnerScope::~HandlerOwnerScope() { current_owner = previous_; }
+
+auto HandlerOwnerScope::current() noexcept -> HandlerOwner {
+  return current_owner;
+}
+
+struct EventDispatcher::Tracker {
+  // 取消信号放在表项中，不再单独分配；表项的地址在删除前不变
+  struct Active {
+    asio::cancellation_signal signal;
+    HandlerOwner owner = 0;
+  };
+
+  std::atomic<bool> accepting{true};
+  std::mutex mutex;
+  // 每个协程结束时通知：drain() 等待全部结束，wait_idle() 等待某所属者
+  std::condition_variable idle;
+  uint64_t next_id = 0;
+  std::unordered_map<uint64_t, Active> active;
+  // 已选出但尚未启动协程的处理器数，按所属者统计；选出时在 handlers_mutex_
+  // 内登记，wait_idle() 因此能看到释放读锁后才启动的处理器
+  std::unordered_map<HandlerOwner, std::size_t> selected;
+
+  void remove(uint64_t id) {
+    std::lock_guard lock(mutex);
+    active.erase(id);
+    idle.notify_all();
+  }
+
+  void reserve(const Selection &selection) {
+    std::lock_guard lock(mutex);
+    for (const auto *route : selection.routes) {
+      if (route->owner != 0) {
+        ++selected[route->owner];
+      }
+    }
+  }
+
+  // 在 io_context 的线程上或 io_context 停止后调用，表项只会在这里之后
+  // 才被删除。发出取消可能同步结束协程并调用 remove()，因此在锁外发出
+  void cancel(const std::vector<uint64_t> &ids) {
+    for (const auto id : ids) {
+      asio::cancellation_signal *signal = nullptr;
+      {
+        std::lock_guard lock(mutex);
+        if (const auto it = active.find(id); it != active.end()) {
+          signal = &it->second.signal;
+        }
+      }
+      if (signal != nullptr) {
+        signal->emit(asio::cancellation_type::terminal);
+      }
+    }
+  }
+
+  // 选出的处理器没有启动协程（如已排入 HandlerQueue）时撤销登记
+  void unreserve(HandlerOwner owner) {
+    std::lock_guard lock(mutex);
+    unreserve_locked(owner);
+    idle.notify_all();
+  }
+
+  // 调用方持有 mutex
+  void unreserve_locked(HandlerOwner owner) {
+    if (const auto it = selected.find(owner);
+        it != selected.end() && --it->second == 0) {
+      selected.erase(it);
+    }
+  }
+
+  // 调用方持有 mutex
+  [[nodiscard]] auto count(HandlerOwner owner) const -> std::size_t {
+    const auto it = selected.find(owner);
+    return static_cast<std::size_t>(
+               std::ranges::count(active, owner,
+                                  [](const auto &entry) {
+                                    return entry.second.owner;
+                                  })) +
+           (it != selected.end() ? it->second : 0);
+  }
+};
+
+EventDispatcher::EventDispatcher(asio::io_context &io_context)
+    : io_context_(io_context), tracker_(std::make_shared<Tracker>()),
+      filters_(std::make_shared<const FilterTable>()) {
+  in_flight_metric_ = common::MetricsRegistry::instance().observe(
+      "obcx_handlers_in_flight", "Event handler coroutines currently running",
+      {}, [tracker = tracker_] {
+        std::lock_guard lock(tracker->mutex);
+        return static_cast<double>(tracker->active.size());
+      });
+}
+
+auto EventDispatcher::on(
+    MessageFilter filter,
+    std::function<asio::awaitable<void>(IBot &, const common::MessageEvent &)>
+        handler,
+    HandlerPolicy policy) -> HandlerToken {
+  auto route = make_route<common::MessageEvent>(std::move(handler),
+                                                std::move(policy));
+  std::lock_guard routes_lock(routes_mutex_);
+  auto filters = std::make_shared<FilterTable>(*filters_);
+  const auto slot = filters->index.add(std::move(filter));
+  if (slot >= filters->routes.size()) {
+    filters->routes.resize(slot + 1);
+  }
+  {
+    std::lock_guard lock(handlers_mutex_);
+    route.id = next_handler_id_++;
+  }
+  const HandlerToken token{.id = route.id};
+  filters->routes[slot] = std::move(route);
+  publish(std::move(filters));
+  OBCX_DEBUG("已注册带过滤条件的消息处理函数（槽位 {}）", slot);
+  return token;
+}
+
+auto EventDispatcher::replace_filter(HandlerToken token, MessageFilter filter)
+    -> bool {
+  if (!token) {
+    return false;
+  }
+  std::lock_guard routes_lock(routes_mutex_);
+  const auto &routes = filters_->routes;
+  const auto it = std::ranges::find_if(routes, [&token](const Route &route) {
+    return route.handler && route.id == token.id;
+  });
+  if (it == routes.end()) {
+    return false;
+  }
+  const auto slot = static_cast<uint32_t>(it - routes.begin());
+  auto filters = std::make_shared<FilterTable>(*filters_);
+  filters->index.replace(slot, std::move(filter));
+  publish(std::move(filters));
+  OBCX_DEBUG("已替换消息处理函数的过滤条件（槽位 {}）", slot);
+  return true;
+}
+
+void EventDispatcher::publish(std::shared_ptr<const FilterTable> filters) {
+  std::unique_lock lock(handlers_mutex_);
+  filters_.swap(filters);
+  lock.unlock();
+  // filters 此时持有旧表，在锁外析构
+}
+
+template <typename Matches>
+auto EventDispatcher::remove_routes(Matches matches) -> std::size_t {
+  std::lock_guard routes_lock(routes_mutex_);
+  std::shared_ptr<FilterTable> filters;
+  std::size_t removed = 0;
+  for (uint32_t slot = 0; slot < filters_->routes.size(); ++slot) {
+    const auto &route = filters_->routes[slot];
+    if (!route.handler || !matches(route)) {
+      continue;
+    }
+    if (!filters) {
+      filters = std::make_shared<FilterTable>(*filters_);
+    }
+    filters->index.remove(slot);
+    filters->routes[slot] = Route{};
+    ++removed;
+  }
+
+  std::array<std::shared_ptr<const Subscribers>, kEventKinds> subscribers;
+  for (std::size_t index = 0; index < kEventKinds; ++index) {
+    if (!handlers_[index] ||
+        std::ranges::none_of(*handlers_[index],
+                             [&](const Subscriber &subscriber) {
+                               return matches(subscriber.route);
+                             })) {
+      continue;
+    }
+    auto remaining = std::make_shared<Subscribers>();
+    for (const auto &subscriber : *handlers_[index]) {
+      if (matches(subscriber.route)) {
+        ++removed;
+      } else {
+        remaining->push_back(subscriber);
+      }
+    }
+    subscribers[index] = std::move(remaining);
+  }
+
+  // 换下的旧表留在这里，解锁后析构
+  std::unique_lock lock(handlers_mutex_);
+  for (std::size_t index = 0; index < kEventKinds; ++index) {
+    if (subscribers[index]) {
+      handlers_[index].swap(subscribers[index]);
+    }
+  }
+  std::shared_ptr<const FilterTable> previous;
+  if (filters) {
+    previous = std::exchange(filters_, std::move(filters));
+  }
+  lock.unlock();
+  return removed;
+}
+
+auto EventDispatcher::off(HandlerToken token) -> bool {
+  if (!token) {
+    return false;
+  }
+  return remove_routes(
+             [id = token.id](const Route &route) { return route.id == id; }) >
+         0;
+}
+
+auto EventDispatcher::off_owner(HandlerOwner owner) -> std::size_t {
+  if (owner == 0) {
+    return 0;
+  }
+  const auto removed = remove_routes(
+      [owner](const Route &route) { return route.owner == owner; });
+  OBCX_DEBUG("已注销所属者 {} 的 {} 个处理函数", owner, removed);
+  return removed;
+}
+
+void EventDispatcher::hold() {
+  {
+    std::lock_guard lock(held_mutex_);
+    ++hold_depth_;
+    holding_.store(true, std::memory_order_release);
+  }
+  // 正在选出处理器的分发持有读锁，等它们把选中的处理器登记到跟踪表；之后
+  // 的分发在读锁内看到 hold_depth_ 而暂存事件，wait_idle() 不会漏掉处理器
+  const std::unique_lock barrier(handlers_mutex_);
+}
+
+auto EventDispatcher::lock_if_held() -> std::unique_lock<std::mutex> {
+  if (!holding_.load(std::memory_order_acquire)) {
+    return {};
+  }
+  std::unique_lock lock(held_mutex_);
+  if (hold_depth_ == 0) {
+    lock.unlock();
+  }
+  return lock;
+}
+
+void EventDispatcher::release() {
+  {
+    std::lock_guard lock(held_mutex_);
+    if (hold_depth_ == 0 || --hold_depth_ > 0) {
+      return;
+    }
+  }
+  if (io_context_.stopped()) {
+    replay_held();
+    return;
+  }
+  // 在 io_context 上回放，暂存事件与其后到达的事件保持在同一线程上有序
+  asio::post(io_context_, [this] { replay_held(); });
+}
+
+void EventDispatcher::replay_held() {
+  std::unique_lock lock(held_mutex_);
+  // 已有回放在进行时由它接着分发新暂存的事件
+  if (replaying_) {
+    return;
+  }
+  replaying_ = true;
+  auto &metrics = DispatcherMetrics::get();
+  // 投递回放之后又有新的 hold()，剩余事件留给与之配对的 release() 回放
+  while (hold_depth_ == 0 && !held_.empty()) {
+    // 处理器可能同步运行并调用 hold()/release() 或再次分发，分发时不持锁
+    decltype(held_) batch;
+    batch.swap(held_);
+    lock.unlock();
+    OBCX_DEBUG("分发 {} 个暂存的事件", batch.size());
+    auto rest = batch.end();
+    for (auto it = batch.begin(); it != batch.end(); ++it) {
+      const auto &[bot, event] = *it;
+      if (!tracker_->accepting.load(std::memory_order_acquire)) {
+        metrics.dropped->inc();
+        continue;
+      }
+      if (!route(bot, event, false)) {
+        rest = it;
+        break;
+      }
+      metrics.events[event->index()]->inc();
+    }
+    lock.lock();
+    // 回放期间又有 hold()，其余事件放回队首，由与之配对的 release() 回放
+    held_.insert(held_.begin(), std::make_move_iterator(rest),
+                 std::make_move_iterator(batch.end()));
+  }
+  replaying_ = false;
+  // 回放期间到达的事件已排在 held_ 中并在上面分发，之后直接分发
+  if (hold_depth_ == 0) {
+    holding_.store(false, std::memory_order_release);
+  }
+}
+
+void EventDispatcher::dispatch(IBot *bot, const common::Event &event) {
+  if (holding_.load(std::memory_order_acquire)) {
+    dispatch(bot, share_event(event));
+    return;
+  }
+  auto &metrics = DispatcherMetrics::get();
+  if (!tracker_->accepting.load(std::memory_order_acquire)) {
+    metrics.dropped->inc();
+    OBCX_DEBUG("分发器已停止接收事件，丢弃 {}", event_name(event.index()));
+    return;
+  }
+  const common::Span span("dispatch");
+  Selection selected;
+  {
+    std::shared_lock lock(handlers_mutex_);
+    if (const auto held = lock_if_held()) {
+      held_.emplace_back(bot, share_event(event));
+      return;
+    }
+    selected = select(event);
+    if (selected.owned) {
+      tracker_->reserve(selected);
+    }
+  }
+  metrics.events[event.index()]->inc();
+  // 没有处理器接收时不拷贝事件
+  if (selected.routes.empty()) {
+    OBCX_DEBUG("没有为事件类型 {} 注册的处理函数", event_name(event.index()));
+    return;
+  }
+  spawn(bot, selected, share_event(event));
+}
+
+void EventDispatcher::dispatch(IBot *bot,
+                               std::shared_ptr<const common::Event> event) {
+  auto &metrics = DispatcherMetrics::get();
+  if (!tracker_->accepting.load(std::memory_order_acquire)) {
+    metrics.dropped->inc();
+    OBCX_DEBUG("分发器已停止接收事件，丢弃 {}", event_name(event->index()));
+    return;
+  }
+  if (holding_.load(std::memory_order_acquire)) {
+    std::lock_guard lock(held_mutex_);
+    if (holding_.load(std::memory_order_relaxed)) {
+      held_.emplace_back(bot, std::move(event));
+      return;
+    }
+  }
+  const common::Span span("dispatch");
+  if (route(bot, event, true)) {
+    metrics.events[event->index()]->inc();
+  }
+}
+
+auto EventDispatcher::route(IBot *bot,
+                            const std::shared_ptr<const common::Event> &event,
+                            bool stash) -> bool {
+  Selection selected;
+  {
+    std::shared_lock lock(handlers_mutex_);
+    if (const auto held = lock_if_held()) {
+      if (stash) {
+        held_.emplace_back(bot, event);
+      }
+      return false;
+    }
+    selected = select(*event);
+    if (selected.owned) {
+      tracker_->reserve(selected);
+    }
+  }
+  spawn(bot, selected, event);
+  return true;
+}
+
+auto EventDispatcher::select(const common::Event &event) const -> Selection {
+  Selection selected;
+  if (const auto &subscribers = handlers_[event.index()]) {
+    for (const auto &subscriber : *subscribers) {
+      if (!subscriber.predicate || subscriber.predicate(event)) {
+        // 第一次命中时按上限预留，没有命中的事件不分配
+        if (selected.routes.empty()) {
+          selected.routes.reserve(subscribers->size());
+        }
+        selected.routes.push_back(&subscriber.route);
+        selected.owned = selected.owned || subscriber.route.owner != 0;
+      }
+    }
+    if (!selected.routes.empty()) {
+      selected.subscribers = subscribers;
+    }
+  }
+
+  if (const auto *message = std::get_if<common::MessageEvent>(&event);
+      message != nullptr && filters_->index.size() > 0) {
+    // 槽位缓冲区按线程复用，只在持锁期间使用
+    thread_local std::vector<uint32_t> matches;
+    matches.clear();
+    filters_->index.match(*message, matches);
+    selected.routes.reserve(selected.routes.size() + matches.size());
+    for (const auto slot : matches) {
+      const auto &route = filters_->routes[slot];
+      selected.routes.push_back(&route);
+      selected.owned = selected.owned || route.owner != 0;
+    }
+    if (!matches.empty()) {
+      selected.filters = filters_;
+    }
+  }
+  return selected;
+}
+
+void EventDispatcher::spawn(IBot *bot, const Selection &selection,
+                            const std::shared_ptr<const common::Event> &event) {
+  OBCX_DEBUG("事件 {} 调用 {} 个处理函数", event_name(event->index()),
+             selection.routes.size());
+
+  for (const auto *entry : selection.routes) {
+    const auto &route = *entry;
+    if (route.queue) {
+      if (auto job = route.queue->submit(event)) {
+        run_queued(bot, route, std::move(*job));
+      } else if (route.owner != 0) {
+        // 已排队的任务由正在运行的协程接着处理，它已在跟踪表中
+        tracker_->unreserve(route.owner);
+      }
+      continue;
+    }
+    // 每个处理器一个协程；协程持有处理器与事件的共享所有权，
+    // 二者的生命周期覆盖整个处理过程
+    auto trace = make_trace_context(*event);
+    const auto spawned_at = trace ? common::Tracer::now() : 0;
+    spawn_tracked(
+        [handler = route.handler, bot, event,
+         spawned_at]() -> asio::awaitable<void> {
+          record_handler_wait(spawned_at);
+          const common::Span span("handler", true);
+          const common::ScopedTimer timer(
+              *DispatcherMetrics::get().handler_duration[event->index()]);
+          co_await (*handler)(*bot, *event);
+        },
+        std::move(trace), route.owner);
+  }
+}
+
+template <typename Coroutine>
+void EventDispatcher::spawn_tracked(
+    Coroutine coroutine, std::shared_ptr<common::TraceContext> trace,
+    HandlerOwner owner) {
+  uint64_t id = 0;
+  asio::cancellation_slot slot;
+  {
+    std::lock_guard lock(tracker_->mutex);
+    id = tracker_->next_id++;
+    auto &active = tracker_->active[id];
+    active.owner = owner;
+    slot = active.signal.slot();
+    // 选出时登记的名额转为正在运行的协程
+    if (owner != 0) {
+      tracker_->unreserve_locked(owner);
+    }
+  }
+
+  // 表项在完成回调的最后才删除，取消槽在协程结束前一直有效
+  auto completion = asio::bind_cancellation_slot(
+      slot, [tracker = tracker_, id](const std::exception_ptr &error) {
+        if (error) {
+          DispatcherMetrics::get().handler_errors->inc();
+          try {
+            std::rethrow_exception(error);
+          } catch (const std::exception &e) {
+            OBCX_ERROR("事件处理器抛出异常: {}", e.what());
+          } catch (...) {
+            OBCX_ERROR("事件处理器抛出未知异常");
+          }
+        }
+        tracker->remove(id);
+      });
+  if (trace) {
+    // 协程每次恢复都会进入事件的追踪 ID，出站调用因此归属该事件
+    asio::co_spawn(
+        common::TraceExecutor(io_context_.get_executor(), std::move(trace)),
+        std::move(coroutine), std::move(completion));
+  } else {
+    asio::co_spawn(io_context_, std::move(coroutine), std::move(completion));
+  }
+}
+
+void EventDispatcher::run_queued(IBot *bot, const Route &route,
+                                 HandlerQueue::Job job) {
+  auto trace = make_trace_context(*job.event);
+  const auto spawned_at = trace ? common::Tracer::now() : 0;
+  auto run = [bot, handler = route.handler, queue = route.queue,
+              job = std::move(job), trace,
+              spawned_at]() mutable -> asio::awaitable<void> {
+    // 同一协程内依次运行放行的任务，避免每个排队事件再启动一次协程
+    bool cancelled = false;
+    auto &metrics = DispatcherMetrics::get();
+    record_handler_wait(spawned_at);
+    while (true) {
+      if (!cancelled) {
+        try {
+          const common::Span span("handler", true);
+          const common::ScopedTimer timer(
+              *metrics.handler_duration[job.event->index()]);
+          co_await (*handler)(*bot, *job.event);
+        } catch (const std::exception &e) {
+          metrics.handler_errors->inc();
+          // 异常不能越过 complete，否则串行键会永远处于忙碌状态
+          OBCX_ERROR("事件处理器 {} 抛出异常: {}", queue->policy().name,
+                     e.what());
+        } catch (...) {
+          metrics.handler_errors->inc();
+          OBCX_ERROR("事件处理器 {} 抛出未知异常", queue->policy().name);
+        }
+      }
+      auto next = queue->complete(job);
+      if (!next) {
+        break;
+      }
+      job = std::move(*next);
+      if (trace) {
+        trace->switch_to(trace_id_of(*job.event));
+      }
+      // 被 drain() 取消后，放行的任务只出队、不再运行
+      auto state = co_await asio::this_coro::cancellation_state;
+      cancelled = state.cancelled() != asio::cancellation_type::none;
+    }
+  };
+  spawn_tracked(std::move(run), std::move(trace), route.owner);
+}
+
+auto EventDispatcher::drain(std::chrono::milliseconds timeout)
+    -> std::size_t {
+  tracker_->accepting.store(false, std::memory_order_release);
+
+  std::vector<uint64_t> pending;
+  const bool can_wait = !io_context_.stopped() &&
+                        !io_context_.get_executor().running_in_this_thread();
+  {
+    std::unique_lock lock(tracker_->mutex);
+    if (can_wait && !tracker_->active.empty()) {
+      OBCX_INFO("等待 {} 个处理中的事件处理器完成...",
+                tracker_->active.size());
+      tracker_->idle.wait_for(lock, timeout,
+                              [this] { return tracker_->active.empty(); });
+    }
+    pending.reserve(tracker_->active.size());
+    for (const auto &[id, active] : tracker_->active) {
+      pending.push_back(id);
+    }
+  }
+
+  if (pending.empty()) {
+    return 0;
+  }
+
+  OBCX_WARN("{} 个事件处理器未能在 {}ms 内完成，取消", pending.size(),
+            timeout.count());
+  auto cancel = [tracker = tracker_, pending] { tracker->cancel(pending); };
+  // 取消信号只能在 io_context 的线程上发出；已停止的 io_context 不会再运行
+  // 投递的任务，此时没有其他线程在推进处理器，直接在本线程发出
+  if (!can_wait) {
+    cancel();
+    return pending.size();
+  }
+  asio::post(io_context_, std::move(cancel));
+
+  // 等被取消的处理器退出，调用方随后停止 io_context 时不留下运行到一半的
+  // 协程；不响应取消的处理器最多等 kCancelTimeout
+  std::unique_lock lock(tracker_->mutex);
+  tracker_->idle.wait_for(lock, kCancelTimeout,
+                          [this] { return tracker_->active.empty(); });
+  if (!tracker_->active.empty()) {
+    OBCX_WARN("{} 个事件处理器取消后 {}ms 内仍未退出",
+              tracker_->active.size(), kCancelTimeout.count());
+  }
+  return tracker_->active.size();
+}
+
+auto EventDispatcher::draining() const -> bool {
+  return !tracker_->accepting.load(std::memory_order_acquire);
+}
+
+void EventDispatcher::resume() {
+  tracker_->accepting.store(true, std::memory_order_release);
+}
+
+auto EventDispatcher::in_flight() const -> std::size_t {
+  std::lock_guard lock(tracker_->mutex);
+  return tracker_->active.size();
+}
+
+auto EventDispatcher::in_flight(HandlerOwner owner) const -> std::size_t {
+  std::lock_guard lock(tracker_->mutex);
+  return tracker_->count(owner);
+}
+
+auto EventDispatcher::wait_idle(HandlerOwner owner,
+                                std::chrono::milliseconds timeout) -> bool {
+  std::unique_lock lock(tracker_->mutex);
+  const bool can_wait = !io_context_.stopped() &&
+                        !io_context_.get_executor().running_in_this_thread();
+  if (!can_wait) {
+    return tracker_->count(owner) == 0;
+  }
+  return tracker_->idle.wait_for(lock, timeout, [this, owner] {
+    return tracker_->count(owner) == 0;
+  });
+}
+
+auto EventDispatcher::handler_stats() const -> std::vector<HandlerStats> {
+  std::shared_lock lock(handlers_mutex_);
+  std::vector<HandlerStats> stats;
+  auto collect = [&stats](const Route &route) {
+    if (route.queue && !route.queue->policy().name.empty()) {
+      stats.push_back(route.queue->stats());
+    }
+  };
+  for (const auto &subscribers : handlers_) {
+    if (!subscribers) {
+      continue;
+    }
+    for (const auto &subscriber : *subscribers) {
+      collect(subscriber.route);
+    }
+  }
+  for (const auto &route : filters_->routes) {
+    collect(route);
+  }
+  return stats;
+}
+
+} // namespace obcx::core
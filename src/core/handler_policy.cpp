@@ -0,0 +1,111 @@
+#include "core/handler_policy.hpp"
+
+#include <algorithm>
+
+namespace obcx::core {
+
+auto HandlerPolicy::chat_key(const common::Event &event) -> std::string {
+  return std::visit(
+      [](const auto &concrete) -> std::string {
+        using T = std::decay_t<decltype(concrete)>;
+        if constexpr (std::is_same_v<T, common::MessageEvent> ||
+                      std::is_same_v<T, common::NoticeEvent>) {
+          if (concrete.group_id) {
+            return "g" + concrete.group_id->str();
+          }
+          return "u" + concrete.user_id.str();
+        } else {
+          return {};
+        }
+      },
+      event);
+}
+
+HandlerQueue::HandlerQueue(HandlerPolicy policy) : policy_(std::move(policy)) {
+  if (policy_.name.empty()) {
+    return;
+  }
+  // 同名的处理器（例如多个 Bot 上的同一插件）在导出时合计
+  auto &registry = common::MetricsRegistry::instance();
+  const common::MetricLabels labels{{"handler", policy_.name}};
+  queued_metric_ = registry.observe(
+      "obcx_handler_queued", "Events waiting for a handler slot", labels,
+      [this] {
+        std::lock_guard lock(mutex_);
+        return static_cast<double>(queued_);
+      });
+  in_flight_metric_ = registry.observe(
+      "obcx_handler_in_flight", "Handler coroutines running per handler",
+      labels, [this] {
+        std::lock_guard lock(mutex_);
+        return static_cast<double>(in_flight_);
+      });
+}
+
+auto HandlerQueue::submit(std::shared_ptr<const common::Event> event)
+    -> std::optional<Job> {
+  auto key = policy_.serial_key ? policy_.serial_key(*event) : std::string();
+
+  std::lock_guard lock(mutex_);
+  if (!key.empty()) {
+    auto [lane, idle] = lanes_.try_emplace(std::move(key));
+    if (!idle) {
+      // 该键已有事件在处理或排队，接在其后
+      lane->second.push_back(std::move(event));
+      ++queued_;
+      peak_queued_ = std::max(peak_queued_, queued_);
+      return std::nullopt;
+    }
+    ready_.push_back({.event = std::move(event), .key = lane->first});
+  } else {
+    ready_.push_back({.event = std::move(event), .key = {}});
+  }
+  ++queued_;
+  auto job = start_next();
+  peak_queued_ = std::max(peak_queued_, queued_);
+  return job;
+}
+
+auto HandlerQueue::complete(const Job &job) -> std::optional<Job> {
+  std::lock_guard lock(mutex_);
+  --in_flight_;
+  ++completed_;
+
+  if (!job.key.empty()) {
+    auto lane = lanes_.find(job.key);
+    if (lane != lanes_.end()) {
+      if (lane->second.empty()) {
+        lanes_.erase(lane);
+      } else {
+        // 同键的下一个事件进入就绪队列，键保持忙碌
+        ready_.push_back(
+            {.event = std::move(lane->second.front()), .key = job.key});
+        lane->second.pop_front();
+      }
+    }
+  }
+  return start_next();
+}
+
+auto HandlerQueue::start_next() -> std::optional<Job> {
+  if (ready_.empty() ||
+      (policy_.max_in_flight != 0 && in_flight_ >= policy_.max_in_flight)) {
+    return std::nullopt;
+  }
+  auto job = std::move(ready_.front());
+  ready_.pop_front();
+  --queued_;
+  ++in_flight_;
+  return job;
+}
+
+auto HandlerQueue::stats() const -> HandlerStats {
+  std::lock_guard lock(mutex_);
+  return {.name = policy_.name,
+          .in_flight = in_flight_,
+          .queued = queued_,
+          .peak_queued = peak_queued_,
+          .completed = completed_};
+}
+
+} // namespace obcx::core
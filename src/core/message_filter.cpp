@@ -0,0 +1,219 @@
+#include "core/message_filter.hpp"
+
+#include <algorithm>
+
+namespace obcx::core {
+
+namespace {
+
+// 命令之后允许的字符：结尾、空白，或 Telegram 的 /cmd@bot_name
+auto at_command_boundary(std::string_view text, std::size_t pos) -> bool {
+  if (pos == text.size()) {
+    return true;
+  }
+  const char next = text[pos];
+  return next == ' ' || next == '\t' || next == '\n' || next == '\r' ||
+         next == '@';
+}
+
+auto mentions(const common::MessageEvent &event, const common::UserId &self)
+    -> bool {
+  if (self.empty()) {
+    return false;
+  }
+  for (const auto &segment : event.message) {
+    if (segment.type != "at") {
+      continue;
+    }
+    auto it = segment.data.find("qq");
+    if (it == segment.data.end()) {
+      continue;
+    }
+    if (it->is_string() ? self == it->get_ref<const std::string &>()
+                        : it->is_number_integer() && self.is_numeric() &&
+                              self.as_int() == it->get<int64_t>()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+auto MessageFilterIndex::add(MessageFilter filter) -> uint32_t {
+  uint32_t slot = 0;
+  if (free_slots_.empty()) {
+    slot = static_cast<uint32_t>(entries_.size());
+    entries_.emplace_back();
+  } else {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  }
+  place(slot, std::move(filter), next_order_++);
+  return slot;
+}
+
+void MessageFilterIndex::remove(uint32_t slot) {
+  if (slot >= entries_.size() || entries_[slot].removed) {
+    return;
+  }
+  unlink(slot);
+  entries_[slot] = Entry{.filter = {}, .groups = {}, .removed = true};
+  free_slots_.push_back(slot);
+}
+
+void MessageFilterIndex::replace(uint32_t slot, MessageFilter filter) {
+  if (slot >= entries_.size() || entries_[slot].removed) {
+    return;
+  }
+  const auto order = entries_[slot].order;
+  unlink(slot);
+  place(slot, std::move(filter), order);
+}
+
+void MessageFilterIndex::place(uint32_t slot, MessageFilter filter,
+                               uint64_t order) {
+  Entry entry{.filter = std::move(filter), .groups = {}, .order = order};
+  entry.groups.insert(entry.filter.group_ids.begin(),
+                      entry.filter.group_ids.end());
+
+  if (!entry.filter.commands.empty()) {
+    // 同一过滤器的命令去重，避免一次匹配中重复命中
+    auto &commands = entry.filter.commands;
+    std::sort(commands.begin(), commands.end());
+    commands.erase(std::unique(commands.begin(), commands.end()),
+                   commands.end());
+    for (const auto &command : commands) {
+      insert_command(command, slot);
+    }
+  } else if (!entry.groups.empty()) {
+    for (const auto &group : entry.groups) {
+      by_group_[group].push_back(slot);
+    }
+  } else {
+    unindexed_.push_back(slot);
+  }
+
+  entries_[slot] = std::move(entry);
+}
+
+void MessageFilterIndex::unlink(uint32_t slot) {
+  const auto &entry = entries_[slot];
+  // 与 place() 的分支一致：过滤器只挂在一种索引上
+  if (!entry.filter.commands.empty()) {
+    for (const auto &command : entry.filter.commands) {
+      if (const auto node = find_command(command); node != 0) {
+        std::erase(trie_[node].entries, slot);
+      }
+    }
+  } else if (!entry.groups.empty()) {
+    for (const auto &group : entry.groups) {
+      if (auto it = by_group_.find(group); it != by_group_.end()) {
+        std::erase(it->second, slot);
+        if (it->second.empty()) {
+          by_group_.erase(it);
+        }
+      }
+    }
+  } else {
+    std::erase(unindexed_, slot);
+  }
+}
+
+auto MessageFilterIndex::find_command(std::string_view command) const
+    -> uint32_t {
+  uint32_t node = 0;
+  for (const char c : command) {
+    const auto &children = trie_[node].children;
+    auto it = std::find_if(children.begin(), children.end(),
+                           [c](const auto &child) { return child.first == c; });
+    if (it == children.end()) {
+      return 0;
+    }
+    node = it->second;
+  }
+  return node;
+}
+
+void MessageFilterIndex::insert_command(std::string_view command,
+                                        uint32_t slot) {
+  uint32_t node = 0;
+  for (const char c : command) {
+    auto &children = trie_[node].children;
+    auto it = std::find_if(children.begin(), children.end(),
+                           [c](const auto &child) { return child.first == c; });
+    if (it != children.end()) {
+      node = it->second;
+      continue;
+    }
+    const auto next = static_cast<uint32_t>(trie_.size());
+    children.emplace_back(c, next);
+    trie_.emplace_back();
+    node = next;
+  }
+  trie_[node].entries.push_back(slot);
+}
+
+void MessageFilterIndex::match(const common::MessageEvent &event,
+                               std::vector<uint32_t> &matches) const {
+  const auto first = matches.size();
+
+  auto collect = [&](const std::vector<uint32_t> &slots) {
+    for (const auto slot : slots) {
+      if (accepts(entries_[slot], event)) {
+        matches.push_back(slot);
+      }
+    }
+  };
+
+  collect(unindexed_);
+
+  if (event.group_id && !by_group_.empty()) {
+    if (auto it = by_group_.find(event.group_id->view());
+        it != by_group_.end()) {
+      collect(it->second);
+    }
+  }
+
+  // 沿 raw_message 走前缀树，每个带过滤器的节点都是一个完整命令
+  const std::string_view text = event.raw_message;
+  uint32_t node = 0;
+  for (std::size_t pos = 0; pos < text.size(); ++pos) {
+    const auto &children = trie_[node].children;
+    auto it = std::find_if(
+        children.begin(), children.end(),
+        [c = text[pos]](const auto &child) { return child.first == c; });
+    if (it == children.end()) {
+      break;
+    }
+    node = it->second;
+    if (!trie_[node].entries.empty() && at_command_boundary(text, pos + 1)) {
+      collect(trie_[node].entries);
+    }
+  }
+
+  std::sort(matches.begin() + static_cast<std::ptrdiff_t>(first),
+            matches.end(), [this](uint32_t a, uint32_t b) {
+              return entries_[a].order < entries_[b].order;
+            });
+}
+
+auto MessageFilterIndex::accepts(const Entry &entry,
+                                 const common::MessageEvent &event) const
+    -> bool {
+  const auto &filter = entry.filter;
+  if (!filter.message_type.empty() &&
+      filter.message_type != event.message_type) {
+    return false;
+  }
+  if (!entry.groups.empty() &&
+      (!event.group_id || !entry.groups.contains(event.group_id->view()))) {
+    return false;
+  }
+  if (filter.mention_self && !mentions(event, event.self_id)) {
+    return false;
+  }
+  return !filter.predicate || filter.predicate(event);
+}
+
+} // namespace obcx::core
@@ -57,6 +57,7 @@ void QQBot::run() {
   if (io_context_->stopped()) {
     io_context_->restart();
   }
+  dispatcher_->resume();
   OBCX_INFO("QQBot 开始运行事件循环...");
   io_context_->run();
   OBCX_INFO("QQBot 事件循环已结束。");
@@ -65,7 +66,13 @@ void QQBot::run() {
 void QQBot::stop() {
   OBCX_INFO("正在请求停止 Bot...");
 
-  // 首先断开连接
+  // 先让处理中的事件完成，它们可能还需要连接来发送消息；调用方已经
+  // drain 过时不再等待第二轮
+  if (!dispatcher_->draining()) {
+    drain(kDefaultDrainTimeout);
+  }
+
+  // 然后断开连接
   if (connection_manager_) {
     connection_manager_->disconnect();
   }
@@ -84,8 +91,7 @@ auto QQBot::send_private_message(std::string_view user_id,
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_send_private_message_request(
       user_id, message, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::send_group_message(std::string_view group_id,
@@ -96,8 +102,7 @@ auto QQBot::send_group_message(std::string_view group_id,
   auto payload = get_onebot_adapter().serialize_send_group_message_request(
       group_id, message, echo_id);
 
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 // --- 消息管理 API ---
@@ -107,8 +112,7 @@ auto QQBot::delete_message(std::string_view message_id)
   auto echo_id = generate_echo_id();
   auto payload =
       adapter_->serialize_delete_message_request("", message_id, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_message(std::string_view message_id)
@@ -116,8 +120,7 @@ auto QQBot::get_message(std::string_view message_id)
   auto echo_id = generate_echo_id();
   auto payload =
       get_onebot_adapter().serialize_get_message_request(message_id, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_forward_msg(std::string_view forward_id)
@@ -125,8 +128,7 @@ auto QQBot::get_forward_msg(std::string_view forward_id)
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_get_forward_msg_request(
       forward_id, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 // --- 好友管理 API ---
@@ -135,8 +137,7 @@ auto QQBot::get_friend_list() -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
   auto payload =
       get_onebot_adapter().serialize_get_friend_list_request(echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_stranger_info(std::string_view user_id, bool no_cache)
@@ -144,8 +145,7 @@ auto QQBot::get_stranger_info(std::string_view user_id, bool no_cache)
   auto echo_id = generate_echo_id();
   auto payload =
       adapter_->serialize_get_user_info_request("", user_id, no_cache, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 // --- 群组管理 API ---
@@ -153,8 +153,7 @@ auto QQBot::get_stranger_info(std::string_view user_id, bool no_cache)
 auto QQBot::get_group_list() -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_get_group_list_request(echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_group_info(std::string_view group_id, bool no_cache)
@@ -162,16 +161,14 @@ auto QQBot::get_group_info(std::string_view group_id, bool no_cache)
   auto echo_id = generate_echo_id();
   auto payload =
       adapter_->serialize_get_chat_info_request(group_id, no_cache, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_group_member_list(std::string_view group_id)
     -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
   auto payload = adapter_->serialize_get_chat_admins_request(group_id, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_group_member_info(std::string_view group_id,
@@ -180,8 +177,7 @@ auto QQBot::get_group_member_info(std::string_view group_id,
   auto echo_id = generate_echo_id();
   auto payload = adapter_->serialize_get_chat_member_info_request(
       group_id, user_id, no_cache, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::set_group_kick(std::string_view group_id, std::string_view user_id,
@@ -190,8 +186,7 @@ auto QQBot::set_group_kick(std::string_view group_id, std::string_view user_id,
   auto echo_id = generate_echo_id();
   auto payload = adapter_->serialize_kick_chat_member_request(
       group_id, user_id, reject_add_request, false, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::set_group_ban(std::string_view group_id, std::string_view user_id,
@@ -199,8 +194,7 @@ auto QQBot::set_group_ban(std::string_view group_id, std::string_view user_id,
   auto echo_id = generate_echo_id();
   auto payload = adapter_->serialize_ban_chat_member_request(group_id, user_id,
                                                              duration, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::set_group_whole_ban(std::string_view group_id, bool enable)
@@ -208,8 +202,7 @@ auto QQBot::set_group_whole_ban(std::string_view group_id, bool enable)
   auto echo_id = generate_echo_id();
   auto payload =
       adapter_->serialize_ban_all_members_request(group_id, enable, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::set_group_card(std::string_view group_id, std::string_view user_id,
@@ -218,8 +211,7 @@ auto QQBot::set_group_card(std::string_view group_id, std::string_view user_id,
   auto echo_id = generate_echo_id();
   auto payload =
       adapter_->serialize_set_chat_title_request(group_id, card, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::set_group_leave(std::string_view group_id, bool is_dismiss)
@@ -227,8 +219,7 @@ auto QQBot::set_group_leave(std::string_view group_id, bool is_dismiss)
   auto echo_id = generate_echo_id();
   auto payload =
       adapter_->serialize_leave_chat_request(group_id, is_dismiss, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 // --- 状态获取 API ---
@@ -236,16 +227,14 @@ auto QQBot::set_group_leave(std::string_view group_id, bool is_dismiss)
 auto QQBot::get_login_info() -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
   auto payload = adapter_->serialize_get_self_info_request(echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_status() -> asio::awaitable<std::string> {
   ensure_connection_manager();
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_get_status_request(echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_version_info() -> asio::awaitable<std::string> {
@@ -253,8 +242,7 @@ auto QQBot::get_version_info() -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
   auto payload =
       get_onebot_adapter().serialize_get_version_info_request(echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 // --- 请求处理 API ---
@@ -265,8 +253,7 @@ auto QQBot::set_friend_add_request(std::string_view flag, bool approve,
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_set_friend_add_request(
       flag, approve, remark, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::set_group_add_request(std::string_view flag,
@@ -276,8 +263,7 @@ auto QQBot::set_group_add_request(std::string_view flag,
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_set_group_add_request(
       flag, sub_type, approve, reason, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::generate_echo_id() -> uint64_t {
@@ -294,8 +280,7 @@ auto QQBot::set_group_name(std::string_view group_id,
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_set_group_name_request(
       group_id, group_name, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::set_group_admin(std::string_view group_id, std::string_view user_id,
@@ -304,8 +289,7 @@ auto QQBot::set_group_admin(std::string_view group_id, std::string_view user_id,
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_set_group_admin_request(
       group_id, user_id, enable, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::set_group_anonymous_ban(std::string_view group_id,
@@ -316,8 +300,7 @@ auto QQBot::set_group_anonymous_ban(std::string_view group_id,
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_set_group_anonymous_ban_request(
       group_id, anonymous, duration, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::set_group_anonymous(std::string_view group_id, bool enable)
@@ -326,8 +309,7 @@ auto QQBot::set_group_anonymous(std::string_view group_id, bool enable)
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_set_group_anonymous_request(
       group_id, enable, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::set_group_portrait(std::string_view group_id, std::string_view file,
@@ -336,8 +318,7 @@ auto QQBot::set_group_portrait(std::string_view group_id, std::string_view file,
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_set_group_portrait_request(
       group_id, file, cache, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_group_honor_info(std::string_view group_id,
@@ -347,8 +328,7 @@ auto QQBot::get_group_honor_info(std::string_view group_id,
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_get_group_honor_info_request(
       group_id, type, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 // --- 资源管理 API ---
@@ -358,8 +338,7 @@ auto QQBot::get_image(std::string_view file) -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
   auto payload =
       get_onebot_adapter().serialize_get_image_request(file, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_record(std::string_view file, std::string_view out_format)
@@ -368,8 +347,7 @@ auto QQBot::get_record(std::string_view file, std::string_view out_format)
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_get_record_request(
       file, out_format, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_group_file_url(std::string_view group_id,
@@ -379,8 +357,7 @@ auto QQBot::get_group_file_url(std::string_view group_id,
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_get_group_file_url_request(
       group_id, file_id, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_private_file_url(std::string_view user_id,
@@ -390,8 +367,7 @@ auto QQBot::get_private_file_url(std::string_view user_id,
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_get_private_file_url_request(
       user_id, file_id, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 // --- 能力检查 API ---
@@ -400,8 +376,7 @@ auto QQBot::can_send_image() -> asio::awaitable<std::string> {
   ensure_connection_manager();
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_can_send_image_request(echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::can_send_record() -> asio::awaitable<std::string> {
@@ -409,8 +384,7 @@ auto QQBot::can_send_record() -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
   auto payload =
       get_onebot_adapter().serialize_can_send_record_request(echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 // --- QQ相关接口凭证 API ---
@@ -421,16 +395,14 @@ auto QQBot::get_cookies(std::string_view domain)
   auto echo_id = generate_echo_id();
   auto payload =
       get_onebot_adapter().serialize_get_cookies_request(domain, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_csrf_token() -> asio::awaitable<std::string> {
   ensure_connection_manager();
   auto echo_id = generate_echo_id();
   auto payload = get_onebot_adapter().serialize_get_csrf_token_request(echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::get_credentials(std::string_view domain)
@@ -439,8 +411,7 @@ auto QQBot::get_credentials(std::string_view domain)
   auto echo_id = generate_echo_id();
   auto payload =
       get_onebot_adapter().serialize_get_credentials_request(domain, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto QQBot::is_connected() const -> bool {
@@ -458,7 +429,8 @@ void QQBot::error_notify(std::string_view target_id, std::string_view message,
 
   common::ErrorEvent error_event{.error_type = "message_error",
                                  .error_message = std::string(message),
-                                 .target_id = std::string(target_id),
+                                 .target_id = common::ChatId(
+                                     target_id, common::Platform::qq),
                                  .is_group = is_group,
                                  .time = std::chrono::system_clock::now(),
                                  .context = {{"source", "bot_error_handler"}}};
@@ -0,0 +1,145 @@
+#include "core/send_scheduler.hpp"
+
+#include "common/logger.hpp"
+#include "network/http_client.hpp"
+
+#include <algorithm>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <optional>
+
+namespace obcx::core {
+
+using Clock = common::TokenBucket::Clock;
+
+struct SendScheduler::Waiter {
+  Waiter(std::string chat_id, asio::strand<asio::io_context::executor_type> &ex)
+      : chat_id(std::move(chat_id)), wake(ex, Clock::time_point::max()) {}
+
+  std::string chat_id;
+  // 获得令牌时取消，唤醒等待的协程
+  asio::steady_timer wake;
+  bool granted = false;
+};
+
+SendScheduler::SendScheduler(asio::io_context &io_context, SendLimits limits)
+    : limits_(limits), strand_(asio::make_strand(io_context)),
+      pump_timer_(strand_), global_(limits.global_rate, limits.global_burst),
+      rate_limited_(common::MetricsRegistry::instance().counter(
+          "obcx_send_rate_limited_total",
+          "Outbound sends rejected with 429 and retried")),
+      queue_wait_(common::MetricsRegistry::instance().histogram(
+          "obcx_send_queue_wait_seconds",
+          "Time outbound sends waited for a rate limit token")) {}
+
+auto SendScheduler::submit(std::string chat_id, SendPriority priority,
+                           Request request) -> asio::awaitable<std::string> {
+  for (int attempt = 0;; ++attempt) {
+    {
+      const common::ScopedTimer timer(queue_wait_);
+      co_await asio::co_spawn(strand_, acquire(chat_id, priority),
+                              asio::use_awaitable);
+    }
+
+    std::optional<std::chrono::seconds> retry_after;
+    try {
+      co_return co_await request();
+    } catch (const network::HttpRateLimitError &e) {
+      if (attempt >= limits_.max_rate_limited_retries) {
+        throw;
+      }
+      retry_after = e.retry_after();
+    }
+
+    // 暂停该会话；排在后面的 acquire 也在 strand 上，会看到暂停
+    rate_limited_.inc();
+    OBCX_WARN("发送到 {} 被限流，{} 秒后重发", chat_id, retry_after->count());
+    asio::post(strand_, [this, chat_id, until = Clock::now() + *retry_after] {
+      bucket(chat_id).pause_until(until);
+      pump();
+    });
+  }
+}
+
+auto SendScheduler::acquire(std::string chat_id, SendPriority priority)
+    -> asio::awaitable<void> {
+  auto &lane = lanes_[static_cast<std::size_t>(priority)];
+  auto waiter = std::make_shared<Waiter>(std::move(chat_id), strand_);
+  lane.push_back(waiter);
+  pump();
+  if (waiter->granted) {
+    co_return;
+  }
+
+  boost::system::error_code ec;
+  co_await waiter->wake.async_wait(
+      asio::redirect_error(asio::use_awaitable, ec));
+  if (!waiter->granted) {
+    // 只有 pump() 会取消 wake，没拿到令牌就返回说明调用方取消了发送；
+    // 移出队列，否则 pump() 会把令牌分给没人使用的等待者
+    std::erase(lane, waiter);
+    throw boost::system::system_error(asio::error::operation_aborted);
+  }
+}
+
+void SendScheduler::pump() {
+  const auto now = Clock::now();
+  auto next = Clock::time_point::max();
+  expire_idle_chats(now);
+
+  bool global_ready = true;
+  for (auto &lane : lanes_) {
+    for (auto it = lane.begin(); global_ready && it != lane.end();) {
+      if (const auto wait = global_.wait_time(now);
+          wait > Clock::duration::zero()) {
+        next = std::min(next, now + wait);
+        global_ready = false;
+        break;
+      }
+      // 会话受限时跳过，同优先级后面其他会话的请求照常发送
+      auto &chat = bucket((*it)->chat_id);
+      if (const auto wait = chat.wait_time(now);
+          wait > Clock::duration::zero()) {
+        next = std::min(next, now + wait);
+        ++it;
+        continue;
+      }
+      global_.consume();
+      chat.consume();
+      (*it)->granted = true;
+      (*it)->wake.cancel();
+      it = lane.erase(it);
+    }
+  }
+
+  if (next != Clock::time_point::max()) {
+    pump_timer_.expires_at(next);
+    pump_timer_.async_wait([this](const boost::system::error_code &ec) {
+      if (!ec) {
+        pump();
+      }
+    });
+  }
+}
+
+auto SendScheduler::bucket(const std::string &chat_id)
+    -> common::TokenBucket & {
+  const bool group = !chat_id.empty() && chat_id.front() == '-';
+  return chats_
+      .try_emplace(chat_id, group ? limits_.group_rate : limits_.private_rate,
+                   group ? limits_.group_burst : limits_.private_burst)
+      .first->second;
+}
+
+void SendScheduler::expire_idle_chats(Clock::time_point now) {
+  if (now < next_chat_expiry_) {
+    return;
+  }
+  next_chat_expiry_ = now + kChatExpiryInterval;
+  std::erase_if(chats_,
+                [now](const auto &entry) { return entry.second.idle(now); });
+}
+
+} // namespace obcx::core
@@ -15,9 +15,11 @@
 
 namespace obcx::core {
 
-TGBot::TGBot(adapter::telegram::ProtocolAdapter adapter)
+TGBot::TGBot(adapter::telegram::ProtocolAdapter adapter, SendLimits send_limits)
     : IBot{std::make_unique<adapter::telegram::ProtocolAdapter>(
-          std::move(adapter))} {
+          std::move(adapter))},
+      send_scheduler_{
+          std::make_unique<SendScheduler>(*io_context_, send_limits)} {
   OBCX_INFO("TelegramBot 实例已创建，所有核心组件已初始化。");
 }
 
@@ -70,6 +72,7 @@ void TGBot::run() {
   if (io_context_->stopped()) {
     io_context_->restart();
   }
+  dispatcher_->resume();
 
   // Start long polling for Telegram updates
   asio::co_spawn(
@@ -85,7 +88,13 @@ void TGBot::run() {
 void TGBot::stop() {
   OBCX_INFO("正在请求停止 TelegramBot...");
 
-  // 首先断开连接
+  // 先让处理中的事件完成，它们可能还需要连接来发送消息；调用方已经
+  // drain 过时不再等待第二轮
+  if (!dispatcher_->draining()) {
+    drain(kDefaultDrainTimeout);
+  }
+
+  // 然后断开连接
   if (connection_manager_) {
     connection_manager_->disconnect();
   }
@@ -130,7 +139,8 @@ void TGBot::error_notify(std::string_view target_id, std::string_view message,
                          bool is_group) {
   common::ErrorEvent error_event{.error_type = "message_error",
                                  .error_message = std::string(message),
-                                 .target_id = std::string(target_id),
+                                 .target_id = common::ChatId(
+                                     target_id, common::Platform::telegram),
                                  .is_group = is_group,
                                  .time = std::chrono::system_clock::now(),
                                  .context = {{"source", "bot_error_handler"}}};
@@ -149,35 +159,44 @@ auto TGBot::send_private_message(std::string_view user_id,
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_send_message_request(
       user_id, message, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await send_scheduled(user_id, SendPriority::interactive,
+                                    std::move(payload), echo_id);
 }
 
 auto TGBot::send_group_message(std::string_view group_id,
                                const common::Message &message)
     -> asio::awaitable<std::string> {
+  co_return co_await send_group_message(group_id, message,
+                                        SendPriority::interactive);
+}
+
+auto TGBot::send_group_message(std::string_view group_id,
+                               const common::Message &message,
+                               SendPriority priority)
+    -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_send_message_request(
       group_id, message, echo_id);
 
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await send_scheduled(group_id, priority, std::move(payload),
+                                    echo_id);
 }
 
 auto TGBot::send_topic_message(std::string_view group_id, int64_t topic_id,
-                               const common::Message &message)
+                               const common::Message &message,
+                               SendPriority priority)
     -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_send_topic_message_request(
       group_id, message, echo_id, topic_id);
 
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await send_scheduled(group_id, priority, std::move(payload),
+                                    echo_id);
 }
 
 auto TGBot::send_group_photo(std::string_view group_id,
                              std::string_view photo_data,
-                             std::string_view caption)
+                             std::string_view caption, SendPriority priority)
     -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
 
@@ -192,8 +211,8 @@ auto TGBot::send_group_photo(std::string_view group_id,
   request["echo"] = echo_id;
 
   std::string payload = request.dump();
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await send_scheduled(group_id, priority, std::move(payload),
+                                    echo_id);
 }
 
 // --- 消息管理 API ---
@@ -215,8 +234,7 @@ auto TGBot::delete_message(std::string_view message_id)
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_delete_message_request(
       chat_id, actual_message_id, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::get_message(std::string_view message_id)
@@ -244,8 +262,7 @@ auto TGBot::get_stranger_info(std::string_view user_id, bool no_cache)
   // might need to track the chat context
   auto payload = get_telegram_adapter().serialize_get_user_info_request(
       "", user_id, no_cache, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 // --- 群组管理 API ---
@@ -262,8 +279,7 @@ auto TGBot::get_group_info(std::string_view group_id, bool no_cache)
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_get_chat_info_request(
       group_id, no_cache, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::get_group_member_list(std::string_view group_id)
@@ -271,8 +287,7 @@ auto TGBot::get_group_member_list(std::string_view group_id)
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_get_chat_admins_request(
       group_id, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::get_group_member_info(std::string_view group_id,
@@ -281,8 +296,7 @@ auto TGBot::get_group_member_info(std::string_view group_id,
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_get_chat_member_info_request(
       group_id, user_id, no_cache, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::set_group_kick(std::string_view group_id, std::string_view user_id,
@@ -291,8 +305,7 @@ auto TGBot::set_group_kick(std::string_view group_id, std::string_view user_id,
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_kick_chat_member_request(
       group_id, user_id, reject_add_request, false, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::set_group_ban(std::string_view group_id, std::string_view user_id,
@@ -300,8 +313,7 @@ auto TGBot::set_group_ban(std::string_view group_id, std::string_view user_id,
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_ban_chat_member_request(
       group_id, user_id, duration, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::set_group_whole_ban(std::string_view group_id, bool enable)
@@ -309,8 +321,7 @@ auto TGBot::set_group_whole_ban(std::string_view group_id, bool enable)
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_ban_all_members_request(
       group_id, enable, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::set_group_card(std::string_view group_id, std::string_view user_id,
@@ -327,8 +338,7 @@ auto TGBot::set_group_leave(std::string_view group_id, bool is_dismiss)
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_leave_chat_request(
       group_id, is_dismiss, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::set_group_name(std::string_view group_id,
@@ -337,8 +347,7 @@ auto TGBot::set_group_name(std::string_view group_id,
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_set_chat_title_request(
       group_id, group_name, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::set_group_admin(std::string_view group_id, std::string_view user_id,
@@ -346,8 +355,7 @@ auto TGBot::set_group_admin(std::string_view group_id, std::string_view user_id,
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_set_chat_admin_request(
       group_id, user_id, enable, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::set_group_anonymous_ban(std::string_view group_id,
@@ -371,8 +379,7 @@ auto TGBot::set_group_portrait(std::string_view group_id, std::string_view file,
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_set_chat_photo_request(
       group_id, file, cache, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::get_group_honor_info(std::string_view group_id,
@@ -389,8 +396,7 @@ auto TGBot::get_login_info() -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
   auto payload =
       get_telegram_adapter().serialize_get_self_info_request(echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::get_status() -> asio::awaitable<std::string> {
@@ -411,8 +417,7 @@ auto TGBot::get_image(std::string_view file) -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
   auto payload =
       get_telegram_adapter().serialize_download_file_request(file, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::get_record(std::string_view file, std::string_view out_format)
@@ -420,8 +425,7 @@ auto TGBot::get_record(std::string_view file, std::string_view out_format)
   auto echo_id = generate_echo_id();
   auto payload =
       get_telegram_adapter().serialize_download_file_request(file, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 // --- 能力检查 API ---
@@ -485,8 +489,7 @@ auto TGBot::get_updates(int offset, int limit) -> asio::awaitable<std::string> {
   auto echo_id = generate_echo_id();
   auto payload = get_telegram_adapter().serialize_get_updates_request(
       offset, limit, echo_id);
-  co_return co_await connection_manager_->send_action_and_wait_async(payload,
-                                                                     echo_id);
+  co_return co_await call_api(payload, echo_id);
 }
 
 auto TGBot::get_task_scheduler() -> TaskScheduler & {
@@ -499,6 +502,19 @@ auto TGBot::generate_echo_id() -> uint64_t {
   return counter.fetch_add(1);
 }
 
+auto TGBot::send_scheduled(std::string_view chat_id, SendPriority priority,
+                           std::string payload, uint64_t echo_id)
+    -> asio::awaitable<std::string> {
+  // 先具名再传入：GCC 12 会把 co_await 参数里临时构造的 std::function
+  // 析构两次
+  SendScheduler::Request request = [this, payload = std::move(payload),
+                                    echo_id] {
+    return call_api(payload, echo_id);
+  };
+  co_return co_await send_scheduler_->submit(std::string(chat_id), priority,
+                                             std::move(request));
+}
+
 void TGBot::ensure_connection_manager() const {
   if (!connection_manager_) {
     throw std::runtime_error("Bot未连接，请先调用connect*方法");
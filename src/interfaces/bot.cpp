@@ -1,13 +1,13 @@
 #include "interfaces/bot.hpp"
 
 #include "common/logger.hpp"
+#include "common/tracing.hpp"
 #include "core/event_dispatcher.hpp"
 #include "core/task_scheduler.hpp"
 #include "onebot11/adapter/protocol_adapter.hpp"
 
 #include <boost/asio/io_context.hpp>
 #include <chrono>
-#include <thread>
 
 namespace obcx::core {
 
@@ -19,6 +19,11 @@ IBot::IBot(std::unique_ptr<adapter::BaseProtocolAdapter> adapter)
       connection_manager_{nullptr} {}
 
 IBot::~IBot() {
+  // 若事件循环仍在其他线程运行，先等待处理中的事件；否则立即返回
+  if (dispatcher_) {
+    dispatcher_->drain(kDefaultDrainTimeout);
+  }
+
   // 确保所有组件正确停止和清理
   if (connection_manager_) {
     connection_manager_->disconnect();
@@ -37,10 +42,32 @@ IBot::~IBot() {
   // 停止io_context并清理所有挂起的操作
   if (io_context_) {
     io_context_->stop();
-    // 等待一小段时间让操作完成
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
     io_context_.reset();
   }
 }
 
+auto IBot::call_api(std::string payload, uint64_t echo_id)
+    -> asio::awaitable<std::string> {
+  std::call_once(api_metrics_once_, [this] {
+    auto &registry = common::MetricsRegistry::instance();
+    const common::MetricLabels labels{
+        {"connection", connection_manager_->get_connection_type()}};
+    api_duration_ = &registry.histogram(
+        "obcx_api_call_duration_seconds",
+        "Bot API calls from request to response", labels);
+    api_errors_ = &registry.counter("obcx_api_call_errors_total",
+                                    "Bot API calls that failed", labels);
+  });
+
+  const common::ScopedTimer timer(*api_duration_);
+  const common::Span span("api.call", true);
+  try {
+    co_return co_await connection_manager_->send_action_and_wait_async(
+        std::move(payload), echo_id);
+  } catch (...) {
+    api_errors_->inc();
+    throw;
+  }
+}
+
 } // namespace obcx::core
@@ -23,13 +23,19 @@ void IPlugin::set_bots(std::vector<std::unique_ptr<core::IBot>> *bots,
   bots_ = bots;
   bots_mutex_ = mutex;
 }
+
+auto IPlugin::metrics() -> common::MetricsRegistry & {
+  return common::MetricsRegistry::instance();
+}
+
 std::optional<toml::table> IPlugin::get_config_section(
     const std::string &section_name) const {
-  auto config = common::ConfigLoader::instance().get_plugin_config(get_name());
-  if (!config)
+  const auto snapshot = common::ConfigLoader::instance().snapshot();
+  const auto *plugin = snapshot ? snapshot->plugin(get_name()) : nullptr;
+  if (!plugin)
     return std::nullopt;
 
-  if (auto section = config->config.get(section_name)) {
+  if (auto section = plugin->info.config.get(section_name)) {
     if (auto section_table = section->as_table()) {
       return *section_table;
     }
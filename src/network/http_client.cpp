@@ -44,6 +44,20 @@ HttpClient::HttpClient(asio::io_context &ioc,
 
 HttpClient::~HttpClient() = default;
 
+auto HttpClient::request_metrics(std::string_view method, std::string_view via)
+    -> RequestMetrics {
+  auto &registry = common::MetricsRegistry::instance();
+  const common::MetricLabels labels{{"method", std::string(method)},
+                                    {"via", std::string(via)}};
+  return {.duration = registry.histogram(
+              "obcx_http_request_duration_seconds",
+              "Duration of outgoing HTTP requests, including connect",
+              labels),
+          .errors = registry.counter("obcx_http_request_errors_total",
+                                     "Outgoing HTTP requests that failed",
+                                     labels)};
+}
+
 template <typename RequestType>
 void HttpClient::prepare_request(
     RequestType &request, const std::map<std::string, std::string> &headers) {
@@ -190,6 +204,9 @@ auto HttpClient::post_sync(std::string_view path, std::string_view body,
     -> HttpResponse {
   OBCX_DEBUG("POST {} with body: {}", path, body);
 
+  static const auto metrics = request_metrics("POST", "direct");
+  const common::ScopedTimer timer(metrics.duration);
+
   try {
     // 创建请求
     http::request<http::string_body> req{http::verb::post, path, 11};
@@ -265,6 +282,7 @@ auto HttpClient::post_sync(std::string_view path, std::string_view body,
 
     return response;
   } catch (const std::exception &e) {
+    metrics.errors.inc();
     OBCX_ERROR("HTTP POST request failed: {}", e.what());
     throw HttpClientError(std::string("HTTP POST request failed: ") + e.what());
   }
@@ -275,6 +293,9 @@ auto HttpClient::get_sync(std::string_view path,
     -> HttpResponse {
   OBCX_DEBUG("GET {}", path);
 
+  static const auto metrics = request_metrics("GET", "direct");
+  const common::ScopedTimer timer(metrics.duration);
+
   try {
     // 创建请求
     http::request<http::string_body> req{http::verb::get, path, 11};
@@ -347,6 +368,7 @@ auto HttpClient::get_sync(std::string_view path,
 
     return response;
   } catch (const std::exception &e) {
+    metrics.errors.inc();
     OBCX_ERROR("HTTP GET request failed: {}", e.what());
     throw HttpClientError(std::string("HTTP GET request failed: ") + e.what());
   }
@@ -355,6 +377,9 @@ auto HttpClient::get_sync(std::string_view path,
 auto HttpClient::head_sync(std::string_view path,
                            const std::map<std::string, std::string> &headers)
     -> HttpResponse {
+  static const auto metrics = request_metrics("HEAD", "direct");
+  const common::ScopedTimer timer(metrics.duration);
+
   try {
     // 创建请求
     http::request<http::string_body> req{http::verb::head, path, 11};
@@ -440,6 +465,7 @@ auto HttpClient::head_sync(std::string_view path,
 
     return response;
   } catch (const std::exception &e) {
+    metrics.errors.inc();
     OBCX_ERROR("HTTP HEAD request failed: {}", e.what());
     throw HttpClientError(std::string("HTTP HEAD request failed: ") + e.what());
   }
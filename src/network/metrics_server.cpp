@@ -0,0 +1,104 @@
+#include "network/metrics_server.hpp"
+#include "common/logger.hpp"
+#include "common/tracing.hpp"
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include <utility>
+
+namespace obcx::network {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+using tcp = asio::ip::tcp;
+
+MetricsServer::MetricsServer(std::string host, uint16_t port,
+                             common::MetricsRegistry &registry)
+    : host_(std::move(host)), port_(port), registry_(registry),
+      acceptor_(ioc_) {}
+
+MetricsServer::~MetricsServer() { stop(); }
+
+void MetricsServer::start() {
+  if (thread_.joinable()) {
+    return;
+  }
+  const tcp::endpoint endpoint(asio::ip::make_address(host_), port_);
+  acceptor_.open(endpoint.protocol());
+  acceptor_.set_option(tcp::acceptor::reuse_address(true));
+  acceptor_.bind(endpoint);
+  acceptor_.listen();
+  bound_port_ = acceptor_.local_endpoint().port();
+
+  asio::co_spawn(ioc_, accept_loop(), asio::detached);
+  thread_ = std::thread([this] { ioc_.run(); });
+  OBCX_INFO("指标服务已启动: http://{}:{}/metrics", host_, bound_port_);
+}
+
+void MetricsServer::stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  ioc_.stop();
+  thread_.join();
+  boost::system::error_code ec;
+  acceptor_.close(ec);
+  OBCX_INFO("指标服务已停止");
+}
+
+auto MetricsServer::accept_loop() -> asio::awaitable<void> {
+  while (acceptor_.is_open()) {
+    boost::system::error_code ec;
+    auto socket = co_await acceptor_.async_accept(
+        asio::redirect_error(asio::use_awaitable, ec));
+    if (ec) {
+      if (ec == asio::error::operation_aborted) {
+        co_return;
+      }
+      OBCX_WARN("指标服务接受连接失败: {}", ec.message());
+      continue;
+    }
+    asio::co_spawn(ioc_, serve(std::move(socket)), asio::detached);
+  }
+}
+
+auto MetricsServer::serve(tcp::socket socket) -> asio::awaitable<void> {
+  boost::system::error_code ec;
+  beast::flat_buffer buffer;
+  http::request<http::empty_body> request;
+  co_await http::async_read(socket, buffer, request,
+                            asio::redirect_error(asio::use_awaitable, ec));
+  if (ec) {
+    co_return;
+  }
+
+  http::response<http::string_body> response;
+  response.version(request.version());
+  response.set(http::field::server, BOOST_BEAST_VERSION_STRING);
+  response.keep_alive(false);
+  const auto target = request.target();
+  if (request.method() != http::verb::get) {
+    response.result(http::status::method_not_allowed);
+  } else if (target == "/metrics" || target.starts_with("/metrics?")) {
+    response.result(http::status::ok);
+    response.set(http::field::content_type,
+                 "text/plain; version=0.0.4; charset=utf-8");
+    response.body() = registry_.render_prometheus();
+  } else if (target == "/trace") {
+    response.result(http::status::ok);
+    response.set(http::field::content_type, "application/json");
+    response.body() = common::Tracer::instance().export_chrome_json();
+  } else {
+    response.result(http::status::not_found);
+  }
+  response.prepare_payload();
+
+  co_await http::async_write(socket, response,
+                             asio::redirect_error(asio::use_awaitable, ec));
+  socket.shutdown(tcp::socket::shutdown_send, ec);
+}
+
+} // namespace obcx::network
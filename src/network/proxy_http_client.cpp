@@ -31,6 +31,9 @@ HttpResponse ProxyHttpClient::post_sync(
     std::string_view path, std::string_view body,
     const std::map<std::string, std::string> &headers) {
 
+  static const auto metrics = request_metrics("POST", "proxy");
+  const common::ScopedTimer timer(metrics.duration);
+
   try {
     // 建立代理隧道
     auto tunnel_socket = connect_through_proxy();
@@ -39,6 +42,7 @@ HttpResponse ProxyHttpClient::post_sync(
     return send_http_request(tunnel_socket, "POST", std::string(path),
                              std::string(body), headers);
   } catch (const std::exception &e) {
+    metrics.errors.inc();
     OBCX_ERROR("ProxyHttpClient POST请求失败: {}", e.what());
     HttpResponse error_response;
     error_response.status_code = 0;
@@ -50,6 +54,9 @@ HttpResponse ProxyHttpClient::post_sync(
 HttpResponse ProxyHttpClient::get_sync(
     std::string_view path, const std::map<std::string, std::string> &headers) {
 
+  static const auto metrics = request_metrics("GET", "proxy");
+  const common::ScopedTimer timer(metrics.duration);
+
   try {
     // 建立代理隧道
     auto tunnel_socket = connect_through_proxy();
@@ -58,6 +65,7 @@ HttpResponse ProxyHttpClient::get_sync(
     return send_http_request(tunnel_socket, "GET", std::string(path), "",
                              headers);
   } catch (const std::exception &e) {
+    metrics.errors.inc();
     OBCX_ERROR("ProxyHttpClient GET请求失败: {}", e.what());
     HttpResponse error_response;
     error_response.status_code = 0;
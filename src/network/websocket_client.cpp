@@ -1,5 +1,6 @@
 #include "network/websocket_client.hpp"
 #include "common/logger.hpp"
+#include "common/tracing.hpp"
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/detached.hpp>
 #include <boost/asio/error.hpp>
@@ -103,17 +104,22 @@ auto WebsocketClient::run(std::string host, std::string port,
      * 4. Loop to read messages
      * \endif
      */
+    auto &tracer = common::Tracer::instance();
     while (ws_.is_open()) {
       buffer_.clear();
       co_await ws_.async_read(buffer_, asio::use_awaitable);
       /*
        * \if CHINESE
-       * 将收到的消息传递给上层处理器
+       * 将收到的消息传递给上层处理器；每一帧是一条独立的追踪，
+       * 解析与分发在同一调用栈内完成
        * \endif
        * \if ENGLISH
-       * Pass received messages to upper layer handler
+       * Pass received messages to upper layer handler; every frame starts
+       * its own trace, parsed and dispatched within this call
        * \endif
        */
+      const common::TraceScope trace(tracer.new_trace());
+      const common::Span span("ws.frame");
       on_message_({}, beast::buffers_to_string(buffer_.data()));
     }
   } catch (const beast::system_error &se) {
@@ -1,72 +1,775 @@
 #include "onebot11/adapter/event_converter.hpp"
+#include "common/json_backend.hpp"
 #include "common/json_utils.hpp"
 #include "common/logger.hpp"
 #include "onebot11/adapter/message_converter.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+#ifdef OBCX_JSON_SIMDJSON
+#include <simdjson.h>
+#endif
+
 using json = nlohmann::json;
 
 namespace obcx::adapter::onebot11 {
 
-auto EventConverter::from_v11_json(std::string_view json_str)
+namespace {
+
+/**
+ * @brief 编译期构造的完美哈希表
+ *
+ * 只取长度与首尾字符做哈希，构造时搜索一个使所有键互不冲突的种子；
+ * 查找时一次取模定位槽位，再做一次完整比较确认，未知键直接落空。
+ */
+template <std::size_t N> class PerfectHash {
+public:
+  static constexpr std::size_t npos = N;
+
+  consteval explicit PerfectHash(std::array<std::string_view, N> keys)
+      : keys_(keys) {
+    for (; seed_ < 4096; ++seed_) {
+      if (try_seed()) {
+        return;
+      }
+    }
+    throw "PerfectHash: no collision-free seed";
+  }
+
+  [[nodiscard]] constexpr auto find(std::string_view key) const noexcept
+      -> std::size_t {
+    if (key.empty()) {
+      return npos;
+    }
+    auto index = slots_[slot(seed_, key)];
+    return index != npos && keys_[index] == key ? index : npos;
+  }
+
+private:
+  static constexpr std::size_t kSlots = std::bit_ceil(N * 2);
+
+  static constexpr auto slot(uint32_t seed, std::string_view key) noexcept
+      -> std::size_t {
+    uint32_t h = static_cast<uint32_t>(key.size()) * 0x9e3779b1U;
+    h ^= static_cast<uint8_t>(key.front()) * seed;
+    h ^= static_cast<uint8_t>(key.back()) * (seed * 0x85ebca6bU + 1);
+    return (h ^ (h >> 15)) & (kSlots - 1);
+  }
+
+  consteval auto try_seed() -> bool {
+    slots_.fill(npos);
+    for (std::size_t i = 0; i < N; ++i) {
+      auto &entry = slots_[slot(seed_, keys_[i])];
+      if (entry != npos) {
+        return false;
+      }
+      entry = i;
+    }
+    return true;
+  }
+
+  std::array<std::string_view, N> keys_;
+  std::array<std::size_t, kSlots> slots_{};
+  uint32_t seed_ = 1;
+};
+
+// 枚举值即为哈希表中的下标，未知类型为 npos
+enum class PostType : uint8_t { message, notice, request, meta_event, unknown };
+constexpr PerfectHash<4> kPostTypes(
+    {"message", "notice", "request", "meta_event"});
+
+enum class MetaEventType : uint8_t { heartbeat, lifecycle, unknown };
+constexpr PerfectHash<2> kMetaEventTypes({"heartbeat", "lifecycle"});
+
+constexpr auto classify_post_type(std::string_view name) noexcept
+    -> PostType {
+  return static_cast<PostType>(kPostTypes.find(name));
+}
+
+constexpr auto classify_meta_event_type(std::string_view name) noexcept
+    -> MetaEventType {
+  return static_cast<MetaEventType>(kMetaEventTypes.find(name));
+}
+
+// 各 post_type 下用于区分子类型的字段
+constexpr std::array<std::string_view, 4> kSubtypeFields = {
+    "message_type", "notice_type", "request_type", "meta_event_type"};
+
+struct StringHash {
+  using is_transparent = void;
+  auto operator()(std::string_view s) const noexcept -> std::size_t {
+    return std::hash<std::string_view>{}(s);
+  }
+};
+
+/**
+ * @brief 查找到的扩展转换函数，持有期间计入所属者的使用数
+ *
+ * 析构时先释放转换函数再减少计数，wait_idle() 返回后不会再运行插件的代码。
+ */
+class ConverterLease {
+public:
+  ConverterLease() = default;
+  ConverterLease(std::shared_ptr<const EventConverter::Converter> converter,
+                 core::HandlerOwner owner)
+      : converter_(std::move(converter)), owner_(owner) {}
+  ~ConverterLease();
+
+  ConverterLease(ConverterLease &&other) noexcept
+      : converter_(std::move(other.converter_)), owner_(other.owner_) {}
+  ConverterLease(const ConverterLease &) = delete;
+  auto operator=(const ConverterLease &) -> ConverterLease & = delete;
+  auto operator=(ConverterLease &&) -> ConverterLease & = delete;
+
+  explicit operator bool() const noexcept { return converter_ != nullptr; }
+  auto operator*() const -> const EventConverter::Converter & {
+    return *converter_;
+  }
+
+private:
+  std::shared_ptr<const EventConverter::Converter> converter_;
+  core::HandlerOwner owner_ = 0;
+};
+
+/**
+ * @brief 插件注册的扩展转换函数
+ *
+ * 注册只发生在插件加载/卸载时，查找在每个事件上发生。另外维护一个按
+ * post_type 划分的原子位图，事件的 post_type 下没有任何注册时只需读取
+ * 一次位图即可跳过，不必获取读锁；例如只注册了 notice.group_recall 时，
+ * 消息事件不会碰到锁。
+ *
+ * 转换函数记录注册时的 HandlerOwner。查找在读锁内计入所属者的使用数，
+ * 热重载注销插件的转换函数后据此等待正在运行的调用结束，再卸载插件。
+ */
+class ConverterRegistry {
+public:
+  void add(std::string_view key, EventConverter::Converter converter) {
+    auto entry = Entry{
+        .converter = std::make_shared<const EventConverter::Converter>(
+            std::move(converter)),
+        .owner = core::HandlerOwnerScope::current()};
+    std::unique_lock lock(mutex_);
+    converters_.insert_or_assign(std::string(key), std::move(entry));
+    update_post_types();
+  }
+
+  auto remove(std::string_view key) -> bool {
+    std::unique_lock lock(mutex_);
+    auto it = converters_.find(key);
+    if (it == converters_.end()) {
+      return false;
+    }
+    converters_.erase(it);
+    update_post_types();
+    return true;
+  }
+
+  auto remove_owner(core::HandlerOwner owner) -> std::size_t {
+    std::unique_lock lock(mutex_);
+    const auto removed = std::erase_if(converters_, [owner](const auto &entry) {
+      return entry.second.owner == owner;
+    });
+    update_post_types();
+    return removed;
+  }
+
+  auto wait_idle(core::HandlerOwner owner, std::chrono::milliseconds timeout)
+      -> bool {
+    std::unique_lock lock(use_mutex_);
+    return idle_.wait_for(lock, timeout,
+                          [this, owner] { return !in_use_.contains(owner); });
+  }
+
+  void release(core::HandlerOwner owner) {
+    std::lock_guard lock(use_mutex_);
+    if (const auto it = in_use_.find(owner);
+        it != in_use_.end() && --it->second == 0) {
+      in_use_.erase(it);
+    }
+    idle_.notify_all();
+  }
+
+  auto find(std::string_view post_type, std::string_view subtype)
+      -> ConverterLease {
+    if ((post_types_.load(std::memory_order_acquire) &
+         post_type_bit(post_type)) == 0) {
+      return {};
+    }
+
+    std::shared_lock lock(mutex_);
+    if (!subtype.empty()) {
+      // 键一般很短，在栈上拼接 "post_type.subtype"
+      std::array<char, 64> buffer{};
+      std::string fallback;
+      std::string_view key;
+      if (post_type.size() + 1 + subtype.size() <= buffer.size()) {
+        char *end = std::copy(post_type.begin(), post_type.end(),
+                              buffer.data());
+        *end++ = '.';
+        end = std::copy(subtype.begin(), subtype.end(), end);
+        key = std::string_view(buffer.data(), end - buffer.data());
+      } else {
+        fallback = std::string(post_type) + '.' + std::string(subtype);
+        key = fallback;
+      }
+      if (auto it = converters_.find(key); it != converters_.end()) {
+        return lease(it->second);
+      }
+    }
+    if (auto it = converters_.find(post_type); it != converters_.end()) {
+      return lease(it->second);
+    }
+    return {};
+  }
+
+private:
+  struct Entry {
+    std::shared_ptr<const EventConverter::Converter> converter;
+    core::HandlerOwner owner = 0;
+  };
+
+  // 持有读锁时调用：注销并等待的一方取得写锁后，已查找到的调用都已计数
+  auto lease(const Entry &entry) -> ConverterLease {
+    {
+      std::lock_guard lock(use_mutex_);
+      ++in_use_[entry.owner];
+    }
+    return {entry.converter, entry.owner};
+  }
+
+  // 未知的 post_type 共用 PostType::unknown 对应的位
+  static auto post_type_bit(std::string_view post_type) -> uint32_t {
+    return 1U << static_cast<unsigned>(classify_post_type(post_type));
+  }
+
+  // 持有写锁时调用
+  void update_post_types() {
+    uint32_t bits = 0;
+    for (const auto &[key, converter] : converters_) {
+      bits |= post_type_bit(std::string_view(key).substr(0, key.find('.')));
+    }
+    post_types_.store(bits, std::memory_order_release);
+  }
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, Entry, StringHash, std::equal_to<>>
+      converters_;
+  std::atomic<uint32_t> post_types_{0};
+
+  // 各所属者正在运行的转换调用数，没有调用的所属者不在表中
+  std::mutex use_mutex_;
+  std::condition_variable idle_;
+  std::unordered_map<core::HandlerOwner, std::size_t> in_use_;
+};
+
+auto registry() -> ConverterRegistry & {
+  static ConverterRegistry instance;
+  return instance;
+}
+
+ConverterLease::~ConverterLease() {
+  if (converter_) {
+    converter_.reset();
+    registry().release(owner_);
+  }
+}
+
+// 扩展转换函数的输入是 nlohmann::json，异常与内置转换一样只记录并丢弃
+auto run_extension(const EventConverter::Converter &converter,
+                   const json &j, std::string_view json_str)
     -> std::optional<common::Event> {
-  auto j_opt = common::JsonUtils::parse(std::string(json_str));
-  if (!j_opt) {
-    OBCX_WARN("EventConverter: 无法解析JSON: {}", json_str);
+  try {
+    return converter(j);
+  } catch (const std::exception &e) {
+    OBCX_ERROR("EventConverter: 扩展事件转换失败: {}. JSON: {}", e.what(),
+               json_str);
+    return std::nullopt;
+  }
+}
+
+#ifdef OBCX_JSON_SIMDJSON
+namespace ondemand = simdjson::ondemand;
+
+constexpr common::Platform kPlatform = common::Platform::qq;
+
+// On-Demand 的值只能向前消费一次，需要保留的子树立即拷贝为 nlohmann::json
+auto to_nlohmann(ondemand::value value) -> json {
+  switch (value.type()) {
+  case ondemand::json_type::object: {
+    auto result = json::object();
+    for (ondemand::field field : value.get_object()) {
+      std::string_view key = field.unescaped_key();
+      result.emplace(key, to_nlohmann(field.value()));
+    }
+    return result;
+  }
+  case ondemand::json_type::array: {
+    auto result = json::array();
+    for (ondemand::value element : value.get_array()) {
+      result.push_back(to_nlohmann(element));
+    }
+    return result;
+  }
+  case ondemand::json_type::number:
+    switch (value.get_number_type()) {
+    case ondemand::number_type::signed_integer:
+      return int64_t(value.get_int64());
+    case ondemand::number_type::unsigned_integer:
+      return uint64_t(value.get_uint64());
+    default:
+      return double(value.get_double());
+    }
+  case ondemand::json_type::string:
+    return std::string_view(value.get_string());
+  case ondemand::json_type::boolean:
+    return bool(value.get_bool());
+  default:
+    return nullptr;
+  }
+}
+
+// 类型不符时保持默认值，与 JsonUtils::get_value 的语义一致
+void read_string(ondemand::value value, std::string_view &out) {
+  std::string_view text;
+  if (!value.get_string().get(text)) {
+    out = text;
+  }
+}
+
+template <typename T> void read_number(ondemand::value value, T &out) {
+  T number{};
+  if (!value.get(number)) {
+    out = number;
+  }
+}
+
+void read_id(ondemand::value value, std::optional<common::Id> &out) {
+  ondemand::json_type type;
+  if (value.type().get(type)) {
+    return;
+  }
+  if (type == ondemand::json_type::string) {
+    out = common::Id(std::string_view(value.get_string()), kPlatform);
+  } else if (type == ondemand::json_type::number) {
+    int64_t number = 0;
+    uint64_t unsigned_number = 0;
+    if (!value.get_int64().get(number)) {
+      out = common::Id(number, kPlatform);
+    } else if (!value.get_uint64().get(unsigned_number)) {
+      out = common::Id::from_unsigned(unsigned_number, kPlatform);
+    } else {
+      out = common::Id(static_cast<int64_t>(double(value.get_double())),
+                       kPlatform);
+    }
+  }
+}
+
+/**
+ * @brief OneBot v11 事件的字段暂存区
+ *
+ * 字段顺序不固定，post_type 可能出现在任意位置，所以先单遍扫描收集所有
+ * 已知字段，最后再按 post_type 组装具体事件。字符串只是指向解析器缓冲区
+ * 的视图，message/status 只记录原始JSON片段，扫描阶段不分配内存，
+ * 未知事件在组装前即被丢弃。
+ */
+struct V11Fields {
+  double time = 0;
+  std::optional<common::Id> self_id;
+  std::string_view post_type;
+  std::string_view message_type;
+  std::string_view sub_type;
+  std::optional<common::Id> message_id;
+  std::optional<common::Id> user_id;
+  std::optional<common::Id> group_id;
+  std::optional<common::Id> guild_id;
+  std::optional<common::Id> channel_id;
+  std::string_view message;
+  std::string_view raw_message;
+  int64_t font = 0;
+  std::optional<std::string_view> anonymous;
+  std::string_view notice_type;
+  std::string_view request_type;
+  std::string_view comment;
+  std::string_view flag;
+  std::string_view meta_event_type;
+  std::string_view status;
+  int64_t interval = 0;
+  // 输入缓冲区的末尾（含填充），用于原地解析 message/status 片段
+  const char *buffer_end = nullptr;
+
+  [[nodiscard]] auto subtype(PostType type) const -> std::string_view {
+    switch (type) {
+    case PostType::message:
+      return message_type;
+    case PostType::notice:
+      return notice_type;
+    case PostType::request:
+      return request_type;
+    case PostType::meta_event:
+      return meta_event_type;
+    default:
+      return {};
+    }
+  }
+};
+
+void read_field(std::string_view key, ondemand::value value, V11Fields &f) {
+  if (key == "time") {
+    read_number(value, f.time);
+  } else if (key == "self_id") {
+    read_id(value, f.self_id);
+  } else if (key == "post_type") {
+    read_string(value, f.post_type);
+  } else if (key == "message_type") {
+    read_string(value, f.message_type);
+  } else if (key == "sub_type") {
+    read_string(value, f.sub_type);
+  } else if (key == "message_id") {
+    read_id(value, f.message_id);
+  } else if (key == "user_id") {
+    read_id(value, f.user_id);
+  } else if (key == "group_id") {
+    read_id(value, f.group_id);
+  } else if (key == "guild_id") {
+    read_id(value, f.guild_id);
+  } else if (key == "channel_id") {
+    read_id(value, f.channel_id);
+  } else if (key == "message") {
+    if (value.type() != ondemand::json_type::array) {
+      throw simdjson::simdjson_error(simdjson::INCORRECT_TYPE);
+    }
+    f.message = value.raw_json();
+  } else if (key == "raw_message") {
+    read_string(value, f.raw_message);
+  } else if (key == "font") {
+    read_number(value, f.font);
+  } else if (key == "anonymous") {
+    std::string_view text;
+    if (!value.get_string().get(text)) {
+      f.anonymous = text;
+    }
+  } else if (key == "notice_type") {
+    read_string(value, f.notice_type);
+  } else if (key == "request_type") {
+    read_string(value, f.request_type);
+  } else if (key == "comment") {
+    read_string(value, f.comment);
+  } else if (key == "flag") {
+    read_string(value, f.flag);
+  } else if (key == "meta_event_type") {
+    read_string(value, f.meta_event_type);
+  } else if (key == "status") {
+    if (value.type() == ondemand::json_type::object) {
+      f.status = value.raw_json();
+    }
+  } else if (key == "interval") {
+    read_number(value, f.interval);
+  }
+}
+
+// 对扫描阶段记录的原始片段做二次解析。片段位于带填充的输入缓冲区内，
+// 可以原地解析；使用独立的解析器，避免覆盖第一次解析的字符串缓冲区。
+auto iterate_fragment(std::string_view fragment, const char *buffer_end)
+    -> ondemand::document {
+  thread_local ondemand::parser parser;
+  return parser.iterate(simdjson::padded_string_view(
+      fragment.data(), fragment.size(),
+      static_cast<std::size_t>(buffer_end - fragment.data())));
+}
+
+auto read_message(const V11Fields &f) -> common::Message {
+  common::Message message;
+  if (f.message.empty()) {
+    return message;
+  }
+  auto doc = iterate_fragment(f.message, f.buffer_end);
+  for (ondemand::value element : doc.get_array()) {
+    common::MessageSegment segment;
+    for (ondemand::field field : element.get_object()) {
+      std::string_view key = field.unescaped_key();
+      if (key == "type") {
+        std::string_view type;
+        read_string(field.value(), type);
+        segment.type = type;
+      } else if (key == "data") {
+        segment.data = to_nlohmann(field.value());
+      }
+    }
+    message.push_back(std::move(segment));
+  }
+  return message;
+}
+
+auto read_status(const V11Fields &f) -> json {
+  if (f.status.empty()) {
+    return json::object();
+  }
+  auto doc = iterate_fragment(f.status, f.buffer_end);
+  return to_nlohmann(doc.get_value());
+}
+
+void fill_base(const V11Fields &f, common::BaseEvent &event) {
+  event.time = std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::duration<double>(f.time)));
+  event.self_id = f.self_id.value_or(common::Id{});
+  event.post_type = f.post_type;
+}
+
+auto build_message(const V11Fields &f) -> std::optional<common::Event> {
+  common::MessageEvent event;
+  fill_base(f, event);
+  event.message_type = f.message_type;
+  event.sub_type = f.sub_type;
+  event.message_id = f.message_id.value_or(common::Id{});
+  event.user_id = f.user_id.value_or(common::Id{});
+  event.message = read_message(f);
+  event.raw_message = MessageConverter::cq_unescape(std::string(f.raw_message));
+  event.font = static_cast<int32_t>(f.font);
+  event.group_id = f.group_id;
+  if (f.anonymous) {
+    event.anonymous = std::string(*f.anonymous);
+  }
+  event.guild_id = f.guild_id;
+  event.channel_id = f.channel_id;
+  return event;
+}
+
+auto build_notice(const V11Fields &f) -> std::optional<common::Event> {
+  common::NoticeEvent event;
+  fill_base(f, event);
+  event.notice_type = f.notice_type;
+  event.user_id = f.user_id.value_or(common::Id{});
+  event.group_id = f.group_id;
+  return event;
+}
+
+auto build_request(const V11Fields &f) -> std::optional<common::Event> {
+  common::RequestEvent event;
+  fill_base(f, event);
+  event.request_type = f.request_type;
+  event.user_id = f.user_id.value_or(common::Id{});
+  event.comment = f.comment;
+  event.flag = f.flag;
+  return event;
+}
+
+auto build_meta_event(const V11Fields &f) -> std::optional<common::Event> {
+  if (classify_meta_event_type(f.meta_event_type) ==
+      MetaEventType::heartbeat) {
+    common::HeartbeatEvent event;
+    fill_base(f, event);
+    event.meta_event_type = f.meta_event_type;
+    event.sub_type = f.sub_type;
+    event.status = read_status(f);
+    event.interval = f.interval;
+    OBCX_DEBUG("EventConverter: 接收到心跳事件，间隔: {}ms", event.interval);
+    return event;
+  }
+  common::MetaEvent event;
+  fill_base(f, event);
+  event.meta_event_type = f.meta_event_type;
+  event.sub_type = f.sub_type;
+  return event;
+}
+
+using Builder = auto (*)(const V11Fields &) -> std::optional<common::Event>;
+constexpr std::array<Builder, 4> kBuilders = {build_message, build_notice,
+                                              build_request, build_meta_event};
+
+auto from_v11_ondemand(std::string_view json_str)
+    -> std::optional<common::Event> {
+  // On-Demand 要求输入尾部带填充，缓冲区与解析器均按线程复用
+  thread_local ondemand::parser parser;
+  thread_local std::string buffer;
+  buffer.assign(json_str);
+  buffer.reserve(json_str.size() + simdjson::SIMDJSON_PADDING);
+
+  try {
+    V11Fields fields;
+    fields.buffer_end = buffer.data() + buffer.capacity();
+    auto doc = parser.iterate(simdjson::padded_string_view(
+        buffer.data(), buffer.size(), buffer.capacity()));
+    for (ondemand::field field : doc.get_object()) {
+      std::string_view key = field.unescaped_key();
+      read_field(key, field.value(), fields);
+    }
+
+    if (fields.post_type.empty()) {
+      return std::nullopt;
+    }
+    auto type = classify_post_type(fields.post_type);
+    if (auto converter =
+            registry().find(fields.post_type, fields.subtype(type))) {
+      auto j = common::JsonBackend::parse(json_str);
+      return j ? run_extension(*converter, *j, json_str) : std::nullopt;
+    }
+    if (type == PostType::unknown) {
+      OBCX_DEBUG("EventConverter: 未知的 post_type '{}'", fields.post_type);
+      return std::nullopt;
+    }
+    return kBuilders[static_cast<std::size_t>(type)](fields);
+  } catch (const simdjson::simdjson_error &e) {
+    OBCX_WARN("EventConverter: 无法解析JSON: {} ({})", json_str, e.what());
     return std::nullopt;
   }
-  const auto &j = j_opt.value();
+}
+#else
+/**
+ * @brief 不构造 DOM，直接从原始文本中读出顶层的 post_type
+ *
+ * 只跟踪括号深度与字符串边界。返回空视图表示顶层对象没有字符串类型的
+ * post_type；遇到转义、非对象或格式错误时返回 std::nullopt，交给完整
+ * 解析处理。
+ */
+auto peek_post_type(std::string_view s) -> std::optional<std::string_view> {
+  auto raw = common::JsonBackend::peek_field(s, "post_type");
+  if (!raw || raw->empty() || raw->front() != '"') {
+    return raw ? std::optional(std::string_view{}) : std::nullopt;
+  }
+  auto value = raw->substr(1, raw->size() - 2);
+  if (value.find('\\') != std::string_view::npos) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+auto string_field(const json &j, std::string_view key) -> std::string_view {
+  auto it = j.find(key);
+  if (it == j.end() || !it->is_string()) {
+    return {};
+  }
+  return it->get_ref<const std::string &>();
+}
+
+auto build_message(const json &j) -> std::optional<common::Event> {
+  common::MessageEvent event;
+  event.from_json(j); // 这里会自动从JSON中解析 message 数组和其他字段
+
+  // 只需要对 raw_message 进行CQ码反转义处理
+  event.raw_message =
+      MessageConverter::cq_unescape(std::move(event.raw_message));
+  return event;
+}
+
+auto build_notice(const json &j) -> std::optional<common::Event> {
+  common::NoticeEvent event;
+  event.from_json(j);
+  return event;
+}
+
+auto build_request(const json &j) -> std::optional<common::Event> {
+  common::RequestEvent event;
+  event.from_json(j);
+  return event;
+}
+
+auto build_meta_event(const json &j) -> std::optional<common::Event> {
+  if (classify_meta_event_type(string_field(j, "meta_event_type")) ==
+      MetaEventType::heartbeat) {
+    common::HeartbeatEvent event;
+    event.from_json(j);
+    OBCX_DEBUG("EventConverter: 接收到心跳事件，间隔: {}ms", event.interval);
+    return event;
+  }
+  common::MetaEvent event;
+  event.from_json(j);
+  return event;
+}
 
-  auto post_type = common::JsonUtils::get_value<std::string>(j, "post_type");
+using Builder = auto (*)(const json &) -> std::optional<common::Event>;
+constexpr std::array<Builder, 4> kBuilders = {build_message, build_notice,
+                                              build_request, build_meta_event};
+
+auto from_v11_object(const json &j, std::string_view json_str)
+    -> std::optional<common::Event> {
+  auto post_type = string_field(j, "post_type");
   if (post_type.empty()) {
     return std::nullopt;
   }
 
+  auto type = classify_post_type(post_type);
+  auto subtype = type == PostType::unknown
+                     ? std::string_view{}
+                     : string_field(j, kSubtypeFields[static_cast<int>(type)]);
+  if (auto converter = registry().find(post_type, subtype)) {
+    return run_extension(*converter, j, json_str);
+  }
+  if (type == PostType::unknown) {
+    OBCX_DEBUG("EventConverter: 未知的 post_type '{}'", post_type);
+    return std::nullopt;
+  }
+
   try {
-    if (post_type == "message") {
-      common::MessageEvent event;
-      event.from_json(j); // 这里会自动从JSON中解析 message 数组和其他字段
-
-      // 只需要对 raw_message 进行CQ码反转义处理
-      auto raw_message_escaped =
-          common::JsonUtils::get_value<std::string>(j, "raw_message");
-      event.raw_message = MessageConverter::cq_unescape(raw_message_escaped);
-
-      return event;
-    }
-    if (post_type == "notice") {
-      common::NoticeEvent event;
-      event.from_json(j);
-      return event;
-    }
-    if (post_type == "request") {
-      common::RequestEvent event;
-      event.from_json(j);
-      return event;
-    }
-    if (post_type == "meta_event") {
-      auto meta_event_type =
-          common::JsonUtils::get_value<std::string>(j, "meta_event_type");
-
-      if (meta_event_type == "heartbeat") {
-        common::HeartbeatEvent event;
-        event.from_json(j);
-        OBCX_DEBUG("EventConverter: 接收到心跳事件，间隔: {}ms",
-                   event.interval);
-        return event;
-      } else {
-        common::MetaEvent event;
-        event.from_json(j);
-        return event;
-      }
-    }
+    return kBuilders[static_cast<std::size_t>(type)](j);
   } catch (const nlohmann::json::exception &e) {
     OBCX_ERROR("EventConverter: 创建事件对象时发生JSON异常: {}. JSON: {}",
                e.what(), json_str);
     return std::nullopt;
   }
+}
+#endif
+
+} // namespace
+
+auto EventConverter::from_v11_json(std::string_view json_str)
+    -> std::optional<common::Event> {
+#ifdef OBCX_JSON_SIMDJSON
+  return from_v11_ondemand(json_str);
+#else
+  // 先从原始文本读出 post_type，缺失或未知且没有扩展转换时不做完整解析
+  if (auto post_type = peek_post_type(json_str)) {
+    if (post_type->empty()) {
+      return std::nullopt;
+    }
+    if (classify_post_type(*post_type) == PostType::unknown &&
+        !registry().find(*post_type, {})) {
+      OBCX_DEBUG("EventConverter: 未知的 post_type '{}'", *post_type);
+      return std::nullopt;
+    }
+  }
+  auto j_opt = common::JsonBackend::parse(json_str);
+  if (!j_opt) {
+    OBCX_WARN("EventConverter: 无法解析JSON: {}", json_str);
+    return std::nullopt;
+  }
+  return from_v11_object(j_opt.value(), json_str);
+#endif
+}
+
+void EventConverter::register_converter(std::string_view event_key,
+                                        Converter converter) {
+  OBCX_DEBUG("EventConverter: 注册扩展事件转换 '{}'", event_key);
+  registry().add(event_key, std::move(converter));
+}
+
+auto EventConverter::unregister_converter(std::string_view event_key) -> bool {
+  OBCX_DEBUG("EventConverter: 注销扩展事件转换 '{}'", event_key);
+  return registry().remove(event_key);
+}
+
+auto EventConverter::unregister_owner(core::HandlerOwner owner)
+    -> std::size_t {
+  if (owner == 0) {
+    return 0;
+  }
+  const auto removed = registry().remove_owner(owner);
+  OBCX_DEBUG("EventConverter: 注销所属者 {} 的 {} 个扩展事件转换", owner,
+             removed);
+  return removed;
+}
 
-  OBCX_DEBUG("EventConverter: 未知的 post_type '{}'", post_type);
-  return std::nullopt;
+auto EventConverter::wait_idle(core::HandlerOwner owner,
+                               std::chrono::milliseconds timeout) -> bool {
+  return registry().wait_idle(owner, timeout);
 }
 
-} // namespace obcx::adapter::onebot11
\ No newline at end of file
+} // namespace obcx::adapter::onebot11
@@ -47,8 +47,9 @@ auto ProtocolAdapter::serialize_delete_message_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_self_info_request(
@@ -61,8 +62,9 @@ auto ProtocolAdapter::serialize_get_self_info_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_user_info_request(
@@ -82,8 +84,9 @@ auto ProtocolAdapter::serialize_get_user_info_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_chat_info_request(
@@ -102,8 +105,9 @@ auto ProtocolAdapter::serialize_get_chat_info_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_chat_member_info_request(
@@ -123,8 +127,9 @@ auto ProtocolAdapter::serialize_get_chat_member_info_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_chat_admins_request(
@@ -144,8 +149,9 @@ auto ProtocolAdapter::serialize_get_chat_admins_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_kick_chat_member_request(
@@ -166,8 +172,9 @@ auto ProtocolAdapter::serialize_kick_chat_member_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_ban_chat_member_request(
@@ -187,8 +194,9 @@ auto ProtocolAdapter::serialize_ban_chat_member_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_unban_chat_member_request(
@@ -209,8 +217,9 @@ auto ProtocolAdapter::serialize_unban_chat_member_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_ban_all_members_request(
@@ -229,8 +238,9 @@ auto ProtocolAdapter::serialize_ban_all_members_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_set_chat_title_request(
@@ -267,8 +277,9 @@ auto ProtocolAdapter::serialize_leave_chat_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_handle_join_request(
@@ -330,8 +341,9 @@ auto ProtocolAdapter::serialize_send_private_message_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_send_group_message_request(
@@ -359,8 +371,9 @@ auto ProtocolAdapter::serialize_send_group_message_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_message_request(
@@ -378,8 +391,9 @@ auto ProtocolAdapter::serialize_get_message_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_forward_msg_request(
@@ -397,8 +411,9 @@ auto ProtocolAdapter::serialize_get_forward_msg_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized get_forward_msg request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized get_forward_msg request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_friend_list_request(
@@ -411,8 +426,9 @@ auto ProtocolAdapter::serialize_get_friend_list_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_group_list_request(
@@ -425,8 +441,9 @@ auto ProtocolAdapter::serialize_get_group_list_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 // --- 状态获取扩展 API ---
@@ -441,8 +458,9 @@ auto ProtocolAdapter::serialize_get_status_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_version_info_request(
@@ -455,8 +473,9 @@ auto ProtocolAdapter::serialize_get_version_info_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 // --- 群组管理扩展 API ---
@@ -473,8 +492,9 @@ auto ProtocolAdapter::serialize_set_group_name_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_set_group_admin_request(
@@ -490,8 +510,9 @@ auto ProtocolAdapter::serialize_set_group_admin_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_set_group_anonymous_ban_request(
@@ -507,8 +528,9 @@ auto ProtocolAdapter::serialize_set_group_anonymous_ban_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_set_group_anonymous_request(
@@ -523,8 +545,9 @@ auto ProtocolAdapter::serialize_set_group_anonymous_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_set_group_portrait_request(
@@ -540,8 +563,9 @@ auto ProtocolAdapter::serialize_set_group_portrait_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_group_honor_info_request(
@@ -556,8 +580,9 @@ auto ProtocolAdapter::serialize_get_group_honor_info_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_set_friend_add_request(
@@ -579,8 +604,9 @@ auto ProtocolAdapter::serialize_set_friend_add_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_set_group_add_request(
@@ -604,8 +630,9 @@ auto ProtocolAdapter::serialize_set_group_add_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 // --- 资源管理 API ---
@@ -620,8 +647,9 @@ auto ProtocolAdapter::serialize_get_image_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_record_request(
@@ -636,8 +664,9 @@ auto ProtocolAdapter::serialize_get_record_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 // --- 能力检查 API ---
@@ -652,8 +681,9 @@ auto ProtocolAdapter::serialize_can_send_image_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_can_send_record_request(
@@ -666,8 +696,9 @@ auto ProtocolAdapter::serialize_can_send_record_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 // --- QQ相关接口凭证 API ---
@@ -687,8 +718,9 @@ auto ProtocolAdapter::serialize_get_cookies_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_csrf_token_request(
@@ -701,8 +733,9 @@ auto ProtocolAdapter::serialize_get_csrf_token_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_credentials_request(
@@ -720,8 +753,9 @@ auto ProtocolAdapter::serialize_get_credentials_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_group_file_url_request(
@@ -736,8 +770,9 @@ auto ProtocolAdapter::serialize_get_group_file_url_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 auto ProtocolAdapter::serialize_get_private_file_url_request(
@@ -752,8 +787,9 @@ auto ProtocolAdapter::serialize_get_private_file_url_request(
     j["echo"] = echo.value();
   }
 
-  OBCX_DEBUG("Serialized action request: {}", j.dump());
-  return j.dump();
+  auto payload = j.dump();
+  OBCX_DEBUG("Serialized action request: {}", payload);
+  return payload;
 }
 
 } // namespace obcx::adapter::onebot11
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "onebot11/network/http/connection_manager.hpp"
+#include "common/json_backend.hpp"
 #include "common/logger.hpp"
 #include "network/proxy_http_client.hpp"
 #include "onebot11/adapter/protocol_adapter.hpp"
@@ -19,6 +20,9 @@ HttpConnectionManager::HttpConnectionManager(
 
 void HttpConnectionManager::connect(const common::ConnectionConfig &config) {
   config_ = config;
+  if (!journal_) {
+    journal_ = common::JournalWriter::open_for(config_, "onebot11");
+  }
 
   // if (config.proxy_host=="")
   http_client_ = std::make_unique<HttpClient>(ioc_, config_);
@@ -39,6 +43,9 @@ void HttpConnectionManager::disconnect() {
     http_client_->close();
     http_client_.reset();
   }
+  if (journal_) {
+    journal_->flush();
+  }
 
   OBCX_INFO("HTTP连接已断开");
 }
@@ -54,6 +61,9 @@ auto HttpConnectionManager::send_action_and_wait_async(
   if (!http_client_) {
     throw std::runtime_error("HTTP客户端未初始化");
   }
+  if (journal_) {
+    journal_->record(common::JournalDirection::outbound, action_payload);
+  }
 
   try {
     // 设置请求头
@@ -126,6 +136,9 @@ auto HttpConnectionManager::poll_events() -> asio::awaitable<void> {
       auto response = http_client_->get_sync(events_path, headers);
 
       if (response.is_success() && !response.body.empty()) {
+        if (journal_) {
+          journal_->record(common::JournalDirection::inbound, response.body);
+        }
         process_events(response.body);
       }
 
@@ -148,29 +161,32 @@ auto HttpConnectionManager::poll_events() -> asio::awaitable<void> {
 }
 
 void HttpConnectionManager::process_events(std::string_view events_json) {
-  try {
-    auto json_data = json::parse(events_json);
+  auto first = events_json.find_first_not_of(" \t\r\n");
+  if (first == std::string_view::npos) {
+    return;
+  }
 
-    // 处理单个事件
-    if (json_data.is_object()) {
-      auto event_opt = adapter_.parse_event(std::string(events_json));
-      if (event_opt && event_callback_) {
-        event_callback_(event_opt.value());
-      }
-    }
-    // 处理事件数组
-    else if (json_data.is_array()) {
-      for (const auto &event_json : json_data) {
-        std::string single_event = event_json.dump();
-        auto event_opt = adapter_.parse_event(single_event);
-        if (event_opt && event_callback_) {
-          event_callback_(event_opt.value());
-        }
-      }
+  // 处理单个事件：直接交给适配器，避免先整体解析一遍再重复解析
+  if (events_json[first] == '{') {
+    auto event_opt = adapter_.parse_event(events_json);
+    if (event_opt && event_callback_) {
+      event_callback_(event_opt.value());
     }
+    return;
+  }
 
-  } catch (const json::exception &e) {
-    OBCX_WARN("解析事件JSON失败: {}", e.what());
+  // 处理事件数组
+  auto json_data = common::JsonBackend::parse(events_json);
+  if (!json_data || !json_data->is_array()) {
+    OBCX_WARN("解析事件JSON失败: {}", events_json);
+    return;
+  }
+  for (const auto &event_json : *json_data) {
+    std::string single_event = event_json.dump();
+    auto event_opt = adapter_.parse_event(single_event);
+    if (event_opt && event_callback_) {
+      event_callback_(event_opt.value());
+    }
   }
 }
 
@@ -1,19 +1,78 @@
 #include "onebot11/network/websocket/connection_manager.hpp"
+#include "common/json_backend.hpp"
 #include "common/logger.hpp"
+#include "common/tracing.hpp"
 #include "onebot11/adapter/protocol_adapter.hpp"
 
 #include <atomic>
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/detached.hpp>
 #include <boost/bind/bind.hpp>
+#include <charconv>
 #include <utility>
 
 namespace obcx::network {
 
+namespace {
+
+struct WebSocketMetrics {
+  common::Counter &reconnects;
+  common::Counter &frames;
+  common::Counter &timeouts;
+
+  static auto get() -> WebSocketMetrics & {
+    static WebSocketMetrics metrics = [] {
+      auto &registry = common::MetricsRegistry::instance();
+      return WebSocketMetrics{
+          .reconnects = registry.counter("obcx_ws_reconnects_total",
+                                         "WebSocket reconnect attempts"),
+          .frames = registry.counter("obcx_ws_frames_received_total",
+                                     "WebSocket frames received"),
+          .timeouts = registry.counter("obcx_ws_request_timeouts_total",
+                                       "API requests that timed out waiting "
+                                       "for a WebSocket response")};
+    }();
+    return metrics;
+  }
+};
+
+/**
+ * @brief 不解析整帧，判断它是否为 API 响应并取出 echo
+ *
+ * 同时带有 echo 与 retcode 的帧是 API 响应，其余帧按事件交给适配器解析。
+ */
+auto response_echo(std::string_view message) -> std::optional<uint64_t> {
+  const auto echo = common::JsonBackend::peek_field(message, "echo");
+  if (!echo || echo->empty()) {
+    return std::nullopt;
+  }
+  const auto retcode = common::JsonBackend::peek_field(message, "retcode");
+  if (!retcode || retcode->empty()) {
+    return std::nullopt;
+  }
+  uint64_t value = 0;
+  const auto [end, ec] =
+      std::from_chars(echo->data(), echo->data() + echo->size(), value);
+  if (ec != std::errc{} || end != echo->data() + echo->size()) {
+    OBCX_WARN("API响应的echo无效: {}", *echo);
+    return std::nullopt;
+  }
+  return value;
+}
+
+} // namespace
+
 WebSocketConnectionManager::WebSocketConnectionManager(
     asio::io_context &ioc, adapter::onebot11::ProtocolAdapter &adapter)
     : ioc_(ioc), adapter_(adapter), reconnect_timer_(ioc),
-      send_strand_(asio::make_strand(ioc)), port_(0) {}
+      send_strand_(asio::make_strand(ioc)), port_(0) {
+  pending_requests_metric_ = common::MetricsRegistry::instance().observe(
+      "obcx_ws_pending_requests",
+      "API requests sent over WebSocket and awaiting a response", {}, [this] {
+        std::lock_guard lock(pending_requests_mutex_);
+        return static_cast<double>(pending_requests_.size());
+      });
+}
 
 void WebSocketConnectionManager::set_event_callback(EventCallback callback) {
   event_callback_ = std::move(callback);
@@ -21,6 +80,9 @@ void WebSocketConnectionManager::set_event_callback(EventCallback callback) {
 
 void WebSocketConnectionManager::connect(
     const common::ConnectionConfig &config) {
+  if (!journal_) {
+    journal_ = common::JournalWriter::open_for(config, "onebot11");
+  }
   connect_ws(config.host, config.port, config.access_token);
 }
 
@@ -57,6 +119,10 @@ void WebSocketConnectionManager::disconnect() {
 
   // 取消重连timer
   reconnect_timer_.cancel();
+
+  if (journal_) {
+    journal_->flush();
+  }
 }
 
 auto WebSocketConnectionManager::get_connection_type() const -> std::string {
@@ -115,61 +181,61 @@ void WebSocketConnectionManager::on_ws_message(const beast::error_code &ec,
   }
 
   OBCX_DEBUG("收到原始消息: {}", message);
+  WebSocketMetrics::get().frames.inc();
+  if (journal_) {
+    journal_->record(common::JournalDirection::inbound, message);
+  }
 
-  try {
-    nlohmann::json j = nlohmann::json::parse(message);
-
-    if (j.contains("echo") && j.contains("retcode")) {
-      uint64_t echo = j["echo"];
-
-      std::lock_guard lock(pending_requests_mutex_);
-      OBCX_DEBUG("查找pending request，echo: {}, 总数: {}", echo,
-                 pending_requests_.size());
-      auto it = pending_requests_.find(echo);
-      if (it != pending_requests_.end()) {
-        auto request = it->second;
-        pending_requests_.erase(it); // 立即移除
-
-        // 取消超时定时器
-        request->need_wait.store(false, std::memory_order_release);
-        request->timeout_timer.cancel();
+  if (const auto response = response_echo(message)) {
+    const uint64_t echo = *response;
+    std::lock_guard lock(pending_requests_mutex_);
+    OBCX_DEBUG("查找pending request，echo: {}, 总数: {}", echo,
+               pending_requests_.size());
+    auto it = pending_requests_.find(echo);
+    if (it != pending_requests_.end()) {
+      auto request = it->second;
+      pending_requests_.erase(it); // 立即移除
+
+      // 取消超时定时器
+      request->need_wait.store(false, std::memory_order_release);
+      request->timeout_timer.cancel();
 
-        if constexpr (USE_COROUTINE_ASYNC_WAIT) {
-          // 协程模式：调用 completion handler
-          if (request->completion_handler) {
-            OBCX_DEBUG("调用completion_handler（协程模式），echo: {}", echo);
-            request->completion_handler(boost::system::error_code{}, message);
-          } else {
-            OBCX_ERROR("Completion handler为空！echo: {}", echo);
-          }
+      if constexpr (USE_COROUTINE_ASYNC_WAIT) {
+        // 协程模式：调用 completion handler
+        if (request->completion_handler) {
+          OBCX_DEBUG("调用completion_handler（协程模式），echo: {}", echo);
+          request->completion_handler(boost::system::error_code{}, message);
         } else {
-          // 轮询模式：调用 resolver
-          if (request->resolver) {
-            OBCX_DEBUG("调用resolver（轮询模式），echo: {}", echo);
-            request->resolver(message);
-          } else {
-            OBCX_ERROR("Resolver为空！echo: {}", echo);
-          }
+          OBCX_ERROR("Completion handler为空！echo: {}", echo);
         }
-        OBCX_DEBUG("已处理API响应，echo: {}", echo);
-        return;
       } else {
-        OBCX_WARN("收到未知的API响应，echo: {}", echo);
-        // 打印所有pending requests的echo IDs用于调试
-        std::string pending_echos;
-        for (const auto &[id, req] : pending_requests_) {
-          if (!pending_echos.empty())
-            pending_echos += ", ";
-          pending_echos += std::to_string(id);
+        // 轮询模式：调用 resolver
+        if (request->resolver) {
+          OBCX_DEBUG("调用resolver（轮询模式），echo: {}", echo);
+          request->resolver(message);
+        } else {
+          OBCX_ERROR("Resolver为空！echo: {}", echo);
         }
-        OBCX_DEBUG("当前pending requests: [{}]", pending_echos);
       }
+      OBCX_DEBUG("已处理API响应，echo: {}", echo);
+      return;
+    } else {
+      OBCX_WARN("收到未知的API响应，echo: {}", echo);
+      // 打印所有pending requests的echo IDs用于调试
+      std::string pending_echos;
+      for (const auto &[id, req] : pending_requests_) {
+        if (!pending_echos.empty())
+          pending_echos += ", ";
+        pending_echos += std::to_string(id);
+      }
+      OBCX_DEBUG("当前pending requests: [{}]", pending_echos);
     }
-  } catch (const nlohmann::json::exception &e) {
-    OBCX_WARN("JSON解析失败: {}", e.what());
   }
 
-  auto event_opt = adapter_.parse_event(message);
+  auto event_opt = [&] {
+    const common::Span span("onebot.parse");
+    return adapter_.parse_event(message);
+  }();
   if (event_opt) {
     if (event_callback_) {
       event_callback_(event_opt.value());
@@ -180,6 +246,7 @@ void WebSocketConnectionManager::on_ws_message(const beast::error_code &ec,
 }
 
 void WebSocketConnectionManager::schedule_reconnect() {
+  WebSocketMetrics::get().reconnects.inc();
   reconnect_timer_.expires_after(std::chrono::seconds(5));
   OBCX_INFO("将在5秒后尝试重新连接...");
   reconnect_timer_.async_wait([this](const beast::error_code &ec) {
@@ -200,6 +267,10 @@ auto WebSocketConnectionManager::send_action_and_wait_async(
     throw std::runtime_error("没有可用的 WebSocket 客户端");
   }
 
+  if (journal_) {
+    journal_->record(common::JournalDirection::outbound, action_payload);
+  }
+
   if constexpr (USE_COROUTINE_ASYNC_WAIT) {
     OBCX_DEBUG("使用协程异步等待模式，echo: {}", echo_id);
 
@@ -234,17 +305,21 @@ auto WebSocketConnectionManager::send_action_and_wait_async(
     }
 
     try {
-      co_await asio::co_spawn(
-          send_strand_,
-          [this, action_payload =
-                     std::move(action_payload)]() -> asio::awaitable<void> {
-            co_await ws_client_->send(action_payload);
-          },
-          asio::use_awaitable);
+      {
+        const common::Span span("ws.send", true);
+        co_await asio::co_spawn(
+            send_strand_,
+            [this, action_payload =
+                       std::move(action_payload)]() -> asio::awaitable<void> {
+              co_await ws_client_->send(action_payload);
+            },
+            asio::use_awaitable);
+      }
 
       OBCX_DEBUG("WebSocket消息已发送（协程模式），echo: {}", echo_id);
 
       if (request->need_wait.load(std::memory_order_acquire)) {
+        const common::Span span("ws.wait_response", true);
         try {
           co_await request->timeout_timer.async_wait(asio::use_awaitable);
           // 如果走到这里，说明真的超时了
@@ -273,6 +348,7 @@ auto WebSocketConnectionManager::send_action_and_wait_async(
         std::lock_guard lock(result_mutex);
         if (response_error) {
           if (response_error == asio::error::timed_out) {
+            WebSocketMetrics::get().timeouts.inc();
             OBCX_ERROR("API请求超时（协程模式），echo: {}", echo_id);
             throw std::runtime_error("API请求超时");
           }
@@ -409,6 +485,7 @@ auto WebSocketConnectionManager::send_action_and_wait_async(
         }
 
         if (state->result.empty()) {
+          WebSocketMetrics::get().timeouts.inc();
           OBCX_ERROR("API请求超时（轮询模式），echo: {}", echo_id);
           throw std::runtime_error("API请求超时");
         }
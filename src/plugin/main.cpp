@@ -1,12 +1,17 @@
 #include "common/config_loader.hpp"
+#include "common/config_watcher.hpp"
 #include "common/logger.hpp"
 #include "common/plugin_manager.hpp"
+#include "common/tracing.hpp"
 #include "core/qq_bot.hpp"
 #include "core/tg_bot.hpp"
 #include "interfaces/connection_manager.hpp"
+#include "network/metrics_server.hpp"
 #include "onebot11/adapter/protocol_adapter.hpp"
 #include "telegram/adapter/protocol_adapter.hpp"
+#include <algorithm>
 #include <boost/date_time/posix_time/time_formatters.hpp>
+#include <chrono>
 #include <csignal>
 #include <cstdint>
 #include <iostream>
@@ -20,6 +25,7 @@ using namespace obcx;
 namespace {
 volatile sig_atomic_t g_should_stop = 0;
 volatile sig_atomic_t g_shutdown_started = 0;
+volatile sig_atomic_t g_reload_requested = 0;
 
 const uint16_t DEFAULT_PORT = 8080;
 
@@ -28,6 +34,88 @@ void print_version() {
   std::cout << "A modular bot framework supporting QQ and Telegram" << '\n';
 }
 
+// 按 [logging] 配置切换异步日志
+void configure_logging(const common::ConfigLoader &config_loader) {
+  if (!config_loader.get_value<bool>("logging.async").value_or(false)) {
+    return;
+  }
+  common::AsyncLogOptions options;
+  if (auto queue_size = config_loader.get_value<int64_t>("logging.queue_size");
+      queue_size && *queue_size > 0) {
+    options.queue_size = static_cast<std::size_t>(*queue_size);
+  }
+  auto overflow = config_loader.get_value<std::string>("logging.overflow")
+                      .value_or("block");
+  if (overflow == "overrun_oldest") {
+    options.overflow = spdlog::async_overflow_policy::overrun_oldest;
+  } else if (overflow != "block") {
+    OBCX_WARN("Unknown logging.overflow '{}', using 'block'", overflow);
+  }
+  common::Logger::enable_async(options);
+}
+
+// [metrics] 启用时在本地端口导出 Prometheus 指标
+auto start_metrics_server(const common::ConfigLoader &config_loader)
+    -> std::unique_ptr<network::MetricsServer> {
+  if (!config_loader.get_value<bool>("metrics.enabled").value_or(false)) {
+    return nullptr;
+  }
+  auto host = config_loader.get_value<std::string>("metrics.host")
+                  .value_or("127.0.0.1");
+  auto port = config_loader.get_value<int64_t>("metrics.port").value_or(9464);
+  if (port < 0 || port > UINT16_MAX) {
+    OBCX_ERROR("Invalid metrics.port {}, metrics endpoint disabled", port);
+    return nullptr;
+  }
+  auto server = std::make_unique<network::MetricsServer>(
+      std::move(host), static_cast<uint16_t>(port));
+  try {
+    server->start();
+  } catch (const std::exception &e) {
+    OBCX_ERROR("Failed to start metrics endpoint: {}", e.what());
+    return nullptr;
+  }
+  return server;
+}
+
+// [tracing] 启用时记录每个事件的延迟跨度，返回退出时写入的文件路径
+auto configure_tracing(const common::ConfigLoader &config_loader)
+    -> std::string {
+  if (!config_loader.get_value<bool>("tracing.enabled").value_or(false)) {
+    return {};
+  }
+  auto capacity = config_loader.get_value<int64_t>("tracing.capacity")
+                      .value_or(common::Tracer::kDefaultCapacity);
+  if (capacity <= 0) {
+    OBCX_WARN("Invalid tracing.capacity {}, using {}", capacity,
+              common::Tracer::kDefaultCapacity);
+    capacity = common::Tracer::kDefaultCapacity;
+  }
+  common::Tracer::instance().start(static_cast<std::size_t>(capacity));
+  auto output = config_loader.get_value<std::string>("tracing.output")
+                    .value_or("obcx_trace.json");
+  OBCX_INFO("Latency tracing enabled, spans will be written to {}", output);
+  return output;
+}
+
+// [config] watch 启用时，配置文件变化后在后台重新加载并发布新快照
+auto start_config_watcher(common::ConfigLoader &config_loader)
+    -> std::unique_ptr<common::ConfigWatcher> {
+  if (!config_loader.get_value<bool>("config.watch").value_or(false)) {
+    return nullptr;
+  }
+  auto watcher = std::make_unique<common::ConfigWatcher>(
+      config_loader.get_config_path(), [&config_loader] {
+        if (!config_loader.reload_config()) {
+          OBCX_WARN("Keeping the previous configuration");
+        }
+      });
+  if (!watcher->start()) {
+    return nullptr;
+  }
+  return watcher;
+}
+
 void print_help() {
   std::cout << "Usage: OBCX [OPTIONS] [CONFIG_FILE]" << '\n';
   std::cout << '\n';
@@ -51,6 +139,9 @@ void signal_handler(int signal) {
   OBCX_INFO("Received signal {}, shutting down gracefully...", signal);
   g_should_stop = 1;
 }
+
+// SIGHUP reloads plugins whose library changed; the main loop does the work
+void reload_signal_handler(int /*signal*/) { g_reload_requested = 1; }
 } // namespace
 
 class ComponentManager {
@@ -180,25 +271,19 @@ public:
       config.proxy_password = "";
     }
 
+    // Traffic journal for offline replay (optional)
+    if (const auto *journal = conn_table.get("journal")) {
+      config.journal_path = journal->value_or<std::string>("");
+    }
+    if (const auto *journal_compress = conn_table.get("journal_compress")) {
+      config.journal_compress = journal_compress->value_or<bool>(false);
+    }
+
     return config;
   }
 
-  bool setup_bot(core::IBot &bot, const common::BotConfig &config,
-                 common::PluginManager &plugin_manager) {
+  bool setup_bot(core::IBot &bot, const common::BotConfig &config) {
     try {
-      // Load and initialize plugins for this bot
-      for (const auto &plugin_name : config.plugins) {
-        if (!plugin_manager.load_plugin(plugin_name)) {
-          OBCX_WARN("Failed to load plugin: {}", plugin_name);
-          continue;
-        }
-
-        if (!plugin_manager.initialize_plugin(plugin_name)) {
-          OBCX_WARN("Failed to initialize plugin: {}", plugin_name);
-          continue;
-        }
-      }
-
       // Setup connection
       auto connection_config = create_connection_config(config.connection);
       std::string conn_type =
@@ -223,6 +308,7 @@ private:
 auto main(int argc, char *argv[]) -> int {
   signal(SIGINT, signal_handler);
   signal(SIGTERM, signal_handler);
+  signal(SIGHUP, reload_signal_handler);
 
   common::Logger::initialize(
       spdlog::level::info,
@@ -257,6 +343,11 @@ auto main(int argc, char *argv[]) -> int {
     return 1;
   }
 
+  configure_logging(config_loader);
+  const auto trace_output = configure_tracing(config_loader);
+  auto metrics_server = start_metrics_server(config_loader);
+  auto config_watcher = start_config_watcher(config_loader);
+
   OBCX_INFO("OBCX Robot Framework starting...");
   OBCX_INFO("Configuration loaded from: {}", config_path);
 
@@ -292,6 +383,9 @@ auto main(int argc, char *argv[]) -> int {
 
   interface::IPlugin::set_bots(&bots, &bots_mutex);
 
+  // Create every bot first so plugins see all of them during initialization
+  std::vector<const common::BotConfig *> enabled_configs;
+  std::vector<std::string> plugin_names;
   for (const auto &config : bot_configs) {
     if (!config.enabled) {
       OBCX_INFO("Skipping disabled bot component of type: {}", config.type);
@@ -303,19 +397,40 @@ auto main(int argc, char *argv[]) -> int {
       OBCX_ERROR("Failed to create bot component of type: {}", config.type);
       continue;
     }
-
-    // Move bot to bots vector first so plugins can access it during
-    // initialization
     bots.push_back(std::move(bot));
-    size_t bot_index = bots.size() - 1;
+    enabled_configs.push_back(&config);
+
+    // A plugin shared by several bots is loaded and initialized once
+    for (const auto &plugin_name : config.plugins) {
+      if (std::ranges::find(plugin_names, plugin_name) == plugin_names.end()) {
+        plugin_names.push_back(plugin_name);
+      }
+    }
+  }
+
+  // Load plugins, then initialize independent ones in parallel
+  std::vector<std::string> loaded_plugins;
+  for (const auto &plugin_name : plugin_names) {
+    if (plugin_manager.load_plugin(plugin_name)) {
+      loaded_plugins.push_back(plugin_name);
+    } else {
+      OBCX_WARN("Failed to load plugin: {}", plugin_name);
+    }
+  }
+  if (!plugin_manager.initialize_plugins(loaded_plugins)) {
+    OBCX_WARN("Some plugins failed to initialize");
+  }
 
-    if (!component_manager.setup_bot(*bots[bot_index], config,
-                                     plugin_manager)) {
+  std::size_t started_bots = 0;
+  for (size_t bot_index = 0; bot_index < bots.size(); ++bot_index) {
+    const auto &config = *enabled_configs[bot_index];
+    // Plugins may already hold this bot, so a failed bot stays in the
+    // vector and is simply not started
+    if (!component_manager.setup_bot(*bots[bot_index], config)) {
       OBCX_ERROR("Failed to setup bot component of type: {}", config.type);
-      // Remove the bot from vector since setup failed
-      bots.pop_back();
       continue;
     }
+    ++started_bots;
 
     OBCX_INFO("Starting bot component of type: {}", config.type);
 
@@ -329,52 +444,76 @@ auto main(int argc, char *argv[]) -> int {
     });
   }
 
-  if (bots.empty()) {
+  if (started_bots == 0) {
     OBCX_ERROR("No bot components started successfully");
     return 1;
   }
 
   OBCX_INFO("All components started successfully. OBCX Framework running...");
 
-  // Wait for shutdown signal
+  // Wait for shutdown signal; SIGHUP hot-reloads changed plugins while the
+  // bots stay connected
   while (g_should_stop == 0) {
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (g_reload_requested != 0 && g_should_stop == 0) {
+      g_reload_requested = 0;
+      OBCX_INFO("Reloaded {} plugins",
+                plugin_manager.reload_modified_plugins());
+    }
   }
 
   OBCX_INFO("Shutting down OBCX Framework...");
+  config_watcher.reset();
+
+  // Stop accepting events and let in-flight handlers finish. All bots share
+  // one deadline; handlers still running after it are cancelled and given a
+  // short grace period to unwind.
+  const auto drain_deadline =
+      std::chrono::steady_clock::now() + core::IBot::kDefaultDrainTimeout;
+  for (auto &bot : bots) {
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        drain_deadline - std::chrono::steady_clock::now());
+    if (auto outstanding =
+            bot->drain(std::max(remaining, std::chrono::milliseconds::zero()));
+        outstanding > 0) {
+      OBCX_WARN("{} event handlers were still running after cancellation",
+                outstanding);
+    }
+  }
 
-  // Stop all bot components
+  // Stop all bot components; stop() skips its own drain since the
+  // dispatchers are already draining
   for (auto &bot : bots) {
     bot->stop();
   }
 
-  // Wait for bot threads to finish with timeout
+  // Event loops return once stopped, and handlers were drained or cancelled
+  // above, so joining does not block on in-flight work
   for (size_t i = 0; i < bot_threads.size(); ++i) {
     if (bot_threads[i].joinable()) {
       OBCX_INFO("Waiting for bot thread {} to finish...", i);
-      // Use a detached thread to implement timeout
-      bool thread_finished = false;
-      std::thread timeout_thread([&]() {
-        std::this_thread::sleep_for(std::chrono::seconds(5));
-        if (!thread_finished) {
-          OBCX_WARN("Bot thread {} did not finish within timeout, detaching",
-                    i);
-          bot_threads[i].detach();
-        }
-      });
-
       bot_threads[i].join();
-      thread_finished = true;
-
-      if (timeout_thread.joinable()) {
-        timeout_thread.join();
-      }
     }
   }
 
   // Shutdown all plugins
   plugin_manager.shutdown_all_plugins();
+  metrics_server.reset();
+  if (!trace_output.empty()) {
+    auto &tracer = common::Tracer::instance();
+    tracer.stop();
+    if (tracer.write_chrome_json(trace_output)) {
+      OBCX_INFO("Latency trace written to {}", trace_output);
+    } else {
+      OBCX_ERROR("Failed to write latency trace to {}", trace_output);
+    }
+  }
 
   OBCX_INFO("OBCX Framework shutdown complete");
+  if (auto dropped = common::Logger::dropped(); dropped > 0) {
+    OBCX_WARN("{} log messages were dropped because the queue was full",
+              dropped);
+  }
+  common::Logger::disable_async();
   return 0;
 }
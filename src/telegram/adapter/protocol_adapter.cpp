@@ -1,5 +1,6 @@
 #include "telegram/adapter/protocol_adapter.hpp"
 
+#include "common/json_backend.hpp"
 #include "common/json_utils.hpp"
 #include "common/logger.hpp"
 
@@ -9,10 +10,19 @@ namespace obcx::adapter::telegram {
 
 auto ProtocolAdapter::parse_event(std::string_view json_str)
     -> std::optional<common::Event> {
-  try {
-    auto json = nlohmann::json::parse(json_str);
-    OBCX_DEBUG("Parsing Telegram event: {}", json_str);
+  OBCX_DEBUG("Parsing Telegram event: {}", json_str);
+  auto json = common::JsonBackend::parse(json_str);
+  if (!json) {
+    OBCX_ERROR("Failed to parse Telegram event: invalid JSON");
+    OBCX_ERROR("JSON string was: {}", json_str);
+    return std::nullopt;
+  }
+  return parse_update(*json);
+}
 
+auto ProtocolAdapter::parse_update(const nlohmann::json &json)
+    -> std::optional<common::Event> {
+  try {
     // Check if this is an update
     if (json.contains("update_id")) {
       // Handle different types of updates
@@ -44,7 +54,7 @@ auto ProtocolAdapter::parse_event(std::string_view json_str)
     return std::nullopt;
   } catch (const std::exception &e) {
     OBCX_ERROR("Failed to parse Telegram event: {}", e.what());
-    OBCX_ERROR("JSON string was: {}", json_str);
+    OBCX_ERROR("Update was: {}", json.dump());
     return std::nullopt;
   }
 }
@@ -59,8 +69,8 @@ auto ProtocolAdapter::parse_message_event(const nlohmann::json &update_json)
     event.time = std::chrono::system_clock::now();
     event.post_type = "message";
     event.type = common::EventType::message;
-    event.self_id =
-        "0"; // Bot ID should be set properly in a real implementation
+    // Bot ID should be set properly in a real implementation
+    event.self_id = common::UserId(0, common::Platform::telegram);
 
     // Store the original message data for access to additional fields
     event.data = message;
@@ -72,7 +82,8 @@ auto ProtocolAdapter::parse_message_event(const nlohmann::json &update_json)
 
     // Extract message ID
     if (message.contains("message_id")) {
-      event.message_id = std::to_string(message["message_id"].get<int64_t>());
+      event.message_id = common::MessageId(
+          message["message_id"].get<int64_t>(), common::Platform::telegram);
       OBCX_DEBUG("Extracted message_id: {}", event.message_id);
     }
 
@@ -80,7 +91,8 @@ auto ProtocolAdapter::parse_message_event(const nlohmann::json &update_json)
     if (message.contains("from")) {
       auto from = message["from"];
       if (from.contains("id")) {
-        event.user_id = std::to_string(from["id"].get<int64_t>());
+        event.user_id = common::UserId(from["id"].get<int64_t>(),
+                                       common::Platform::telegram);
         OBCX_DEBUG("Extracted user_id: {}", event.user_id);
       }
     }
@@ -89,7 +101,8 @@ auto ProtocolAdapter::parse_message_event(const nlohmann::json &update_json)
     if (message.contains("chat")) {
       auto chat = message["chat"];
       if (chat.contains("id")) {
-        std::string chat_id = std::to_string(chat["id"].get<int64_t>());
+        common::ChatId chat_id(chat["id"].get<int64_t>(),
+                               common::Platform::telegram);
         OBCX_DEBUG("Extracted chat_id: {}", chat_id);
 
         // Check chat type to determine if it's a group or private chat
@@ -399,23 +412,25 @@ auto ProtocolAdapter::parse_callback_query_event(
       event.time = std::chrono::system_clock::now();
       event.post_type = "notice";
       event.type = common::EventType::notice;
-      event.self_id =
-          "0"; // Bot ID should be set properly in a real implementation
+      // Bot ID should be set properly in a real implementation
+      event.self_id = common::UserId(0, common::Platform::telegram);
       event.notice_type = "callback_query";
 
       // Extract user ID if available
       if (callback_query.contains("from") &&
           callback_query["from"].contains("id")) {
-        event.user_id =
-            std::to_string(callback_query["from"]["id"].get<int64_t>());
+        event.user_id = common::UserId(
+            callback_query["from"]["id"].get<int64_t>(),
+            common::Platform::telegram);
       }
 
       // Extract chat ID if available
       if (callback_query.contains("message") &&
           callback_query["message"].contains("chat") &&
           callback_query["message"]["chat"].contains("id")) {
-        event.group_id = std::to_string(
-            callback_query["message"]["chat"]["id"].get<int64_t>());
+        event.group_id = common::ChatId(
+            callback_query["message"]["chat"]["id"].get<int64_t>(),
+            common::Platform::telegram);
       }
 
       OBCX_DEBUG("Successfully parsed Telegram callback query event");
@@ -1,8 +1,12 @@
 #include "../../../../include/telegram/network/connection_manager.hpp"
+#include "common/json_backend.hpp"
+#include "common/json_utils.hpp"
 #include "common/logger.hpp"
+#include "common/tracing.hpp"
 #include "telegram/adapter/protocol_adapter.hpp"
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/detached.hpp>
+#include <charconv>
 #include <nlohmann/json.hpp>
 
 using obcx::network::ProxyConfig;
@@ -11,6 +15,30 @@ namespace obcx::network {
 
 using json = nlohmann::json;
 
+namespace {
+
+// 429 响应要求的等待时间：优先取 Bot API 的 parameters.retry_after，
+// 其次是 Retry-After 头，都没有时等待 1 秒
+auto retry_after_of(const HttpResponse &response) -> std::chrono::seconds {
+  const auto body = json::parse(response.body, nullptr, false);
+  if (body.is_object() && body.contains("parameters") &&
+      body["parameters"].is_object()) {
+    const auto &retry_after = body["parameters"].value("retry_after", json());
+    if (retry_after.is_number_integer()) {
+      return std::chrono::seconds(retry_after.get<int64_t>());
+    }
+  }
+  const auto header = response.raw_response[http::field::retry_after];
+  int64_t seconds = 0;
+  if (std::from_chars(header.data(), header.data() + header.size(), seconds)
+          .ec == std::errc{}) {
+    return std::chrono::seconds(seconds);
+  }
+  return std::chrono::seconds(1);
+}
+
+} // namespace
+
 TelegramConnectionManager::TelegramConnectionManager(
     asio::io_context &ioc, adapter::telegram::ProtocolAdapter &adapter)
     : ioc_(ioc), adapter_(adapter), poll_timer_(ioc) {
@@ -20,6 +48,9 @@ TelegramConnectionManager::TelegramConnectionManager(
 void TelegramConnectionManager::connect(
     const common::ConnectionConfig &config) {
   config_ = config;
+  if (!journal_) {
+    journal_ = common::JournalWriter::open_for(config_, "telegram");
+  }
 
   // 检查是否需要使用代理
   if (!config_.proxy_host.empty() && config_.proxy_port > 0) {
@@ -67,6 +98,9 @@ void TelegramConnectionManager::disconnect() {
     http_client_->close();
     http_client_.reset();
   }
+  if (journal_) {
+    journal_->flush();
+  }
 
   OBCX_INFO("Telegram HTTP连接已断开");
 }
@@ -82,6 +116,9 @@ auto TelegramConnectionManager::send_action_and_wait_async(
   if (!http_client_) {
     throw std::runtime_error("HTTP客户端未初始化");
   }
+  if (journal_) {
+    journal_->record(common::JournalDirection::outbound, action_payload);
+  }
 
   try {
     // 解析action_payload以获取方法名和参数
@@ -107,8 +144,14 @@ auto TelegramConnectionManager::send_action_and_wait_async(
     std::string body = payload_json.dump();
 
     // 发送POST请求到Telegram API
-    HttpResponse response = http_client_->post_sync(api_path, body, headers);
+    HttpResponse response = [&] {
+      const common::Span span("telegram.post");
+      return http_client_->post_sync(api_path, body, headers);
+    }();
 
+    if (response.status_code == 429) {
+      throw HttpRateLimitError("HTTP请求失败: 429", retry_after_of(response));
+    }
     if (!response.is_success()) {
       throw std::runtime_error("HTTP请求失败: " +
                                std::to_string(response.status_code));
@@ -269,6 +312,9 @@ auto TelegramConnectionManager::poll_updates() -> asio::awaitable<void> {
           http_client_->post_sync(updates_path, body, headers);
 
       if (response.is_success() && !response.body.empty()) {
+        if (journal_) {
+          journal_->record(common::JournalDirection::inbound, response.body);
+        }
         process_updates(response.body);
       }
 
@@ -292,27 +338,39 @@ auto TelegramConnectionManager::poll_updates() -> asio::awaitable<void> {
 
 void TelegramConnectionManager::process_updates(std::string_view updates_json) {
   try {
-    auto json_data = json::parse(updates_json);
+    auto parsed = common::JsonBackend::parse(updates_json);
+    if (!parsed) {
+      OBCX_WARN("解析更新JSON失败: {}", updates_json);
+      return;
+    }
+    auto &json_data = *parsed;
     OBCX_DEBUG("Received Telegram updates: {}", updates_json);
 
     // 检查是否有result字段
     if (json_data.contains("result") && json_data["result"].is_array()) {
-      auto result_array = json_data["result"];
+      const auto &result_array = json_data["result"];
       OBCX_DEBUG("Processing {} updates from Telegram", result_array.size());
 
       // 更新offset为最新的update_id + 1
       if (!result_array.empty()) {
-        auto last_update = result_array.back();
+        const auto &last_update = result_array.back();
         if (last_update.contains("update_id")) {
           update_offset_ = last_update["update_id"].get<int>() + 1;
         }
       }
 
-      // 处理每个更新
+      // 处理每个更新，每个更新是一条独立的追踪
+      auto &tracer = common::Tracer::instance();
       for (const auto &update_json : result_array) {
-        std::string single_update = update_json.dump();
-        OBCX_DEBUG("Processing single update: {}", single_update);
-        auto event_opt = adapter_.parse_event(single_update);
+        const common::TraceScope trace(tracer.new_trace());
+        const common::Span span("telegram.update");
+        OBCX_DEBUG("Processing single update: {}",
+                   common::JsonUtils::get_value<int64_t>(update_json,
+                                                         "update_id"));
+        auto event_opt = [&] {
+          const common::Span parse_span("telegram.parse");
+          return adapter_.parse_update(update_json);
+        }();
         if (event_opt && event_callback_) {
           OBCX_DEBUG("Dispatching event to callback");
           event_callback_(event_opt.value());
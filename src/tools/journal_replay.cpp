@@ -0,0 +1,287 @@
+/**
+ * @file journal_replay.cpp
+ * @brief 回放连接层流量日志
+ *
+ * 把 JournalWriter 录下的入站帧重新送入 ProtocolAdapter::parse_event 与
+ * EventDispatcher，可以全速回放用于压测，也可以按录制时的节奏回放用于
+ * 复现问题。每种事件类型注册若干个空处理器，只统计调用次数。
+ */
+
+#include "common/event_journal.hpp"
+#include "common/json_backend.hpp"
+#include "common/logger.hpp"
+#include "core/event_dispatcher.hpp"
+#include "core/qq_bot.hpp"
+#include "core/tg_bot.hpp"
+#include "onebot11/adapter/protocol_adapter.hpp"
+#include "telegram/adapter/protocol_adapter.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+using namespace obcx;
+namespace asio = boost::asio;
+
+namespace {
+
+struct Options {
+  std::string path;
+  /// 相对录制速度的倍率；0 表示全速回放
+  double speed = 0;
+  int repeat = 1;
+  int handlers = 1;
+  bool dump = false;
+};
+
+struct Stats {
+  uint64_t frames = 0;
+  uint64_t outbound = 0;
+  uint64_t events = 0;
+  uint64_t non_events = 0;
+  uint64_t handled = 0;
+};
+
+void print_help() {
+  std::cout << "Usage: obcx_journal_replay [OPTIONS] JOURNAL" << '\n';
+  std::cout << '\n';
+  std::cout << "OPTIONS:" << '\n';
+  std::cout << "  --speed X      Replay at X times the recorded speed "
+               "(default: as fast as possible)"
+            << '\n';
+  std::cout << "  --repeat N     Replay the journal N times (default: 1)"
+            << '\n';
+  std::cout << "  --handlers N   Handlers registered per event type "
+               "(default: 1)"
+            << '\n';
+  std::cout << "  --dump         Print the records instead of replaying"
+            << '\n';
+  std::cout << "  -h, --help     Show this help message" << '\n';
+}
+
+auto parse_args(int argc, char *argv[]) -> std::optional<Options> {
+  Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    auto value = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::invalid_argument("Missing value for " + arg);
+      }
+      return argv[++i];
+    };
+    if (arg == "-h" || arg == "--help") {
+      return std::nullopt;
+    }
+    if (arg == "--speed") {
+      options.speed = std::stod(value());
+    } else if (arg == "--repeat") {
+      options.repeat = std::stoi(value());
+    } else if (arg == "--handlers") {
+      options.handlers = std::stoi(value());
+    } else if (arg == "--dump") {
+      options.dump = true;
+    } else if (arg.starts_with("-")) {
+      throw std::invalid_argument("Unknown option: " + arg);
+    } else {
+      options.path = arg;
+    }
+  }
+  if (options.path.empty()) {
+    throw std::invalid_argument("No journal file given");
+  }
+  return options;
+}
+
+// 为每种事件类型注册 count 个只计数的处理器
+template <typename... Events>
+void register_counters(core::EventDispatcher &dispatcher, Stats &stats,
+                       int count, std::type_identity<std::variant<Events...>>) {
+  for (int i = 0; i < count; ++i) {
+    (dispatcher.on<Events>(
+         [&stats](core::IBot &, const Events &) -> asio::awaitable<void> {
+           ++stats.handled;
+           co_return;
+         }),
+     ...);
+  }
+}
+
+// 把一个入站帧拆成事件，与对应连接管理器的处理方式一致
+using FrameParser =
+    std::function<void(std::string_view, std::vector<common::Event> &)>;
+
+auto onebot11_parser() -> FrameParser {
+  return [adapter = std::make_shared<adapter::onebot11::ProtocolAdapter>()](
+             std::string_view frame, std::vector<common::Event> &events) {
+    auto first = frame.find_first_not_of(" \t\r\n");
+    if (first != std::string_view::npos && frame[first] == '[') {
+      // HTTP 轮询一次返回的事件数组
+      if (auto array = common::JsonBackend::parse(frame)) {
+        for (const auto &item : *array) {
+          if (auto event = adapter->parse_event(item.dump())) {
+            events.push_back(std::move(*event));
+          }
+        }
+      }
+      return;
+    }
+    if (auto event = adapter->parse_event(frame)) {
+      events.push_back(std::move(*event));
+    }
+  };
+}
+
+auto telegram_parser() -> FrameParser {
+  return [adapter = std::make_shared<adapter::telegram::ProtocolAdapter>()](
+             std::string_view frame, std::vector<common::Event> &events) {
+    // getUpdates 的响应体，更新位于 result 数组中
+    auto body = common::JsonBackend::parse(frame);
+    if (!body || !body->contains("result") || !(*body)["result"].is_array()) {
+      return;
+    }
+    for (const auto &update : (*body)["result"]) {
+      if (auto event = adapter->parse_update(update)) {
+        events.push_back(std::move(*event));
+      }
+    }
+  };
+}
+
+auto dump(common::JournalReader &reader) -> int {
+  while (auto record = reader.next()) {
+    std::cout << (record->direction == common::JournalDirection::inbound
+                      ? "<< "
+                      : ">> ")
+              << std::chrono::duration<double>(record->timestamp).count()
+              << "s " << record->payload << '\n';
+  }
+  return 0;
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+  std::optional<Options> parsed;
+  try {
+    parsed = parse_args(argc, argv);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    print_help();
+    return 1;
+  }
+  if (!parsed) {
+    print_help();
+    return 0;
+  }
+  const auto &options = *parsed;
+
+  // 回放时只关心统计结果，处理器与适配器的日志全部关闭
+  common::Logger::initialize(spdlog::level::warn);
+
+  std::unique_ptr<common::JournalReader> reader;
+  try {
+    reader = std::make_unique<common::JournalReader>(options.path);
+  } catch (const std::exception &e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+  if (options.dump) {
+    return dump(*reader);
+  }
+
+  std::unique_ptr<core::IBot> bot;
+  FrameParser parse_frame;
+  if (reader->protocol() == "onebot11") {
+    bot = std::make_unique<core::QQBot>(adapter::onebot11::ProtocolAdapter{});
+    parse_frame = onebot11_parser();
+  } else if (reader->protocol() == "telegram") {
+    bot = std::make_unique<core::TGBot>(adapter::telegram::ProtocolAdapter{});
+    parse_frame = telegram_parser();
+  } else {
+    std::cerr << "Unknown protocol in journal: " << reader->protocol() << '\n';
+    return 1;
+  }
+
+  // 先全部读入内存，回放时不受磁盘与解压影响
+  Stats stats;
+  std::vector<common::JournalRecord> frames;
+  while (auto record = reader->next()) {
+    if (record->direction == common::JournalDirection::outbound) {
+      ++stats.outbound;
+      continue;
+    }
+    frames.push_back(std::move(*record));
+  }
+  if (reader->truncated()) {
+    std::cerr << "Warning: journal ends mid-record, the tail is ignored\n";
+  }
+  if (frames.empty()) {
+    std::cerr << "No inbound frames in journal\n";
+    return 1;
+  }
+
+  asio::io_context io_context;
+  core::EventDispatcher dispatcher(io_context);
+  register_counters(dispatcher, stats, options.handlers,
+                    std::type_identity<common::Event>{});
+
+  std::vector<common::Event> events;
+  const auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < options.repeat; ++round) {
+    const auto round_start = std::chrono::steady_clock::now();
+    for (const auto &frame : frames) {
+      if (options.speed > 0) {
+        const auto due =
+            round_start + std::chrono::duration_cast<
+                              std::chrono::steady_clock::duration>(
+                              (frame.timestamp - frames.front().timestamp) /
+                              options.speed);
+        io_context.run_until(due);
+        io_context.restart();
+        std::this_thread::sleep_until(due);
+      }
+
+      events.clear();
+      parse_frame(frame.payload, events);
+      ++stats.frames;
+      if (events.empty()) {
+        ++stats.non_events;
+      }
+      for (auto &event : events) {
+        ++stats.events;
+        dispatcher.dispatch(
+            bot.get(), std::make_shared<const common::Event>(std::move(event)));
+      }
+      // 没有待运行的处理器时 poll() 会停止 io_context，需要重置
+      io_context.poll();
+      io_context.restart();
+    }
+  }
+  io_context.run();
+  const auto elapsed = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+  std::cout << "protocol:        " << reader->protocol()
+            << (reader->compressed() ? " (zstd)" : "") << '\n';
+  std::cout << "recorded span:   "
+            << std::chrono::duration<double>(frames.back().timestamp).count()
+            << " s, " << frames.size() << " inbound / " << stats.outbound
+            << " outbound records" << '\n';
+  std::cout << "frames replayed: " << stats.frames << " (" << stats.non_events
+            << " without events)" << '\n';
+  std::cout << "events:          " << stats.events << ", handler calls "
+            << stats.handled << '\n';
+  std::cout << "elapsed:         " << elapsed << " s, "
+            << static_cast<double>(stats.frames) / elapsed << " frames/s, "
+            << static_cast<double>(stats.events) / elapsed << " events/s"
+            << '\n';
+  return 0;
+}
@@ -0,0 +1,551 @@
+#include <gtest/gtest.h>
+
+#include "dependency/bridge_bot/database_manager.hpp"
+#include <boost/asio.hpp>
+#include <filesystem>
+#include <thread>
+
+namespace obcx::test {
+
+using storage::CachedStatement;
+using storage::DatabaseManager;
+using storage::DatabaseOptions;
+using storage::LruCache;
+using storage::MessageMapping;
+using storage::MessageMappingCache;
+using storage::SqliteConnection;
+using storage::UserInfo;
+
+using namespace std::chrono_literals;
+
+namespace asio = boost::asio;
+
+namespace {
+
+auto count_rows(const std::string &path, std::string_view table) -> int {
+  SqliteConnection connection;
+  EXPECT_TRUE(connection.open(path, {.wal = false}, true));
+  CachedStatement stmt;
+  EXPECT_EQ(connection.prepare(
+                "SELECT COUNT(*) FROM " + std::string(table) + ";", stmt),
+            SQLITE_OK);
+  EXPECT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+  return sqlite3_column_int(stmt, 0);
+}
+
+// 每个测试使用独立的数据库文件，析构时删除
+class TempDatabase {
+public:
+  explicit TempDatabase(const DatabaseOptions &options = {})
+      : path_(std::filesystem::temp_directory_path() /
+              ("obcx-bridge-test-" +
+               std::to_string(reinterpret_cast<uintptr_t>(this)) + ".db")) {
+    remove_files();
+    db = std::make_unique<DatabaseManager>(path_.string(), options);
+    EXPECT_TRUE(db->initialize());
+  }
+  ~TempDatabase() {
+    db.reset();
+    remove_files();
+  }
+
+  [[nodiscard]] auto path() const -> std::string { return path_.string(); }
+
+  // 用独立连接读取 PRAGMA journal_mode
+  [[nodiscard]] auto journal_mode() const -> std::string {
+    SqliteConnection connection;
+    EXPECT_TRUE(connection.open(path(), {.wal = false}, true));
+    CachedStatement stmt;
+    EXPECT_EQ(connection.prepare("PRAGMA journal_mode;", stmt), SQLITE_OK);
+    EXPECT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    return reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0));
+  }
+
+  // 用独立连接统计已落盘的行数，不包含写队列中的数据
+  [[nodiscard]] auto committed_rows(std::string_view table) const -> int {
+    return count_rows(path(), table);
+  }
+
+  // 等待后台批次提交，最多等 timeout
+  [[nodiscard]] auto wait_for_rows(std::string_view table, int rows,
+                                   std::chrono::milliseconds timeout) const
+      -> bool {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (committed_rows(table) < rows) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      std::this_thread::sleep_for(5ms);
+    }
+    return true;
+  }
+
+  std::unique_ptr<DatabaseManager> db;
+
+private:
+  void remove_files() const {
+    for (const auto *suffix : {"", "-wal", "-shm"}) {
+      std::filesystem::remove(path_.string() + suffix);
+    }
+  }
+
+  std::filesystem::path path_;
+};
+
+auto mapping(const std::string &source, const std::string &target)
+    -> MessageMapping {
+  return MessageMapping{.source_platform = "qq",
+                        .source_message_id = source,
+                        .target_platform = "telegram",
+                        .target_message_id = target,
+                        .created_at = std::chrono::system_clock::now()};
+}
+
+// 在单线程 io_context 上运行协程直到完成
+template <typename Coroutine> void run(Coroutine coroutine) {
+  asio::io_context ioc;
+  std::exception_ptr error;
+  asio::co_spawn(ioc, std::move(coroutine),
+                 [&error](std::exception_ptr e) { error = std::move(e); });
+  ioc.run();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+} // namespace
+
+TEST(BridgeDatabaseTest, AsyncCallsRunOffTheCallerThread) {
+  TempDatabase temp;
+  auto &db = *temp.db;
+
+  run([&]() -> asio::awaitable<void> {
+    const auto caller = std::this_thread::get_id();
+    const auto worker =
+        co_await db.run_read([] { return std::this_thread::get_id(); });
+    EXPECT_NE(worker, caller);
+    // 完成后回到调用方线程
+    EXPECT_EQ(std::this_thread::get_id(), caller);
+
+    EXPECT_TRUE(co_await db.add_message_mapping_async(mapping("1", "100")));
+    EXPECT_EQ(std::this_thread::get_id(), caller);
+    EXPECT_EQ(co_await db.get_target_message_id_async("qq", "1", "telegram"),
+              "100");
+    EXPECT_EQ(co_await db.get_source_message_id_async("telegram", "100", "qq"),
+              "1");
+    EXPECT_FALSE(
+        co_await db.get_target_message_id_async("qq", "2", "telegram"));
+  });
+}
+
+TEST(BridgeDatabaseTest, ConcurrentWritesAreAllApplied) {
+  TempDatabase temp;
+  auto &db = *temp.db;
+  constexpr int kWrites = 200;
+
+  asio::io_context ioc;
+  int succeeded = 0;
+  for (int i = 0; i < kWrites; ++i) {
+    asio::co_spawn(
+        ioc,
+        [&db, &succeeded, i]() -> asio::awaitable<void> {
+          if (co_await db.add_message_mapping_async(
+                  mapping(std::to_string(i), std::to_string(i + 1000)))) {
+            ++succeeded;
+          }
+        },
+        asio::detached);
+  }
+  ioc.run();
+  EXPECT_EQ(succeeded, kWrites);
+
+  for (int i = 0; i < kWrites; i += 37) {
+    EXPECT_EQ(db.get_target_message_id("qq", std::to_string(i), "telegram"),
+              std::to_string(i + 1000));
+  }
+}
+
+TEST(BridgeDatabaseTest, ExceptionsPropagateToTheAwaiter) {
+  TempDatabase temp;
+  auto &db = *temp.db;
+
+  run([&]() -> asio::awaitable<void> {
+    const auto failing = []() -> int {
+      throw std::runtime_error("write failed");
+    };
+    EXPECT_THROW(co_await db.run_write(failing), std::runtime_error);
+    // 写线程在异常后仍可继续工作
+    EXPECT_TRUE(co_await db.update_platform_heartbeat_async(
+        "qq", std::chrono::system_clock::now()));
+    EXPECT_TRUE(co_await db.get_platform_heartbeat_async("qq"));
+  });
+}
+
+TEST(BridgeDatabaseTest, StatementsArePreparedOncePerConnection) {
+  TempDatabase temp;
+  SqliteConnection connection;
+  ASSERT_TRUE(connection.open(temp.path(), {}));
+
+  constexpr std::string_view kSql =
+      "SELECT target_message_id FROM message_mappings WHERE id = ?;";
+  sqlite3_stmt *first = nullptr;
+  {
+    CachedStatement stmt;
+    ASSERT_EQ(connection.prepare(kSql, stmt), SQLITE_OK);
+    first = stmt;
+    sqlite3_bind_int(stmt, 1, 1);
+    EXPECT_EQ(sqlite3_step(stmt), SQLITE_DONE);
+  }
+  // 归还时已 reset，不再持有读事务
+  EXPECT_FALSE(sqlite3_stmt_busy(first));
+
+  CachedStatement again;
+  ASSERT_EQ(connection.prepare(kSql, again), SQLITE_OK);
+  EXPECT_EQ(static_cast<sqlite3_stmt *>(again), first);
+  EXPECT_EQ(connection.cached_statements(), 1u);
+
+  CachedStatement broken;
+  EXPECT_NE(connection.prepare("SELECT FROM nowhere;", broken), SQLITE_OK);
+  EXPECT_EQ(connection.cached_statements(), 1u);
+}
+
+TEST(BridgeDatabaseTest, JournalModeFollowsOptions) {
+  {
+    TempDatabase temp;
+    EXPECT_EQ(temp.journal_mode(), "wal");
+    ASSERT_TRUE(temp.db->add_message_mapping(mapping("1", "100")));
+    EXPECT_EQ(temp.db->get_target_message_id("qq", "1", "telegram"), "100");
+  }
+  {
+    TempDatabase temp({.read_connections = 0, .wal = false});
+    EXPECT_EQ(temp.journal_mode(), "delete");
+    ASSERT_TRUE(temp.db->add_message_mapping(mapping("1", "100")));
+    EXPECT_EQ(temp.db->get_target_message_id("qq", "1", "telegram"), "100");
+  }
+}
+
+// 间隔足够长，只有行数上限或显式 flush() 会触发提交
+const DatabaseOptions kManualBatches{.batch_interval = 1h,
+                                         .batch_max_rows = 1000};
+
+TEST(BridgeDatabaseTest, PendingWritesAreReadableBeforeCommit) {
+  TempDatabase temp(kManualBatches);
+  auto &db = *temp.db;
+
+  ASSERT_TRUE(db.add_message_mapping(mapping("1", "100")));
+  ASSERT_TRUE(db.save_or_update_user(UserInfo{.platform = "qq",
+                                              .user_id = "42",
+                                              .group_id = "7",
+                                              .nickname = "Alice"}));
+  ASSERT_TRUE(
+      db.update_platform_heartbeat("qq", std::chrono::system_clock::now()));
+  EXPECT_EQ(temp.committed_rows("message_mappings"), 0);
+  EXPECT_EQ(temp.committed_rows("users"), 0);
+
+  EXPECT_EQ(db.get_target_message_id("qq", "1", "telegram"), "100");
+  EXPECT_EQ(db.get_source_message_id("telegram", "100", "qq"), "1");
+  EXPECT_EQ(db.get_user_display_name("qq", "42", "7"), "Alice");
+  EXPECT_FALSE(db.should_fetch_user_info("qq", "42", "7"));
+  EXPECT_TRUE(db.get_platform_heartbeat("qq"));
+
+  // 同一主键在队列中合并为一行
+  ASSERT_TRUE(db.add_message_mapping(mapping("1", "101")));
+  EXPECT_EQ(db.get_target_message_id("qq", "1", "telegram"), "101");
+
+  ASSERT_TRUE(db.flush());
+  EXPECT_EQ(temp.committed_rows("message_mappings"), 1);
+  EXPECT_EQ(temp.committed_rows("users"), 1);
+  EXPECT_EQ(temp.committed_rows("platform_heartbeats"), 1);
+  EXPECT_EQ(db.get_target_message_id("qq", "1", "telegram"), "101");
+}
+
+TEST(BridgeDatabaseTest, BatchesCommitOnRowLimitAndInterval) {
+  {
+    TempDatabase temp({.batch_interval = 1h, .batch_max_rows = 8});
+    for (int i = 0; i < 8; ++i) {
+      ASSERT_TRUE(temp.db->add_message_mapping(
+          mapping(std::to_string(i), std::to_string(i + 100))));
+    }
+    EXPECT_TRUE(temp.wait_for_rows("message_mappings", 8, 2s));
+  }
+  {
+    TempDatabase temp({.batch_interval = 20ms});
+    ASSERT_TRUE(temp.db->add_message_mapping(mapping("1", "100")));
+    EXPECT_TRUE(temp.wait_for_rows("message_mappings", 1, 2s));
+  }
+}
+
+TEST(BridgeDatabaseTest, MappingChangesSeeQueuedInserts) {
+  TempDatabase temp(kManualBatches);
+  auto &db = *temp.db;
+
+  ASSERT_TRUE(db.add_message_mapping(mapping("1", "100")));
+  ASSERT_TRUE(db.update_message_mapping("qq", "1", "telegram", "200"));
+  EXPECT_EQ(db.get_target_message_id("qq", "1", "telegram"), "200");
+
+  ASSERT_TRUE(db.add_message_mapping(mapping("2", "300")));
+  ASSERT_TRUE(db.delete_message_mapping("qq", "2", "telegram"));
+  EXPECT_FALSE(db.get_target_message_id("qq", "2", "telegram"));
+}
+
+TEST(BridgeDatabaseTest, DestructorCommitsQueuedWrites) {
+  TempDatabase temp(kManualBatches);
+  ASSERT_TRUE(temp.db->add_message_mapping(mapping("1", "100")));
+
+  temp.db.reset();
+  temp.db = std::make_unique<DatabaseManager>(temp.path(), kManualBatches);
+  ASSERT_TRUE(temp.db->initialize());
+  EXPECT_EQ(temp.committed_rows("message_mappings"), 1);
+  EXPECT_EQ(temp.db->get_target_message_id("qq", "1", "telegram"), "100");
+}
+
+TEST(BridgeDatabaseTest, DestructorStopsRetentionTimer) {
+  // 间隔为 0 时定时器回调总在排队，析构时必然有一个已到期的回调
+  TempDatabase temp({.retention_age = std::chrono::hours(24),
+                     .retention_interval = std::chrono::seconds(0)});
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  const auto started = std::chrono::steady_clock::now();
+  temp.db.reset();
+  EXPECT_LT(std::chrono::steady_clock::now() - started,
+            std::chrono::seconds(1));
+}
+
+TEST(BridgeDatabaseTest, UserLookupsAreServedFromCache) {
+  // 关闭写入批次，确保读取经过缓存而不是写队列
+  TempDatabase temp({.batch_interval = 0ms});
+  auto &db = *temp.db;
+
+  // 不存在的用户同样缓存
+  EXPECT_TRUE(db.should_fetch_user_info("qq", "42", "7"));
+  EXPECT_TRUE(db.should_fetch_user_info("qq", "42", "7"));
+  EXPECT_EQ(db.user_cache_stats().misses, 1u);
+  EXPECT_EQ(db.user_cache_stats().hits, 1u);
+
+  // 写入直接更新缓存，随后的读取不再查询数据库
+  const UserInfo alice{
+      .platform = "qq", .user_id = "42", .group_id = "7", .nickname = "Alice"};
+  ASSERT_TRUE(db.save_or_update_user(alice));
+  EXPECT_EQ(db.get_user_display_name("qq", "42", "7"), "Alice");
+  EXPECT_FALSE(db.should_fetch_user_info("qq", "42", "7"));
+  EXPECT_EQ(db.user_cache_stats().misses, 1u);
+
+  auto renamed = alice;
+  renamed.nickname = "Alicia";
+  ASSERT_TRUE(db.save_or_update_user(renamed));
+  EXPECT_EQ(db.get_user_display_name("qq", "42", "7"), "Alicia");
+  // 群组是键的一部分
+  EXPECT_EQ(db.get_user_display_name("qq", "42", "8"), "42");
+}
+
+TEST(BridgeDatabaseTest, FailedUserWriteIsNotCached) {
+  TempDatabase temp(kManualBatches);
+  auto &db = *temp.db;
+
+  // 用触发器让批次中的用户写入失败
+  SqliteConnection other;
+  ASSERT_TRUE(other.open(temp.path(), {.wal = false}));
+  ASSERT_TRUE(other.execute("CREATE TRIGGER fail_users BEFORE INSERT ON users "
+                            "BEGIN SELECT RAISE(ABORT, 'injected'); END;"));
+
+  const UserInfo alice{
+      .platform = "qq", .user_id = "42", .group_id = "7", .nickname = "Alice"};
+  ASSERT_TRUE(db.save_or_update_user(alice));
+  EXPECT_FALSE(db.flush());
+  EXPECT_EQ(temp.committed_rows("users"), 0);
+
+  // 相同的资料再次保存时仍会写入
+  ASSERT_TRUE(other.execute("DROP TRIGGER fail_users;"));
+  ASSERT_TRUE(db.save_or_update_user(alice));
+  ASSERT_TRUE(db.flush());
+  EXPECT_EQ(temp.committed_rows("users"), 1);
+}
+
+TEST(LruCacheTest, EvictsLeastRecentlyUsedAndExpiredEntries) {
+  LruCache<int, std::string> cache(2, 1h);
+  cache.put(1, "one");
+  cache.put(2, "two");
+  EXPECT_EQ(cache.get(1), "one");
+  cache.put(3, "three");
+  EXPECT_FALSE(cache.get(2));
+  EXPECT_EQ(cache.get(1), "one");
+  EXPECT_EQ(cache.get(3), "three");
+  EXPECT_EQ(cache.stats().evictions, 1u);
+
+  cache.put(4, "four", 1ms);
+  std::this_thread::sleep_for(5ms);
+  EXPECT_FALSE(cache.get(4));
+  EXPECT_EQ(cache.stats().size, 1u);
+}
+
+TEST(LruCacheTest, StaleFillsAreDiscarded) {
+  LruCache<int, std::string> cache(8, 1h);
+  const auto version = cache.version();
+  // 读者查询期间有写入，回填的旧值被丢弃
+  cache.put(1, "new");
+  EXPECT_FALSE(cache.put_if_unchanged(version, 1, "old"));
+  EXPECT_EQ(cache.get(1), "new");
+  EXPECT_TRUE(cache.put_if_unchanged(cache.version(), 2, "fresh"));
+}
+
+TEST(BridgeDatabaseTest, RecentMappingsResolveFromCache) {
+  TempDatabase temp({.batch_interval = 0ms});
+  auto &db = *temp.db;
+
+  ASSERT_TRUE(db.add_message_mapping(mapping("1", "100")));
+  EXPECT_EQ(db.get_target_message_id("qq", "1", "telegram"), "100");
+  EXPECT_EQ(db.get_source_message_id("telegram", "100", "qq"), "1");
+  EXPECT_EQ(db.mapping_cache_stats().hits, 2u);
+
+  // 编辑后旧的目标消息不再反查到源消息
+  ASSERT_TRUE(db.update_message_mapping("qq", "1", "telegram", "200"));
+  EXPECT_EQ(db.get_target_message_id("qq", "1", "telegram"), "200");
+  EXPECT_EQ(db.get_source_message_id("telegram", "200", "qq"), "1");
+  EXPECT_FALSE(db.get_source_message_id("telegram", "100", "qq"));
+
+  ASSERT_TRUE(db.delete_message_mapping("qq", "1", "telegram"));
+  EXPECT_FALSE(db.get_target_message_id("qq", "1", "telegram"));
+  EXPECT_FALSE(db.get_source_message_id("telegram", "200", "qq"));
+}
+
+TEST(BridgeDatabaseTest, LinkedMessagesResolveInBothDirections) {
+  for (const auto interval : {0ms, 1000ms}) {
+    TempDatabase temp({.batch_interval = interval, .mapping_cache_size = 0});
+    auto &db = *temp.db;
+    ASSERT_TRUE(db.add_message_mapping(mapping("1", "100")));
+
+    // 正向：QQ 消息转发到了 Telegram；反向：Telegram 消息来自 QQ
+    EXPECT_EQ(db.find_linked_message_id("qq", "1", "telegram"), "100");
+    EXPECT_EQ(db.find_linked_message_id("telegram", "100", "qq"), "1");
+    EXPECT_FALSE(db.find_linked_message_id("telegram", "1", "qq"));
+    ASSERT_TRUE(db.flush());
+    EXPECT_EQ(db.find_linked_message_id("telegram", "100", "qq"), "1");
+    EXPECT_FALSE(db.find_linked_message_id("qq", "100", "telegram"));
+  }
+}
+
+TEST(BridgeDatabaseTest, MappingCacheIsFilledFromTheDatabase) {
+  TempDatabase temp({.batch_interval = 0ms});
+  ASSERT_TRUE(temp.db->add_message_mapping(mapping("1", "100")));
+
+  // 新的管理器缓存为空，第一次查询回填两个方向
+  temp.db.reset();
+  temp.db = std::make_unique<DatabaseManager>(
+      temp.path(), DatabaseOptions{.batch_interval = 0ms});
+  ASSERT_TRUE(temp.db->initialize());
+  EXPECT_EQ(temp.db->get_target_message_id("qq", "1", "telegram"), "100");
+  EXPECT_EQ(temp.db->mapping_cache_stats().misses, 1u);
+  EXPECT_EQ(temp.db->get_source_message_id("telegram", "100", "qq"), "1");
+  EXPECT_EQ(temp.db->mapping_cache_stats().hits, 1u);
+}
+
+TEST(BridgeDatabaseTest, FailedMappingWriteIsNotCached) {
+  TempDatabase temp(kManualBatches);
+  auto &db = *temp.db;
+
+  // 用触发器让批次中的映射写入失败
+  SqliteConnection other;
+  ASSERT_TRUE(other.open(temp.path(), {.wal = false}));
+  ASSERT_TRUE(other.execute(
+      "CREATE TRIGGER fail_mappings BEFORE INSERT ON message_mappings "
+      "BEGIN SELECT RAISE(ABORT, 'injected'); END;"));
+
+  ASSERT_TRUE(db.add_message_mapping(mapping("1", "100")));
+  EXPECT_EQ(db.get_target_message_id("qq", "1", "telegram"), "100");
+  EXPECT_FALSE(db.flush());
+  EXPECT_EQ(temp.committed_rows("message_mappings"), 0);
+
+  // 未落盘的映射两个方向都不再由缓存返回
+  EXPECT_FALSE(db.get_target_message_id("qq", "1", "telegram"));
+  EXPECT_FALSE(db.get_source_message_id("telegram", "100", "qq"));
+}
+
+TEST(MessageMappingCacheTest, IndexesStayConsistentUnderEviction) {
+  MessageMappingCache cache(2, 1h);
+  cache.put("qq", "1", "telegram", "100");
+  cache.put("qq", "2", "telegram", "200");
+  // 同一源消息的新映射替换旧映射及其反向索引
+  cache.put("qq", "1", "telegram", "101");
+  EXPECT_FALSE(cache.find_source("telegram", "100", "qq"));
+  EXPECT_EQ(cache.find_source("telegram", "101", "qq"), "1");
+  EXPECT_EQ(cache.stats().size, 2u);
+
+  // "2" 最久未使用，被淘汰时两个方向一起删除
+  cache.put("qq", "3", "telegram", "300");
+  EXPECT_FALSE(cache.find_target("qq", "2", "telegram"));
+  EXPECT_FALSE(cache.find_source("telegram", "200", "qq"));
+  EXPECT_EQ(cache.find_target("qq", "3", "telegram"), "300");
+  EXPECT_EQ(cache.stats().evictions, 1u);
+
+  // 方向不同的映射互不干扰
+  cache.put("telegram", "300", "qq", "3");
+  EXPECT_EQ(cache.find_target("qq", "3", "telegram"), "300");
+  EXPECT_EQ(cache.find_target("telegram", "300", "qq"), "3");
+}
+
+TEST(BridgeDatabaseTest, RetentionArchivesExpiredRowsByMonth) {
+  const auto archive_dir = std::filesystem::temp_directory_path() /
+                           "obcx-bridge-test-archive";
+  std::filesystem::remove_all(archive_dir);
+  TempDatabase temp({.mapping_cache_size = 0,
+                     .retention_age = 24h,
+                     .archive_dir = archive_dir.string(),
+                     .retention_batch_rows = 4});
+  auto &db = *temp.db;
+
+  for (int i = 0; i < 10; ++i) {
+    db.add_message_mapping(mapping(std::to_string(i), "t" + std::to_string(i)));
+  }
+  ASSERT_TRUE(db.flush());
+  {
+    SqliteConnection connection;
+    ASSERT_TRUE(connection.open(temp.path(), {}));
+    ASSERT_TRUE(connection.execute(
+        "UPDATE message_mappings SET created_at = '2024-01-15 08:00:00' "
+        "WHERE id <= 5;"));
+    ASSERT_TRUE(connection.execute(
+        "UPDATE message_mappings SET created_at = '2024-02-03 08:00:00' "
+        "WHERE id BETWEEN 6 AND 8;"));
+
+    CachedStatement stmt;
+    ASSERT_EQ(connection.prepare("PRAGMA auto_vacuum;", stmt), SQLITE_OK);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    EXPECT_EQ(sqlite3_column_int(stmt, 0), 2); // INCREMENTAL
+  }
+
+  // 1 月的 5 行分两批，2 月的 3 行一批，最新的 2 行保留
+  EXPECT_EQ(db.apply_retention(), 8u);
+  EXPECT_EQ(temp.committed_rows("message_mappings"), 2);
+  EXPECT_FALSE(db.get_target_message_id("qq", "0", "telegram").has_value());
+  EXPECT_EQ(db.get_target_message_id("qq", "9", "telegram"), "t9");
+
+  const auto stem = std::filesystem::path(temp.path()).stem().string();
+  EXPECT_EQ(count_rows((archive_dir / (stem + "-2024-01.db")).string(),
+                       "message_mappings"),
+            5);
+  EXPECT_EQ(count_rows((archive_dir / (stem + "-2024-02.db")).string(),
+                       "message_mappings"),
+            3);
+  EXPECT_EQ(db.apply_retention(), 0u);
+
+  temp.db.reset();
+  std::filesystem::remove_all(archive_dir);
+}
+
+TEST(BridgeDatabaseTest, RetentionKeepsNewestRowsUnderRowLimit) {
+  TempDatabase temp({.mapping_cache_size = 0, .retention_max_rows = 3});
+  auto &db = *temp.db;
+
+  for (int i = 0; i < 10; ++i) {
+    db.add_message_mapping(mapping(std::to_string(i), "t" + std::to_string(i)));
+  }
+  ASSERT_TRUE(db.flush());
+
+  // 没有归档目录时直接删除
+  EXPECT_EQ(db.apply_retention(), 7u);
+  EXPECT_EQ(temp.committed_rows("message_mappings"), 3);
+  EXPECT_FALSE(db.get_target_message_id("qq", "6", "telegram").has_value());
+  EXPECT_EQ(db.get_target_message_id("qq", "7", "telegram"), "t7");
+}
+
+} // namespace obcx::test
@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+
+#include "common/config_loader.hpp"
+#include "common/config_watcher.hpp"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace obcx::test {
+
+using common::ConfigLoader;
+using common::ConfigSnapshot;
+using common::ConfigWatcher;
+
+namespace {
+
+constexpr std::string_view kConfig = R"(
+[metrics]
+enabled = true
+port = 9464
+ratio = 0.5
+hosts = ["a", "b"]
+
+[bots.qq_bot]
+type = "qq"
+enabled = true
+plugins = ["qq_to_tg"]
+
+[bots.qq_bot.connection]
+port = 3001
+
+[plugins.qq_to_tg]
+enabled = true
+callbacks = ["on_message"]
+
+[plugins.qq_to_tg.config]
+database_file = "bridge.db"
+max_in_flight = 8
+limits = { burst = 4.0 }
+)";
+
+// 每个测试独占的临时目录，析构时删除
+class TempDir {
+public:
+  TempDir()
+      : path_(std::filesystem::temp_directory_path() /
+              ("obcx-config-test-" +
+               std::to_string(reinterpret_cast<uintptr_t>(this)))) {
+    std::filesystem::create_directories(path_);
+  }
+  ~TempDir() { std::filesystem::remove_all(path_); }
+
+  [[nodiscard]] auto file(const std::string &name) const
+      -> std::filesystem::path {
+    return path_ / name;
+  }
+
+private:
+  std::filesystem::path path_;
+};
+
+void write_file(const std::filesystem::path &path, std::string_view text) {
+  std::ofstream(path, std::ios::trunc) << text;
+}
+
+template <typename Predicate>
+auto wait_until(Predicate predicate) -> bool {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  return true;
+}
+
+} // namespace
+
+TEST(ConfigSnapshotTest, FlattensScalarsByPath) {
+  const ConfigSnapshot snapshot(toml::parse(kConfig), 1);
+
+  EXPECT_EQ(snapshot.get<bool>("metrics.enabled"), true);
+  EXPECT_EQ(snapshot.get<int64_t>("metrics.port"), 9464);
+  EXPECT_EQ(snapshot.get<std::string>("metrics.hosts[1]"), "b");
+  EXPECT_EQ(snapshot.get<int64_t>("bots.qq_bot.connection.port"), 3001);
+  EXPECT_FALSE(snapshot.get<int64_t>("metrics.missing"));
+  EXPECT_FALSE(snapshot.get<std::string>("metrics.port"));
+
+  // 与 toml++ 的 value<T>() 一致，只做无损的数值转换
+  EXPECT_EQ(snapshot.get<double>("metrics.port"), 9464.0);
+  EXPECT_FALSE(snapshot.get<int64_t>("metrics.ratio"));
+}
+
+TEST(ConfigSnapshotTest, ParsesBotsAndPlugins) {
+  const ConfigSnapshot snapshot(toml::parse(kConfig), 1);
+
+  ASSERT_EQ(snapshot.bots().size(), 1u);
+  EXPECT_EQ(snapshot.bots()[0].type, "qq");
+  EXPECT_EQ(snapshot.bots()[0].plugins,
+            std::vector<std::string>{"qq_to_tg"});
+
+  const auto *plugin = snapshot.plugin("qq_to_tg");
+  ASSERT_NE(plugin, nullptr);
+  EXPECT_TRUE(plugin->info.enabled);
+  EXPECT_EQ(plugin->info.callbacks, std::vector<std::string>{"on_message"});
+  EXPECT_EQ(plugin->values.get<std::string>("database_file"), "bridge.db");
+  EXPECT_EQ(plugin->values.get<int64_t>("limits.burst"), 4);
+  EXPECT_EQ(snapshot.plugin("tg_to_qq"), nullptr);
+}
+
+TEST(ConfigSnapshotTest, ReloadPublishesNewSnapshot) {
+  const TempDir dir;
+  const auto path = dir.file("config.toml");
+  write_file(path, kConfig);
+
+  auto &loader = ConfigLoader::instance();
+  ASSERT_TRUE(loader.load_config(path.string()));
+  const auto first = loader.snapshot();
+
+  std::shared_ptr<const ConfigSnapshot> notified;
+  const auto subscription = loader.subscribe(
+      [&notified](const auto &snapshot) { notified = snapshot; });
+
+  write_file(path, "[metrics]\nport = 1234\n");
+  ASSERT_TRUE(loader.reload_config());
+  const auto second = loader.snapshot();
+  EXPECT_EQ(second->version(), first->version() + 1);
+  EXPECT_EQ(notified, second);
+  EXPECT_EQ(loader.get_value<int64_t>("metrics.port"), 1234);
+  // 旧快照仍可读取
+  EXPECT_EQ(first->get<int64_t>("metrics.port"), 9464);
+
+  // 解析失败时保留原快照
+  write_file(path, "[metrics\n");
+  EXPECT_FALSE(loader.reload_config());
+  EXPECT_EQ(loader.snapshot(), second);
+
+  loader.unsubscribe(subscription);
+  write_file(path, kConfig);
+  ASSERT_TRUE(loader.reload_config());
+  EXPECT_EQ(notified, second);
+}
+
+TEST(ConfigSnapshotTest, UnsubscribeWaitsForRunningListener) {
+  const TempDir dir;
+  const auto path = dir.file("config.toml");
+  write_file(path, kConfig);
+
+  auto &loader = ConfigLoader::instance();
+  ASSERT_TRUE(loader.load_config(path.string()));
+
+  std::atomic<bool> entered{false};
+  std::atomic<bool> release{false};
+  std::atomic<bool> returned{false};
+  const auto subscription = loader.subscribe([&](const auto &) {
+    entered = true;
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    returned = true;
+  });
+
+  std::thread reloader([&loader] { loader.reload_config(); });
+  ASSERT_TRUE(wait_until([&entered] { return entered.load(); }));
+
+  // 订阅者仍在运行时 unsubscribe() 不返回
+  std::atomic<bool> unsubscribed{false};
+  std::thread unsubscriber([&] {
+    loader.unsubscribe(subscription);
+    unsubscribed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(unsubscribed);
+
+  release = true;
+  unsubscriber.join();
+  reloader.join();
+  EXPECT_TRUE(unsubscribed);
+  EXPECT_TRUE(returned);
+}
+
+TEST(ConfigSnapshotTest, ListenerMayUnsubscribeItself) {
+  const TempDir dir;
+  const auto path = dir.file("config.toml");
+  write_file(path, kConfig);
+
+  auto &loader = ConfigLoader::instance();
+  ASSERT_TRUE(loader.load_config(path.string()));
+
+  int calls = 0;
+  uint64_t subscription = 0;
+  subscription = loader.subscribe([&](const auto &) {
+    ++calls;
+    loader.unsubscribe(subscription);
+  });
+
+  ASSERT_TRUE(loader.reload_config());
+  ASSERT_TRUE(loader.reload_config());
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ConfigSnapshotTest, WatcherReportsWritesAndRenames) {
+  const TempDir dir;
+  const auto path = dir.file("config.toml");
+  write_file(path, "a = 1\n");
+
+  std::atomic<int> changes{0};
+  ConfigWatcher watcher(
+      path.string(), [&changes] { ++changes; },
+      std::chrono::milliseconds(20));
+  ASSERT_TRUE(watcher.start());
+
+  write_file(path, "a = 2\n");
+  EXPECT_TRUE(wait_until([&] { return changes == 1; }));
+
+  // 编辑器常见的保存方式：写临时文件后 rename 覆盖
+  write_file(dir.file("config.toml.tmp"), "a = 3\n");
+  std::filesystem::rename(dir.file("config.toml.tmp"), path);
+  EXPECT_TRUE(wait_until([&] { return changes == 2; }));
+
+  write_file(dir.file("other.toml"), "b = 1\n");
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(changes, 2);
+
+  watcher.stop();
+}
+
+} // namespace obcx::test
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include "onebot11/adapter/event_converter.hpp"
+#include <future>
+#include <thread>
+
+namespace obcx::test {
+
+namespace EventConverter = adapter::onebot11::EventConverter;
+
+constexpr std::string_view kGroupRecall = R"({
+  "time": 1718000015, "self_id": 3889001234, "post_type": "notice",
+  "notice_type": "group_recall", "group_id": 987654321,
+  "user_id": 1122334455, "operator_id": 1122334455,
+  "message_id": -2093847561
+})";
+
+TEST(EventConverterTest, BuiltinPostTypes) {
+  auto message = EventConverter::from_v11_json(R"({
+    "time": 1718000001, "self_id": 1, "post_type": "message",
+    "message_type": "group", "sub_type": "normal", "message_id": 7,
+    "user_id": 2, "group_id": 3, "raw_message": "&#91;hi&#93;",
+    "message": [{"type": "text", "data": {"text": "[hi]"}}], "font": 0
+  })");
+  ASSERT_TRUE(message.has_value());
+  const auto &event = std::get<common::MessageEvent>(*message);
+  EXPECT_EQ(event.raw_message, "[hi]");
+  ASSERT_EQ(event.message.size(), 1U);
+  EXPECT_EQ(event.message[0].data["text"], "[hi]");
+
+  auto heartbeat = EventConverter::from_v11_json(
+      R"({"post_type": "meta_event", "meta_event_type": "heartbeat",
+          "interval": 30000, "status": {"online": true}})");
+  ASSERT_TRUE(heartbeat.has_value());
+  EXPECT_EQ(std::get<common::HeartbeatEvent>(*heartbeat).interval, 30000);
+
+  auto lifecycle = EventConverter::from_v11_json(
+      R"({"post_type": "meta_event", "meta_event_type": "lifecycle"})");
+  ASSERT_TRUE(lifecycle.has_value());
+  EXPECT_TRUE(std::holds_alternative<common::MetaEvent>(*lifecycle));
+}
+
+TEST(EventConverterTest, UnsignedIdsBeyondInt64KeepTheirDigits) {
+  auto message = EventConverter::from_v11_json(R"({
+    "time": 1718000001, "self_id": 1, "post_type": "message",
+    "message_type": "group", "sub_type": "normal", "message_id": 7,
+    "user_id": 18446744073709551615, "group_id": 9223372036854775807,
+    "raw_message": "", "message": [], "font": 0
+  })");
+  ASSERT_TRUE(message.has_value());
+  const auto &event = std::get<common::MessageEvent>(*message);
+  EXPECT_EQ(event.user_id, "18446744073709551615");
+  ASSERT_TRUE(event.group_id.has_value());
+  EXPECT_TRUE(event.group_id->is_numeric());
+  EXPECT_EQ(*event.group_id, "9223372036854775807");
+}
+
+TEST(EventConverterTest, RejectsUnknownPostType) {
+  EXPECT_FALSE(EventConverter::from_v11_json(R"({"post_type": "message_sent"})")
+                   .has_value());
+  EXPECT_FALSE(
+      EventConverter::from_v11_json(R"({"post_type": "mes"})").has_value());
+  EXPECT_FALSE(EventConverter::from_v11_json(R"({"time": 1})").has_value());
+  EXPECT_FALSE(EventConverter::from_v11_json("{").has_value());
+}
+
+TEST(EventConverterTest, OnlyTopLevelPostTypeCounts) {
+  // 嵌套对象里的同名字段不影响判断
+  auto notice = EventConverter::from_v11_json(
+      R"({"extra": {"post_type": "message_sent", "s": "\"post_type\""},
+          "post_type": "notice", "notice_type": "group_upload"})");
+  ASSERT_TRUE(notice.has_value());
+  EXPECT_TRUE(std::holds_alternative<common::NoticeEvent>(*notice));
+
+  EXPECT_FALSE(EventConverter::from_v11_json(
+                   R"({"extra": {"post_type": "notice"}})")
+                   .has_value());
+
+  // 带转义的值交给完整解析
+  auto escaped = EventConverter::from_v11_json(
+      R"({"post_type": "meta\u005fevent", "meta_event_type": "lifecycle"})");
+  ASSERT_TRUE(escaped.has_value());
+  EXPECT_TRUE(std::holds_alternative<common::MetaEvent>(*escaped));
+}
+
+TEST(EventConverterTest, ExtensionConverterOverridesBuiltin) {
+  EventConverter::register_converter(
+      "notice.group_recall",
+      [](const nlohmann::json &j) -> std::optional<common::Event> {
+        common::NoticeEvent event;
+        event.from_json(j);
+        event.data = j;
+        return event;
+      });
+
+  auto recall = EventConverter::from_v11_json(kGroupRecall);
+  ASSERT_TRUE(recall.has_value());
+  const auto &notice = std::get<common::NoticeEvent>(*recall);
+  EXPECT_EQ(notice.notice_type, "group_recall");
+  EXPECT_EQ(notice.data["message_id"], -2093847561);
+
+  EXPECT_TRUE(EventConverter::unregister_converter("notice.group_recall"));
+  EXPECT_FALSE(EventConverter::unregister_converter("notice.group_recall"));
+
+  recall = EventConverter::from_v11_json(kGroupRecall);
+  ASSERT_TRUE(recall.has_value());
+  EXPECT_TRUE(std::get<common::NoticeEvent>(*recall).data.is_null());
+}
+
+TEST(EventConverterTest, ExtensionConverterForUnknownPostType) {
+  EventConverter::register_converter(
+      "message_sent",
+      [](const nlohmann::json &j) -> std::optional<common::Event> {
+        common::MessageEvent event;
+        event.from_json(j);
+        return event;
+      });
+
+  auto sent = EventConverter::from_v11_json(
+      R"({"post_type": "message_sent", "message_type": "private",
+          "user_id": 42, "message": []})");
+  EventConverter::unregister_converter("message_sent");
+
+  ASSERT_TRUE(sent.has_value());
+  EXPECT_EQ(std::get<common::MessageEvent>(*sent).user_id, "42");
+}
+
+TEST(EventConverterTest, WaitIdleWaitsForRunningConverterOfOwner) {
+  std::promise<void> entered;
+  std::promise<void> resume;
+  auto resumed = resume.get_future().share();
+  {
+    // 与插件 initialize() 中注册时相同，转换函数记录所属者
+    const core::HandlerOwnerScope owner(7);
+    EventConverter::register_converter(
+        "notice.group_recall",
+        [&entered, resumed](
+            const nlohmann::json &) -> std::optional<common::Event> {
+          entered.set_value();
+          resumed.wait();
+          return common::NoticeEvent{};
+        });
+  }
+
+  std::thread converting(
+      [] { EXPECT_TRUE(EventConverter::from_v11_json(kGroupRecall)); });
+  entered.get_future().wait();
+
+  // 注销后正在运行的调用仍计入所属者，结束后 wait_idle() 才返回 true
+  EXPECT_EQ(EventConverter::unregister_owner(7), 1U);
+  EXPECT_FALSE(EventConverter::unregister_converter("notice.group_recall"));
+  EXPECT_FALSE(EventConverter::wait_idle(7, std::chrono::milliseconds(20)));
+  EXPECT_TRUE(EventConverter::wait_idle(8, std::chrono::milliseconds(0)));
+  resume.set_value();
+  EXPECT_TRUE(EventConverter::wait_idle(7, std::chrono::seconds(5)));
+  converting.join();
+}
+
+} // namespace obcx::test
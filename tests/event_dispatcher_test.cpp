@@ -0,0 +1,352 @@
+#include <gtest/gtest.h>
+
+#include "core/event_dispatcher.hpp"
+#include <atomic>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace obcx::test {
+
+using core::EventDispatcher;
+using core::HandlerOwnerScope;
+using core::IBot;
+
+namespace asio = boost::asio;
+
+namespace {
+
+using MessageHandler =
+    std::function<asio::awaitable<void>(IBot &, const common::MessageEvent &)>;
+
+auto message(std::string raw_message) -> common::MessageEvent {
+  common::MessageEvent event;
+  event.message_type = "group";
+  event.group_id = common::ChatId(int64_t{1}, common::Platform::qq);
+  event.raw_message = std::move(raw_message);
+  return event;
+}
+
+// 测试中的处理器不访问 bot，只需要一个非空指针
+auto fake_bot() -> IBot * {
+  alignas(std::max_align_t) static std::byte storage[64];
+  return reinterpret_cast<IBot *>(storage);
+}
+
+auto recorder(std::vector<std::string> &seen, std::string tag = "")
+    -> MessageHandler {
+  return [&seen, tag](IBot &, const common::MessageEvent &event)
+             -> asio::awaitable<void> {
+    seen.push_back(tag + event.raw_message);
+    co_return;
+  };
+}
+
+} // namespace
+
+TEST(EventDispatcherTest, OffRemovesOnlyThatHandler) {
+  asio::io_context ioc;
+  EventDispatcher dispatcher(ioc);
+  std::vector<std::string> seen;
+
+  const auto plain =
+      dispatcher.on<common::MessageEvent>(recorder(seen, "plain:"));
+  const auto filtered = dispatcher.on(core::MessageFilter{.group_ids = {"1"}},
+                                      recorder(seen, "filtered:"));
+  dispatcher.on<common::MessageEvent>(recorder(seen, "kept:"));
+  ASSERT_TRUE(plain && filtered);
+  EXPECT_NE(plain.id, filtered.id);
+  EXPECT_EQ(dispatcher.handler_count<common::MessageEvent>(), 3u);
+
+  EXPECT_TRUE(dispatcher.off(plain));
+  EXPECT_TRUE(dispatcher.off(filtered));
+  EXPECT_FALSE(dispatcher.off(plain));
+  EXPECT_FALSE(dispatcher.off({}));
+  EXPECT_EQ(dispatcher.handler_count<common::MessageEvent>(), 1u);
+
+  dispatcher.dispatch(fake_bot(), message("a"));
+  ioc.run();
+  EXPECT_EQ(seen, std::vector<std::string>{"kept:a"});
+}
+
+TEST(EventDispatcherTest, ReplaceFilterKeepsHandler) {
+  asio::io_context ioc;
+  EventDispatcher dispatcher(ioc);
+  std::vector<std::string> seen;
+
+  const auto token = dispatcher.on(core::MessageFilter{.group_ids = {"2"}},
+                                   recorder(seen));
+  dispatcher.dispatch(fake_bot(), message("a"));
+  EXPECT_TRUE(
+      dispatcher.replace_filter(token, core::MessageFilter{.group_ids = {"1"}}));
+  dispatcher.dispatch(fake_bot(), message("b"));
+  EXPECT_EQ(dispatcher.handler_count<common::MessageEvent>(), 1u);
+
+  EXPECT_TRUE(dispatcher.off(token));
+  EXPECT_FALSE(dispatcher.replace_filter(token, core::MessageFilter{}));
+  EXPECT_FALSE(dispatcher.replace_filter({}, core::MessageFilter{}));
+  ioc.run();
+  EXPECT_EQ(seen, std::vector<std::string>{"b"});
+}
+
+TEST(EventDispatcherTest, OwnerScopeTagsHandlers) {
+  asio::io_context ioc;
+  EventDispatcher dispatcher(ioc);
+  std::vector<std::string> seen;
+
+  {
+    const HandlerOwnerScope owner(7);
+    EXPECT_EQ(HandlerOwnerScope::current(), 7u);
+    dispatcher.on<common::MessageEvent>(recorder(seen, "owned:"));
+    dispatcher.on(core::MessageFilter{}, recorder(seen, "owned:"));
+  }
+  EXPECT_EQ(HandlerOwnerScope::current(), 0u);
+  dispatcher.on<common::MessageEvent>(recorder(seen, "other:"));
+
+  EXPECT_EQ(dispatcher.off_owner(0), 0u);
+  EXPECT_EQ(dispatcher.off_owner(7), 2u);
+  EXPECT_EQ(dispatcher.handler_count<common::MessageEvent>(), 1u);
+
+  dispatcher.dispatch(fake_bot(), message("a"));
+  ioc.run();
+  EXPECT_EQ(seen, std::vector<std::string>{"other:a"});
+}
+
+TEST(EventDispatcherTest, HeldEventsKeepTheirOrder) {
+  asio::io_context ioc;
+  EventDispatcher dispatcher(ioc);
+  std::vector<std::string> seen;
+
+  dispatcher.hold();
+  dispatcher.dispatch(fake_bot(), message("1"));
+  dispatcher.dispatch(fake_bot(), message("2"));
+  // 暂存期间注册的处理器同样收到暂存的事件
+  dispatcher.on<common::MessageEvent>(recorder(seen));
+  ioc.poll();
+  EXPECT_TRUE(seen.empty());
+
+  dispatcher.release();
+  // 回放之前到达的事件排在暂存事件之后
+  dispatcher.dispatch(fake_bot(), message("3"));
+  ioc.restart();
+  ioc.run();
+  EXPECT_EQ(seen, (std::vector<std::string>{"1", "2", "3"}));
+
+  dispatcher.dispatch(fake_bot(), message("4"));
+  ioc.restart();
+  ioc.run();
+  EXPECT_EQ(seen.back(), "4");
+}
+
+TEST(EventDispatcherTest, NestedHoldReplaysOnOutermostRelease) {
+  asio::io_context ioc;
+  EventDispatcher dispatcher(ioc);
+  std::vector<std::string> seen;
+  dispatcher.on<common::MessageEvent>(recorder(seen));
+
+  dispatcher.hold();
+  dispatcher.hold();
+  dispatcher.dispatch(fake_bot(), message("1"));
+  dispatcher.release();
+  ioc.run();
+  EXPECT_TRUE(seen.empty());
+
+  // 回放已投递但尚未执行时再次 hold()，回放留给配对的 release()
+  ioc.restart();
+  dispatcher.release();
+  dispatcher.hold();
+  dispatcher.dispatch(fake_bot(), message("2"));
+  ioc.restart();
+  ioc.run();
+  EXPECT_TRUE(seen.empty());
+
+  dispatcher.release();
+  ioc.restart();
+  ioc.run();
+  EXPECT_EQ(seen, (std::vector<std::string>{"1", "2"}));
+}
+
+TEST(EventDispatcherTest, HandlersMayRegisterAndDispatchFromInside) {
+  asio::io_context ioc;
+  EventDispatcher dispatcher(ioc);
+  std::vector<std::string> seen;
+
+  // 处理器可能在 co_spawn 内同步运行，其中注册、注销与再次分发不能死锁
+  core::HandlerToken self;
+  self = dispatcher.on<common::MessageEvent>(
+      [&](IBot &bot, const common::MessageEvent &event)
+          -> asio::awaitable<void> {
+        seen.push_back("outer:" + event.raw_message);
+        dispatcher.off(self);
+        dispatcher.on<common::MessageEvent>(recorder(seen, "inner:"));
+        dispatcher.dispatch(&bot, message("b"));
+        co_return;
+      });
+
+  dispatcher.dispatch(fake_bot(), message("a"));
+  ioc.run();
+  EXPECT_EQ(seen, (std::vector<std::string>{"outer:a", "inner:b"}));
+}
+
+TEST(EventDispatcherTest, HandlerMayHoldDuringReplay) {
+  asio::io_context ioc;
+  EventDispatcher dispatcher(ioc);
+  std::vector<std::string> seen;
+  dispatcher.on<common::MessageEvent>(
+      [&](IBot &bot, const common::MessageEvent &event)
+          -> asio::awaitable<void> {
+        seen.push_back(event.raw_message);
+        if (event.raw_message == "1") {
+          // 回放时不持锁，处理器中可以再次暂存
+          dispatcher.hold();
+          dispatcher.dispatch(&bot, message("x"));
+          dispatcher.release();
+        }
+        co_return;
+      });
+
+  dispatcher.hold();
+  dispatcher.dispatch(fake_bot(), message("1"));
+  dispatcher.dispatch(fake_bot(), message("2"));
+  dispatcher.release();
+  ioc.run();
+  EXPECT_EQ(seen, (std::vector<std::string>{"1", "2", "x"}));
+
+  dispatcher.dispatch(fake_bot(), message("3"));
+  ioc.restart();
+  ioc.run();
+  EXPECT_EQ(seen.back(), "3");
+}
+
+TEST(EventDispatcherTest, WaitIdleWaitsForOwnerHandlers) {
+  asio::io_context ioc;
+  auto work = asio::make_work_guard(ioc);
+  std::thread runner([&ioc] { ioc.run(); });
+
+  EventDispatcher dispatcher(ioc);
+  std::atomic<bool> finished{false};
+  {
+    const HandlerOwnerScope owner(5);
+    dispatcher.on<common::MessageEvent>(
+        [&finished](IBot &,
+                    const common::MessageEvent &) -> asio::awaitable<void> {
+          asio::steady_timer timer(co_await asio::this_coro::executor,
+                                   std::chrono::milliseconds(50));
+          co_await timer.async_wait(asio::use_awaitable);
+          finished = true;
+        });
+  }
+
+  dispatcher.dispatch(fake_bot(), message("a"));
+  EXPECT_FALSE(dispatcher.wait_idle(5, std::chrono::milliseconds(1)));
+  EXPECT_EQ(dispatcher.in_flight(5), 1u);
+  EXPECT_EQ(dispatcher.in_flight(6), 0u);
+  EXPECT_TRUE(dispatcher.wait_idle(5, std::chrono::seconds(5)));
+  EXPECT_TRUE(finished);
+  EXPECT_EQ(dispatcher.in_flight(5), 0u);
+
+  work.reset();
+  runner.join();
+}
+
+TEST(EventDispatcherTest, HoldWaitsForRoutesBeingSelected) {
+  asio::io_context ioc;
+  EventDispatcher dispatcher(ioc);
+  std::vector<std::string> seen;
+  {
+    const HandlerOwnerScope owner(5);
+    dispatcher.on<common::MessageEvent>(recorder(seen));
+  }
+
+  // 后注册的谓词在选出处理器期间阻塞，此时所属者 5 的处理器已被选中
+  std::promise<void> selecting;
+  std::promise<void> resume;
+  auto resumed = resume.get_future().share();
+  dispatcher.on<common::MessageEvent>(
+      [&selecting, resumed](const common::MessageEvent &) {
+        selecting.set_value();
+        resumed.wait();
+        return false;
+      },
+      recorder(seen, "other:"));
+
+  std::thread dispatching(
+      [&dispatcher] { dispatcher.dispatch(fake_bot(), message("a")); });
+  selecting.get_future().wait();
+
+  // hold() 等选出的处理器登记后才返回，之后 wait_idle() 能看到它
+  auto held = std::async(std::launch::async, [&dispatcher] {
+    dispatcher.hold();
+    return dispatcher.in_flight(5);
+  });
+  EXPECT_EQ(held.wait_for(std::chrono::milliseconds(50)),
+            std::future_status::timeout);
+  resume.set_value();
+  EXPECT_EQ(held.get(), 1u);
+  dispatching.join();
+  EXPECT_FALSE(dispatcher.wait_idle(5, std::chrono::milliseconds(1)));
+
+  ioc.run();
+  EXPECT_EQ(seen, (std::vector<std::string>{"a"}));
+  EXPECT_TRUE(dispatcher.wait_idle(5, std::chrono::milliseconds(1)));
+  dispatcher.release();
+}
+
+TEST(EventDispatcherTest, DrainWaitsForCancelledHandlersToExit) {
+  asio::io_context ioc;
+  auto work = asio::make_work_guard(ioc);
+  std::thread runner([&ioc] { ioc.run(); });
+
+  EventDispatcher dispatcher(ioc);
+  std::atomic<bool> unwound{false};
+  dispatcher.on<common::MessageEvent>(
+      [&unwound](IBot &,
+                 const common::MessageEvent &) -> asio::awaitable<void> {
+        asio::steady_timer timer(co_await asio::this_coro::executor,
+                                 std::chrono::hours(1));
+        try {
+          co_await timer.async_wait(asio::use_awaitable);
+        } catch (const boost::system::system_error &) {
+          unwound = true;
+          throw;
+        }
+      });
+
+  dispatcher.dispatch(fake_bot(), message("a"));
+  // 超时后取消，返回前被取消的处理器已经退出，调用方可以直接停止 io_context
+  EXPECT_EQ(dispatcher.drain(std::chrono::milliseconds(20)), 0u);
+  EXPECT_TRUE(unwound);
+  EXPECT_EQ(dispatcher.in_flight(), 0u);
+
+  work.reset();
+  runner.join();
+}
+
+TEST(EventDispatcherTest, DrainOnStoppedContextCancelsInPlace) {
+  asio::io_context ioc;
+  EventDispatcher dispatcher(ioc);
+  dispatcher.on<common::MessageEvent>(
+      [](IBot &, const common::MessageEvent &) -> asio::awaitable<void> {
+        asio::steady_timer timer(co_await asio::this_coro::executor,
+                                 std::chrono::hours(1));
+        co_await timer.async_wait(asio::use_awaitable);
+      });
+
+  dispatcher.dispatch(fake_bot(), message("a"));
+  ioc.poll();
+  ioc.stop();
+  EXPECT_FALSE(dispatcher.draining());
+  // 不等待，直接取消仍在运行的处理器
+  EXPECT_EQ(dispatcher.drain(std::chrono::seconds(5)), 1u);
+  EXPECT_TRUE(dispatcher.draining());
+
+  ioc.restart();
+  ioc.run_for(std::chrono::seconds(5));
+  EXPECT_EQ(dispatcher.in_flight(), 0u);
+
+  dispatcher.resume();
+  EXPECT_FALSE(dispatcher.draining());
+}
+
+} // namespace obcx::test
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include "common/event_journal.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace obcx::test {
+
+using common::JournalDirection;
+using common::JournalReader;
+using common::JournalWriter;
+
+namespace {
+
+class EventJournalTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path_ = (std::filesystem::temp_directory_path() /
+             ("obcx_journal_" +
+              std::string(::testing::UnitTest::GetInstance()
+                              ->current_test_info()
+                              ->name()) +
+              ".bin"))
+                .string();
+  }
+
+  void TearDown() override { std::filesystem::remove(path_); }
+
+  // 写入若干条记录，其中一条超过写缓冲区
+  void write_sample(bool compress) {
+    JournalWriter writer(path_, "onebot11",
+                         {.compress = compress, .buffer_size = 256});
+    writer.record(JournalDirection::inbound, R"({"post_type":"message"})");
+    writer.record(JournalDirection::outbound, R"({"action":"send_msg"})");
+    writer.record(JournalDirection::inbound, std::string(1000, 'x'));
+    writer.record(JournalDirection::inbound, "");
+  }
+
+  void expect_sample(JournalReader &reader) {
+    EXPECT_EQ(reader.protocol(), "onebot11");
+
+    auto first = reader.next();
+    ASSERT_TRUE(first);
+    EXPECT_EQ(first->direction, JournalDirection::inbound);
+    EXPECT_EQ(first->payload, R"({"post_type":"message"})");
+
+    auto second = reader.next();
+    ASSERT_TRUE(second);
+    EXPECT_EQ(second->direction, JournalDirection::outbound);
+    EXPECT_EQ(second->payload, R"({"action":"send_msg"})");
+    EXPECT_GE(second->timestamp, first->timestamp);
+
+    auto third = reader.next();
+    ASSERT_TRUE(third);
+    EXPECT_EQ(third->payload, std::string(1000, 'x'));
+
+    auto fourth = reader.next();
+    ASSERT_TRUE(fourth);
+    EXPECT_TRUE(fourth->payload.empty());
+
+    EXPECT_FALSE(reader.next());
+    EXPECT_FALSE(reader.truncated());
+  }
+
+  std::string path_;
+};
+
+} // namespace
+
+TEST_F(EventJournalTest, RoundTrip) {
+  write_sample(false);
+  JournalReader reader(path_);
+  EXPECT_FALSE(reader.compressed());
+  expect_sample(reader);
+}
+
+TEST_F(EventJournalTest, CompressedRoundTrip) {
+  if (!JournalWriter::compression_supported()) {
+    GTEST_SKIP() << "built without OBCX_JOURNAL_ZSTD";
+  }
+  write_sample(true);
+  JournalReader reader(path_);
+  EXPECT_TRUE(reader.compressed());
+  expect_sample(reader);
+}
+
+TEST_F(EventJournalTest, DetectsTruncatedTail) {
+  write_sample(false);
+  std::filesystem::resize_file(path_, std::filesystem::file_size(path_) - 10);
+
+  JournalReader reader(path_);
+  int records = 0;
+  while (reader.next()) {
+    ++records;
+  }
+  EXPECT_EQ(records, 2);
+  EXPECT_TRUE(reader.truncated());
+}
+
+TEST_F(EventJournalTest, RejectsOtherFiles) {
+  std::ofstream(path_) << "not a journal";
+  EXPECT_THROW(JournalReader{path_}, std::runtime_error);
+}
+
+TEST_F(EventJournalTest, OpenForRequiresJournalPath) {
+  common::ConnectionConfig config;
+  EXPECT_EQ(JournalWriter::open_for(config, "onebot11"), nullptr);
+
+  config.journal_path = path_;
+  EXPECT_NE(JournalWriter::open_for(config, "onebot11"), nullptr);
+  EXPECT_TRUE(std::filesystem::exists(path_));
+}
+
+} // namespace obcx::test
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include "core/handler_policy.hpp"
+
+namespace obcx::test {
+
+using core::HandlerPolicy;
+using core::HandlerQueue;
+
+namespace {
+
+auto group_message(int64_t group_id, std::string raw_message)
+    -> std::shared_ptr<const common::Event> {
+  common::MessageEvent event;
+  event.message_type = "group";
+  event.group_id = common::ChatId(group_id, common::Platform::qq);
+  event.raw_message = std::move(raw_message);
+  return std::make_shared<const common::Event>(std::move(event));
+}
+
+auto text_of(const HandlerQueue::Job &job) -> std::string {
+  return std::get<common::MessageEvent>(*job.event).raw_message;
+}
+
+} // namespace
+
+TEST(HandlerPolicyTest, ChatKey) {
+  EXPECT_EQ(HandlerPolicy::chat_key(*group_message(42, "")), "g42");
+
+  common::MessageEvent private_message;
+  private_message.user_id = common::UserId(int64_t{7});
+  EXPECT_EQ(HandlerPolicy::chat_key(private_message), "u7");
+
+  EXPECT_EQ(HandlerPolicy::chat_key(common::HeartbeatEvent{}), "");
+}
+
+TEST(HandlerPolicyTest, MaxInFlight) {
+  HandlerQueue queue({.name = "test", .max_in_flight = 2});
+
+  auto a = queue.submit(group_message(1, "a"));
+  auto b = queue.submit(group_message(2, "b"));
+  ASSERT_TRUE(a && b);
+  EXPECT_FALSE(queue.submit(group_message(3, "c")));
+  EXPECT_FALSE(queue.submit(group_message(4, "d")));
+
+  auto stats = queue.stats();
+  EXPECT_EQ(stats.in_flight, 2U);
+  EXPECT_EQ(stats.queued, 2U);
+
+  auto c = queue.complete(*b);
+  ASSERT_TRUE(c);
+  EXPECT_EQ(text_of(*c), "c");
+  auto d = queue.complete(*a);
+  ASSERT_TRUE(d);
+  EXPECT_EQ(text_of(*d), "d");
+  EXPECT_FALSE(queue.complete(*c));
+  EXPECT_FALSE(queue.complete(*d));
+
+  stats = queue.stats();
+  EXPECT_EQ(stats.name, "test");
+  EXPECT_EQ(stats.in_flight, 0U);
+  EXPECT_EQ(stats.queued, 0U);
+  EXPECT_EQ(stats.peak_queued, 2U);
+  EXPECT_EQ(stats.completed, 4U);
+}
+
+TEST(HandlerPolicyTest, NamedQueueExportsGauges) {
+  auto &registry = common::MetricsRegistry::instance();
+  {
+    HandlerQueue queue({.name = "gauge_test", .max_in_flight = 1});
+    auto a = queue.submit(group_message(1, "a"));
+    ASSERT_TRUE(a);
+    EXPECT_FALSE(queue.submit(group_message(2, "b")));
+    EXPECT_FALSE(queue.submit(group_message(3, "c")));
+
+    const auto text = registry.render_prometheus();
+    EXPECT_NE(text.find(R"(obcx_handler_queued{handler="gauge_test"} 2)"),
+              std::string::npos);
+    EXPECT_NE(text.find(R"(obcx_handler_in_flight{handler="gauge_test"} 1)"),
+              std::string::npos);
+  }
+  // 队列析构后不再导出
+  EXPECT_EQ(registry.render_prometheus().find(R"(handler="gauge_test")"),
+            std::string::npos);
+}
+
+TEST(HandlerPolicyTest, SerialPerKeyKeepsOrder) {
+  HandlerQueue queue({.serial_key = &HandlerPolicy::chat_key});
+
+  auto first = queue.submit(group_message(1, "1-first"));
+  auto other = queue.submit(group_message(2, "2-first"));
+  ASSERT_TRUE(first && other);
+  EXPECT_FALSE(queue.submit(group_message(1, "1-second")));
+  EXPECT_FALSE(queue.submit(group_message(1, "1-third")));
+  EXPECT_EQ(queue.stats().queued, 2U);
+
+  // 其他群不受影响
+  EXPECT_FALSE(queue.complete(*other));
+
+  auto second = queue.complete(*first);
+  ASSERT_TRUE(second);
+  EXPECT_EQ(text_of(*second), "1-second");
+  auto third = queue.complete(*second);
+  ASSERT_TRUE(third);
+  EXPECT_EQ(text_of(*third), "1-third");
+  EXPECT_FALSE(queue.complete(*third));
+
+  // 串行键空闲后，新事件立即运行
+  EXPECT_TRUE(queue.submit(group_message(1, "1-fourth")));
+}
+
+TEST(HandlerPolicyTest, SerialKeyWithConcurrencyLimit) {
+  HandlerQueue queue(
+      {.max_in_flight = 1, .serial_key = &HandlerPolicy::chat_key});
+
+  auto a1 = queue.submit(group_message(1, "a1"));
+  ASSERT_TRUE(a1);
+  EXPECT_FALSE(queue.submit(group_message(2, "b1")));
+  EXPECT_FALSE(queue.submit(group_message(1, "a2")));
+
+  // b1 先进入就绪队列，a2 只能等 a1 结束后再排到 b1 后面
+  auto b1 = queue.complete(*a1);
+  ASSERT_TRUE(b1);
+  EXPECT_EQ(text_of(*b1), "b1");
+  auto a2 = queue.complete(*b1);
+  ASSERT_TRUE(a2);
+  EXPECT_EQ(text_of(*a2), "a2");
+  EXPECT_FALSE(queue.complete(*a2));
+  EXPECT_EQ(queue.stats().completed, 3U);
+}
+
+} // namespace obcx::test
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <unordered_set>
+
+#include "common/id.hpp"
+#include "common/message_type.hpp"
+
+namespace obcx::test {
+
+using common::Id;
+using common::Platform;
+
+TEST(IdTest, NumericRoundTrip) {
+  Id id(int64_t{2458061234}, Platform::qq);
+  EXPECT_TRUE(id.is_numeric());
+  EXPECT_EQ(id.view(), "2458061234");
+  EXPECT_STREQ(id.c_str(), "2458061234");
+  EXPECT_EQ(id.as_int(), 2458061234);
+
+  Id negative(int64_t{-1001234567890}, Platform::telegram);
+  EXPECT_EQ(negative.view(), "-1001234567890");
+  EXPECT_EQ(Id(std::string_view("-1001234567890"), Platform::telegram),
+            negative);
+}
+
+TEST(IdTest, NonCanonicalTextStaysText) {
+  for (std::string_view text : {"007", "-0", "+1", "@channel", "1a"}) {
+    Id id(text);
+    EXPECT_FALSE(id.is_numeric()) << text;
+    EXPECT_EQ(id.view(), text);
+  }
+  EXPECT_TRUE(Id(std::string_view("0")).is_numeric());
+}
+
+TEST(IdTest, InternedTextComparesByIdentity) {
+  Id a(std::string_view("@obcx_bridge"), Platform::telegram);
+  Id b(std::string("@obcx_bridge"), Platform::telegram);
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(a.c_str(), b.c_str());
+  EXPECT_EQ(a.hash(), b.hash());
+}
+
+TEST(IdTest, InternedTextIsReleasedWithLastId) {
+  const auto before = Id::interned_count();
+  {
+    Id a(std::string_view("@released_with_last_id"), Platform::telegram);
+    EXPECT_EQ(Id::interned_count(), before + 1);
+
+    Id copy = a;
+    Id moved = std::move(a);
+    Id again(std::string_view("@released_with_last_id"));
+    EXPECT_EQ(Id::interned_count(), before + 1);
+    EXPECT_EQ(copy.c_str(), moved.c_str());
+    EXPECT_EQ(again.view(), "@released_with_last_id");
+
+    copy = Id(int64_t{1});
+    EXPECT_EQ(moved.view(), "@released_with_last_id");
+  }
+  EXPECT_EQ(Id::interned_count(), before);
+}
+
+TEST(IdTest, PlatformIsPartOfIdentity) {
+  Id qq(int64_t{123}, Platform::qq);
+  Id tg(int64_t{123}, Platform::telegram);
+  EXPECT_NE(qq, tg);
+  EXPECT_EQ(qq, "123");
+  EXPECT_EQ(tg, "123");
+
+  std::unordered_set<Id> ids{qq, tg};
+  EXPECT_EQ(ids.size(), 2U);
+}
+
+TEST(IdTest, EmptyId) {
+  Id id;
+  EXPECT_TRUE(id.empty());
+  EXPECT_EQ(id.view(), "");
+  EXPECT_STREQ(id.c_str(), "");
+  EXPECT_EQ(Id(std::string_view("")), id);
+}
+
+TEST(IdTest, MessageEventJsonIds) {
+  auto j = common::json::parse(R"({
+    "time": 1718000000, "self_id": 10001, "post_type": "message",
+    "message_type": "group", "sub_type": "normal", "message_id": "abc",
+    "user_id": 2458061234, "group_id": 987654321, "message": [],
+    "raw_message": "", "font": 0
+  })");
+
+  common::MessageEvent event;
+  event.from_json(j);
+  EXPECT_EQ(event.user_id, Id(int64_t{2458061234}, Platform::qq));
+  EXPECT_EQ(event.message_id, "abc");
+  ASSERT_TRUE(event.group_id.has_value());
+  EXPECT_EQ(*event.group_id, "987654321");
+
+  common::json out;
+  event.to_json(out);
+  EXPECT_TRUE(out["user_id"].is_number_integer());
+  EXPECT_TRUE(out["message_id"].is_string());
+}
+
+TEST(IdTest, UnsignedIdsBeyondInt64DoNotWrap) {
+  auto j = common::json::parse(R"({
+    "time": 1718000000, "self_id": 10001, "post_type": "message",
+    "message_type": "group", "sub_type": "normal", "message_id": 1,
+    "user_id": 18446744073709551615, "group_id": 9223372036854775808,
+    "message": [], "raw_message": "", "font": 0
+  })");
+
+  common::MessageEvent event;
+  event.from_json(j);
+  EXPECT_EQ(event.user_id, "18446744073709551615");
+  EXPECT_FALSE(event.user_id.is_numeric());
+  ASSERT_TRUE(event.group_id.has_value());
+  EXPECT_EQ(*event.group_id, "9223372036854775808");
+
+  // int64_t 范围内的无符号值仍按数字保存
+  const auto max = Id::from_unsigned(9223372036854775807ULL, Platform::qq);
+  EXPECT_TRUE(max.is_numeric());
+  EXPECT_EQ(max.as_int(), std::numeric_limits<int64_t>::max());
+}
+
+TEST(IdTest, ErrorEventTargetKeepsPlatform) {
+  common::ErrorEvent event{
+      .error_type = "message_error",
+      .error_message = {},
+      .target_id = common::ChatId(int64_t{-100123}, Platform::telegram),
+      .is_group = true,
+      .time = {},
+      .context = {},
+      .trace_id = 0};
+
+  common::json j;
+  event.to_json(j);
+  common::ErrorEvent parsed;
+  parsed.from_json(j);
+  EXPECT_EQ(parsed.target_id, event.target_id);
+
+  // 未注明平台的旧数据按 OneBot 事件处理，与其他事件的ID一致
+  j.erase("platform");
+  j["target_id"] = 123;
+  parsed.from_json(j);
+  EXPECT_EQ(parsed.target_id, Id(int64_t{123}, Platform::qq));
+}
+
+} // namespace obcx::test
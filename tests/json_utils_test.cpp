@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include "common/json_backend.hpp"
+#include "common/json_utils.hpp"
+
+namespace obcx::test {
+
+using common::json;
+namespace JsonUtils = common::JsonUtils;
+
+class JsonUtilsTest : public ::testing::Test {
+protected:
+  json doc = json::parse(R"({
+    "post_type": "message",
+    "font": 14,
+    "anonymous": null,
+    "message": [{"type": "text", "data": {"text": "hi"}}],
+    "a/b": {"m~n": 1},
+    "": {"": 2}
+  })");
+};
+
+TEST_F(JsonUtilsTest, GetValueWithStringViewKeys) {
+  std::string_view key = "post_type";
+  EXPECT_EQ(JsonUtils::get_value<std::string>(doc, key), "message");
+  EXPECT_EQ(JsonUtils::get_value<int>(doc, "font"), 14);
+  EXPECT_EQ(JsonUtils::get_value<int>(doc, "post_type", -1), -1);
+  EXPECT_EQ(JsonUtils::get_value<std::string>(doc, "anonymous", "none"),
+            "none");
+  EXPECT_FALSE(JsonUtils::get_optional<int>(doc, "missing").has_value());
+}
+
+TEST_F(JsonUtilsTest, ValidateRequiredFields) {
+  EXPECT_TRUE(JsonUtils::validate_required_fields(doc, {"post_type", "font"}));
+  EXPECT_FALSE(JsonUtils::validate_required_fields(doc, {"anonymous"}));
+  EXPECT_FALSE(
+      JsonUtils::validate_required_fields(doc, std::vector<std::string>{"x"}));
+}
+
+TEST_F(JsonUtilsTest, FindPath) {
+  EXPECT_EQ(JsonUtils::find_path(doc, ""), &doc);
+  EXPECT_TRUE(JsonUtils::has_path(doc, "/message/0/data/text"));
+  EXPECT_EQ(JsonUtils::get_by_path<std::string>(doc, "/message/0/data/text"),
+            "hi");
+  EXPECT_EQ(JsonUtils::get_by_path<int>(doc, "/a~1b/m~0n"), 1);
+  EXPECT_EQ(JsonUtils::get_by_path<int>(doc, "//"), 2);
+
+  EXPECT_FALSE(JsonUtils::has_path(doc, "/message/1"));
+  EXPECT_FALSE(JsonUtils::has_path(doc, "/message/01"));
+  EXPECT_FALSE(JsonUtils::has_path(doc, "/message/-"));
+  EXPECT_FALSE(JsonUtils::has_path(doc, "/font/0"));
+  EXPECT_FALSE(JsonUtils::has_path(doc, "message/0"));
+  EXPECT_FALSE(JsonUtils::has_path(doc, "/a~2b"));
+  EXPECT_EQ(JsonUtils::get_by_path<int>(doc, "/post_type", 7), 7);
+}
+
+TEST_F(JsonUtilsTest, PrecomputedPath) {
+  const JsonUtils::JsonPath text("/message/0/data/text");
+  const JsonUtils::JsonPath escaped("/a~1b/m~0n");
+  const JsonUtils::JsonPath malformed("message");
+
+  EXPECT_TRUE(text.valid());
+  EXPECT_EQ(JsonUtils::get_by_path<std::string>(doc, text), "hi");
+  EXPECT_EQ(JsonUtils::get_by_path<int>(doc, escaped), 1);
+  EXPECT_FALSE(malformed.valid());
+  EXPECT_FALSE(JsonUtils::has_path(doc, malformed));
+}
+
+TEST(JsonBackendTest, PeekField) {
+  namespace JsonBackend = common::JsonBackend;
+  const std::string_view response =
+      R"({"data": {"echo": 1}, "retcode": 0, "echo": 42, "s": "a\"b"})";
+
+  EXPECT_EQ(JsonBackend::peek_field(response, "echo"), "42");
+  EXPECT_EQ(JsonBackend::peek_field(response, "retcode"), "0");
+  EXPECT_EQ(JsonBackend::peek_field(response, "s"), R"("a\"b")");
+  EXPECT_EQ(JsonBackend::peek_field(R"({"post_type":"message"})",
+                                    "post_type"),
+            R"("message")");
+  EXPECT_EQ(JsonBackend::peek_field(R"({"time": 1})", "echo"), "");
+  EXPECT_EQ(JsonBackend::peek_field(response, "data"), std::nullopt);
+  EXPECT_EQ(JsonBackend::peek_field(R"([{"echo": 1}])", "echo"),
+            std::nullopt);
+  EXPECT_EQ(JsonBackend::peek_field(R"({"time": 1)", "echo"), std::nullopt);
+}
+
+} // namespace obcx::test
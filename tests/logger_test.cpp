@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+// 本文件按 info 级别编译，验证更低级别的日志调用被整体移除
+#undef OBCX_ACTIVE_LEVEL
+#define OBCX_ACTIVE_LEVEL SPDLOG_LEVEL_INFO
+
+#include "common/logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <spdlog/sinks/base_sink.h>
+#include <spdlog/sinks/ringbuffer_sink.h>
+#include <thread>
+
+namespace obcx::test {
+
+using common::AsyncLogOptions;
+using common::Logger;
+
+namespace {
+
+// 第一条日志在 open() 之前一直阻塞，用来把异步队列填满
+class GateSink : public spdlog::sinks::base_sink<std::mutex> {
+public:
+  void wait_entered() {
+    std::unique_lock lock(gate_mutex_);
+    changed_.wait(lock, [this] { return entered_; });
+  }
+
+  void open() {
+    std::lock_guard lock(gate_mutex_);
+    open_ = true;
+    changed_.notify_all();
+  }
+
+  auto count() -> std::size_t {
+    std::lock_guard lock(gate_mutex_);
+    return count_;
+  }
+
+protected:
+  void sink_it_(const spdlog::details::log_msg &) override {
+    std::unique_lock lock(gate_mutex_);
+    entered_ = true;
+    ++count_;
+    changed_.notify_all();
+    changed_.wait(lock, [this] { return open_; });
+  }
+
+  void flush_() override {}
+
+private:
+  std::mutex gate_mutex_;
+  std::condition_variable changed_;
+  bool entered_ = false;
+  bool open_ = false;
+  std::size_t count_ = 0;
+};
+
+// 给默认日志器加一个输出，测试结束时移除
+template <typename Sink> class ScopedSink {
+public:
+  explicit ScopedSink(std::shared_ptr<Sink> sink) : sink_(std::move(sink)) {
+    Logger::get()->sinks().push_back(sink_);
+  }
+  ~ScopedSink() {
+    auto &sinks = Logger::get()->sinks();
+    std::erase(sinks, sink_);
+  }
+  ScopedSink(const ScopedSink &) = delete;
+  auto operator=(const ScopedSink &) -> ScopedSink & = delete;
+
+  auto operator->() const -> Sink * { return sink_.get(); }
+
+private:
+  std::shared_ptr<Sink> sink_;
+};
+
+} // namespace
+
+TEST(LoggerTest, RawMatchesDefaultLogger) {
+  EXPECT_EQ(Logger::raw(), Logger::get().get());
+}
+
+TEST(LoggerTest, FilteredCallsDoNotEvaluateArguments) {
+  int evaluated = 0;
+  auto expensive = [&evaluated] {
+    ++evaluated;
+    return std::string("payload");
+  };
+
+  Logger::set_level(spdlog::level::warn);
+  OBCX_INFO("filtered at runtime: {}", expensive());
+  EXPECT_EQ(evaluated, 0);
+  OBCX_WARN("logged: {}", expensive());
+  EXPECT_EQ(evaluated, 1);
+
+  // 运行时级别放开到 trace，编译期下限仍为 info
+  Logger::set_level(spdlog::level::trace);
+  OBCX_DEBUG("removed at compile time: {}", expensive());
+  OBCX_TRACE("removed at compile time: {}", expensive());
+  EXPECT_EQ(evaluated, 1);
+  OBCX_INFO("logged: {}", expensive());
+  EXPECT_EQ(evaluated, 2);
+
+  Logger::set_level(spdlog::level::info);
+}
+
+TEST(LoggerTest, DisableAsyncWritesOutQueuedMessages) {
+  ScopedSink sink(std::make_shared<spdlog::sinks::ringbuffer_sink_mt>(2000));
+  auto *sync_logger = Logger::raw();
+
+  Logger::enable_async({.queue_size = 2048, .threads = 1});
+  EXPECT_NE(Logger::raw(), sync_logger);
+  for (int i = 0; i < 1000; ++i) {
+    OBCX_INFO("async message {}", i);
+  }
+  Logger::disable_async();
+
+  const auto lines = sink->last_raw();
+  ASSERT_GE(lines.size(), 1000u);
+  EXPECT_EQ(lines.back().payload, "async message 999");
+  EXPECT_EQ(Logger::raw(), Logger::get().get());
+
+  // 被替换的日志器仍然可用
+  sync_logger->info("retired logger still alive");
+}
+
+TEST(LoggerTest, ReenablingAsyncKeepsRetiredPoolAlive) {
+  ScopedSink sink(std::make_shared<spdlog::sinks::ringbuffer_sink_mt>(100));
+
+  Logger::enable_async({.queue_size = 64, .threads = 1});
+  auto *first = Logger::raw();
+  std::size_t errors = 0;
+  first->set_error_handler([&errors](const std::string &) { ++errors; });
+
+  // 重建后旧的异步日志器可能仍被其他线程持有，其线程池必须还在
+  Logger::enable_async({.queue_size = 64, .threads = 2});
+  EXPECT_NE(Logger::raw(), first);
+  first->info("from retired async logger");
+  Logger::disable_async();
+  EXPECT_EQ(errors, 0u);
+
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  auto written = [&sink] {
+    const auto lines = sink->last_raw();
+    return std::ranges::any_of(lines, [](const auto &line) {
+      return line.payload == "from retired async logger";
+    });
+  };
+  while (!written() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_TRUE(written());
+}
+
+TEST(LoggerTest, OverrunOldestDropsInsteadOfBlocking) {
+  auto gate = std::make_shared<GateSink>();
+  ScopedSink sink(gate);
+
+  Logger::enable_async(
+      {.queue_size = 4,
+       .threads = 1,
+       .overflow = spdlog::async_overflow_policy::overrun_oldest});
+  // Logger::enable_async 自身的日志占住后台线程
+  gate->wait_entered();
+  for (int i = 0; i < 14; ++i) {
+    OBCX_INFO("overrun message {}", i);
+  }
+  EXPECT_EQ(Logger::dropped(), 10u);
+
+  gate->open();
+  Logger::disable_async();
+  EXPECT_EQ(gate->count(), 1u + 4u);
+  EXPECT_EQ(Logger::dropped(), 0u);
+}
+
+} // namespace obcx::test
@@ -0,0 +1,170 @@
+#include <gtest/gtest.h>
+
+#include "core/message_filter.hpp"
+
+namespace obcx::test {
+
+using core::MessageFilter;
+using core::MessageFilterIndex;
+
+namespace {
+
+auto group_message(std::string_view group_id, std::string raw_message)
+    -> common::MessageEvent {
+  common::MessageEvent event;
+  event.self_id = common::UserId(int64_t{10001}, common::Platform::qq);
+  event.message_type = "group";
+  event.group_id = common::ChatId(group_id, common::Platform::qq);
+  event.raw_message = std::move(raw_message);
+  return event;
+}
+
+auto matches(const MessageFilterIndex &index, const common::MessageEvent &e)
+    -> std::vector<uint32_t> {
+  std::vector<uint32_t> result;
+  index.match(e, result);
+  return result;
+}
+
+} // namespace
+
+TEST(MessageFilterTest, EmptyFilterMatchesEverything) {
+  MessageFilterIndex index;
+  index.add({});
+  EXPECT_EQ(matches(index, group_message("1", "hello")),
+            std::vector<uint32_t>{0});
+}
+
+TEST(MessageFilterTest, GroupIdsIgnorePlatform) {
+  MessageFilterIndex index;
+  index.add({.group_ids = {"987654321", "123"}});
+  index.add({.group_ids = {"555"}});
+
+  EXPECT_EQ(matches(index, group_message("123", "hi")),
+            std::vector<uint32_t>{0});
+  EXPECT_EQ(matches(index, group_message("555", "hi")),
+            std::vector<uint32_t>{1});
+  EXPECT_TRUE(matches(index, group_message("777", "hi")).empty());
+
+  auto private_message = group_message("123", "hi");
+  private_message.group_id.reset();
+  EXPECT_TRUE(matches(index, private_message).empty());
+}
+
+TEST(MessageFilterTest, CommandsRequireWordBoundary) {
+  MessageFilterIndex index;
+  index.add({.commands = {"/status"}});
+  index.add({.commands = {"/s", "/reupload"}});
+
+  EXPECT_EQ(matches(index, group_message("1", "/status")),
+            std::vector<uint32_t>{0});
+  EXPECT_EQ(matches(index, group_message("1", "/status@obcx_bot now")),
+            std::vector<uint32_t>{0});
+  EXPECT_EQ(matches(index, group_message("1", "/s x")),
+            std::vector<uint32_t>{1});
+  EXPECT_EQ(matches(index, group_message("1", "/reupload 42")),
+            std::vector<uint32_t>{1});
+  EXPECT_TRUE(matches(index, group_message("1", "/statusx")).empty());
+  EXPECT_TRUE(matches(index, group_message("1", "say /status")).empty());
+}
+
+TEST(MessageFilterTest, ConditionsAreCombined) {
+  MessageFilterIndex index;
+  index.add({.group_ids = {"1"}, .commands = {"/ping"}});
+  index.add({.message_type = "private"});
+  index.add({.predicate = [](const common::MessageEvent &event) {
+    return event.raw_message.find("magnet:?") != std::string::npos;
+  }});
+
+  EXPECT_EQ(matches(index, group_message("1", "/ping")),
+            std::vector<uint32_t>{0});
+  EXPECT_TRUE(matches(index, group_message("2", "/ping")).empty());
+  EXPECT_EQ(matches(index, group_message("2", "/ping magnet:?xt=urn")),
+            std::vector<uint32_t>{2});
+
+  auto private_message = group_message("1", "/ping");
+  private_message.message_type = "private";
+  EXPECT_EQ(matches(index, private_message), (std::vector<uint32_t>{0, 1}));
+}
+
+TEST(MessageFilterTest, MentionSelf) {
+  MessageFilterIndex index;
+  index.add({.mention_self = true});
+
+  auto event = group_message("1", "[CQ:at,qq=10001] hi");
+  EXPECT_TRUE(matches(index, event).empty());
+
+  event.message.push_back({.type = "at", .data = {{"qq", "20002"}}});
+  EXPECT_TRUE(matches(index, event).empty());
+
+  event.message.push_back({.type = "at", .data = {{"qq", 10001}}});
+  EXPECT_EQ(matches(index, event), std::vector<uint32_t>{0});
+}
+
+TEST(MessageFilterTest, ResultsKeepRegistrationOrder) {
+  MessageFilterIndex index;
+  index.add({.commands = {"/help"}});
+  index.add({.group_ids = {"1"}});
+  index.add({});
+
+  EXPECT_EQ(matches(index, group_message("1", "/help")),
+            (std::vector<uint32_t>{0, 1, 2}));
+}
+
+TEST(MessageFilterTest, RemovedFiltersStopMatching) {
+  MessageFilterIndex index;
+  index.add({.commands = {"/help"}});
+  index.add({.group_ids = {"1"}});
+  index.add({});
+  index.add({.commands = {"/help"}});
+
+  index.remove(0);
+  index.remove(1);
+  index.remove(1); // 重复移除无影响
+  EXPECT_EQ(index.size(), 2u);
+  EXPECT_EQ(matches(index, group_message("1", "/help")),
+            (std::vector<uint32_t>{2, 3}));
+
+  // 空出的槽位被复用，结果仍按注册顺序
+  index.remove(2);
+  EXPECT_EQ(index.add({.group_ids = {"1"}}), 2u);
+  EXPECT_EQ(index.size(), 2u);
+  EXPECT_EQ(matches(index, group_message("1", "/help")),
+            (std::vector<uint32_t>{3, 2}));
+
+  EXPECT_EQ(index.add({}), 1u);
+  EXPECT_EQ(index.add({}), 0u);
+  EXPECT_EQ(index.add({}), 4u);
+}
+
+TEST(MessageFilterTest, ReplaceKeepsSlotAndOrder) {
+  MessageFilterIndex index;
+  index.add({.group_ids = {"1"}});
+  index.add({.group_ids = {"1"}});
+
+  index.replace(0, {.group_ids = {"2"}});
+  EXPECT_EQ(index.size(), 2u);
+  EXPECT_EQ(matches(index, group_message("1", "hi")),
+            std::vector<uint32_t>{1});
+  EXPECT_EQ(matches(index, group_message("2", "hi")),
+            std::vector<uint32_t>{0});
+
+  // 换回后仍排在先注册的位置
+  index.replace(0, {.group_ids = {"1", "2"}});
+  EXPECT_EQ(matches(index, group_message("1", "hi")),
+            (std::vector<uint32_t>{0, 1}));
+
+  // 副本与原索引互不影响
+  MessageFilterIndex copy = index;
+  copy.replace(1, {.commands = {"/help"}});
+  EXPECT_EQ(matches(copy, group_message("1", "hi")),
+            std::vector<uint32_t>{0});
+  EXPECT_EQ(matches(index, group_message("1", "hi")),
+            (std::vector<uint32_t>{0, 1}));
+
+  index.remove(1);
+  index.replace(1, {});
+  EXPECT_EQ(index.size(), 1u);
+}
+
+} // namespace obcx::test
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include "common/metrics.hpp"
+#include "network/metrics_server.hpp"
+#include <boost/asio/connect.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <thread>
+#include <vector>
+
+namespace obcx::test {
+
+using common::Histogram;
+using common::MetricsRegistry;
+
+namespace {
+
+// 向本地端口发送一个 HTTP 请求，返回完整响应
+auto http_get(uint16_t port, const std::string &target) -> std::string {
+  boost::asio::io_context ioc;
+  boost::asio::ip::tcp::socket socket(ioc);
+  socket.connect({boost::asio::ip::make_address("127.0.0.1"), port});
+  const auto request =
+      "GET " + target + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  boost::asio::write(socket, boost::asio::buffer(request));
+
+  std::string response;
+  boost::system::error_code ec;
+  boost::asio::read(socket, boost::asio::dynamic_buffer(response), ec);
+  return response;
+}
+
+} // namespace
+
+TEST(MetricsTest, CounterSumsAcrossThreads) {
+  MetricsRegistry registry;
+  auto &counter = registry.counter("test_events_total", "events");
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&counter] {
+      for (int i = 0; i < 10000; ++i) {
+        counter.inc();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(counter.value(), 40000u);
+  EXPECT_EQ(&registry.counter("test_events_total", "events"), &counter);
+}
+
+TEST(MetricsTest, RejectsInvalidNamesAndTypeClashes) {
+  MetricsRegistry registry;
+  EXPECT_THROW(registry.counter("bad-name", ""), std::invalid_argument);
+  EXPECT_THROW(registry.counter("ok_total", "", {{"bad label", "x"}}),
+               std::invalid_argument);
+  registry.counter("shared_name", "");
+  EXPECT_THROW(registry.gauge("shared_name", ""), std::invalid_argument);
+}
+
+TEST(MetricsTest, HistogramBucketsAreContiguous) {
+  for (std::size_t bucket = 1; bucket < Histogram::kBuckets; ++bucket) {
+    const auto lower = Histogram::bucket_upper_bound(bucket - 1);
+    EXPECT_EQ(Histogram::bucket_of(lower), bucket) << lower;
+    EXPECT_EQ(Histogram::bucket_of(Histogram::bucket_upper_bound(bucket) - 1),
+              bucket);
+  }
+  EXPECT_EQ(Histogram::bucket_of(UINT64_MAX), Histogram::kBuckets - 1);
+}
+
+TEST(MetricsTest, HistogramQuantilesWithinBucketError) {
+  Histogram histogram;
+  for (uint64_t us = 1; us <= 1000; ++us) {
+    histogram.record(std::chrono::microseconds(us));
+  }
+  const auto snapshot = histogram.snapshot();
+  EXPECT_EQ(snapshot.count, 1000u);
+  EXPECT_EQ(snapshot.sum, 500500u * 1000u);
+
+  for (const auto [q, expected] :
+       {std::pair{0.5, 500'000.0}, {0.99, 990'000.0}, {1.0, 1'000'000.0}}) {
+    const auto value = static_cast<double>(snapshot.quantile(q));
+    EXPECT_GE(value, expected) << q;
+    EXPECT_LE(value, expected * 1.125) << q;
+  }
+  EXPECT_EQ(Histogram{}.snapshot().quantile(0.5), 0u);
+}
+
+TEST(MetricsTest, RendersPrometheusText) {
+  MetricsRegistry registry;
+  registry.counter("test_requests_total", "Requests", {{"method", "GET"}})
+      .inc(3);
+  registry.gauge("test_depth", "Depth").set(-2);
+  registry.histogram("test_latency_seconds", "Latency")
+      .record(std::chrono::milliseconds(2));
+
+  const auto text = registry.render_prometheus();
+  EXPECT_NE(text.find("# TYPE test_requests_total counter\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_requests_total{method=\"GET\"} 3\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_depth -2\n"), std::string::npos);
+  EXPECT_NE(text.find("# TYPE test_latency_seconds summary\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_latency_seconds{quantile=\"0.5\"} 0.002"),
+            std::string::npos);
+  EXPECT_NE(text.find("test_latency_seconds_count 1\n"), std::string::npos);
+}
+
+TEST(MetricsTest, ObservedGaugesAreSummedAndUnregistered) {
+  MetricsRegistry registry;
+  auto first =
+      registry.observe("test_pending", "Pending", {}, [] { return 2.0; });
+  {
+    auto second =
+        registry.observe("test_pending", "Pending", {}, [] { return 5.0; });
+    EXPECT_NE(registry.render_prometheus().find("test_pending 7\n"),
+              std::string::npos);
+  }
+  EXPECT_NE(registry.render_prometheus().find("test_pending 2\n"),
+            std::string::npos);
+  first.reset();
+  EXPECT_EQ(registry.render_prometheus().find("test_pending 2\n"),
+            std::string::npos);
+}
+
+TEST(MetricsTest, ServerExposesMetrics) {
+  MetricsRegistry registry;
+  registry.counter("test_served_total", "Served").inc();
+
+  network::MetricsServer server("127.0.0.1", 0, registry);
+  server.start();
+  ASSERT_NE(server.port(), 0);
+
+  const auto ok = http_get(server.port(), "/metrics");
+  EXPECT_TRUE(ok.starts_with("HTTP/1.1 200")) << ok;
+  EXPECT_NE(ok.find("text/plain; version=0.0.4"), std::string::npos);
+  EXPECT_NE(ok.find("test_served_total 1\n"), std::string::npos);
+
+  EXPECT_TRUE(http_get(server.port(), "/").starts_with("HTTP/1.1 404"));
+  server.stop();
+}
+
+} // namespace obcx::test
@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+
+#include "common/plugin_manager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+namespace obcx::test {
+
+using common::detail::PluginInitTask;
+using common::detail::run_init_tasks;
+
+namespace {
+
+// 记录每个任务的开始与结束顺序
+class InitRecorder {
+public:
+  auto run(const std::string &name, std::chrono::milliseconds work,
+           bool result = true) -> bool {
+    {
+      std::lock_guard lock(mutex_);
+      events_.push_back("+" + name);
+      ++running_;
+      peak_ = std::max(peak_, running_);
+    }
+    std::this_thread::sleep_for(work);
+    std::lock_guard lock(mutex_);
+    events_.push_back("-" + name);
+    --running_;
+    return result;
+  }
+
+  [[nodiscard]] auto position(const std::string &event) const -> std::size_t {
+    return static_cast<std::size_t>(
+        std::ranges::find(events_, event) - events_.begin());
+  }
+
+  [[nodiscard]] auto events() const -> const std::vector<std::string> & {
+    return events_;
+  }
+
+  [[nodiscard]] auto peak() const -> int { return peak_; }
+
+private:
+  std::mutex mutex_;
+  std::vector<std::string> events_;
+  int running_ = 0;
+  int peak_ = 0;
+};
+
+struct TestPlugin : interface::IPlugin {
+  static auto metadata() -> const interface::PluginMetadata & {
+    static constexpr const char *kDependencies[] = {"base", nullptr};
+    static constexpr interface::PluginMetadata kMetadata{
+        .name = "test", .version = "1.0", .dependencies = kDependencies};
+    return kMetadata;
+  }
+};
+
+} // namespace
+
+static_assert(interface::HasPluginMetadata<TestPlugin>);
+static_assert(!interface::HasPluginMetadata<interface::IPlugin>);
+
+TEST(PluginManagerTest, IndependentPluginsInitializeConcurrently) {
+  InitRecorder recorder;
+  const std::vector<PluginInitTask> tasks{{.name = "a"}, {.name = "b"},
+                                          {.name = "c"}};
+
+  const auto started = std::chrono::steady_clock::now();
+  const auto results = run_init_tasks(tasks, [&](const std::string &name) {
+    return recorder.run(name, std::chrono::milliseconds(100));
+  });
+  const auto elapsed = std::chrono::steady_clock::now() - started;
+
+  EXPECT_EQ(recorder.peak(), 3);
+  EXPECT_LT(elapsed, std::chrono::milliseconds(250));
+  for (const auto &task : tasks) {
+    EXPECT_TRUE(results.at(task.name));
+  }
+}
+
+TEST(PluginManagerTest, DependenciesInitializeFirst) {
+  InitRecorder recorder;
+  const std::vector<PluginInitTask> tasks{
+      {.name = "bridge", .dependencies = {"db", "config"}},
+      {.name = "db", .dependencies = {"config"}},
+      {.name = "config"},
+      {.name = "other"}};
+
+  const auto results = run_init_tasks(tasks, [&](const std::string &name) {
+    return recorder.run(name, std::chrono::milliseconds(20));
+  });
+
+  EXPECT_LT(recorder.position("-config"), recorder.position("+db"));
+  EXPECT_LT(recorder.position("-db"), recorder.position("+bridge"));
+  // 无依赖的插件不必等待依赖链
+  EXPECT_LT(recorder.position("+other"), recorder.position("-config"));
+  EXPECT_EQ(std::ranges::count_if(
+                results, [](const auto &result) { return result.second; }),
+            4);
+}
+
+TEST(PluginManagerTest, FailedMissingAndCyclicDependenciesAreSkipped) {
+  InitRecorder recorder;
+  const std::vector<PluginInitTask> tasks{
+      {.name = "broken"},
+      {.name = "needs_broken", .dependencies = {"broken"}},
+      {.name = "needs_missing", .dependencies = {"missing"}},
+      {.name = "cycle_a", .dependencies = {"cycle_b"}},
+      {.name = "cycle_b", .dependencies = {"cycle_a"}},
+      {.name = "fine"}};
+
+  const auto results = run_init_tasks(tasks, [&](const std::string &name) {
+    if (name == "fine") {
+      throw std::runtime_error("init throws");
+    }
+    return recorder.run(name, std::chrono::milliseconds(1), false);
+  });
+
+  for (const auto &task : tasks) {
+    EXPECT_FALSE(results.at(task.name)) << task.name;
+  }
+  // 只有 broken 真正运行过
+  EXPECT_EQ(recorder.events(),
+            (std::vector<std::string>{"+broken", "-broken"}));
+}
+
+TEST(PluginManagerTest, ExclusivePluginsRunAlone) {
+  InitRecorder recorder;
+  const std::vector<PluginInitTask> tasks{
+      {.name = "a"}, {.name = "legacy", .exclusive = true}, {.name = "b"}};
+
+  const auto results = run_init_tasks(tasks, [&](const std::string &name) {
+    return recorder.run(name, std::chrono::milliseconds(30));
+  });
+
+  const auto start = recorder.position("+legacy");
+  const auto end = recorder.position("-legacy");
+  ASSERT_EQ(end, start + 1);
+  for (const auto &name : {"a", "b"}) {
+    EXPECT_TRUE(results.at(name));
+  }
+  EXPECT_TRUE(results.at("legacy"));
+}
+
+TEST(PluginManagerTest, ReadMetadataRejectsMissingLibrary) {
+  EXPECT_FALSE(
+      common::PluginManager::read_metadata("/nonexistent/libplugin.so"));
+}
+
+} // namespace obcx::test
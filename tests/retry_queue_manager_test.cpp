@@ -0,0 +1,416 @@
+#include <gtest/gtest.h>
+
+#include "dependency/bridge_bot/retry_queue_manager.hpp"
+#include <atomic>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace obcx::test {
+
+using bridge::RetryLimits;
+using bridge::RetryQueueManager;
+using bridge::RetryWorker;
+using storage::DatabaseManager;
+using storage::MessageRetryInfo;
+
+using namespace std::chrono_literals;
+
+namespace asio = boost::asio;
+
+namespace {
+
+class RetryQueueManagerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path_ = (std::filesystem::temp_directory_path() /
+             ("obcx_retry_" +
+              std::string(::testing::UnitTest::GetInstance()
+                              ->current_test_info()
+                              ->name()) +
+              ".db"))
+                .string();
+    remove_files();
+    db_ = std::make_shared<DatabaseManager>(path_);
+    ASSERT_TRUE(db_->initialize());
+    retries_ = std::make_unique<RetryQueueManager>(db_, ioc_);
+
+    // 记录第一次重试的时间，成功后停止处理
+    retries_->register_message_send_callback(
+        "telegram",
+        [this](const MessageRetryInfo &, const common::Message &)
+            -> asio::awaitable<RetryQueueManager::SendResult> {
+          attempted_at_ = std::chrono::steady_clock::now();
+          retries_->stop();
+          co_return RetryQueueManager::SendResult{.message_id = "42"};
+        });
+  }
+
+  void TearDown() override {
+    retries_.reset();
+    db_.reset();
+    remove_files();
+  }
+
+  // 运行 io_context 直到处理协程结束，返回从测试开始到第一次重试的时间
+  auto run_until_attempt() -> std::optional<std::chrono::milliseconds> {
+    retries_->start();
+    ioc_.run_for(5s);
+    if (!attempted_at_) {
+      return std::nullopt;
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        *attempted_at_ - started_);
+  }
+
+  std::shared_ptr<DatabaseManager> db_;
+  std::unique_ptr<RetryQueueManager> retries_;
+  asio::io_context ioc_;
+
+private:
+  void remove_files() const {
+    for (const auto *suffix : {"", "-wal", "-shm"}) {
+      std::filesystem::remove(path_ + suffix);
+    }
+  }
+
+  std::string path_;
+  std::chrono::steady_clock::time_point started_ =
+      std::chrono::steady_clock::now();
+  std::optional<std::chrono::steady_clock::time_point> attempted_at_;
+};
+
+auto text_message(const std::string &text) -> common::Message {
+  common::MessageSegment segment;
+  segment.type = "text";
+  segment.data["text"] = text;
+  return {segment};
+}
+
+// 上次运行留下、已经到期的重试记录
+// 模拟 Bot 的发送：参数按引用传入，在 Bot 的 io_context 上等待一段时间
+auto slow_send(asio::io_context &bot, std::string_view group_id,
+               std::promise<void> &sending, std::atomic<bool> &finished)
+    -> asio::awaitable<std::string> {
+  sending.set_value();
+  asio::steady_timer timer(bot, 200ms);
+  co_await timer.async_wait(asio::use_awaitable);
+  EXPECT_EQ(group_id, "-100");
+  finished = true;
+  co_return R"({"ok":true,"result":{"message_id":42}})";
+}
+
+auto stored_retry(const std::string &message_id, const std::string &group_id)
+    -> MessageRetryInfo {
+  MessageRetryInfo info;
+  info.source_platform = "qq";
+  info.target_platform = "telegram";
+  info.source_message_id = message_id;
+  info.message_content = R"([{"type":"text","data":{"text":"hi"}}])";
+  info.group_id = group_id;
+  info.source_group_id = "123";
+  info.target_topic_id = -1;
+  info.retry_count = 1;
+  info.max_retry_count = 5;
+  info.retry_type = "message_send";
+  info.created_at = std::chrono::system_clock::now() - 1min;
+  info.last_attempt_at = info.created_at;
+  info.next_retry_at = std::chrono::system_clock::now() - 1s;
+  return info;
+}
+
+} // namespace
+
+TEST_F(RetryQueueManagerTest, RetryRunsAtItsDeadlineInsteadOfNextPoll) {
+  // 第一次重试在 1~2 秒后（带随机抖动），不再等到下一个 10 秒的轮询
+  retries_->add_message_retry("qq", "telegram", "1", text_message("hi"),
+                              "-100", "123", -1);
+
+  const auto elapsed = run_until_attempt();
+  ASSERT_TRUE(elapsed.has_value());
+  EXPECT_GE(*elapsed, 900ms);
+  EXPECT_LT(*elapsed, 3s);
+
+  EXPECT_EQ(db_->get_target_message_id("qq", "1", "telegram"), "42");
+  EXPECT_TRUE(db_->get_pending_message_retries(
+                     100, std::chrono::system_clock::time_point::max())
+                  .empty());
+}
+
+TEST_F(RetryQueueManagerTest, AddingRetryDoesNotWriteOnCallerThread) {
+  // 写库在管理器的 strand 上进行，调用方（Bot 的 io 线程）不等待 SQLite
+  retries_->add_message_retry("qq", "telegram", "1", text_message("hi"),
+                              "-100", "123", -1);
+  const auto stored = [&] {
+    return db_->get_pending_message_retries(
+        100, std::chrono::system_clock::time_point::max());
+  };
+  EXPECT_TRUE(stored().empty());
+
+  ioc_.poll();
+  ASSERT_EQ(stored().size(), 1U);
+  EXPECT_EQ(stored().front().source_message_id, "1");
+}
+
+TEST_F(RetryQueueManagerTest, StoredRetriesAreLoadedOnStart) {
+  ASSERT_TRUE(db_->add_message_retry(stored_retry("7", "-100")));
+
+  // 上次运行留下的到期记录在启动后立即重试
+  const auto elapsed = run_until_attempt();
+  ASSERT_TRUE(elapsed.has_value());
+  EXPECT_LT(*elapsed, 1s);
+  EXPECT_EQ(db_->get_target_message_id("qq", "7", "telegram"), "42");
+}
+
+TEST_F(RetryQueueManagerTest, ConcurrentRetriesAreCapped) {
+  constexpr int kRetries = 8;
+  for (int i = 0; i < kRetries; ++i) {
+    ASSERT_TRUE(db_->add_message_retry(
+        stored_retry(std::to_string(i), std::to_string(-100 - i))));
+  }
+
+  retries_ = std::make_unique<RetryQueueManager>(
+      db_, ioc_, RetryLimits{.max_concurrent = 3});
+  int in_flight = 0;
+  int peak = 0;
+  int done = 0;
+  retries_->register_message_send_callback(
+      "telegram",
+      [&](const MessageRetryInfo &info, const common::Message &)
+          -> asio::awaitable<RetryQueueManager::SendResult> {
+        peak = std::max(peak, ++in_flight);
+        asio::steady_timer timer(co_await asio::this_coro::executor, 100ms);
+        co_await timer.async_wait(asio::use_awaitable);
+        --in_flight;
+        if (++done == kRetries) {
+          retries_->stop();
+        }
+        co_return RetryQueueManager::SendResult{.message_id =
+                                                    info.source_message_id};
+      });
+
+  retries_->start();
+  ioc_.run_for(5s);
+
+  EXPECT_EQ(done, kRetries);
+  EXPECT_EQ(peak, 3);
+}
+
+TEST_F(RetryQueueManagerTest, RateLimitedRetryWaitsWithoutCountingAttempt) {
+  ASSERT_TRUE(db_->add_message_retry(stored_retry("7", "-100")));
+
+  std::vector<std::chrono::steady_clock::time_point> attempts;
+  retries_->register_message_send_callback(
+      "telegram",
+      [&](const MessageRetryInfo &info, const common::Message &)
+          -> asio::awaitable<RetryQueueManager::SendResult> {
+        attempts.push_back(std::chrono::steady_clock::now());
+        if (attempts.size() == 1) {
+          co_return RetryQueueManager::SendResult{.retry_after = 1s};
+        }
+        // 限流不计入重试次数
+        EXPECT_EQ(info.retry_count, 1);
+        retries_->stop();
+        co_return RetryQueueManager::SendResult{.message_id = "42"};
+      });
+
+  retries_->start();
+  ioc_.run_for(5s);
+
+  ASSERT_EQ(attempts.size(), 2U);
+  EXPECT_GE(attempts[1] - attempts[0], 950ms);
+  EXPECT_LT(attempts[1] - attempts[0], 2s);
+  EXPECT_EQ(db_->get_target_message_id("qq", "7", "telegram"), "42");
+}
+
+TEST_F(RetryQueueManagerTest, WorkerRunsRetriesOnItsOwnThread) {
+  ASSERT_TRUE(db_->add_message_retry(stored_retry("7", "-100")));
+
+  // 与插件相同：注册回调后启动，由 RetryWorker 的线程运行 io_context
+  RetryWorker worker(db_);
+  std::promise<std::thread::id> sent_on;
+  worker.manager()->register_message_send_callback(
+      "telegram",
+      [&](const MessageRetryInfo &, const common::Message &)
+          -> asio::awaitable<RetryQueueManager::SendResult> {
+        sent_on.set_value(std::this_thread::get_id());
+        co_return RetryQueueManager::SendResult{.message_id = "42"};
+      });
+  worker.start();
+
+  auto sent = sent_on.get_future();
+  ASSERT_EQ(sent.wait_for(5s), std::future_status::ready);
+  EXPECT_NE(sent.get(), std::this_thread::get_id());
+
+  // stop() 等进行中的重试结束，完成的记录不再留在内存中
+  worker.stop();
+  EXPECT_EQ(db_->get_target_message_id("qq", "7", "telegram"), "42");
+  EXPECT_NE(worker.manager()->get_retry_statistics().find("待重试消息数: 0"),
+            std::string::npos);
+}
+
+TEST_F(RetryQueueManagerTest, WorkerRunsDueRetriesInParallel) {
+  // 同一会话也不在这里限速，交给目标 Bot 的发送调度器
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(db_->add_message_retry(
+        stored_retry(std::to_string(i), std::to_string(-100 - i))));
+  }
+  for (int i = 3; i < 6; ++i) {
+    ASSERT_TRUE(db_->add_message_retry(stored_retry(std::to_string(i), "-1")));
+  }
+
+  RetryWorker worker(db_, RetryLimits{.max_concurrent = 4});
+  std::mutex mutex;
+  int in_flight = 0;
+  int peak = 0;
+  worker.manager()->register_message_send_callback(
+      "telegram",
+      [&](const MessageRetryInfo &info, const common::Message &)
+          -> asio::awaitable<RetryQueueManager::SendResult> {
+        {
+          std::lock_guard lock(mutex);
+          peak = std::max(peak, ++in_flight);
+        }
+        asio::steady_timer timer(co_await asio::this_coro::executor, 50ms);
+        co_await timer.async_wait(asio::use_awaitable);
+        {
+          std::lock_guard lock(mutex);
+          --in_flight;
+        }
+        co_return RetryQueueManager::SendResult{.message_id =
+                                                    info.source_message_id};
+      });
+  worker.start();
+
+  // 全部发出并记录映射后停止
+  const auto all_mapped = [&] {
+    for (int i = 0; i < 6; ++i) {
+      if (!db_->get_target_message_id("qq", std::to_string(i), "telegram")) {
+        return false;
+      }
+    }
+    return true;
+  };
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (!all_mapped() && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(10ms);
+  }
+  worker.stop();
+
+  EXPECT_TRUE(all_mapped());
+  EXPECT_GT(peak, 1);
+  EXPECT_LE(peak, 4);
+}
+
+TEST_F(RetryQueueManagerTest, WorkerStopsWhileSendWaitsOnStoppedBot) {
+  ASSERT_TRUE(db_->add_message_retry(stored_retry("7", "-100")));
+
+  // 与插件关闭时相同：Bot 的 io_context 已停止，发送永远不会运行
+  asio::io_context bot;
+  bot.stop();
+  RetryWorker worker(db_);
+  std::promise<void> waiting;
+  worker.manager()->register_message_send_callback(
+      "telegram",
+      [&](const MessageRetryInfo &, const common::Message &)
+          -> asio::awaitable<RetryQueueManager::SendResult> {
+        waiting.set_value();
+        try {
+          auto send = []() -> asio::awaitable<std::string> {
+            co_return R"({"ok":true,"result":{"message_id":42}})";
+          };
+          co_await worker.manager()->run_send(bot, std::move(send));
+        } catch (const boost::system::system_error &e) {
+          EXPECT_EQ(e.code(), asio::error::operation_aborted);
+        }
+        co_return RetryQueueManager::SendResult{};
+      });
+  worker.start();
+  ASSERT_EQ(waiting.get_future().wait_for(5s), std::future_status::ready);
+
+  // stop() 打断等待后返回，被打断的重发不计入重试次数
+  const auto started = std::chrono::steady_clock::now();
+  worker.stop();
+  EXPECT_LT(std::chrono::steady_clock::now() - started, 1s);
+  const auto stored = db_->get_pending_message_retries(
+      100, std::chrono::system_clock::time_point::max());
+  ASSERT_EQ(stored.size(), 1U);
+  EXPECT_EQ(stored.front().retry_count, 1);
+}
+
+TEST_F(RetryQueueManagerTest, WorkerStopWaitsForSendOnRunningBot) {
+  ASSERT_TRUE(db_->add_message_retry(stored_retry("7", "-100")));
+
+  // 与插件重载时相同：Bot 继续运行，stop() 返回后插件代码即被卸载
+  asio::io_context bot;
+  auto work = asio::make_work_guard(bot);
+  std::thread bot_thread([&bot] { bot.run(); });
+  RetryWorker worker(db_);
+  std::promise<void> sending;
+  std::atomic<bool> send_finished = false;
+  worker.manager()->register_message_send_callback(
+      "telegram",
+      [&](const MessageRetryInfo &info, const common::Message &)
+          -> asio::awaitable<RetryQueueManager::SendResult> {
+        try {
+          // 与插件相同：工厂按值捕获参数，发送协程按引用使用它们，等待方
+          // 的协程帧先销毁也能运行完
+          auto send = [&bot, &sending, &send_finished,
+                       group_id = info.group_id] {
+            return slow_send(bot, group_id, sending, send_finished);
+          };
+          co_await worker.manager()->run_send(bot, std::move(send));
+        } catch (const boost::system::system_error &e) {
+          EXPECT_EQ(e.code(), asio::error::operation_aborted);
+        }
+        co_return RetryQueueManager::SendResult{};
+      });
+  worker.start();
+  ASSERT_EQ(sending.get_future().wait_for(5s), std::future_status::ready);
+
+  // stop() 打断等待，但等 Bot 上的发送结束后才返回
+  worker.stop();
+  EXPECT_TRUE(send_finished);
+
+  work.reset();
+  bot_thread.join();
+}
+
+TEST(RetryQueueManagerParseTest, ReadsMessageIdFromSendResponse) {
+  EXPECT_EQ(RetryQueueManager::send_result_from_response(
+                R"({"ok":true,"result":{"message_id":5}})")
+                .message_id,
+            "5");
+  EXPECT_EQ(RetryQueueManager::send_result_from_response(
+                R"({"status":"ok","retcode":0,"data":{"message_id":6}})")
+                .message_id,
+            "6");
+
+  const auto limited = RetryQueueManager::send_result_from_response(
+      R"({"ok":false,"error_code":429,"parameters":{"retry_after":3}})");
+  EXPECT_FALSE(limited.message_id.has_value());
+  EXPECT_EQ(limited.retry_after, 3s);
+
+  const auto failed = RetryQueueManager::send_result_from_response("");
+  EXPECT_FALSE(failed.message_id.has_value());
+  EXPECT_FALSE(failed.retry_after.has_value());
+}
+
+TEST(RetryQueueManagerParseTest, ReadsRetryAfterFromErrorResponse) {
+  EXPECT_EQ(RetryQueueManager::retry_after_from_response(
+                R"({"ok":false,"error_code":429,)"
+                R"("description":"Too Many Requests: retry after 7",)"
+                R"("parameters":{"retry_after":7}})"),
+            7s);
+  EXPECT_FALSE(RetryQueueManager::retry_after_from_response(
+                   R"({"ok":true,"result":{"message_id":1}})")
+                   .has_value());
+  EXPECT_FALSE(RetryQueueManager::retry_after_from_response(
+                   R"({"ok":false,"error_code":400})")
+                   .has_value());
+  EXPECT_FALSE(
+      RetryQueueManager::retry_after_from_response("not json").has_value());
+}
+
+} // namespace obcx::test
@@ -0,0 +1,237 @@
+#include <gtest/gtest.h>
+
+#include "core/send_scheduler.hpp"
+#include "network/http_client.hpp"
+#include <boost/asio/bind_cancellation_slot.hpp>
+#include <boost/asio/cancellation_signal.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+namespace obcx::test {
+
+using common::TokenBucket;
+using core::SendPriority;
+using core::SendScheduler;
+
+using namespace std::chrono_literals;
+
+namespace asio = boost::asio;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 记录每次请求的发出时间与顺序
+class SendSchedulerTest : public ::testing::Test {
+protected:
+  void send(SendScheduler &scheduler, std::string chat_id,
+            SendPriority priority, std::string name) {
+    asio::co_spawn(ioc_,
+                   submit(scheduler, std::move(chat_id), priority,
+                          std::move(name)),
+                   asio::detached);
+  }
+
+  auto submit(SendScheduler &scheduler, std::string chat_id,
+              SendPriority priority, std::string name)
+      -> asio::awaitable<void> {
+    SendScheduler::Request request =
+        [this, name]() -> asio::awaitable<std::string> {
+      sent_.emplace_back(name, Clock::now() - started_);
+      co_return name;
+    };
+    co_await scheduler.submit(std::move(chat_id), priority,
+                              std::move(request));
+  }
+
+  auto order() const -> std::vector<std::string> {
+    std::vector<std::string> names;
+    for (const auto &[name, at] : sent_) {
+      names.push_back(name);
+    }
+    return names;
+  }
+
+  asio::io_context ioc_;
+  Clock::time_point started_ = Clock::now();
+  std::vector<std::pair<std::string, Clock::duration>> sent_;
+};
+
+} // namespace
+
+TEST_F(SendSchedulerTest, GroupBurstThenRate) {
+  SendScheduler scheduler(ioc_, {.group_rate = 10, .group_burst = 2});
+  for (const auto *name : {"a", "b", "c", "d"}) {
+    send(scheduler, "-1", SendPriority::interactive, name);
+  }
+  ioc_.run_for(5s);
+
+  ASSERT_EQ(order(), (std::vector<std::string>{"a", "b", "c", "d"}));
+  // 突发量内立即发出，之后每 100ms 一条
+  EXPECT_LT(sent_[1].second, 50ms);
+  EXPECT_GE(sent_[2].second, 90ms);
+  EXPECT_GE(sent_[3].second, 190ms);
+  EXPECT_LT(sent_[3].second, 1s);
+}
+
+TEST_F(SendSchedulerTest, LimitedChatDoesNotBlockOthers) {
+  SendScheduler scheduler(ioc_, {.group_rate = 1, .group_burst = 1});
+  send(scheduler, "-1", SendPriority::interactive, "first");
+  send(scheduler, "-1", SendPriority::interactive, "waits");
+  send(scheduler, "-2", SendPriority::interactive, "other");
+  ioc_.run_for(5s);
+
+  ASSERT_EQ(order(), (std::vector<std::string>{"first", "other", "waits"}));
+  EXPECT_LT(sent_[1].second, 50ms);
+  EXPECT_GE(sent_[2].second, 900ms);
+}
+
+TEST_F(SendSchedulerTest, InteractiveGoesAheadOfBulk) {
+  // 全局每 100ms 一个令牌，排队时按优先级分配
+  SendScheduler scheduler(ioc_, {.global_rate = 10, .global_burst = 1});
+  send(scheduler, "-1", SendPriority::bulk, "bulk-1");
+  send(scheduler, "-2", SendPriority::notification, "notice");
+  send(scheduler, "-3", SendPriority::bulk, "bulk-2");
+  send(scheduler, "-4", SendPriority::interactive, "user");
+  ioc_.run_for(5s);
+
+  EXPECT_EQ(order(), (std::vector<std::string>{"bulk-1", "user", "bulk-2",
+                                               "notice"}));
+}
+
+TEST_F(SendSchedulerTest, BulkYieldsToInteractiveInSameChat) {
+  // 重发与合并转发走批量队列，之后到达的普通消息先发
+  SendScheduler scheduler(ioc_, {.group_rate = 10, .group_burst = 1});
+  send(scheduler, "-1", SendPriority::interactive, "first");
+  send(scheduler, "-1", SendPriority::bulk, "resend-1");
+  send(scheduler, "-1", SendPriority::bulk, "resend-2");
+  send(scheduler, "-1", SendPriority::interactive, "reply");
+  ioc_.run_for(5s);
+
+  EXPECT_EQ(order(), (std::vector<std::string>{"first", "reply", "resend-1",
+                                               "resend-2"}));
+}
+
+TEST_F(SendSchedulerTest, CancelledSendLeavesQueue) {
+  SendScheduler scheduler(ioc_, {.group_rate = 1, .group_burst = 1});
+  send(scheduler, "-1", SendPriority::interactive, "first");
+
+  asio::cancellation_signal cancel;
+  asio::co_spawn(ioc_,
+                 submit(scheduler, "-1", SendPriority::interactive,
+                        "cancelled"),
+                 asio::bind_cancellation_slot(cancel.slot(), asio::detached));
+  send(scheduler, "-1", SendPriority::interactive, "next");
+
+  asio::steady_timer timer(ioc_, 100ms);
+  timer.async_wait([&](const boost::system::error_code &) {
+    cancel.emit(asio::cancellation_type::terminal);
+  });
+  ioc_.run_for(5s);
+
+  // 取消的请求不再占用令牌，下一条在 1 秒后发出
+  ASSERT_EQ(order(), (std::vector<std::string>{"first", "next"}));
+  EXPECT_GE(sent_[1].second, 900ms);
+  EXPECT_LT(sent_[1].second, 1500ms);
+}
+
+TEST_F(SendSchedulerTest, RetriesAfterRateLimit) {
+  SendScheduler scheduler(ioc_);
+  int attempts = 0;
+  std::optional<std::string> result;
+  asio::co_spawn(
+      ioc_,
+      [&]() -> asio::awaitable<void> {
+        SendScheduler::Request request =
+            [&]() -> asio::awaitable<std::string> {
+          if (++attempts == 1) {
+            throw network::HttpRateLimitError("429", 1s);
+          }
+          sent_.emplace_back("ok", Clock::now() - started_);
+          co_return "ok";
+        };
+        result = co_await scheduler.submit("-1", SendPriority::interactive,
+                                           std::move(request));
+      },
+      asio::detached);
+  ioc_.run_for(5s);
+
+  EXPECT_EQ(result, "ok");
+  EXPECT_EQ(attempts, 2);
+  ASSERT_EQ(sent_.size(), 1U);
+  EXPECT_GE(sent_[0].second, 950ms);
+  EXPECT_LT(sent_[0].second, 2s);
+}
+
+TEST_F(SendSchedulerTest, GivesUpAfterMaxRateLimitedRetries) {
+  SendScheduler scheduler(ioc_, {.max_rate_limited_retries = 0});
+  bool rate_limited = false;
+  asio::co_spawn(
+      ioc_,
+      [&]() -> asio::awaitable<void> {
+        SendScheduler::Request request = []() -> asio::awaitable<std::string> {
+          throw network::HttpRateLimitError("429", 1s);
+          co_return "";
+        };
+        try {
+          co_await scheduler.submit("-1", SendPriority::interactive,
+                                    std::move(request));
+        } catch (const network::HttpRateLimitError &) {
+          rate_limited = true;
+        }
+      },
+      asio::detached);
+  ioc_.run_for(5s);
+
+  EXPECT_TRUE(rate_limited);
+}
+
+TEST(TokenBucketTest, RefillsAtRateUpToBurst) {
+  const auto start = TokenBucket::Clock::time_point{};
+  TokenBucket bucket(2.0, 2.0, start);
+
+  // 初始满桶，可以连发 burst 个
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(bucket.wait_time(start), TokenBucket::Clock::duration::zero());
+    bucket.consume();
+  }
+  EXPECT_EQ(bucket.wait_time(start), 500ms);
+
+  // 空闲很久也只积攒 burst 个
+  const auto later = start + 10s;
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(bucket.wait_time(later), TokenBucket::Clock::duration::zero());
+    bucket.consume();
+  }
+  EXPECT_GT(bucket.wait_time(later), TokenBucket::Clock::duration::zero());
+}
+
+TEST(TokenBucketTest, IdleOnceRefilledAndNotPaused) {
+  const auto start = TokenBucket::Clock::time_point{};
+  TokenBucket bucket(1.0, 2.0, start);
+  EXPECT_TRUE(bucket.idle(start));
+
+  bucket.consume();
+  EXPECT_FALSE(bucket.idle(start));
+  EXPECT_TRUE(bucket.idle(start + 1s));
+
+  // 暂停期间即使补满也要保留
+  bucket.pause_until(start + 10s);
+  EXPECT_FALSE(bucket.idle(start + 5s));
+  EXPECT_TRUE(bucket.idle(start + 11s));
+}
+
+TEST(TokenBucketTest, PauseBlocksUntilDeadline) {
+  const auto start = TokenBucket::Clock::time_point{};
+  TokenBucket bucket(1.0, 5.0, start);
+
+  bucket.pause_until(start + 3s);
+  EXPECT_EQ(bucket.wait_time(start + 1s), 2s);
+  // 暂停结束时只放行一个，之后按速率补充
+  EXPECT_EQ(bucket.wait_time(start + 3s), TokenBucket::Clock::duration::zero());
+  bucket.consume();
+  EXPECT_EQ(bucket.wait_time(start + 3s), 1s);
+}
+
+} // namespace obcx::test
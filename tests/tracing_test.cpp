@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include "common/tracing.hpp"
+#include <algorithm>
+#include <boost/asio.hpp>
+#include <nlohmann/json.hpp>
+#include <string_view>
+
+namespace obcx::test {
+
+using common::current_trace_id;
+using common::Span;
+using common::TraceContext;
+using common::TraceExecutor;
+using common::Tracer;
+using common::TraceScope;
+
+namespace asio = boost::asio;
+
+namespace {
+
+auto spans_of(uint64_t trace_id) -> std::vector<common::SpanRecord> {
+  auto spans = Tracer::instance().snapshot();
+  std::erase_if(spans, [trace_id](const common::SpanRecord &span) {
+    return span.trace_id != trace_id;
+  });
+  return spans;
+}
+
+} // namespace
+
+TEST(TracingTest, SpansRecordOnlyInsideATrace) {
+  auto &tracer = Tracer::instance();
+  tracer.start();
+
+  { const Span untraced("untraced"); }
+  EXPECT_EQ(spans_of(0).size(), 0u);
+
+  const auto trace_id = tracer.new_trace();
+  ASSERT_NE(trace_id, 0u);
+  {
+    const TraceScope scope(trace_id);
+    EXPECT_EQ(current_trace_id(), trace_id);
+    {
+      const TraceScope nested(tracer.new_trace());
+      EXPECT_NE(current_trace_id(), trace_id);
+    }
+    EXPECT_EQ(current_trace_id(), trace_id);
+    const Span outer("outer");
+    { const Span inner("inner"); }
+  }
+  EXPECT_EQ(current_trace_id(), 0u);
+
+  const auto spans = spans_of(trace_id);
+  ASSERT_EQ(spans.size(), 2u);
+  // 按开始时间排序：外层先开始，内层先结束
+  EXPECT_EQ(std::string_view(spans[0].name), "outer");
+  EXPECT_EQ(std::string_view(spans[1].name), "inner");
+  EXPECT_LE(spans[1].start_ns + spans[1].duration_ns,
+            spans[0].start_ns + spans[0].duration_ns);
+}
+
+TEST(TracingTest, RingBufferKeepsNewestSpans) {
+  Tracer tracer;
+  tracer.record("ignored", 1, 0, 1);
+  EXPECT_TRUE(tracer.snapshot().empty());
+
+  tracer.start(3); // 取整为 4
+  for (uint64_t i = 0; i < 10; ++i) {
+    tracer.record("span", i + 1, i * 10, i * 10 + 5);
+  }
+  const auto spans = tracer.snapshot();
+  ASSERT_EQ(spans.size(), 4u);
+  for (std::size_t i = 0; i < spans.size(); ++i) {
+    EXPECT_EQ(spans[i].trace_id, 7 + i);
+    EXPECT_EQ(spans[i].duration_ns, 5u);
+  }
+
+  tracer.stop();
+  EXPECT_EQ(tracer.new_trace(), 0u);
+  tracer.record("ignored", 1, 0, 1);
+  EXPECT_EQ(tracer.snapshot().size(), 4u);
+}
+
+TEST(TracingTest, ExportsChromeTraceEvents) {
+  Tracer tracer;
+  tracer.start(16);
+  tracer.record("ws.frame", 42, 1'500, 4'000);
+  tracer.record("handler", 42, 3'000, 9'250, true);
+
+  const auto trace = nlohmann::json::parse(tracer.export_chrome_json());
+  const auto &events = trace.at("traceEvents");
+  ASSERT_EQ(events.size(), 4u); // 进程名 + X + b/e
+
+  const auto &complete = events[1];
+  EXPECT_EQ(complete["ph"], "X");
+  EXPECT_EQ(complete["name"], "ws.frame");
+  EXPECT_DOUBLE_EQ(complete["ts"].get<double>(), 1.5);
+  EXPECT_DOUBLE_EQ(complete["dur"].get<double>(), 2.5);
+  EXPECT_EQ(complete["args"]["trace_id"], 42);
+
+  EXPECT_EQ(events[2]["ph"], "b");
+  EXPECT_EQ(events[3]["ph"], "e");
+  EXPECT_EQ(events[2]["id"], events[3]["id"]);
+  EXPECT_DOUBLE_EQ(events[3]["ts"].get<double>(), 9.25);
+}
+
+TEST(TracingTest, ExecutorCarriesTraceAcrossSuspension) {
+  auto &tracer = Tracer::instance();
+  tracer.start();
+
+  asio::io_context ioc;
+  std::vector<std::pair<uint64_t, uint64_t>> seen;
+  std::vector<uint64_t> ids;
+  for (int i = 0; i < 2; ++i) {
+    const auto trace_id = tracer.new_trace();
+    ids.push_back(trace_id);
+    asio::co_spawn(
+        TraceExecutor(ioc.get_executor(),
+                      std::make_shared<TraceContext>(trace_id)),
+        [&seen, trace_id]() -> asio::awaitable<void> {
+          const Span span("coroutine", true);
+          asio::steady_timer timer(co_await asio::this_coro::executor,
+                                   std::chrono::milliseconds(5));
+          co_await timer.async_wait(asio::use_awaitable);
+          seen.emplace_back(trace_id, current_trace_id());
+          co_await asio::post(asio::use_awaitable);
+          seen.emplace_back(trace_id, current_trace_id());
+        },
+        asio::detached);
+  }
+  ioc.run();
+  EXPECT_EQ(current_trace_id(), 0u);
+
+  ASSERT_EQ(seen.size(), 4u);
+  for (const auto &[expected, actual] : seen) {
+    EXPECT_EQ(actual, expected);
+  }
+  for (const auto trace_id : ids) {
+    const auto spans = spans_of(trace_id);
+    ASSERT_EQ(spans.size(), 1u);
+    EXPECT_TRUE(spans[0].async);
+    EXPECT_GE(spans[0].duration_ns, 5'000'000u);
+  }
+}
+
+} // namespace obcx::test